@@ -0,0 +1,194 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <drogon/orm/DbClient.h>
+#include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
+
+namespace student_attendance
+{
+namespace benchmarks
+{
+
+// Synthetic school: one attendance row per student per school day, forty
+// students to a class. Everything is derived from the row number, so a
+// given size always produces the same data.
+struct Dataset
+{
+    static constexpr int64_t kDaysPerStudent = 40;
+    static constexpr int64_t kStudentsPerClass = 40;
+    static constexpr utils::Date kFirstDay = utils::Date::fromYmd(2024, 9, 2);
+
+    int64_t records = 0;
+    int64_t students = 0;
+    int64_t classes = 0;
+    int64_t days = 0;
+
+    static Dataset ofSize(int64_t records)
+    {
+        Dataset data;
+        data.records = records;
+        data.students = std::max<int64_t>(records / kDaysPerStudent, 1);
+        data.classes = std::max<int64_t>(data.students / kStudentsPerClass, 1);
+        data.days = (records + data.students - 1) / data.students;
+        return data;
+    }
+
+    static std::string studentId(int64_t n)
+    {
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "S%08lld", static_cast<long long>(n));
+        return buffer;
+    }
+
+    static std::string studentName(int64_t n)
+    {
+        return "学生" + std::to_string(n);
+    }
+
+    static std::string className(int64_t c)
+    {
+        char buffer[40];
+        std::snprintf(buffer, sizeof(buffer), "班级%04lld", static_cast<long long>(c));
+        return buffer;
+    }
+
+    int64_t classOf(int64_t student) const { return student % classes; }
+    int64_t studentOf(int64_t row) const { return row % students; }
+    utils::Date dayOf(int64_t row) const
+    {
+        return utils::Date::fromOrdinal(kFirstDay.ordinal() + static_cast<int32_t>(row / students));
+    }
+    utils::Date lastDay() const { return dayOf(records - 1); }
+
+    // Roughly 85% present, the rest spread over the other statuses
+    static utils::StatusCode statusOf(int64_t row)
+    {
+        uint64_t h = static_cast<uint64_t>(row) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+        auto bucket = h % 100;
+        if (bucket < 85)
+            return utils::StatusCode::Present;
+        return static_cast<utils::StatusCode>(1 + (bucket - 85) % (utils::kStatusCount - 1));
+    }
+
+    models::Student student(int64_t n) const
+    {
+        return models::Student(studentId(n), studentName(n), className(classOf(n)));
+    }
+
+    models::Attendance attendance(int64_t row) const
+    {
+        auto n = studentOf(row);
+        return models::Attendance(0, studentId(n), studentName(n), className(classOf(n)),
+                                  dayOf(row), statusOf(row));
+    }
+};
+
+inline Dataset &loadedDataStore()
+{
+    static Dataset loaded;
+    return loaded;
+}
+
+// Replaces the DataStore contents with the dataset of the given size. The
+// store is a singleton, so consecutive runs of the same size reuse it.
+inline const Dataset &loadDataStore(int64_t records)
+{
+    auto &loaded = loadedDataStore();
+    if (loaded.records == records)
+    {
+        return loaded;
+    }
+
+    auto &store = models::DataStore::getInstance();
+    store.clear();
+    auto data = Dataset::ofSize(records);
+
+    std::vector<models::Student> students;
+    students.reserve(static_cast<size_t>(data.students));
+    for (int64_t n = 0; n < data.students; ++n)
+    {
+        students.push_back(data.student(n));
+    }
+    store.importStudents(students);
+
+    // Chunked so a 10M-row load does not materialize every row at once
+    constexpr int64_t kChunk = 1 << 16;
+    std::vector<models::Attendance> chunk;
+    chunk.reserve(kChunk);
+    for (int64_t row = 0; row < data.records; row += kChunk)
+    {
+        chunk.clear();
+        auto end = std::min(row + kChunk, data.records);
+        for (int64_t r = row; r < end; ++r)
+        {
+            chunk.push_back(data.attendance(r));
+        }
+        store.importAttendances(chunk);
+    }
+
+    loaded = data;
+    return loaded;
+}
+
+// For benchmarks that write: the next loadDataStore() starts over.
+inline void invalidateDataStore()
+{
+    loadedDataStore().records = -1;
+}
+
+// Replaces the rows of a SQLite database with `data`. Rows are generated
+// inside SQLite, so large sizes load quickly.
+inline void fillSqlite(drogon::orm::DbClient &client, const Dataset &data)
+{
+    client.execSqlSync("DELETE FROM attendances");
+    client.execSqlSync("DELETE FROM students");
+    client.execSqlSync("DELETE FROM sqlite_sequence WHERE name='attendances'");
+    client.execSqlSync(
+        "INSERT INTO students (student_id, name, class_name) "
+        "WITH RECURSIVE seq(n) AS (SELECT 0 UNION ALL SELECT n + 1 FROM seq WHERE n + 1 < ?) "
+        "SELECT printf('S%08d', n), '学生' || n, printf('班级%04d', n % ?) FROM seq",
+        data.students, data.classes);
+    // Roughly 85% present, as in the in-memory dataset
+    client.execSqlSync(
+        "INSERT INTO attendances (student_id, date, status, remark) "
+        "WITH RECURSIVE seq(n) AS (SELECT 0 UNION ALL SELECT n + 1 FROM seq WHERE n + 1 < ?) "
+        "SELECT printf('S%08d', n % ?), ? + n / ?, "
+        "CASE WHEN n * 7919 % 100 < 85 THEN 0 ELSE 1 + (n * 7919 % 100 - 85) % 5 END, '' "
+        "FROM seq",
+        data.records, data.students, Dataset::kFirstDay.ordinal(), data.students);
+    client.execSqlSync("ANALYZE");
+}
+
+// The largest dataset to run. Defaults to 1M rows; set
+// STUDENT_ATTENDANCE_BENCH_MAX_RECORDS=10000000 for the 10M runs.
+inline int64_t maxRecords()
+{
+    int64_t ceiling = 1'000'000;
+    if (const char *env = std::getenv("STUDENT_ATTENDANCE_BENCH_MAX_RECORDS"))
+    {
+        ceiling = std::clamp<int64_t>(std::atoll(env), 1'000, 10'000'000);
+    }
+    return ceiling;
+}
+
+// Dataset sizes from 1k rows up by powers of ten, to maxRecords()
+inline void datasetSizes(benchmark::internal::Benchmark *bench)
+{
+    for (int64_t size = 1'000; size <= maxRecords(); size *= 10)
+    {
+        bench->Arg(size);
+    }
+    bench->ArgName("records");
+}
+
+}  // namespace benchmarks
+}  // namespace student_attendance
@@ -0,0 +1,189 @@
+#include "Dataset.h"
+#include "student_attendance/services/ImportService.h"
+#include "student_attendance/utils/CsvReader.h"
+#include "student_attendance/utils/CsvScanner.h"
+#include <sstream>
+
+using namespace student_attendance;
+using student_attendance::benchmarks::Dataset;
+using student_attendance::benchmarks::invalidateDataStore;
+using student_attendance::services::ImportService;
+using student_attendance::utils::CsvReader;
+using student_attendance::utils::CsvScanner;
+
+namespace
+{
+
+constexpr int64_t kMiB = 1 << 20;
+// Bytes handed to the reader per feed(), as the importer does
+constexpr size_t kChunkSize = 64 * 1024;
+
+struct CsvFile
+{
+    int64_t mib = 0;
+    Dataset data;
+    std::string text;
+};
+
+// An attendance CSV of about `mib` MiB in the export layout. Every 16th
+// remark needs quoting. Kept between runs of the same size.
+const CsvFile &csvFile(int64_t mib)
+{
+    static CsvFile file;
+    if (file.mib == mib)
+    {
+        return file;
+    }
+
+    // About 60 bytes per row
+    file.mib = mib;
+    file.data = Dataset::ofSize(mib * kMiB / 60);
+    file.text.clear();
+    file.text.reserve(static_cast<size_t>(mib * kMiB + kMiB));
+    file.text += "id,student_id,name,class,date,status,remark\n";
+    for (int64_t row = 0; row < file.data.records; ++row)
+    {
+        auto n = file.data.studentOf(row);
+        file.text += std::to_string(row + 1);
+        file.text += ',';
+        file.text += Dataset::studentId(n);
+        file.text += ',';
+        file.text += Dataset::studentName(n);
+        file.text += ',';
+        file.text += Dataset::className(file.data.classOf(n));
+        file.text += ',';
+        file.text += file.data.dayOf(row).toString();
+        file.text += ',';
+        file.text += utils::AttendanceStatus::toString(Dataset::statusOf(row));
+        file.text += row % 16 == 0 ? ",\"病假,已补假条\"\n" : ",\n";
+    }
+    return file;
+}
+
+// What an import would do without a tokenizer: getline, then a byte loop
+// building a std::string per field.
+void BM_Csv_Naive(benchmark::State &state)
+{
+    const auto &file = csvFile(state.range(0));
+    for (auto _ : state)
+    {
+        std::istringstream in(file.text);
+        std::string line;
+        std::vector<std::string> fields;
+        int64_t count = 0;
+        while (std::getline(in, line))
+        {
+            fields.clear();
+            std::string field;
+            bool quoted = false;
+            for (char c : line)
+            {
+                if (c == '"')
+                    quoted = !quoted;
+                else if (c == ',' && !quoted)
+                {
+                    fields.push_back(std::move(field));
+                    field.clear();
+                }
+                else
+                    field += c;
+            }
+            fields.push_back(std::move(field));
+            count += static_cast<int64_t>(fields.size());
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.text.size()));
+}
+BENCHMARK(BM_Csv_Naive)->Arg(16)->Arg(256)->ArgName("MiB")->Unit(benchmark::kMillisecond);
+
+void BM_Csv_Reader(benchmark::State &state)
+{
+    auto level = static_cast<CsvScanner::Level>(state.range(0));
+    if (level > CsvScanner::bestLevel())
+    {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    const auto &file = csvFile(state.range(1));
+    std::string_view text(file.text);
+    for (auto _ : state)
+    {
+        CsvReader reader(level);
+        int64_t count = 0;
+        auto onRecord = [&](int64_t, const std::vector<std::string_view> &fields) {
+            count += static_cast<int64_t>(fields.size());
+        };
+        for (size_t offset = 0; offset < text.size(); offset += kChunkSize)
+        {
+            reader.feed(text.substr(offset, kChunkSize), onRecord);
+        }
+        reader.finish(onRecord);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetLabel(CsvScanner::levelName(level));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.text.size()));
+}
+BENCHMARK(BM_Csv_Reader)
+    ->ArgsProduct({{0, 1, 2}, {16, 256}})
+    ->ArgNames({"level", "MiB"})
+    ->Unit(benchmark::kMillisecond);
+
+// The scanner alone: every special byte of the file
+void BM_Csv_Scan(benchmark::State &state)
+{
+    auto level = static_cast<CsvScanner::Level>(state.range(0));
+    if (level > CsvScanner::bestLevel())
+    {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    const auto &file = csvFile(state.range(1));
+    for (auto _ : state)
+    {
+        CsvScanner scanner(file.text, level);
+        int64_t count = 0;
+        for (size_t pos = scanner.next(0); pos < file.text.size(); pos = scanner.next(pos + 1))
+        {
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetLabel(CsvScanner::levelName(level));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.text.size()));
+}
+BENCHMARK(BM_Csv_Scan)
+    ->ArgsProduct({{0, 1, 2}, {16, 256}})
+    ->ArgNames({"level", "MiB"})
+    ->Unit(benchmark::kMillisecond);
+
+// End to end: parse, validate and apply to the in-memory store
+void BM_Import_CsvAttendances(benchmark::State &state)
+{
+    const auto &file = csvFile(state.range(0));
+    std::vector<models::Student> roster;
+    roster.reserve(static_cast<size_t>(file.data.students));
+    for (int64_t n = 0; n < file.data.students; ++n)
+    {
+        roster.push_back(file.data.student(n));
+    }
+
+    auto &store = models::DataStore::getInstance();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        store.clear();
+        store.importStudents(roster);
+        state.ResumeTiming();
+
+        auto result = ImportService::getInstance().import(
+            ImportService::Type::Attendances, ImportService::Format::Csv, file.text);
+        benchmark::DoNotOptimize(result.importedCount);
+    }
+    invalidateDataStore();
+    state.SetItemsProcessed(state.iterations() * file.data.records);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.text.size()));
+}
+BENCHMARK(BM_Import_CsvAttendances)->Arg(16)->Arg(64)->ArgName("MiB")->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,273 @@
+#include "Dataset.h"
+
+using namespace student_attendance;
+using student_attendance::benchmarks::Dataset;
+using student_attendance::benchmarks::datasetSizes;
+using student_attendance::benchmarks::invalidateDataStore;
+using student_attendance::benchmarks::loadDataStore;
+
+namespace
+{
+
+void BM_DataStore_SearchByStudent(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    models::AttendanceFilter filter;
+    int64_t n = 0;
+    for (auto _ : state)
+    {
+        filter.studentId = Dataset::studentId(n++ % data.students);
+        benchmark::DoNotOptimize(store.searchAttendances(filter));
+    }
+}
+BENCHMARK(BM_DataStore_SearchByStudent)->Apply(datasetSizes);
+
+void BM_DataStore_SearchByClassAndDay(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    models::AttendanceFilter filter;
+    filter.className = Dataset::className(data.classes / 2);
+    filter.date = data.dayOf(data.records / 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.searchAttendances(filter));
+    }
+}
+BENCHMARK(BM_DataStore_SearchByClassAndDay)->Apply(datasetSizes);
+
+void BM_DataStore_SearchByDateRange(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    models::AttendanceFilter filter;
+    filter.startDate = Dataset::kFirstDay;
+    filter.endDate = utils::Date::fromOrdinal(Dataset::kFirstDay.ordinal() + 6);
+    filter.status = utils::StatusCode::Absent;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.searchAttendances(filter));
+    }
+    state.SetComplexityN(data.records);
+}
+BENCHMARK(BM_DataStore_SearchByDateRange)->Apply(datasetSizes)->Complexity();
+
+void BM_DataStore_ScanAll(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    models::AttendanceFilter filter;
+    for (auto _ : state)
+    {
+        int absent = 0;
+        store.scanAttendances(filter, [&](const auto &row) {
+            absent += row.status() == utils::StatusCode::Absent;
+        });
+        benchmark::DoNotOptimize(absent);
+    }
+    state.SetItemsProcessed(state.iterations() * data.records);
+}
+BENCHMARK(BM_DataStore_ScanAll)->Apply(datasetSizes);
+
+void BM_DataStore_SearchStudents(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    auto className = Dataset::className(data.classes - 1);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.searchStudents("学生1", className));
+    }
+}
+BENCHMARK(BM_DataStore_SearchStudents)->Apply(datasetSizes);
+
+// What GET /api/v1/classes reads
+void BM_DataStore_ClassSizes(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.getClassSizes());
+    }
+}
+BENCHMARK(BM_DataStore_ClassSizes)->Apply(datasetSizes);
+
+void BM_DataStore_ClassStudents(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    auto className = Dataset::className(data.classes / 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.findClassStudents(className));
+    }
+}
+BENCHMARK(BM_DataStore_ClassStudents)->Apply(datasetSizes);
+
+// What a report pays for its point-in-time view: nothing while the store is
+// unchanged, the written shard's chunk pointers after a single write
+void BM_DataStore_Snapshot(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    store.snapshot();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.snapshot());
+    }
+}
+BENCHMARK(BM_DataStore_Snapshot)->Apply(datasetSizes);
+
+void BM_DataStore_SnapshotAfterWrite(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    int64_t row = data.records;
+    store.snapshot();
+    // Timed together: the write after a snapshot clones the chunks it lands
+    // in, the snapshot after it copies the shard's chunk pointers
+    for (auto _ : state)
+    {
+        store.addAttendance(data.attendance(row++));
+        benchmark::DoNotOptimize(store.snapshot());
+    }
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_SnapshotAfterWrite)->Apply(datasetSizes);
+
+// Startup from a snapshot: the image format copies columns and indexes out
+// as blocks, against re-inserting every record as the old format did
+void BM_DataStore_LoadImage(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    std::string image;
+    store.snapshot()->saveImage(image);
+    for (auto _ : state)
+    {
+        // A starting server has nothing to free
+        state.PauseTiming();
+        store.clear();
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(store.loadImage(image));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.size()));
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_LoadImage)->Apply(datasetSizes)->Unit(benchmark::kMillisecond);
+
+void BM_DataStore_ReloadRecords(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    auto students = store.getAllStudents();
+    auto attendances = store.getAllAttendances();
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        store.clear();
+        state.ResumeTiming();
+        store.importStudents(students);
+        store.restoreAttendances(attendances);
+    }
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_ReloadRecords)->Apply(datasetSizes)->Unit(benchmark::kMillisecond);
+
+void BM_DataStore_AddAttendance(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    // Appends past the generated days so the loaded rows stay untouched
+    int64_t row = data.records;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.addAttendance(data.attendance(row++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    // Extra rows change the dataset; reload it for the next benchmark
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_AddAttendance)->Apply(datasetSizes);
+
+void BM_DataStore_AddAttendancesBatch(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    constexpr int64_t kBatch = 500;
+    int64_t row = data.records;
+    std::vector<models::Attendance> batch;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        batch.clear();
+        for (int64_t i = 0; i < kBatch; ++i)
+        {
+            batch.push_back(data.attendance(row++));
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(store.addAttendances(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * kBatch);
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_AddAttendancesBatch)->Apply(datasetSizes);
+
+// Roll-call writes while another thread scans the whole store, as a
+// dashboard does. Thread 0 scans; the others each add attendances.
+void BM_DataStore_AddDuringScan(benchmark::State &state)
+{
+    static const Dataset *data = nullptr;
+    if (state.thread_index() == 0)
+    {
+        data = &loadDataStore(state.range(0));
+    }
+    auto &store = models::DataStore::getInstance();
+    models::AttendanceFilter filter;
+    int64_t row = -1;
+    for (auto _ : state)
+    {
+        // Each writer appends past the generated days in a row range of its
+        // own; data is set once every thread is past the start barrier
+        if (row < 0)
+        {
+            row = data->records * (1 + state.thread_index());
+        }
+        if (state.thread_index() == 0)
+        {
+            int absent = 0;
+            store.scanAttendances(filter, [&](const auto &r) {
+                absent += r.status() == utils::StatusCode::Absent;
+            });
+            benchmark::DoNotOptimize(absent);
+        }
+        else
+        {
+            benchmark::DoNotOptimize(store.addAttendance(data->attendance(row++)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0)
+    {
+        invalidateDataStore();
+    }
+}
+BENCHMARK(BM_DataStore_AddDuringScan)->Apply(datasetSizes)->Threads(4)->UseRealTime();
+
+void BM_DataStore_AddStudent(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto &store = models::DataStore::getInstance();
+    int64_t n = data.students;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(store.addStudent(data.student(n++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    invalidateDataStore();
+}
+BENCHMARK(BM_DataStore_AddStudent)->Apply(datasetSizes);
+
+}  // namespace
@@ -0,0 +1,109 @@
+#include "Dataset.h"
+#include "student_attendance/services/ExportService.h"
+#include "student_attendance/utils/JsonResponse.h"
+#include <sstream>
+
+using namespace student_attendance;
+using student_attendance::benchmarks::datasetSizes;
+using student_attendance::benchmarks::loadDataStore;
+using student_attendance::services::ExportService;
+using student_attendance::utils::JsonResponse;
+
+namespace
+{
+
+// One page of a listing, serialized the way the list endpoints respond
+void BM_Json_PaginatedResponse(benchmark::State &state)
+{
+    loadDataStore(1'000);
+    auto page = models::DataStore::getInstance().getAllAttendances();
+    page.resize(std::min<size_t>(page.size(), static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        Json::Value items(Json::arrayValue);
+        for (const auto &att : page)
+        {
+            items.append(att.toJson());
+        }
+        auto resp = JsonResponse::success(
+            JsonResponse::paginatedData(1'000, 1, static_cast<int>(page.size()), items));
+        benchmark::DoNotOptimize(resp->body().size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(page.size()));
+}
+BENCHMARK(BM_Json_PaginatedResponse)->Arg(10)->Arg(100)->Arg(1'000)->ArgName("items");
+
+// The same page through the writer variant the list endpoints use
+void BM_Json_PaginatedResponseWriter(benchmark::State &state)
+{
+    loadDataStore(1'000);
+    auto page = models::DataStore::getInstance().getAllAttendances();
+    page.resize(std::min<size_t>(page.size(), static_cast<size_t>(state.range(0))));
+    for (auto _ : state)
+    {
+        auto resp = JsonResponse::success([&page](utils::JsonWriter &json) {
+            JsonResponse::writePage(json, 1'000, 1, static_cast<int>(page.size()),
+                                    [&page](utils::JsonWriter &items) {
+                                        for (const auto &att : page)
+                                        {
+                                            att.writeJson(items);
+                                        }
+                                    });
+        });
+        benchmark::DoNotOptimize(resp->body().size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(page.size()));
+}
+BENCHMARK(BM_Json_PaginatedResponseWriter)->Arg(10)->Arg(100)->Arg(1'000)->ArgName("items");
+
+void BM_Export_Json(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::ostringstream json;
+        ExportService::getInstance().exportTo("attendances", ExportService::Format::Json, json);
+        bytes += static_cast<int64_t>(json.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * data.records);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Export_Json)->Apply(datasetSizes)->Unit(benchmark::kMillisecond);
+
+void BM_Export_Csv(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::ostringstream csv;
+        ExportService::getInstance().exportTo("attendances", ExportService::Format::Csv, csv);
+        bytes += static_cast<int64_t>(csv.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * data.records);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Export_Csv)->Apply(datasetSizes)->Unit(benchmark::kMillisecond);
+
+// The export as the server sends it: refills of a fixed chunk buffer, with
+// memory bounded by one store batch
+void BM_Export_CsvStream(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    int64_t bytes = 0;
+    std::vector<char> chunk(16 * 1024);
+    for (auto _ : state)
+    {
+        auto stream = ExportService::getInstance().open("attendances", ExportService::Format::Csv);
+        while (auto count = stream->read(chunk.data(), chunk.size()))
+        {
+            bytes += static_cast<int64_t>(count);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * data.records);
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_Export_CsvStream)->Apply(datasetSizes)->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,174 @@
+#include "Dataset.h"
+#include "student_attendance/services/ReportCache.h"
+#include "student_attendance/services/ReportService.h"
+
+using namespace student_attendance;
+using student_attendance::benchmarks::Dataset;
+using student_attendance::benchmarks::datasetSizes;
+using student_attendance::benchmarks::invalidateDataStore;
+using student_attendance::benchmarks::loadDataStore;
+using student_attendance::services::ReportCache;
+using student_attendance::services::ReportService;
+
+namespace
+{
+
+// One school week into the dataset
+std::string weekStart()
+{
+    return Dataset::kFirstDay.toString();
+}
+
+std::string weekEnd()
+{
+    return utils::Date::fromOrdinal(Dataset::kFirstDay.ordinal() + 6).toString();
+}
+
+// Writes a report the way the endpoint does, into a buffer reused across
+// iterations, and counts its bytes. The report cache is off unless asked
+// for, so each iteration computes the report.
+template <typename Write>
+void writeReport(benchmark::State &state, Write &&write, bool cached = false)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    if (!cached)
+    {
+        cache.setCapacity(0, 0);
+    }
+
+    std::string body;
+    int64_t bytes = 0;
+    for (auto _ : state)
+    {
+        body.clear();
+        utils::JsonWriter json(body);
+        write(json);
+        benchmark::DoNotOptimize(body.data());
+        bytes += static_cast<int64_t>(body.size());
+    }
+    state.SetBytesProcessed(bytes);
+    cache.setCapacity(ReportCache::kMaxEntries, ReportCache::kMaxBytes);
+}
+
+void BM_Report_Details(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto className = Dataset::className(0);
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeDetailsReport(
+            json, weekStart(), weekEnd(), className, "");
+    });
+}
+BENCHMARK(BM_Report_Details)->Apply(datasetSizes);
+
+// Every class over the whole dataset, split across the compute pool
+void BM_Report_DetailsSchool(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = data.lastDay().toString();
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeDetailsReport(json, first, last, "", "");
+    });
+}
+BENCHMARK(BM_Report_DetailsSchool)->Apply(datasetSizes);
+
+void BM_Report_Daily(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto day = data.dayOf(data.records / 2).toString();
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeDailyReport(json, day, "");
+    });
+}
+BENCHMARK(BM_Report_Daily)->Apply(datasetSizes);
+
+void BM_Report_DailyByClass(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto day = data.dayOf(data.records / 2).toString();
+    auto className = Dataset::className(data.classes / 2);
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeDailyReport(json, day, className);
+    });
+}
+BENCHMARK(BM_Report_DailyByClass)->Apply(datasetSizes);
+
+void BM_Report_Summary(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = data.lastDay().toString();
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeSummaryReport(json, first, last, "");
+    });
+}
+BENCHMARK(BM_Report_Summary)->Apply(datasetSizes);
+
+// The same summary requested again and again, as by many teachers at once
+void BM_Report_SummaryCached(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = data.lastDay().toString();
+    writeReport(
+        state,
+        [&](utils::JsonWriter &json) {
+            ReportService::getInstance().writeSummaryReport(json, first, last, "");
+        },
+        true);
+}
+BENCHMARK(BM_Report_SummaryCached)->Apply(datasetSizes);
+
+// A class summary of the first week while every iteration also writes to a
+// later day of the class: the writes fall outside the entry's scope, so the
+// entry keeps being served
+void BM_Report_SummaryCachedOutOfScopeWrites(benchmark::State &state)
+{
+    loadDataStore(state.range(0));
+    auto className = Dataset::className(0);
+    auto &store = models::DataStore::getInstance();
+
+    models::AttendanceFilter filter;
+    filter.className = className;
+    filter.startDate = utils::Date::fromOrdinal(Dataset::kFirstDay.ordinal() + 7);
+    auto later = store.searchAttendances(filter).at(0);
+    bool flip = false;
+
+    writeReport(
+        state,
+        [&](utils::JsonWriter &json) {
+            flip = !flip;
+            store.updateAttendance(later.id, std::nullopt, flip ? "补签" : "");
+            ReportService::getInstance().writeSummaryReport(
+                json, weekStart(), weekEnd(), className);
+        },
+        true);
+    invalidateDataStore();
+}
+BENCHMARK(BM_Report_SummaryCachedOutOfScopeWrites)->Apply(datasetSizes);
+
+void BM_Report_Abnormal(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = data.lastDay().toString();
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeAbnormalReport(json, first, last, "", "");
+    });
+}
+BENCHMARK(BM_Report_Abnormal)->Apply(datasetSizes);
+
+void BM_Report_Leave(benchmark::State &state)
+{
+    const auto &data = loadDataStore(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = data.lastDay().toString();
+    writeReport(state, [&](utils::JsonWriter &json) {
+        ReportService::getInstance().writeLeaveReport(json, first, last, "", "");
+    });
+}
+BENCHMARK(BM_Report_Leave)->Apply(datasetSizes);
+
+}  // namespace
@@ -0,0 +1,322 @@
+#include "Dataset.h"
+#include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/db/StudentCache.h"
+#include "student_attendance/services/AttendanceService.h"
+#include "student_attendance/services/StudentService.h"
+#include <drogon/orm/DbClient.h>
+#include <filesystem>
+
+using namespace student_attendance;
+using student_attendance::benchmarks::Dataset;
+using student_attendance::benchmarks::datasetSizes;
+using student_attendance::services::AttendanceService;
+using student_attendance::services::StudentService;
+
+namespace
+{
+
+int64_t loadedRecords = -1;
+
+// Points the services at one storage backend for the length of a benchmark
+class UseBackend
+{
+public:
+    explicit UseBackend(db::Storage::Backend backend)
+        : previous_(db::Storage::current().backend())
+    {
+        db::Storage::select(backend);
+    }
+    ~UseBackend() { db::Storage::select(previous_); }
+
+private:
+    db::Storage::Backend previous_;
+};
+
+// Loads the dataset into a scratch SQLite file and points the services at
+// it.
+const Dataset &loadSqlite(int64_t records)
+{
+    static Dataset data;
+    static drogon::orm::DbClientPtr client;
+    if (!client)
+    {
+        auto path = std::filesystem::temp_directory_path() / "student_attendance_bench.db";
+        std::filesystem::remove(path);
+        client = drogon::orm::DbClient::newSqlite3Client("filename=" + path.string(), 4);
+        db::DatabaseManager::getInstance().initialize(client);
+    }
+    if (loadedRecords == records)
+    {
+        return data;
+    }
+
+    data = Dataset::ofSize(records);
+    benchmarks::fillSqlite(*client, data);
+    db::StudentCache::getInstance().invalidate();
+
+    loadedRecords = records;
+    return data;
+}
+
+void BM_Sqlite_StudentsFirstPage(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    loadSqlite(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StudentService::getInstance().getStudents(
+            1, 20, "name", "asc", "", ""));
+    }
+}
+BENCHMARK(BM_Sqlite_StudentsFirstPage)->Apply(datasetSizes);
+
+void BM_Sqlite_StudentsDeepOffset(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    const auto &data = loadSqlite(state.range(0));
+    auto page = static_cast<int>(std::max<int64_t>(data.students / 20 / 2, 1));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StudentService::getInstance().getStudents(
+            page, 20, "name", "asc", "", "", std::nullopt, false));
+    }
+}
+BENCHMARK(BM_Sqlite_StudentsDeepOffset)->Apply(datasetSizes);
+
+// Walks the listing page by page with cursors, starting over at the end
+void BM_Sqlite_StudentsCursorWalk(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    loadSqlite(state.range(0));
+    auto &service = StudentService::getInstance();
+    std::optional<utils::PageCursor> cursor;
+    for (auto _ : state)
+    {
+        auto result = service.getStudents(1, 20, "name", "asc", "", "", cursor, false);
+        cursor = utils::PageCursor::decode(result.nextCursor);
+    }
+}
+BENCHMARK(BM_Sqlite_StudentsCursorWalk)->Apply(datasetSizes);
+
+void BM_Sqlite_GetStudent(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    const auto &data = loadSqlite(state.range(0));
+    int64_t n = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StudentService::getInstance().getStudent(
+            Dataset::studentId(n++ % data.students)));
+    }
+}
+BENCHMARK(BM_Sqlite_GetStudent)->Apply(datasetSizes);
+
+void BM_Sqlite_CreateStudent(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    const auto &data = loadSqlite(state.range(0));
+    int64_t n = data.students;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(StudentService::getInstance().createStudent(data.student(n++)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    // Extra rows change the dataset; reload it for the next benchmark
+    loadedRecords = -1;
+}
+BENCHMARK(BM_Sqlite_CreateStudent)->Apply(datasetSizes);
+
+void BM_Sqlite_AttendancesByClassAndDay(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    const auto &data = loadSqlite(state.range(0));
+    auto className = Dataset::className(data.classes / 2);
+    auto day = data.dayOf(data.records / 2).toString();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(AttendanceService::getInstance().getAttendances(
+            1, 20, "", "", className, day, "", "", "", "date", "asc"));
+    }
+}
+BENCHMARK(BM_Sqlite_AttendancesByClassAndDay)->Apply(datasetSizes);
+
+void BM_Sqlite_AttendancesByStudent(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    const auto &data = loadSqlite(state.range(0));
+    int64_t n = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(AttendanceService::getInstance().getAttendances(
+            1, 20, Dataset::studentId(n++ % data.students), "", "", "", "", "", "",
+            "date", "desc"));
+    }
+}
+BENCHMARK(BM_Sqlite_AttendancesByStudent)->Apply(datasetSizes);
+
+void BM_Sqlite_AttendancesAbsentInRange(benchmark::State &state)
+{
+    UseBackend backend(db::Storage::Backend::Sqlite);
+    loadSqlite(state.range(0));
+    auto first = Dataset::kFirstDay.toString();
+    auto last = utils::Date::fromOrdinal(Dataset::kFirstDay.ordinal() + 6).toString();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(AttendanceService::getInstance().getAttendances(
+            1, 20, "", "", "", "", first, last, "absent", "date", "asc"));
+    }
+}
+BENCHMARK(BM_Sqlite_AttendancesAbsentInRange)->Apply(datasetSizes);
+
+// Pages halfway down the memory backend's listings, by offset and by
+// cursor. A cursor seeks the ordered indexes, so only the offset pages grow
+// with the dataset.
+void BM_Memory_StudentsDeepOffset(benchmark::State &state)
+{
+    const auto &data = benchmarks::loadDataStore(state.range(0));
+    auto &storage = db::Storage::of(db::Storage::Backend::Memory);
+    db::StudentQuery query;
+    query.sortColumn = db::StudentQuery::ByName;
+    query.offset = static_cast<int>(data.students / 2);
+    query.withTotal = false;
+    // The first listing takes the snapshot
+    drogon::sync_wait(storage.listStudents(query));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.listStudents(query)));
+    }
+}
+BENCHMARK(BM_Memory_StudentsDeepOffset)->Apply(datasetSizes);
+
+void BM_Memory_StudentsDeepCursor(benchmark::State &state)
+{
+    const auto &data = benchmarks::loadDataStore(state.range(0));
+    auto &storage = db::Storage::of(db::Storage::Backend::Memory);
+    db::StudentQuery query;
+    query.sortColumn = db::StudentQuery::ByName;
+    query.offset = static_cast<int>(data.students / 2);
+    query.limit = 1;
+    query.withTotal = false;
+    query.after = drogon::sync_wait(storage.listStudents(query)).rows.at(0);
+    query.offset = 0;
+    query.limit = 20;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.listStudents(query)));
+    }
+}
+BENCHMARK(BM_Memory_StudentsDeepCursor)->Apply(datasetSizes);
+
+void BM_Memory_AttendancesDeepOffset(benchmark::State &state)
+{
+    const auto &data = benchmarks::loadDataStore(state.range(0));
+    auto &storage = db::Storage::of(db::Storage::Backend::Memory);
+    db::AttendanceQuery query;
+    query.sortColumn = db::AttendanceQuery::ByDate;
+    query.offset = static_cast<int>(data.records / 2);
+    query.withTotal = false;
+    // The first listing takes the snapshot
+    drogon::sync_wait(storage.listAttendances(query));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.listAttendances(query)));
+    }
+}
+BENCHMARK(BM_Memory_AttendancesDeepOffset)->Apply(datasetSizes);
+
+void BM_Memory_AttendancesDeepCursor(benchmark::State &state)
+{
+    const auto &data = benchmarks::loadDataStore(state.range(0));
+    auto &storage = db::Storage::of(db::Storage::Backend::Memory);
+    db::AttendanceQuery query;
+    query.sortColumn = db::AttendanceQuery::ByDate;
+    query.offset = static_cast<int>(data.records / 2);
+    query.limit = 1;
+    query.withTotal = false;
+    query.after = drogon::sync_wait(storage.listAttendances(query)).rows.at(0);
+    query.offset = 0;
+    query.limit = 20;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.listAttendances(query)));
+    }
+}
+BENCHMARK(BM_Memory_AttendancesDeepCursor)->Apply(datasetSizes);
+
+// The same operations against each backend directly. Memory and hybrid
+// read the in-memory dataset; sqlite and hybrid write to the SQLite file.
+void storageArgs(benchmark::internal::Benchmark *bench)
+{
+    for (auto backend : {db::Storage::Backend::Memory, db::Storage::Backend::Sqlite,
+                         db::Storage::Backend::Hybrid})
+    {
+        for (int64_t size = 1'000; size <= benchmarks::maxRecords(); size *= 10)
+        {
+            bench->Args({static_cast<int64_t>(backend), size});
+        }
+    }
+    bench->ArgNames({"backend", "records"});
+}
+
+db::Storage &loadStorage(benchmark::State &state, const Dataset *&data)
+{
+    auto backend = static_cast<db::Storage::Backend>(state.range(0));
+    if (backend != db::Storage::Backend::Memory)
+    {
+        data = &loadSqlite(state.range(1));
+    }
+    if (backend != db::Storage::Backend::Sqlite)
+    {
+        data = &benchmarks::loadDataStore(state.range(1));
+    }
+    state.SetLabel(db::Storage::backendName(backend));
+    return db::Storage::of(backend);
+}
+
+void BM_Storage_GetStudent(benchmark::State &state)
+{
+    const Dataset *data = nullptr;
+    auto &storage = loadStorage(state, data);
+    int64_t n = 0;
+    for (auto _ : state)
+    {
+        auto id = Dataset::studentId(n++ % data->students);
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.getStudent(id)));
+    }
+}
+BENCHMARK(BM_Storage_GetStudent)->Apply(storageArgs);
+
+void BM_Storage_AttendancesByClassAndDay(benchmark::State &state)
+{
+    const Dataset *data = nullptr;
+    auto &storage = loadStorage(state, data);
+    db::AttendanceQuery query;
+    query.filter.className = Dataset::className(data->classes / 2);
+    query.filter.date = data->dayOf(data->records / 2);
+    query.sortColumn = db::AttendanceQuery::ByDate;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.listAttendances(query)));
+    }
+}
+BENCHMARK(BM_Storage_AttendancesByClassAndDay)->Apply(storageArgs);
+
+void BM_Storage_AddAttendance(benchmark::State &state)
+{
+    const Dataset *data = nullptr;
+    auto &storage = loadStorage(state, data);
+    int64_t row = data->records;
+    std::vector<models::Attendance> batch(1);
+    for (auto _ : state)
+    {
+        batch[0] = data->attendance(row++);
+        benchmark::DoNotOptimize(drogon::sync_wait(storage.addAttendances(batch)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    loadedRecords = -1;
+    benchmarks::invalidateDataStore();
+}
+BENCHMARK(BM_Storage_AddAttendance)->Apply(storageArgs);
+
+}  // namespace
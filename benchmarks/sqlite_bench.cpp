@@ -0,0 +1,141 @@
+#include "Dataset.h"
+#include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqliteTuning.h"
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/db/StudentCache.h"
+#include <drogon/orm/DbClient.h>
+#include <atomic>
+#include <filesystem>
+#include <map>
+
+// The SQLite tuning profiles under the SQLite backend's request mix: per ten
+// requests, eight listings (class-and-day attendance, a class's students)
+// and two single attendance inserts. Run on one and four threads; under the
+// default profile's rollback journal, listings wait while a write commits.
+
+using namespace student_attendance;
+using student_attendance::benchmarks::Dataset;
+
+namespace
+{
+
+constexpr int64_t kRecords = 100'000;
+constexpr size_t kConnections = 4;
+
+struct ProfileDatabase
+{
+    drogon::orm::DbClientPtr client;
+    Dataset data;
+    std::atomic<int64_t> nextRow{0};
+};
+
+// A scratch database per profile, opened under that profile's settings and
+// filled once
+ProfileDatabase &openProfile(const std::string &name)
+{
+    static std::map<std::string, ProfileDatabase> databases;
+    auto &database = databases[name];
+    if (database.client)
+    {
+        return database;
+    }
+
+    auto &manager = db::DatabaseManager::getInstance();
+    auto previous = manager.tuning();
+    manager.configure(*db::SqliteTuning::fromProfile(name));
+
+    auto path = std::filesystem::temp_directory_path() /
+                ("student_attendance_bench_" + name + ".db");
+    for (const char *suffix : {"", "-wal", "-shm"})
+    {
+        std::filesystem::remove(path.string() + suffix);
+    }
+    database.client =
+        drogon::orm::DbClient::newSqlite3Client("filename=" + path.string(), kConnections);
+    {
+        // Connections open in the background; one transaction held on each
+        // waits until all of them are open with the settings applied
+        std::vector<std::shared_ptr<drogon::orm::Transaction>> held;
+        for (size_t i = 0; i < kConnections; ++i)
+        {
+            held.push_back(database.client->newTransaction());
+        }
+    }
+    manager.configure(previous.value_or(*db::SqliteTuning::fromProfile("default")));
+
+    auto client = manager.getClient();
+    manager.initialize(database.client);
+    database.data = Dataset::ofSize(kRecords);
+    benchmarks::fillSqlite(*database.client, database.data);
+    database.nextRow = kRecords;
+    manager.initialize(client);
+    return database;
+}
+
+void profileArgs(benchmark::internal::Benchmark *bench)
+{
+    auto names = db::SqliteTuning::profileNames();
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        bench->Arg(static_cast<int64_t>(i));
+    }
+    bench->ArgName("profile")->Threads(1)->Threads(4)->UseRealTime();
+}
+
+void BM_SqliteProfile_Mix(benchmark::State &state)
+{
+    auto name = db::SqliteTuning::profileNames()[static_cast<size_t>(state.range(0))];
+    auto &manager = db::DatabaseManager::getInstance();
+    static drogon::orm::DbClientPtr previous;
+    static ProfileDatabase *database = nullptr;
+    if (state.thread_index() == 0)
+    {
+        database = &openProfile(name);
+        previous = manager.getClient();
+        manager.initialize(database->client);
+    }
+    state.SetLabel(name);
+
+    auto &storage = db::Storage::of(db::Storage::Backend::Sqlite);
+    int64_t n = state.thread_index();
+    for (auto _ : state)
+    {
+        const auto &data = database->data;
+        auto row = n * 7919 % data.records;
+        switch (n++ % 5)
+        {
+        case 0:
+        {
+            std::vector<models::Attendance> batch{data.attendance(database->nextRow++)};
+            benchmark::DoNotOptimize(drogon::sync_wait(storage.addAttendances(batch)));
+            break;
+        }
+        case 1:
+        case 3:
+        {
+            db::AttendanceQuery query;
+            query.filter.className = Dataset::className(row % data.classes);
+            query.filter.date = data.dayOf(row);
+            benchmark::DoNotOptimize(drogon::sync_wait(storage.listAttendances(query)));
+            break;
+        }
+        default:
+        {
+            db::StudentQuery query;
+            query.className = Dataset::className(row % data.classes);
+            benchmark::DoNotOptimize(drogon::sync_wait(storage.listStudents(query)));
+            break;
+        }
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        manager.initialize(previous);
+        previous.reset();
+    }
+}
+BENCHMARK(BM_SqliteProfile_Mix)->Apply(profileArgs);
+
+}  // namespace
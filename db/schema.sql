@@ -22,16 +22,18 @@ CREATE TABLE IF NOT EXISTS students (
     updated_at DATETIME DEFAULT CURRENT_TIMESTAMP
 );
 
--- Create index for class queries
-CREATE INDEX IF NOT EXISTS idx_students_class ON students(class_name);
-CREATE INDEX IF NOT EXISTS idx_students_name ON students(name);
+-- Create index for class queries; student_id breaks ties for keyset paging
+CREATE INDEX IF NOT EXISTS idx_students_class_id ON students(class_name, student_id);
+CREATE INDEX IF NOT EXISTS idx_students_name_id ON students(name, student_id);
 
 -- Attendances table
 CREATE TABLE IF NOT EXISTS attendances (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
     student_id TEXT NOT NULL,
-    date TEXT NOT NULL,
-    status TEXT NOT NULL CHECK(status IN ('present', 'absent', 'late', 'early_leave', 'sick_leave', 'personal_leave')),
+    -- days since 1970-01-01
+    date INTEGER NOT NULL,
+    -- 0 present, 1 absent, 2 personal_leave, 3 sick_leave, 4 late, 5 early_leave
+    status INTEGER NOT NULL CHECK(status BETWEEN 0 AND 5),
     remark TEXT DEFAULT '',
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
     updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
@@ -75,12 +77,13 @@ INSERT OR IGNORE INTO students (student_id, name, class_name) VALUES
     ('2024007', '周九', '人文2403班'),
     ('2024008', '吴十', '人文2403班');
 
+-- date 20437 is 2025-12-15
 INSERT OR IGNORE INTO attendances (student_id, date, status, remark) VALUES
-    ('2024001', '12-15', 'present', ''),
-    ('2024002', '12-15', 'present', ''),
-    ('2024003', '12-15', 'late', '迟到5分钟'),
-    ('2024004', '12-15', 'absent', ''),
-    ('2024005', '12-15', 'present', ''),
-    ('2024006', '12-15', 'sick_leave', '感冒'),
-    ('2024007', '12-15', 'present', ''),
-    ('2024008', '12-15', 'personal_leave', '家中有事');
+    ('2024001', 20437, 0, ''),
+    ('2024002', 20437, 0, ''),
+    ('2024003', 20437, 4, '迟到5分钟'),
+    ('2024004', 20437, 1, ''),
+    ('2024005', 20437, 0, ''),
+    ('2024006', 20437, 3, '感冒'),
+    ('2024007', 20437, 0, ''),
+    ('2024008', 20437, 2, '家中有事');
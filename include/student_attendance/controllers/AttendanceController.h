@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include <json/json.h>
 
 namespace api
@@ -20,26 +21,26 @@ public:
     ADD_METHOD_TO(AttendanceController::deleteAttendance, "/api/v1/attendances/{id}", drogon::Delete, "student_attendance::filters::AuthFilter");
     METHOD_LIST_END
 
-    void getAttendances(const drogon::HttpRequestPtr &req,
-                        std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> getAttendances(drogon::HttpRequestPtr req,
+                                  std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void createAttendance(const drogon::HttpRequestPtr &req,
-                          std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> createAttendance(drogon::HttpRequestPtr req,
+                                    std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void batchCreateAttendances(const drogon::HttpRequestPtr &req,
-                                std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> batchCreateAttendances(drogon::HttpRequestPtr req,
+                                          std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void getAttendance(const drogon::HttpRequestPtr &req,
-                       std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                       int id) const;
+    drogon::Task<> getAttendance(drogon::HttpRequestPtr req,
+                                 std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                 int id) const;
 
-    void updateAttendance(const drogon::HttpRequestPtr &req,
-                          std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                          int id) const;
+    drogon::Task<> updateAttendance(drogon::HttpRequestPtr req,
+                                    std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                    int id) const;
 
-    void deleteAttendance(const drogon::HttpRequestPtr &req,
-                          std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                          int id) const;
+    drogon::Task<> deleteAttendance(drogon::HttpRequestPtr req,
+                                    std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                    int id) const;
 };
 
 }  // namespace v1
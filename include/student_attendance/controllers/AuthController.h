@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 
 namespace api
 {
@@ -16,8 +17,8 @@ public:
     ADD_METHOD_TO(AuthController::me, "/api/v1/auth/me", drogon::Get);
     METHOD_LIST_END
 
-    void login(const drogon::HttpRequestPtr &req,
-               std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> login(drogon::HttpRequestPtr req,
+                         std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
     void logout(const drogon::HttpRequestPtr &req,
                 std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
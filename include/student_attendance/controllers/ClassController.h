@@ -16,12 +16,12 @@ public:
     ADD_METHOD_TO(ClassController::getClassStudents, "/api/v1/classes/{class_name}/students", drogon::Get, "student_attendance::filters::AuthFilter");
     METHOD_LIST_END
 
-    void getClasses(const drogon::HttpRequestPtr &req,
-                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> getClasses(drogon::HttpRequestPtr req,
+                              std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void getClassStudents(const drogon::HttpRequestPtr &req,
-                          std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                          const std::string &className) const;
+    drogon::Task<> getClassStudents(drogon::HttpRequestPtr req,
+                                    std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                    std::string className) const;
 };
 
 }  // namespace v1
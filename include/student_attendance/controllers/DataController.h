@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include <json/json.h>
 
 namespace api
@@ -19,8 +20,8 @@ public:
     void exportData(const drogon::HttpRequestPtr &req,
                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
 
-    void importData(const drogon::HttpRequestPtr &req,
-                    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> importData(drogon::HttpRequestPtr req,
+                              std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 };
 
 }  // namespace v1
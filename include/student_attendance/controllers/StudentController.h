@@ -1,6 +1,7 @@
 #pragma once
 
 #include <drogon/HttpController.h>
+#include <drogon/utils/coroutine.h>
 #include <json/json.h>
 
 namespace api
@@ -19,23 +20,23 @@ public:
     ADD_METHOD_TO(StudentController::deleteStudent, "/api/v1/students/{student_id}", drogon::Delete, "student_attendance::filters::AuthFilter");
     METHOD_LIST_END
 
-    void getStudents(const drogon::HttpRequestPtr &req,
-                     std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> getStudents(drogon::HttpRequestPtr req,
+                               std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void createStudent(const drogon::HttpRequestPtr &req,
-                       std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+    drogon::Task<> createStudent(drogon::HttpRequestPtr req,
+                                 std::function<void(const drogon::HttpResponsePtr &)> callback) const;
 
-    void getStudent(const drogon::HttpRequestPtr &req,
-                    std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                    const std::string &studentId) const;
+    drogon::Task<> getStudent(drogon::HttpRequestPtr req,
+                              std::function<void(const drogon::HttpResponsePtr &)> callback,
+                              std::string studentId) const;
 
-    void updateStudent(const drogon::HttpRequestPtr &req,
-                       std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                       const std::string &studentId) const;
+    drogon::Task<> updateStudent(drogon::HttpRequestPtr req,
+                                 std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                 std::string studentId) const;
 
-    void deleteStudent(const drogon::HttpRequestPtr &req,
-                       std::function<void(const drogon::HttpResponsePtr &)> &&callback,
-                       const std::string &studentId) const;
+    drogon::Task<> deleteStudent(drogon::HttpRequestPtr req,
+                                 std::function<void(const drogon::HttpResponsePtr &)> callback,
+                                 std::string studentId) const;
 };
 
 }  // namespace v1
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <drogon/HttpController.h>
+
+namespace api
+{
+namespace v1
+{
+
+class SystemController : public drogon::HttpController<SystemController>
+{
+public:
+    METHOD_LIST_BEGIN
+    ADD_METHOD_TO(SystemController::getStats, "/api/v1/system/stats", drogon::Get, "student_attendance::filters::AuthFilter");
+    METHOD_LIST_END
+
+    void getStats(const drogon::HttpRequestPtr &req,
+                  std::function<void(const drogon::HttpResponsePtr &)> &&callback) const;
+};
+
+}  // namespace v1
+}  // namespace api
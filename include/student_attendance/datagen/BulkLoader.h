@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <drogon/orm/DbClient.h>
+#include "student_attendance/datagen/SchoolGenerator.h"
+#include "student_attendance/models/DataStore.h"
+
+namespace student_attendance
+{
+namespace datagen
+{
+
+// Loads a generated school into a store as fast as the store allows.
+// Both loaders replace existing students and attendances; users are kept.
+class BulkLoader
+{
+public:
+    struct Stats
+    {
+        int64_t students = 0;
+        int64_t attendances = 0;
+        double seconds = 0.0;
+    };
+
+    // In-memory store: students in one import, records in large batches
+    static Stats loadDataStore(const SchoolGenerator &generator, models::DataStore &store);
+
+    // SQLite: one transaction of multi-row INSERTs, with the secondary
+    // indexes dropped during the load and rebuilt once at the end. Throws
+    // DrogonDbException on failure, leaving the database unchanged.
+    static Stats loadSqlite(const SchoolGenerator &generator,
+                            const drogon::orm::DbClientPtr &client);
+};
+
+}  // namespace datagen
+}  // namespace student_attendance
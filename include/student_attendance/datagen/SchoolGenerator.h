@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "student_attendance/models/Attendance.h"
+#include "student_attendance/models/Student.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
+
+namespace student_attendance
+{
+namespace datagen
+{
+
+// Shape of a synthetic school. The defaults give a mid-sized school; the
+// production profile is 1250 classes x 40 students over 200 days.
+struct SchoolSpec
+{
+    int classes = 20;
+    int studentsPerClass = 40;
+    // School days in the term; weekends are skipped
+    int termDays = 100;
+    utils::Date termStart = utils::Date::fromYmd(2024, 9, 2);
+    int enrollmentYear = 2024;
+    // Relative weights indexed by StatusCode
+    std::array<double, utils::kStatusCount> statusWeights{92.0, 1.5, 1.5, 1.5, 2.5, 1.0};
+    uint64_t seed = 20240902;
+
+    int64_t studentCount() const
+    {
+        return static_cast<int64_t>(classes) * studentsPerClass;
+    }
+
+    int64_t attendanceCount() const
+    {
+        return studentCount() * termDays;
+    }
+};
+
+// Deterministic generator for a SchoolSpec: the same spec always yields the
+// same students and records.
+//
+// Students differ in how often they deviate from `present`: each one gets a
+// skewed multiplier on the non-present weights, so a few students account
+// for most absences, as in real rosters. Sick leave runs for several days
+// once it starts.
+class SchoolGenerator
+{
+public:
+    explicit SchoolGenerator(const SchoolSpec &spec);
+
+    const SchoolSpec &spec() const { return spec_; }
+
+    std::string className(int classIndex) const;
+    std::string studentId(int classIndex, int seat) const;
+
+    std::vector<models::Student> students() const;
+
+    // The school days of the term, in order
+    std::vector<utils::Date> termDays() const;
+
+    // Emits every attendance record, day by day, in batches of at most
+    // batchSize. Record ids are left at 0 for the store to assign.
+    void generateAttendances(
+        size_t batchSize,
+        const std::function<void(const std::vector<models::Attendance> &)> &sink) const;
+
+private:
+    SchoolSpec spec_;
+};
+
+}  // namespace datagen
+}  // namespace student_attendance
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <drogon/orm/DbClient.h>
+#include <optional>
 #include <string>
+#include "student_attendance/db/SqliteTuning.h"
 
 namespace student_attendance
 {
@@ -17,9 +19,19 @@ public:
         return instance;
     }
 
+    // Settings for every SQLite connection the process opens from now on,
+    // the framework's pool included. Call before the clients are created;
+    // connections already open keep what they had.
+    void configure(const SqliteTuning &tuning);
+    // nullopt until configure() is called, when SQLite's defaults apply
+    std::optional<SqliteTuning> tuning() const;
+
     // Initialize database with schema
     void initialize(const std::string &dbPath = "./student_attendance.db");
 
+    // Adopt an existing client, for tools that run without the app framework
+    void initialize(const drogon::orm::DbClientPtr &client);
+
     // Get database client
     drogon::orm::DbClientPtr getClient() const { return dbClient_; }
 
@@ -38,6 +50,9 @@ private:
     DatabaseManager(const DatabaseManager &) = delete;
     DatabaseManager &operator=(const DatabaseManager &) = delete;
 
+    // Rewrites tables created by older versions into the current layout
+    void migrateSchema();
+
     drogon::orm::DbClientPtr dbClient_;
     std::string dbPath_;
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "student_attendance/db/MemoryStorage.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// MemoryStorage with SQLite kept as a mirror: reads are served from memory
+// alone, and every write, once applied in memory, is written through to
+// SQLite before it returns. The mirror is best effort and its failures are
+// logged; without a database client this is plain MemoryStorage. Records
+// keep one id in both (see WriteThrough.h).
+class HybridStorage : public MemoryStorage
+{
+public:
+    using MemoryStorage::MemoryStorage;
+
+    Backend backend() const override { return Backend::Hybrid; }
+
+    drogon::Task<bool> addStudent(const models::Student &student) override;
+    drogon::Task<int> addStudents(const std::vector<models::Student> &students,
+                                  std::vector<bool> &added) override;
+    drogon::Task<bool> updateStudent(const std::string &studentId,
+                                     const std::string &name,
+                                     const std::string &className) override;
+    drogon::Task<bool> deleteStudent(const std::string &studentId) override;
+
+    drogon::Task<int> addAttendances(std::vector<models::Attendance> &attendances) override;
+    drogon::Task<bool> updateAttendance(int id,
+                                        std::optional<utils::StatusCode> status,
+                                        const std::string &remark) override;
+    drogon::Task<bool> deleteAttendance(int id) override;
+};
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/models/DataStore.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Storage over the in-memory DataStore. Listings page through the latest
+// DataStore snapshot, seeking its indexes rather than sorting; writes wait for the write-ahead log, when one is open, to have
+// them on disk.
+class MemoryStorage : public Storage
+{
+public:
+    explicit MemoryStorage(models::DataStore &store) : store_(store) {}
+
+    Backend backend() const override { return Backend::Memory; }
+
+    drogon::Task<Page<models::Student>> listStudents(const StudentQuery &query) override;
+    drogon::Task<std::optional<models::Student>> getStudent(
+        const std::string &studentId) override;
+    drogon::Task<bool> addStudent(const models::Student &student) override;
+    drogon::Task<int> addStudents(const std::vector<models::Student> &students,
+                                  std::vector<bool> &added) override;
+    drogon::Task<bool> updateStudent(const std::string &studentId,
+                                     const std::string &name,
+                                     const std::string &className) override;
+    drogon::Task<bool> deleteStudent(const std::string &studentId) override;
+
+    drogon::Task<Page<models::Attendance>> listAttendances(
+        const AttendanceQuery &query) override;
+    drogon::Task<std::optional<models::Attendance>> getAttendance(int id) override;
+    drogon::Task<int> addAttendances(std::vector<models::Attendance> &attendances) override;
+    drogon::Task<bool> updateAttendance(int id,
+                                        std::optional<utils::StatusCode> status,
+                                        const std::string &remark) override;
+    drogon::Task<bool> deleteAttendance(int id) override;
+
+    drogon::Task<std::vector<models::ClassSize>> classSizes() override;
+    drogon::Task<std::optional<std::vector<models::Student>>> classStudents(
+        const std::string &className) override;
+
+    std::shared_ptr<const models::DataSnapshot> snapshot() override;
+    std::shared_ptr<const models::DataSnapshot> snapshot(const ReportScope &scope) override;
+    std::vector<StudentSummary> studentSummaries(const std::string &className,
+                                                 std::optional<utils::Date> first,
+                                                 std::optional<utils::Date> last) override;
+
+    uint64_t generation() const override;
+    uint64_t attendanceGeneration(const std::string &className,
+                                  std::optional<utils::Date> first,
+                                  std::optional<utils::Date> last) const override;
+    uint64_t rosterGeneration(const std::string &className) const override;
+
+protected:
+    models::DataStore &store_;
+};
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <drogon/orm/DbClient.h>
+#include <utility>
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Awaits a statement whose arguments were bound at runtime. execSqlCoro()
+// takes a fixed argument list, so queries with optional filters fill a
+// binder and hand it over here. Throws DrogonDbException on failure.
+inline drogon::orm::internal::SqlAwaiter execBinderCoro(
+    drogon::orm::internal::SqlBinder &&binder)
+{
+    return drogon::orm::internal::SqlAwaiter(std::move(binder));
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Queries whose SQL is built by SqlText.
+enum class QueryId : uint16_t
+{
+    StudentCount,
+    StudentPage,
+    StudentById,
+    StudentInsert,
+    StudentInsertRows,
+    StudentUpsert,
+    AttendanceCount,
+    AttendancePage,
+    AttendanceInsertRows,
+    AttendanceScan,
+    StudentSummary,
+    UserByName,
+};
+
+// Canonical SQL text per query shape.
+//
+// A shape is a query plus whatever changes its text: the set of filters
+// present, the sort column and the direction. The text for a shape is built
+// once and kept, so request handlers do not reassemble the same SQL on every
+// call. Prepared statements are left to the database client.
+class SqlText
+{
+public:
+    static SqlText &getInstance()
+    {
+        static SqlText instance;
+        return instance;
+    }
+
+    // Packs a query shape into a key. `filters` is a per-query bitmask of
+    // the conditions present; `sortColumn` indexes the query's sort list.
+    static constexpr uint64_t shape(QueryId query, uint32_t filters = 0,
+                                    uint8_t sortColumn = 0, bool descending = false)
+    {
+        return (static_cast<uint64_t>(query) << 48) |
+               (static_cast<uint64_t>(filters) << 16) |
+               (static_cast<uint64_t>(sortColumn) << 1) |
+               (descending ? 1u : 0u);
+    }
+
+    // SQL for `key`, produced by `build()` the first time the shape is seen.
+    // The returned reference stays valid for the life of the process.
+    template <typename Build>
+    const std::string &get(uint64_t key, Build &&build)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = texts_.find(key);
+            if (it != texts_.end())
+            {
+                return it->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto [it, inserted] = texts_.try_emplace(key);
+        if (inserted)
+        {
+            it->second = build();
+        }
+        return it->second;
+    }
+
+private:
+    SqlText() = default;
+    ~SqlText() = default;
+    SqlText(const SqlText &) = delete;
+    SqlText &operator=(const SqlText &) = delete;
+
+    std::shared_mutex mutex_;
+    // Node-based, so references to stored strings survive rehashing
+    std::unordered_map<uint64_t, std::string> texts_;
+};
+
+}  // namespace db
+}  // namespace student_attendance
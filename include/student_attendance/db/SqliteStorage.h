@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/models/WriteGenerations.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Storage over the SQLite database of the DatabaseManager. Listings run as
+// keyset or offset queries over the indexed tables; statement text comes
+// from the SqlText. Single students, and the student of each new
+// attendance row, are resolved from the StudentCache, which the student
+// writes here keep current.
+//
+// Nothing is kept in memory besides the roster cache. Reports read only
+// the students and records in their scope, and the summary report counts in
+// SQL; exports page through the tables by id. Writes stamp the classes and
+// days they touch with their generation, as the DataStore does, so cached
+// reports of other classes and days stay fresh. Changes made to the
+// database by other processes are not noticed.
+class SqliteStorage : public Storage
+{
+public:
+    Backend backend() const override { return Backend::Sqlite; }
+
+    drogon::Task<Page<models::Student>> listStudents(const StudentQuery &query) override;
+    drogon::Task<std::optional<models::Student>> getStudent(
+        const std::string &studentId) override;
+    drogon::Task<bool> addStudent(const models::Student &student) override;
+    drogon::Task<int> addStudents(const std::vector<models::Student> &students,
+                                  std::vector<bool> &added) override;
+    drogon::Task<bool> updateStudent(const std::string &studentId,
+                                     const std::string &name,
+                                     const std::string &className) override;
+    drogon::Task<bool> deleteStudent(const std::string &studentId) override;
+
+    drogon::Task<Page<models::Attendance>> listAttendances(
+        const AttendanceQuery &query) override;
+    drogon::Task<std::optional<models::Attendance>> getAttendance(int id) override;
+    drogon::Task<int> addAttendances(std::vector<models::Attendance> &attendances) override;
+    drogon::Task<bool> updateAttendance(int id,
+                                        std::optional<utils::StatusCode> status,
+                                        const std::string &remark) override;
+    drogon::Task<bool> deleteAttendance(int id) override;
+
+    drogon::Task<std::vector<models::ClassSize>> classSizes() override;
+    drogon::Task<std::optional<std::vector<models::Student>>> classStudents(
+        const std::string &className) override;
+
+    std::shared_ptr<const models::DataSnapshot> snapshot() override;
+    std::shared_ptr<const models::DataSnapshot> snapshot(const ReportScope &scope) override;
+    std::vector<StudentSummary> studentSummaries(const std::string &className,
+                                                 std::optional<utils::Date> first,
+                                                 std::optional<utils::Date> last) override;
+
+    uint64_t generation() const override;
+    uint64_t attendanceGeneration(const std::string &className,
+                                  std::optional<utils::Date> first,
+                                  std::optional<utils::Date> last) const override;
+    uint64_t rosterGeneration(const std::string &className) const override;
+
+private:
+    using Cell = std::pair<std::string, utils::Date>;
+
+    // Called once a write has committed: takes the next generation and
+    // stamps what the write touched with it. Records take their name
+    // and class from the roster, so a roster change that is not an insert
+    // touches every record of its classes.
+    void rosterWritten(const std::vector<std::string> &classes, bool records);
+    void attendancesWritten(const std::vector<Cell> &cells);
+    // Caller holds generationMutex_.
+    uint64_t nextGeneration();
+
+    std::atomic<uint64_t> writes_{0};
+    mutable std::mutex generationMutex_;
+    models::WriteGenerations attendanceGenerations_;
+    std::unordered_map<std::string, uint64_t> rosterGenerations_;
+    uint64_t rosterLatest_ = 0;
+};
+
+}  // namespace db
+}  // namespace student_attendance
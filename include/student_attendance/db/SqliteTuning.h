@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <json/json.h>
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Settings applied to each SQLite connection as it opens. Named profiles
+// give the common combinations; single settings can be overridden on top.
+//
+//   default  - SQLite's own: rollback journal, full fsync on every commit
+//   wal      - WAL journal, fsync at checkpoints only, memory-mapped reads
+//              and a 64 MiB page cache. A crash of the process loses
+//              nothing; a power loss may lose the last commits.
+//   durable  - as wal, but every commit is synced
+struct SqliteTuning
+{
+    std::string profile = "wal";
+    // DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF
+    std::string journalMode = "WAL";
+    // OFF, NORMAL, FULL or EXTRA
+    std::string synchronous = "NORMAL";
+    // Bytes of the file read through mmap; 0 turns it off
+    int64_t mmapSize = int64_t{256} << 20;
+    // As PRAGMA cache_size: pages when positive, KiB when negative
+    int64_t cacheSize = -65536;
+    // DEFAULT, FILE or MEMORY
+    std::string tempStore = "MEMORY";
+    // How long a statement waits on a locked database before failing
+    int busyTimeoutMs = 5000;
+
+    static std::vector<std::string> profileNames();
+    static std::optional<SqliteTuning> fromProfile(std::string_view name);
+
+    // The "profile" named in `config` (wal when absent), then any of
+    // journal_mode, synchronous, mmap_size, cache_size, temp_store and
+    // busy_timeout set there. nullopt, with `error` set, for an unknown
+    // profile or value.
+    static std::optional<SqliteTuning> fromConfig(const Json::Value &config,
+                                                  std::string &error);
+
+    // The PRAGMA statements, journal mode first
+    std::vector<std::string> pragmas() const;
+};
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <drogon/utils/coroutine.h>
+#include "student_attendance/models/Student.h"
+#include "student_attendance/models/Attendance.h"
+#include "student_attendance/models/AttendanceTable.h"
+#include "student_attendance/models/ClassRoster.h"
+#include "student_attendance/models/DataSnapshot.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// A student listing. Rows are ordered by the sort column, then student_id.
+struct StudentQuery
+{
+    // Sort columns; student_id is unique, so it also breaks ties
+    enum Column : uint8_t
+    {
+        ById,
+        ByName,
+        ByClass,
+        kColumns
+    };
+
+    std::string className;
+    // Matches part of the student id or name
+    std::string keyword;
+    uint8_t sortColumn = ById;
+    bool descending = false;
+    // Keyset paging: the page starts after this row and offset is ignored.
+    // Only the sort column and the id are read.
+    std::optional<models::Student> after;
+    int offset = 0;
+    int limit = 20;
+    bool withTotal = true;
+};
+
+// An attendance listing. Rows are ordered by the sort column, then id.
+struct AttendanceQuery
+{
+    enum Column : uint8_t
+    {
+        ById,
+        ByStudent,
+        ByName,
+        ByDate,
+        kColumns
+    };
+
+    models::AttendanceFilter filter;
+    uint8_t sortColumn = ById;
+    bool descending = false;
+    // As StudentQuery::after
+    std::optional<models::Attendance> after;
+    int offset = 0;
+    int limit = 20;
+    bool withTotal = true;
+};
+
+// What a report reads besides aggregates: the students of filter.className
+// (every class when empty), or only filter.studentId when set, and the
+// records matching filter.
+struct ReportScope
+{
+    models::AttendanceFilter filter;
+    bool students = true;
+    bool attendances = true;
+};
+
+// A student and the statuses of their records over a date range
+struct StudentSummary
+{
+    models::Student student;
+    models::StatusHistogram histogram{};
+};
+
+template <typename Row>
+struct Page
+{
+    std::vector<Row> rows;
+    // Rows matching the query regardless of paging; -1 when not counted
+    int total = -1;
+    // Whether rows follow this page
+    bool more = false;
+};
+
+// The one way the services, reports and import/export reach stored data.
+// Each backend is the source of truth for what it serves: whatever a
+// backend accepted is what its reads return.
+//
+// Coroutine methods reference their arguments until the task completes, so
+// co_await them directly. Writes return once the change is durable as far
+// as the backend makes it so.
+class Storage
+{
+public:
+    enum class Backend
+    {
+        // DataStore, made durable by the write-ahead log
+        Memory,
+        // The SQLite database alone
+        Sqlite,
+        // DataStore for reads and writes, every write also mirrored into
+        // SQLite
+        Hybrid
+    };
+
+    // "memory", "sqlite" or "hybrid"
+    static std::optional<Backend> parseBackend(std::string_view name);
+    static const char *backendName(Backend backend);
+
+    // The backend every caller uses; Hybrid until select() is called
+    static Storage &current();
+    static void select(Backend backend);
+    // A backend whether selected or not, e.g. to benchmark it
+    static Storage &of(Backend backend);
+
+    virtual ~Storage() = default;
+
+    virtual Backend backend() const = 0;
+
+    // Students
+    virtual drogon::Task<Page<models::Student>> listStudents(const StudentQuery &query) = 0;
+    virtual drogon::Task<std::optional<models::Student>> getStudent(
+        const std::string &studentId) = 0;
+    // False when the id is taken
+    virtual drogon::Task<bool> addStudent(const models::Student &student) = 0;
+    // For imports. Students whose id is already taken, including earlier in
+    // the same batch, are skipped; added[i] tells which went in. Returns the
+    // number added.
+    virtual drogon::Task<int> addStudents(const std::vector<models::Student> &students,
+                                          std::vector<bool> &added) = 0;
+    // An empty name or class is left as it is. False for an unknown student.
+    virtual drogon::Task<bool> updateStudent(const std::string &studentId,
+                                             const std::string &name,
+                                             const std::string &className) = 0;
+    virtual drogon::Task<bool> deleteStudent(const std::string &studentId) = 0;
+
+    // Attendances
+    virtual drogon::Task<Page<models::Attendance>> listAttendances(
+        const AttendanceQuery &query) = 0;
+    virtual drogon::Task<std::optional<models::Attendance>> getAttendance(int id) = 0;
+    // Fills in id, name and class on each row, in input order; id stays 0
+    // where the student is unknown. Returns the number of rows added.
+    virtual drogon::Task<int> addAttendances(std::vector<models::Attendance> &attendances) = 0;
+    // Leaves the status as it is when none is given; the remark is always
+    // replaced. False for an unknown record.
+    virtual drogon::Task<bool> updateAttendance(int id,
+                                                std::optional<utils::StatusCode> status,
+                                                const std::string &remark) = 0;
+    virtual drogon::Task<bool> deleteAttendance(int id) = 0;
+
+    // Classes, by name; a class's students by id. nullopt when no student
+    // is in the class.
+    virtual drogon::Task<std::vector<models::ClassSize>> classSizes() = 0;
+    virtual drogon::Task<std::optional<std::vector<models::Student>>> classStudents(
+        const std::string &className) = 0;
+
+    // Everything as of now, for exports, read without locks for as long as
+    // it is held. Null from a backend that keeps no copy in memory; exports
+    // then page through listStudents() and listAttendances() by id.
+    virtual std::shared_ptr<const models::DataSnapshot> snapshot() = 0;
+    // A view holding at least `scope`, for reports: the memory backends hand
+    // out their whole snapshot(), SQLite reads only the scope. Throws when
+    // the data cannot be read.
+    virtual std::shared_ptr<const models::DataSnapshot> snapshot(const ReportScope &scope) = 0;
+    // Students of a class (every class when empty) by class and id, each
+    // with the statuses of their records in [first, last] within the class.
+    // SQLite counts them with one GROUP BY query. Throws when the data
+    // cannot be read.
+    virtual std::vector<StudentSummary> studentSummaries(const std::string &className,
+                                                         std::optional<utils::Date> first,
+                                                         std::optional<utils::Date> last) = 0;
+
+    // Write generations, for caches of results derived from snapshot(): a
+    // result computed when generation() was g is stale once what it covers
+    // reports a later generation. A backend may answer coarser than asked,
+    // down to its latest write.
+    virtual uint64_t generation() const = 0;
+    // Latest attendance write in [first, last] of a class, or of any class
+    // when empty
+    virtual uint64_t attendanceGeneration(const std::string &className,
+                                          std::optional<utils::Date> first,
+                                          std::optional<utils::Date> last) const = 0;
+    // Latest change to the students of a class, or of any class when empty
+    virtual uint64_t rosterGeneration(const std::string &className) const = 0;
+};
+
+}  // namespace db
+}  // namespace student_attendance
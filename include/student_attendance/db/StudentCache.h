@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <drogon/orm/DbClient.h>
+#include <drogon/utils/coroutine.h>
+#include "student_attendance/models/Student.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// The whole student table held in memory, in front of SQLite, so attendance
+// writes and lookups resolve a student's name and class without a query.
+//
+// The roster is read in one query on first use. Writes that go through
+// SqliteStorage are applied to it as they commit; anything else that writes
+// the students table (imports mirrored by the hybrid backend, resets, bulk
+// loads) calls invalidate(), and the roster is read again on next use. While
+// it is loaded, a student missing from it does not exist, so lookups never
+// fall back to the database.
+class StudentCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        // Lookups made while the roster was not loaded
+        uint64_t misses = 0;
+        uint64_t loads = 0;
+        uint64_t invalidations = 0;
+        size_t students = 0;
+
+        double hitRate() const
+        {
+            auto lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+        }
+    };
+
+    static StudentCache &getInstance()
+    {
+        static StudentCache instance;
+        return instance;
+    }
+
+    // Reads the roster from `client` unless it is loaded. False when the
+    // query fails or a write raced it; callers then go to the database.
+    drogon::Task<bool> load(drogon::orm::DbClientPtr client);
+
+    // False when the roster is not loaded. Otherwise sets `student` to the
+    // student, or to nullopt for an unknown id.
+    bool lookup(const std::string &studentId, std::optional<models::Student> &student);
+
+    // Called once the matching write has committed. An empty name or class
+    // is left as it is, as in SqliteStorage::updateStudent().
+    void put(const models::Student &student);
+    void update(const std::string &studentId, const std::string &name,
+                const std::string &className);
+    void erase(const std::string &studentId);
+    // Drops the roster, for writes made around SqliteStorage
+    void invalidate();
+
+    Stats stats() const;
+    void resetStats();
+
+private:
+    StudentCache() = default;
+    ~StudentCache() = default;
+    StudentCache(const StudentCache &) = delete;
+    StudentCache &operator=(const StudentCache &) = delete;
+
+    mutable std::shared_mutex mutex_;
+    bool loaded_ = false;
+    // Bumped by every change, so a load that read the table before a write
+    // committed does not install what it read
+    uint64_t version_ = 0;
+    std::unordered_map<std::string, models::Student> students_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> invalidations_{0};
+};
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <drogon/utils/coroutine.h>
+#include "student_attendance/models/DataStore.h"
+#include "student_attendance/models/StoreJournal.h"
+#include "student_attendance/utils/PlatformFile.h"
+
+namespace trantor
+{
+class EventLoop;
+}
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Thrown by writes that were applied in memory but could not be made
+// durable; the request fails with a server error.
+class DurabilityError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Makes the in-memory DataStore durable without a SQLite round trip per
+// write. Every change the store makes is appended to a binary log; a
+// background thread writes what has accumulated and syncs it once (see
+// utils::PlatformFile::sync()), so concurrent writers share the cost of a sync (group commit).
+// A compact snapshot of the whole store is written once the log grows past
+// a budget, and the log it covers is dropped.
+//
+// The directory holds snapshot.bin and log segments wal-<n>.log. Recovery
+// maps the snapshot and loads it shard by shard as whole blocks (see
+// DataSnapshot::saveImage()), then replays the segments, skipping changes
+// whose generation the snapshot already includes. A record cut short by a
+// crash ends the log.
+//
+// A failed write or sync fails the log for good: nothing logged after it is
+// reported durable, and no snapshot is taken, until it is opened again.
+//
+// Files are written in host byte order.
+class WriteAheadLog : public models::StoreJournal
+{
+public:
+    static WriteAheadLog &getInstance()
+    {
+        static WriteAheadLog instance;
+        return instance;
+    }
+
+    struct Options
+    {
+        std::string directory = "./data";
+        // Log bytes written before a new snapshot is taken
+        uint64_t checkpointBytes = 64u << 20;
+    };
+
+    struct RecoveryStats
+    {
+        bool fromSnapshot = false;
+        size_t students = 0;
+        size_t attendances = 0;
+        // Log records applied on top of the snapshot
+        size_t replayed = 0;
+        // Whether the log ended in a partial or corrupt record
+        bool tornTail = false;
+    };
+
+    struct Stats
+    {
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t syncs = 0;
+        uint64_t checkpoints = 0;
+        bool failed = false;
+    };
+
+    // Restores `store` from the directory, creating it when missing, writes
+    // a fresh snapshot and starts logging the store's changes. An empty
+    // directory leaves the store as it is. Throws std::runtime_error when the
+    // directory or its snapshot cannot be read or written.
+    RecoveryStats open(const Options &options, models::DataStore &store);
+    // Whether `directory` holds a snapshot or log segment for open() to
+    // restore from
+    static bool hasState(const std::string &directory);
+    // Syncs what is logged, stops logging and detaches from the store.
+    void close();
+    bool isOpen() const;
+
+    // Blocks until every change logged so far is on disk. True at once when
+    // the log is not open; false when the log has failed, or was closed
+    // before those changes reached the disk.
+    bool waitDurable();
+    // As waitDurable(), but an event loop thread is not blocked: the caller
+    // is suspended and the flusher queues it back onto that loop once its
+    // changes are on disk. Elsewhere it blocks as waitDurable() does.
+    drogon::Task<bool> waitDurableCoro();
+    // Writes a snapshot of the store now and drops the log it covers.
+    void checkpoint();
+
+    Stats stats() const;
+
+    // models::StoreJournal
+    void studentPut(uint64_t generation, const models::Student &student) override;
+    void studentErased(uint64_t generation, const std::string &studentId) override;
+    void attendanceInserted(uint64_t generation, int id,
+                            const models::Attendance &attendance) override;
+    void attendanceUpdated(uint64_t generation, int id,
+                           std::optional<utils::StatusCode> status,
+                           const std::string &remark) override;
+    void attendanceErased(uint64_t generation, int id) override;
+    void cleared(uint64_t generation) override;
+
+private:
+    WriteAheadLog() = default;
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    struct DurableAwaiter;
+    // A coroutine suspended in waitDurableCoro()
+    struct Waiter
+    {
+        uint64_t target;
+        std::coroutine_handle<> handle;
+        trantor::EventLoop *loop;
+        bool *durable;
+    };
+
+    // Removes the waiters that the log can answer now, setting their
+    // results; caller holds mutex_.
+    std::vector<Waiter> takeAnsweredWaiters();
+    static void resume(const std::vector<Waiter> &waiters);
+
+    // Frames one record around payload_, which the caller filled in; caller
+    // holds mutex_.
+    void append();
+    void flushLoop();
+    void checkpointLoop();
+    // Ends the current segment; later records go to the next one. Returns
+    // the number of the segment ended.
+    uint64_t rotate();
+    void writeCheckpoint();
+
+    Options options_;
+    models::DataStore *store_ = nullptr;
+
+    mutable std::mutex mutex_;
+    // Flusher, checkpointer, and callers of waitDurable()
+    std::condition_variable wake_;
+    std::condition_variable checkpointWake_;
+    std::condition_variable flushed_;
+    std::vector<Waiter> waiters_;
+    std::string pending_;
+    std::string payload_;
+    // Records appended and records on disk
+    uint64_t appended_ = 0;
+    uint64_t durable_ = 0;
+    uint64_t sinceCheckpoint_ = 0;
+    uint64_t segment_ = 0;
+    bool rotating_ = false;
+    bool checkpointDue_ = false;
+    bool stopping_ = false;
+    bool open_ = false;
+    bool failed_ = false;
+    // The current segment and the bytes of whole batches in it; written by
+    // the flusher alone
+    utils::PlatformFile log_;
+    uint64_t logBytes_ = 0;
+    Stats stats_;
+
+    // One checkpoint at a time
+    std::mutex checkpointMutex_;
+    std::thread flusher_;
+    std::thread checkpointer_;
+};
+
+}  // namespace db
+}  // namespace student_attendance
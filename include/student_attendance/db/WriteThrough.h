@@ -0,0 +1,54 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <drogon/utils/coroutine.h>
+#include "student_attendance/models/DataStore.h"
+#include "student_attendance/models/Student.h"
+#include "student_attendance/models/Attendance.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+// Mirrors changes already applied to the in-memory store into SQLite; bulk
+// inserts go in one transaction of multi-row INSERTs per call. Best effort
+// like the other SQLite paths: the in-memory store, which reports read from,
+// keeps the rows either way, and a failed write is logged. Does nothing when
+// no database client is configured.
+//
+// Records keep the same id in both, so at startup the store is loaded from
+// the mirror when nothing else restores it, and new ids are drawn above the
+// mirror's (see loadFromMirror() and reseedFromMirror()).
+
+// Students that already exist in SQLite are left as they are.
+drogon::Task<> writeThroughStudents(const std::vector<models::Student> &students);
+
+// Inserted under their in-memory ids; rows with id 0 were rejected by the
+// store and are skipped.
+drogon::Task<> writeThroughAttendances(const std::vector<models::Attendance> &attendances);
+
+// The student as it now is, inserted or overwritten
+drogon::Task<> writeThroughStudentChange(const models::Student &student);
+drogon::Task<> writeThroughStudentRemoval(const std::string &studentId);
+
+// As DataStore::updateAttendance()
+drogon::Task<> writeThroughAttendanceChange(int id,
+                                            std::optional<utils::StatusCode> status,
+                                            const std::string &remark);
+drogon::Task<> writeThroughAttendanceRemoval(int id);
+
+// Startup, before serving: replaces the contents of `store` with the
+// mirror's students and records. False, leaving the store as it is, when no
+// client is configured or the tables cannot be read.
+bool loadFromMirror(models::DataStore &store);
+// Startup, after recovery: makes `store` draw new attendance ids above
+// MAX(id) of the mirror, so rows written through never take an id the
+// mirror already holds.
+void reseedFromMirror(models::DataStore &store);
+
+}  // namespace db
+}  // namespace student_attendance
@@ -3,6 +3,8 @@
 #include <string>
 #include <json/json.h>
 #include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
+#include "student_attendance/utils/JsonWriter.h"
 
 namespace student_attendance
 {
@@ -15,15 +17,15 @@ struct Attendance
     std::string studentId;
     std::string name;
     std::string className;
-    std::string date;  // MM-DD format
-    std::string status;
+    utils::Date date;
+    utils::StatusCode status;
     std::string remark;
 
-    Attendance() : id(0) {}
+    Attendance() : id(0), status(utils::StatusCode::Present) {}
 
     Attendance(int i, const std::string &sid, const std::string &n,
-               const std::string &cls, const std::string &d,
-               const std::string &s, const std::string &r = "")
+               const std::string &cls, utils::Date d,
+               utils::StatusCode s, const std::string &r = "")
         : id(i), studentId(sid), name(n), className(cls),
           date(d), status(s), remark(r)
     {
@@ -36,13 +38,30 @@ struct Attendance
         json["student_id"] = studentId;
         json["name"] = name;
         json["class"] = className;
-        json["date"] = date;
-        json["status"] = status;
-        json["status_symbol"] = utils::AttendanceStatus::getSymbol(status);
+        json["date"] = date.toString();
+        json["status"] = std::string(utils::AttendanceStatus::toString(status));
+        json["status_symbol"] = std::string(utils::AttendanceStatus::getSymbol(status));
         json["remark"] = remark;
         return json;
     }
 
+    // Same members as toJson(), written without building a tree.
+    void writeJson(utils::JsonWriter &json) const
+    {
+        json.beginObject()
+            .member("id", id)
+            .member("student_id", studentId)
+            .member("name", name)
+            .member("class", className)
+            .member("date", date.toString())
+            .member("status", utils::AttendanceStatus::toString(status))
+            .member("status_symbol", utils::AttendanceStatus::getSymbol(status))
+            .member("remark", remark)
+            .endObject();
+    }
+
+    // An unknown "status" or unparsable "date" leaves the default; callers
+    // that accept external input validate those fields first.
     static Attendance fromJson(const Json::Value &json)
     {
         Attendance att;
@@ -55,9 +74,15 @@ struct Attendance
         if (json.isMember("class"))
             att.className = json["class"].asString();
         if (json.isMember("date"))
-            att.date = json["date"].asString();
+        {
+            if (auto date = utils::Date::parse(json["date"].asString()))
+                att.date = *date;
+        }
         if (json.isMember("status"))
-            att.status = json["status"].asString();
+        {
+            if (auto code = utils::AttendanceStatus::fromString(json["status"].asString()))
+                att.status = *code;
+        }
         if (json.isMember("remark"))
             att.remark = json["remark"].asString();
         return att;
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "CopyOnWrite.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
+
+namespace student_attendance
+{
+namespace utils
+{
+class ImageWriter;
+class ImageReader;
+}  // namespace utils
+
+namespace models
+{
+
+// Record counts indexed by StatusCode.
+using StatusHistogram = std::array<int, utils::kStatusCount>;
+
+// Status histograms kept in step with every attendance write, so reports sum
+// a handful of cells instead of rescanning records.
+//
+// Cells are keyed by (student, class, day), (class, day) and day, plus a
+// running total per (student, class). Class is the one recorded on the
+// attendance row, matching what a filtered scan would count. Cells that drop
+// to zero are removed, so a student's day map spans exactly the days that
+// have records.
+//
+// Cells are held in copy-on-write buckets (CopyOnWrite.h), so copying the
+// aggregates is cheap and a write after a copy clones one bucket of students
+// and one month or so of day cells.
+//
+// Not synchronized; DataStore keeps one per shard, under the shard's
+// attendance lock.
+class AttendanceAggregates
+{
+public:
+    void add(const std::string &studentId, const std::string &className,
+             utils::Date day, utils::StatusCode status);
+    void remove(const std::string &studentId, const std::string &className,
+                utils::Date day, utils::StatusCode status);
+    void clear();
+
+    // Records on one day, in one class or across all classes when empty.
+    StatusHistogram day(utils::Date day, const std::string &className) const;
+
+    // Records of one student within [first, last]; an empty class counts the
+    // student's records in every class. Missing bounds leave the range open.
+    StatusHistogram student(const std::string &studentId,
+                            const std::string &className,
+                            std::optional<utils::Date> first,
+                            std::optional<utils::Date> last) const;
+
+    // The cells as a binary image, next to AttendanceTable::saveImage(), so
+    // a loaded snapshot need not re-add every record. loadImage() replaces
+    // the contents; false when the image is malformed.
+    void saveImage(utils::ImageWriter &out) const;
+    bool loadImage(utils::ImageReader &in);
+
+private:
+    // Histograms by day, in buckets of 2^kBucketBits consecutive days
+    class DayCells
+    {
+    public:
+        bool empty() const { return buckets_->empty(); }
+        int32_t firstDay() const { return (*buckets_->begin()->second).begin()->first; }
+        int32_t lastDay() const { return (*buckets_->rbegin()->second).rbegin()->first; }
+        const StatusHistogram *find(int32_t day) const;
+        // Drops the cell once it is all zeroes
+        void adjust(int32_t day, size_t code, int delta);
+        void put(int32_t day, const StatusHistogram &cell);
+
+        // Calls visit(day, cell) for each cell in [first, last], in day order
+        template <typename Visit>
+        void forEach(int32_t first, int32_t last, Visit &&visit) const
+        {
+            if (first > last)
+            {
+                return;
+            }
+            auto end = buckets_->upper_bound(bucketOf(last));
+            for (auto bucket = buckets_->lower_bound(bucketOf(first)); bucket != end; ++bucket)
+            {
+                const auto &cells = *bucket->second;
+                auto cellsEnd = cells.upper_bound(last);
+                for (auto it = cells.lower_bound(first); it != cellsEnd; ++it)
+                {
+                    visit(it->first, it->second);
+                }
+            }
+        }
+
+    private:
+        static constexpr int kBucketBits = 5;
+        using Bucket = std::map<int32_t, StatusHistogram>;
+
+        static int32_t bucketOf(int32_t day) { return day >> kBucketBits; }
+
+        CopyOnWrite<std::map<int32_t, CopyOnWrite<Bucket>>> buckets_;
+    };
+
+    struct StudentCells
+    {
+        DayCells days;
+        StatusHistogram total{};
+    };
+
+    static StatusHistogram sumRange(const StudentCells &cells, int32_t first, int32_t last);
+    static void saveCells(utils::ImageWriter &out, const DayCells &cells);
+    static bool loadCells(utils::ImageReader &in, DayCells &cells);
+
+    // student -> class -> cells; almost always a single class per student
+    using StudentClasses = std::unordered_map<std::string, StudentCells>;
+    BucketedMap<StudentClasses> students_;
+    BucketedMap<DayCells> classes_;
+    DayCells days_;
+};
+
+}  // namespace models
+}  // namespace student_attendance
@@ -0,0 +1,469 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Attendance.h"
+#include "CopyOnWrite.h"
+#include "StringPool.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+
+namespace student_attendance
+{
+namespace utils
+{
+class ImageWriter;
+class ImageReader;
+}  // namespace utils
+
+namespace models
+{
+
+// Search criteria for attendance scans; empty fields match everything.
+// The date range is inclusive on both ends.
+struct AttendanceFilter
+{
+    std::string studentId;
+    std::string name;
+    std::string className;
+    std::optional<utils::Date> date;
+    std::optional<utils::Date> startDate;
+    std::optional<utils::Date> endDate;
+    std::optional<utils::StatusCode> status;
+};
+
+// Column-oriented attendance storage.
+//
+// Every record is a row index into parallel arrays: ids, interned student /
+// name / class keys, day ordinals and a one-byte status code. Remarks are packed into
+// a single side blob so the scanned columns stay dense. Rows are appended in
+// id order, which keeps the id column sorted for binary-search lookups.
+// Deleted rows are tombstoned and reclaimed by compaction.
+//
+// Student and class postings, day postings ordered by date and per-status
+// bitmaps let scans start from the most selective index instead of reading
+// every row. Student ids and names are also kept in order, with name
+// postings, so walk() can list rows by any AttendanceQuery column from a
+// seek instead of a sort.
+//
+// Columns, remarks, dictionaries and indexes are all held in copy-on-write
+// chunks (CopyOnWrite.h): a copy of the table costs one pointer per chunk,
+// and a write to either copy afterwards clones only the chunks it touches.
+// DataStore relies on this to snapshot a shard without copying its rows.
+//
+// The table is not synchronized. Const members only read, so DataStore lets
+// readers share it and gives writers exclusive access.
+class AttendanceTable
+{
+public:
+    // Lightweight view of one stored row, valid while the table is unchanged.
+    class Row
+    {
+    public:
+        int id() const { return table_->ids_[index_]; }
+        uint32_t studentKey() const { return table_->studentKeys_[index_]; }
+        const std::string &studentId() const
+        {
+            return table_->studentIds_.value(table_->studentKeys_[index_]);
+        }
+        const std::string &name() const
+        {
+            return table_->names_.value(table_->nameKeys_[index_]);
+        }
+        const std::string &className() const
+        {
+            return table_->classNames_.value(table_->classKeys_[index_]);
+        }
+        utils::Date date() const { return utils::Date::fromOrdinal(table_->days_[index_]); }
+        utils::StatusCode status() const
+        {
+            return static_cast<utils::StatusCode>(table_->statusCodes_[index_]);
+        }
+        std::string_view remark() const { return table_->remarkAt(index_); }
+
+        Attendance toAttendance() const;
+        // Same members as Attendance::writeJson(), without copying the row out.
+        void writeJson(utils::JsonWriter &json) const;
+
+    private:
+        friend class AttendanceTable;
+        Row(const AttendanceTable &table, size_t index) : table_(&table), index_(index) {}
+
+        const AttendanceTable *table_;
+        size_t index_;
+    };
+
+    // Appends a record under the next id and returns that id.
+    int insert(const Attendance &attendance);
+    // Appends a record under `id`, which must exceed every id in the table.
+    int insert(const Attendance &attendance, int id);
+    // The id after the last one inserted
+    int nextId() const { return nextId_; }
+    std::optional<Attendance> find(int id) const;
+    // View of a live row; invalidated by the next erase (which may compact).
+    std::optional<Row> row(int id) const;
+    // Replaces the status (when given) and the remark of a record.
+    bool update(int id, std::optional<utils::StatusCode> status, std::string_view remark);
+    bool erase(int id);
+
+    void reserve(size_t rows);
+    void clear();
+    size_t size() const { return liveRows_; }
+
+    std::vector<Attendance> select(const AttendanceFilter &filter) const;
+
+    // Calls visitor(const Row &) for every live row matching the filter,
+    // in id order.
+    template <typename Visitor>
+    void scan(const AttendanceFilter &filter, Visitor &&visitor) const
+    {
+        Predicate predicate;
+        if (!compile(filter, predicate))
+        {
+            return;
+        }
+
+        auto candidates = plan(predicate);
+        if (!candidates)
+        {
+            for (size_t row = 0; row < ids_.size(); ++row)
+            {
+                if (predicate.matches(*this, row))
+                {
+                    visitor(Row(*this, row));
+                }
+            }
+            return;
+        }
+
+        for (uint32_t row : *candidates)
+        {
+            if (predicate.matches(*this, row))
+            {
+                visitor(Row(*this, row));
+            }
+        }
+    }
+
+    // scan() for callers that split the work. run(rows, scanSlice) is told
+    // how many rows the scan reads; scanSlice(first, last, visit) calls
+    // visit(const Row &) for the matching rows among [first, last) of them,
+    // in id order. Slices may be scanned concurrently.
+    template <typename Run>
+    void scanSliced(const AttendanceFilter &filter, Run &&run) const
+    {
+        Predicate predicate;
+        if (!compile(filter, predicate))
+        {
+            return;
+        }
+
+        auto candidates = plan(predicate);
+        size_t total = candidates ? candidates->size() : ids_.size();
+        run(total, [&](size_t first, size_t last, auto &&visit) {
+            for (size_t i = first; i < last; ++i)
+            {
+                size_t row = candidates ? (*candidates)[i] : i;
+                if (predicate.matches(*this, row))
+                {
+                    visit(Row(*this, row));
+                }
+            }
+        });
+    }
+
+    // Calls visitor(const Row &) for up to `limit` live rows with an id
+    // above afterId, in id order. Returns the last id visited, or afterId
+    // when there are none, so callers can resume from it.
+    template <typename Visitor>
+    int scanAfter(int afterId, size_t limit, Visitor &&visitor) const
+    {
+        auto first = std::upper_bound(ids_.begin(), ids_.end(), afterId) - ids_.begin();
+        int lastId = afterId;
+        for (auto row = static_cast<size_t>(first); row < ids_.size() && limit > 0; ++row)
+        {
+            if (statusCodes_[row] == kTombstone)
+                continue;
+            visitor(Row(*this, row));
+            lastId = ids_[row];
+            --limit;
+        }
+        return lastId;
+    }
+
+    // Orders walk() lists rows in: by id, or by student id, name or date and
+    // then id
+    enum class Order : uint8_t
+    {
+        ById,
+        ByStudent,
+        ByName,
+        ByDate
+    };
+
+    // Calls visitor(const Row &) for live rows matching the filter in
+    // `order`, reversed when descending, until it returns false. With
+    // `after`, starts past that row; only its `order` column and id are
+    // read. Seeks in O(log n) through the id column or the ordered keys and
+    // their postings, then steps over rows the filter rejects.
+    template <typename Visitor>
+    void walk(const AttendanceFilter &filter, Order order, bool descending,
+              const Attendance *after, Visitor &&visitor) const
+    {
+        Predicate predicate;
+        if (!compile(filter, predicate))
+        {
+            return;
+        }
+        auto visit = [&](uint32_t row) {
+            return !predicate.matches(*this, row) || visitor(Row(*this, row));
+        };
+
+        switch (order)
+        {
+        case Order::ById:
+            walkIds(descending, after, visit);
+            break;
+        case Order::ByStudent:
+            walkKeys(*studentOrder_, studentRows_, descending,
+                     after ? &after->studentId : nullptr, after, visit);
+            break;
+        case Order::ByName:
+            walkKeys(*nameOrder_, nameRows_, descending, after ? &after->name : nullptr,
+                     after, visit);
+            break;
+        case Order::ByDate:
+        {
+            int32_t day = after ? after->date.ordinal() : 0;
+            walkKeys(*daySlots_, dayRows_, descending, after ? &day : nullptr, after, visit);
+            break;
+        }
+        }
+    }
+
+    // Number of live rows matching the filter; read off the row or status
+    // counts, without a scan, when that is all the filter asks
+    size_t count(const AttendanceFilter &filter) const;
+
+    // Number of rows the given filter would read: the size of the candidate
+    // set chosen by the planner, or every row for a full scan.
+    size_t estimateRows(const AttendanceFilter &filter) const;
+
+    // The columns, string pools and indexes as one binary image, so a
+    // snapshot file can be loaded without re-inserting rows. loadImage()
+    // replaces the table; false when the image is malformed.
+    void saveImage(utils::ImageWriter &out) const;
+    bool loadImage(utils::ImageReader &in);
+
+private:
+    static constexpr uint8_t kTombstone = 0xFF;
+    // A block takes further remarks until it holds this many bytes
+    static constexpr size_t kRemarkBlock = 16 * 1024;
+
+    // Row numbers, ascending
+    using Postings = ChunkedVector<uint32_t>;
+    // One posting list per key, in chunks of 64 lists
+    using PostingsIndex = ChunkedVector<Postings, 6>;
+
+    // Interned strings in value order, with their keys
+    using KeyOrder = std::map<std::string, uint32_t, std::less<>>;
+
+    // Remarks back to back, starting at `start` in the offsets the remark
+    // column holds. A remark never spans two blocks.
+    struct RemarkBlock
+    {
+        uint64_t start = 0;
+        CopyOnWrite<std::string> bytes;
+    };
+
+    // A filter resolved against the dictionaries: equality filters become key
+    // compares, the date range becomes an ordinal interval and the name
+    // substring filter a per-key lookup mask.
+    struct Predicate
+    {
+        std::optional<uint32_t> studentKey;
+        std::optional<uint32_t> classKey;
+        std::optional<uint8_t> statusCode;
+        int32_t firstDay = std::numeric_limits<int32_t>::min();
+        int32_t lastDay = std::numeric_limits<int32_t>::max();
+        std::vector<uint8_t> nameMask;
+
+        bool singleDay() const { return firstDay == lastDay; }
+        bool hasDayRange() const
+        {
+            return firstDay != std::numeric_limits<int32_t>::min() ||
+                   lastDay != std::numeric_limits<int32_t>::max();
+        }
+
+        bool matches(const AttendanceTable &table, size_t row) const
+        {
+            if (table.statusCodes_[row] == kTombstone)
+                return false;
+            if (studentKey && table.studentKeys_[row] != *studentKey)
+                return false;
+            if (classKey && table.classKeys_[row] != *classKey)
+                return false;
+            if (statusCode && table.statusCodes_[row] != *statusCode)
+                return false;
+            if (!nameMask.empty() && !nameMask[table.nameKeys_[row]])
+                return false;
+            if (table.days_[row] < firstDay || table.days_[row] > lastDay)
+                return false;
+            return true;
+        }
+    };
+
+    // One index the planner may drive a query from.
+    struct Access
+    {
+        enum class Kind
+        {
+            Postings,
+            DayRange,
+            Status
+        };
+
+        Kind kind;
+        size_t estimate;
+        const Postings *postings = nullptr;
+    };
+
+    std::vector<Access> accessPaths(const Predicate &predicate) const;
+    // Candidate rows in ascending order, or nullopt when a full scan is cheaper.
+    std::optional<std::vector<uint32_t>> plan(const Predicate &predicate) const;
+    std::vector<uint32_t> rowsInDayRange(const Predicate &predicate) const;
+    std::vector<uint32_t> rowsWithStatus(uint8_t code) const;
+
+    template <typename Visit>
+    void walkIds(bool descending, const Attendance *after, Visit &&visit) const
+    {
+        if (!descending)
+        {
+            auto row = after ? std::upper_bound(ids_.begin(), ids_.end(), after->id) - ids_.begin()
+                             : 0;
+            for (auto end = static_cast<std::ptrdiff_t>(ids_.size()); row < end; ++row)
+            {
+                if (!visit(static_cast<uint32_t>(row)))
+                    return;
+            }
+            return;
+        }
+        auto row = after ? std::lower_bound(ids_.begin(), ids_.end(), after->id) - ids_.begin()
+                         : static_cast<std::ptrdiff_t>(ids_.size());
+        while (row > 0)
+        {
+            if (!visit(static_cast<uint32_t>(--row)))
+                return;
+        }
+    }
+
+    // Walks the postings of each key in key order, rows within a key in id
+    // order. The key of `after` resumes past its id.
+    template <typename Keys, typename Key, typename Visit>
+    void walkKeys(const Keys &keys, const PostingsIndex &postings, bool descending,
+                  const Key *afterKey, const Attendance *after, Visit &&visit) const
+    {
+        auto idAtMost = [this](int id) {
+            return [this, id](uint32_t row) { return ids_[row] <= id; };
+        };
+        auto idBelow = [this](int id) {
+            return [this, id](uint32_t row) { return ids_[row] < id; };
+        };
+
+        if (!descending)
+        {
+            for (auto it = afterKey ? keys.lower_bound(*afterKey) : keys.begin(); it != keys.end();
+                 ++it)
+            {
+                // Compaction drops the postings of keys with no live rows
+                if (it->second >= postings.size())
+                    continue;
+                const auto &rows = postings[it->second];
+                auto row = rows.begin();
+                if (afterKey && it->first == *afterKey)
+                    row = std::partition_point(rows.begin(), rows.end(), idAtMost(after->id));
+                for (; row != rows.end(); ++row)
+                {
+                    if (!visit(*row))
+                        return;
+                }
+            }
+            return;
+        }
+        for (auto it = afterKey ? keys.upper_bound(*afterKey) : keys.end(); it != keys.begin();)
+        {
+            --it;
+            if (it->second >= postings.size())
+                continue;
+            const auto &rows = postings[it->second];
+            auto row = rows.end();
+            if (afterKey && it->first == *afterKey)
+                row = std::partition_point(rows.begin(), rows.end(), idBelow(after->id));
+            while (row != rows.begin())
+            {
+                if (!visit(*--row))
+                    return;
+            }
+        }
+    }
+
+    bool compile(const AttendanceFilter &filter, Predicate &predicate) const;
+    std::optional<size_t> rowOf(int id) const;
+    void storeRemark(size_t row, std::string_view remark);
+    std::string_view remarkAt(size_t row) const;
+    void maybeCompact();
+    void compact();
+    void indexRow(size_t row);
+    uint32_t daySlot(int32_t day);
+    void setStatusBit(size_t row, uint8_t code, bool value);
+    void rebuildIndexes();
+    uint32_t intern(StringPool &pool, CopyOnWrite<KeyOrder> &order, std::string_view value);
+
+    // Columns
+    ChunkedVector<int> ids_;
+    ChunkedVector<uint32_t> studentKeys_;
+    ChunkedVector<uint32_t> nameKeys_;
+    ChunkedVector<uint32_t> classKeys_;
+    ChunkedVector<int32_t> days_;
+    ChunkedVector<uint8_t> statusCodes_;
+    ChunkedVector<uint64_t> remarkOffsets_;
+    ChunkedVector<uint32_t> remarkLengths_;
+
+    // Side storage: remarks in blocks by start offset, remarkSize_ bytes in all
+    std::vector<RemarkBlock> remarkBlocks_;
+    size_t remarkSize_ = 0;
+    size_t remarkGarbage_ = 0;
+
+    // Dictionaries
+    StringPool studentIds_;
+    StringPool names_;
+    StringPool classNames_;
+
+    // Secondary indexes. Postings hold row numbers in ascending order and may
+    // still reference tombstoned rows until the next compaction; status
+    // bitmaps and counts only track live rows. Days map, in date order, to
+    // their slot in dayRows_. Name postings and the key orders are left out
+    // of the image and rebuilt when it loads.
+    PostingsIndex studentRows_;
+    PostingsIndex nameRows_;
+    PostingsIndex classRows_;
+    CopyOnWrite<KeyOrder> studentOrder_;
+    CopyOnWrite<KeyOrder> nameOrder_;
+    CopyOnWrite<std::map<int32_t, uint32_t>> daySlots_;
+    PostingsIndex dayRows_;
+    std::array<ChunkedVector<uint64_t>, utils::kStatusCount> statusBitmaps_;
+    std::array<size_t, utils::kStatusCount> statusCounts_{};
+
+    size_t liveRows_ = 0;
+    int nextId_ = 1;
+};
+
+}  // namespace models
+}  // namespace student_attendance
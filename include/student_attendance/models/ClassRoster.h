@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "CopyOnWrite.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+struct ClassSize
+{
+    std::string name;
+    int studentCount = 0;
+};
+
+// Members of every class, kept in step with the student table so class
+// listings never scan students. Classes and members are held in order;
+// a class disappears with its last member. Copies share the class list and
+// each class's members until written (CopyOnWrite.h), so a change after a
+// copy clones the list of classes and the one class it touches.
+//
+// Not synchronized; DataStore updates it under its roster lock.
+class ClassRoster
+{
+public:
+    void add(const std::string &className, const std::string &studentId);
+    void remove(const std::string &className, const std::string &studentId);
+    void clear() { classes_ = {}; }
+
+    bool contains(const std::string &className) const { return classes_->count(className) > 0; }
+    int count(const std::string &className) const;
+    // Student ids of a class in order, or nullptr for an unknown class.
+    const std::set<std::string> *members(const std::string &className) const;
+
+    // Class names in order, and with their sizes
+    std::vector<std::string> names() const;
+    std::vector<ClassSize> sizes() const;
+
+private:
+    // The class list for writing
+    std::map<std::string, CopyOnWrite<std::set<std::string>>> &classes() { return classes_.mutate(); }
+
+    CopyOnWrite<std::map<std::string, CopyOnWrite<std::set<std::string>>>> classes_;
+};
+
+}  // namespace models
+}  // namespace student_attendance
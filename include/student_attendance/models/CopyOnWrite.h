@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace student_attendance
+{
+namespace models
+{
+
+// Building blocks that let DataStore hand out snapshots without deep copies.
+// Copying any of them copies pointers to shared parts; a later write clones
+// the one part it lands in when a copy still holds that part. Writers and
+// the snapshot that copies them hold the same lock, so a part seen as
+// unshared stays unshared while it is written.
+
+// A value shared by its copies until one of them is written through
+// mutate(). Empty (a default T) until first written.
+template <typename T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() = default;
+    explicit CopyOnWrite(T value) : value_(std::make_shared<T>(std::move(value))) {}
+
+    const T &operator*() const { return value_ ? *value_ : empty(); }
+    const T *operator->() const { return &**this; }
+
+    T &mutate()
+    {
+        if (!value_)
+        {
+            value_ = std::make_shared<T>();
+        }
+        else if (value_.use_count() != 1)
+        {
+            value_ = std::make_shared<T>(std::as_const(*value_));
+        }
+        else
+        {
+            // Pairs with the release of the last other copy's reference
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *value_;
+    }
+
+private:
+    static const T &empty()
+    {
+        static const T value{};
+        return value;
+    }
+
+    std::shared_ptr<T> value_;
+};
+
+// A vector in chunks of 2^ChunkBits elements. Reads index through one table
+// of chunk pointers; a write after a copy clones the chunk it lands in.
+template <typename T, size_t ChunkBits = 10>
+class ChunkedVector
+{
+public:
+    static constexpr size_t kChunkSize = size_t{1} << ChunkBits;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() = default;
+        const_iterator(const ChunkedVector *values, size_t index) : values_(values), index_(index) {}
+
+        reference operator*() const { return (*values_)[index_]; }
+        pointer operator->() const { return &(*values_)[index_]; }
+        reference operator[](difference_type n) const { return (*values_)[index_ + n]; }
+
+        const_iterator &operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++index_; return old; }
+        const_iterator &operator--() { --index_; return *this; }
+        const_iterator operator--(int) { auto old = *this; --index_; return old; }
+        const_iterator &operator+=(difference_type n) { index_ += n; return *this; }
+        const_iterator &operator-=(difference_type n) { index_ -= n; return *this; }
+        friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+        friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+        friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const const_iterator &a, const const_iterator &b)
+        {
+            return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+        }
+        friend bool operator==(const const_iterator &a, const const_iterator &b)
+        {
+            return a.index_ == b.index_;
+        }
+        friend auto operator<=>(const const_iterator &a, const const_iterator &b)
+        {
+            return a.index_ <=> b.index_;
+        }
+
+    private:
+        const ChunkedVector *values_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T &operator[](size_t i) const { return data_[i >> ChunkBits][i & kMask]; }
+    const T &back() const { return (*this)[size_ - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+    // Element i for writing
+    T &mutate(size_t i) { return chunk(i >> ChunkBits)[i & kMask]; }
+
+    void push_back(T value)
+    {
+        if ((size_ & kMask) == 0)
+        {
+            chunks_.emplace_back();
+            data_.push_back(nullptr);
+        }
+        auto &values = chunks_.back().mutate();
+        values.push_back(std::move(value));
+        data_.back() = values.data();
+        ++size_;
+    }
+
+    void resize(size_t count, const T &value = T())
+    {
+        while (size_ < count)
+        {
+            push_back(value);
+        }
+        if (count == size_)
+        {
+            return;
+        }
+        size_t keep = (count + kMask) >> ChunkBits;
+        chunks_.resize(keep);
+        data_.resize(keep);
+        if ((count & kMask) != 0)
+        {
+            chunk(keep - 1).resize(count & kMask);
+        }
+        size_ = count;
+    }
+
+    void reserve(size_t count)
+    {
+        chunks_.reserve((count + kMask) >> ChunkBits);
+        data_.reserve((count + kMask) >> ChunkBits);
+    }
+
+    void clear()
+    {
+        chunks_.clear();
+        data_.clear();
+        size_ = 0;
+    }
+
+    void assign(const T *values, size_t count)
+    {
+        clear();
+        reserve(count);
+        for (size_t first = 0; first < count; first += kChunkSize)
+        {
+            size_t last = std::min(count, first + kChunkSize);
+            chunks_.emplace_back(std::vector<T>(values + first, values + last));
+            data_.push_back(chunks_.back()->data());
+        }
+        size_ = count;
+    }
+
+    // Calls visit(values, count) for each chunk in order
+    template <typename Visit>
+    void forEachChunk(Visit &&visit) const
+    {
+        for (size_t c = 0; c < chunks_.size(); ++c)
+        {
+            visit(data_[c], chunks_[c]->size());
+        }
+    }
+
+private:
+    static constexpr size_t kMask = kChunkSize - 1;
+
+    std::vector<T> &chunk(size_t c)
+    {
+        auto &values = chunks_[c].mutate();
+        data_[c] = values.data();
+        return values;
+    }
+
+    std::vector<CopyOnWrite<std::vector<T>>> chunks_;
+    // chunks_[c]->data(), saving a hop on every read
+    std::vector<const T *> data_;
+    size_t size_ = 0;
+};
+
+// Hash for maps looked up by string_view without building a std::string
+struct StringViewHash
+{
+    using is_transparent = void;
+    size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+};
+
+// A string-keyed hash map split into kBuckets buckets by key; a write after
+// a copy clones the one bucket it lands in. Iterates in no particular order.
+template <typename Value>
+class BucketedMap
+{
+    using Bucket = std::unordered_map<std::string, Value, StringViewHash, std::equal_to<>>;
+
+public:
+    static constexpr size_t kBuckets = 64;
+    using value_type = typename Bucket::value_type;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename Bucket::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return *it_; }
+        pointer operator->() const { return &*it_; }
+        const_iterator &operator++()
+        {
+            ++it_;
+            skipEmpty();
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+        friend bool operator==(const const_iterator &a, const const_iterator &b)
+        {
+            return a.bucket_ == b.bucket_ && (a.bucket_ == kBuckets || a.it_ == b.it_);
+        }
+
+    private:
+        friend class BucketedMap;
+        const_iterator(const BucketedMap *map, size_t bucket, typename Bucket::const_iterator it)
+            : map_(map), bucket_(bucket), it_(it)
+        {
+        }
+
+        // Moves on to the next bucket with entries once this one is done
+        void skipEmpty()
+        {
+            while (bucket_ < kBuckets && it_ == map_->buckets_[bucket_]->end())
+            {
+                if (++bucket_ < kBuckets)
+                {
+                    it_ = map_->buckets_[bucket_]->begin();
+                }
+            }
+        }
+
+        const BucketedMap *map_ = nullptr;
+        size_t bucket_ = kBuckets;
+        typename Bucket::const_iterator it_{};
+    };
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const_iterator begin() const
+    {
+        const_iterator it(this, 0, buckets_[0]->begin());
+        it.skipEmpty();
+        return it;
+    }
+    const_iterator end() const { return const_iterator(this, kBuckets, {}); }
+
+    const_iterator find(std::string_view key) const
+    {
+        size_t b = bucketOf(key);
+        auto it = buckets_[b]->find(key);
+        return it == buckets_[b]->end() ? end() : const_iterator(this, b, it);
+    }
+
+    // False, leaving the map as it was, when the key is taken
+    bool insert(std::string key, Value value)
+    {
+        auto &bucket = buckets_[bucketOf(key)];
+        if (bucket->find(key) != bucket->end())
+        {
+            return false;
+        }
+        bucket.mutate().emplace(std::move(key), std::move(value));
+        ++size_;
+        return true;
+    }
+
+    void put(std::string key, Value value)
+    {
+        auto &bucket = buckets_[bucketOf(key)];
+        if (bucket.mutate().insert_or_assign(std::move(key), std::move(value)).second)
+        {
+            ++size_;
+        }
+    }
+
+    // The value under key for writing, default-constructed when missing
+    Value &mutate(std::string_view key)
+    {
+        auto &bucket = buckets_[bucketOf(key)].mutate();
+        auto it = bucket.find(key);
+        if (it == bucket.end())
+        {
+            it = bucket.emplace(std::string(key), Value()).first;
+            ++size_;
+        }
+        return it->second;
+    }
+
+    bool erase(std::string_view key)
+    {
+        auto &bucket = buckets_[bucketOf(key)];
+        if (bucket->find(key) == bucket->end())
+        {
+            return false;
+        }
+        auto &values = bucket.mutate();
+        values.erase(values.find(key));
+        --size_;
+        return true;
+    }
+
+    void clear()
+    {
+        buckets_ = {};
+        size_ = 0;
+    }
+
+private:
+    static size_t bucketOf(std::string_view key) { return StringViewHash{}(key) % kBuckets; }
+
+    std::array<CopyOnWrite<Bucket>, kBuckets> buckets_;
+    size_t size_ = 0;
+};
+
+}  // namespace models
+}  // namespace student_attendance
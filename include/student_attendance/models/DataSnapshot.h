@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Student.h"
+#include "AttendanceTable.h"
+#include "AttendanceAggregates.h"
+#include "ClassRoster.h"
+#include "CopyOnWrite.h"
+#include "student_attendance/utils/ComputePool.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+// Students of one shard, by id
+using StudentMap = BucketedMap<Student>;
+
+// Attendance records of one shard and their aggregates
+struct AttendancePartition
+{
+    AttendanceTable table;
+    AttendanceAggregates aggregates;
+};
+
+// An immutable point-in-time view of the DataStore, from
+// DataStore::snapshot(). Holders read it without locks while writers go on
+// changing the store: it shows every write up to generation(), and writes
+// after it only in shards copied after they landed. Shards and the class
+// roster that did not change between two snapshots are shared by both, and
+// the rest share their unchanged chunks with the store.
+class DataSnapshot
+{
+public:
+    static constexpr size_t kShards = 16;
+
+    // Orders a student listing comes in: by id, or by name or class and
+    // then id
+    enum class StudentOrder : uint8_t
+    {
+        ById,
+        ByName,
+        ByClass
+    };
+
+    // Which page of a listing to read. Rows come in `order`, then id,
+    // reversed when descending; the page starts past `after` when set
+    // (only its order column and id are read), else past the first
+    // `offset` rows.
+    template <typename Row, typename Order>
+    struct Listing
+    {
+        Order order{};
+        bool descending = false;
+        const Row *after = nullptr;
+        size_t offset = 0;
+        size_t limit = 0;
+    };
+    using StudentListing = Listing<Student, StudentOrder>;
+    using AttendanceListing = Listing<Attendance, AttendanceTable::Order>;
+
+    // The shard of a student and of all their attendance records. FNV-1a, so
+    // it does not depend on the standard library.
+    static size_t shardOf(std::string_view studentId);
+
+    // A view of records read from outside the DataStore, e.g. a database.
+    // Attendances keep the ids they carry and must come in id order.
+    static std::shared_ptr<const DataSnapshot> fromRecords(
+        const std::vector<Student> &students,
+        const std::vector<Attendance> &attendances,
+        uint64_t generation);
+
+    // The store's write generation this view was taken at
+    uint64_t generation() const { return generation_; }
+    // The id the store's next attendance record will get
+    int nextAttendanceId() const { return nextAttendanceId_; }
+
+    std::vector<Student> getAllStudents() const;
+    std::optional<Student> getStudentById(const std::string &studentId) const;
+    // By id; empty for an unknown class
+    std::vector<Student> getStudentsByClass(const std::string &className) const;
+    size_t attendanceCount() const;
+    // Up to `limit` students with an id above afterId, in id order, for
+    // exports. Seeks each shard's id index and merges them, so a batch costs
+    // O(limit) whatever the roster size.
+    std::vector<Student> getStudentsAfter(const std::string &afterId, size_t limit) const;
+
+    // A page of the students in className (any when empty) whose id or name
+    // contains keyword. A class is read from its roster entry; otherwise
+    // each shard's index for the order is seeked and the shards merged, so
+    // a page costs O(page + log n) plus the students the keyword rejects.
+    std::vector<Student> listStudents(const std::string &className, const std::string &keyword,
+                                      const StudentListing &listing) const;
+    size_t countStudents(const std::string &className, const std::string &keyword) const;
+
+    // A page of the records matching filter. Each shard walks its table
+    // from a seek (AttendanceTable::walk()) and the shards are merged; a
+    // filter the indexes cut to a few rows has those rows sorted instead.
+    std::vector<Attendance> listAttendances(const AttendanceFilter &filter,
+                                            const AttendanceListing &listing) const;
+    size_t countAttendances(const AttendanceFilter &filter) const;
+
+    // As DataStore::scanAttendances(), without locking
+    template <typename Visitor>
+    void scanAttendances(const AttendanceFilter &filter, Visitor &&visitor) const
+    {
+        if (!filter.studentId.empty())
+        {
+            shards_[shardOf(filter.studentId)].attendances->table.scan(
+                filter, std::forward<Visitor>(visitor));
+            return;
+        }
+        for (const auto &shard : shards_)
+        {
+            shard.attendances->table.scan(filter, visitor);
+        }
+    }
+
+    // Visits up to `limit` records with an id above afterId, in id order,
+    // returning the last id visited (afterId when none). The view does not
+    // change, so paging through it misses nothing
+    template <typename Visitor>
+    int scanAttendancesAfter(int afterId, size_t limit, Visitor &&visitor) const
+    {
+        std::vector<AttendanceTable::Row> rows;
+        for (const auto &shard : shards_)
+        {
+            shard.attendances->table.scanAfter(afterId, limit, [&rows](const AttendanceTable::Row &row) {
+                rows.push_back(row);
+            });
+        }
+        auto byId = [](const AttendanceTable::Row &a, const AttendanceTable::Row &b) {
+            return a.id() < b.id();
+        };
+        auto end = rows.begin() + static_cast<std::ptrdiff_t>(std::min(limit, rows.size()));
+        std::partial_sort(rows.begin(), end, rows.end(), byId);
+
+        int lastId = afterId;
+        for (auto it = rows.begin(); it != end; ++it)
+        {
+            visitor(*it);
+            lastId = it->id();
+        }
+        return lastId;
+    }
+
+    // scanAttendances() with one part per shard, scanned concurrently on the
+    // ComputePool once the view holds at least minRows records. prepare(
+    // parts) is called first; visitor(part, row) then sees the matching
+    // records of each part in id order, with different parts on different
+    // threads at once. A student's records all fall in one part.
+    template <typename Prepare, typename Visitor>
+    void scanAttendancesPartitioned(const AttendanceFilter &filter, size_t minRows,
+                                    Prepare &&prepare, Visitor &&visitor) const
+    {
+        prepare(kShards);
+        auto scanShard = [&](size_t part) {
+            shards_[part].attendances->table.scan(filter, [&](const AttendanceTable::Row &row) {
+                visitor(part, row);
+            });
+        };
+        if (attendanceCount() < minRows)
+        {
+            for (size_t part = 0; part < kShards; ++part)
+                scanShard(part);
+            return;
+        }
+        utils::ComputePool::getInstance().parallelFor(kShards, scanShard);
+    }
+
+    // What an image from saveImage() holds
+    struct ImageInfo
+    {
+        uint64_t generation = 0;
+        int nextAttendanceId = 1;
+        size_t students = 0;
+        size_t attendances = 0;
+    };
+
+    // Appends the view as a binary image for DataStore::loadImage(): a
+    // header, then one checksummed section per shard with its students,
+    // attendance table (columns and indexes as they are in memory) and
+    // aggregates. `out`
+    // must be 8-byte aligned in size where the image starts.
+    void saveImage(std::string &out) const;
+
+    // As the DataStore aggregate queries
+    StatusHistogram dailyHistogram(utils::Date day, const std::string &className) const;
+    std::vector<StatusHistogram> studentHistograms(
+        const std::vector<std::string> &studentIds,
+        const std::string &className,
+        std::optional<utils::Date> first,
+        std::optional<utils::Date> last) const;
+
+private:
+    friend class DataStore;
+
+    static constexpr size_t kStudentOrders = 3;
+
+    // A shard's students in each StudentOrder, each sorted on first use
+    struct StudentIndex
+    {
+        std::array<std::once_flag, kStudentOrders> sorted;
+        std::array<std::vector<const Student *>, kStudentOrders> rows;
+    };
+
+    struct Shard
+    {
+        std::shared_ptr<const StudentMap> students;
+        // Index of `students`, shared with it by later views
+        std::shared_ptr<StudentIndex> index = std::make_shared<StudentIndex>();
+        std::shared_ptr<const AttendancePartition> attendances;
+        // The shard's write counts when copied, to tell whether the next
+        // snapshot can share them
+        uint64_t studentVersion = 0;
+        uint64_t attendanceVersion = 0;
+    };
+
+    const std::vector<const Student *> &studentsInOrder(const Shard &shard,
+                                                        StudentOrder order) const;
+
+    std::array<Shard, kShards> shards_;
+    std::shared_ptr<const ClassRoster> roster_;
+    uint64_t rosterVersion_ = 0;
+    uint64_t generation_ = 0;
+    int nextAttendanceId_ = 1;
+};
+
+}  // namespace models
+}  // namespace student_attendance
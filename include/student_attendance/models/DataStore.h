@@ -1,32 +1,50 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <mutex>
+#include <shared_mutex>
 #include <optional>
 #include <algorithm>
 #include <memory>
 #include "Student.h"
 #include "Attendance.h"
-
-namespace drogon
-{
-namespace orm
-{
-class DbClient;
-using DbClientPtr = std::shared_ptr<DbClient>;
-}  // namespace orm
-}  // namespace drogon
+#include "AttendanceTable.h"
+#include "AttendanceAggregates.h"
+#include "ClassRoster.h"
+#include "DataSnapshot.h"
+#include "StoreJournal.h"
+#include "WriteGenerations.h"
+#include "student_attendance/utils/ComputePool.h"
 
 namespace student_attendance
 {
 namespace models
 {
 
+// In-memory students and attendances, partitioned into kShards shards by a
+// hash of the student id. A student and all of their attendance records
+// live in the same shard. Each shard has a reader-writer lock for its
+// students and one for its attendances, so readers share a shard and a
+// write holds up only its own shard. Scans take one shard at a time: a
+// long scan delays writers of the shard it is reading, not the others.
+//
+// Class membership (ClassRoster) and write generations span shards and have
+// locks of their own, always taken after any shard lock. Operations on
+// several shards lock them in index order.
+//
+// Reports read a DataSnapshot instead, which needs no locks once taken.
 class DataStore
 {
 public:
+    static constexpr size_t kShards = DataSnapshot::kShards;
+
     static DataStore &getInstance()
     {
         static DataStore instance;
@@ -37,6 +55,10 @@ public:
     std::vector<Student> getAllStudents() const;
     std::optional<Student> getStudentById(const std::string &studentId) const;
     bool addStudent(const Student &student);
+    // Bulk insert for imports, locking each shard involved once. Students whose id is already
+    // taken, including earlier in the same batch, are skipped; added[i]
+    // tells which went in. Returns the number added.
+    int addStudents(const std::vector<Student> &students, std::vector<bool> &added);
     bool updateStudent(const std::string &studentId, const Student &student);
     bool deleteStudent(const std::string &studentId);
     bool studentExists(const std::string &studentId) const;
@@ -47,20 +69,81 @@ public:
     std::vector<Attendance> getAllAttendances() const;
     std::optional<Attendance> getAttendanceById(int id) const;
     int addAttendance(const Attendance &attendance);
+    // Bulk insert for batch submissions: resolves every student, then
+    // inserts with every shard involved locked, so the batch gets ids in
+    // input order. Fills in id, name and class on each row; id stays 0
+    // where the student is unknown. Returns the number of rows inserted.
+    int addAttendances(std::vector<Attendance> &attendances);
     bool updateAttendance(int id, const Attendance &attendance);
+    // Leaves the status unchanged when none is given.
+    bool updateAttendance(int id, std::optional<utils::StatusCode> status,
+                          const std::string &remark);
     bool deleteAttendance(int id);
-    std::vector<Attendance> searchAttendances(
-        const std::string &studentId,
-        const std::string &name,
-        const std::string &className,
-        const std::string &date,
-        const std::string &startDate,
-        const std::string &endDate,
-        const std::string &status) const;
+    // In id order
+    std::vector<Attendance> searchAttendances(const AttendanceFilter &filter) const;
+
+    // Visits matching records in place, without copying them out of the
+    // columnar store: shard by shard, each under its shared lock, and in id
+    // order within a shard. A filter on one student reads only its shard.
+    template <typename Visitor>
+    void scanAttendances(const AttendanceFilter &filter, Visitor &&visitor) const
+    {
+        if (!filter.studentId.empty())
+        {
+            const auto &shard = shardFor(filter.studentId);
+            std::shared_lock<std::shared_mutex> lock(shard.attendanceMutex);
+            shard.records.table.scan(filter, std::forward<Visitor>(visitor));
+            return;
+        }
+        for (const auto &shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.attendanceMutex);
+            shard.records.table.scan(filter, visitor);
+        }
+    }
 
-    // Class operations
+    // Pre-aggregated status counts, maintained on every attendance write.
+    // Equivalent to tallying scanAttendances() over the same criteria.
+    StatusHistogram dailyHistogram(utils::Date day, const std::string &className) const;
+    // One histogram per student id, in the given order, for [first, last].
+    // Long lists are summed in parallel on the ComputePool.
+    std::vector<StatusHistogram> studentHistograms(
+        const std::vector<std::string> &studentIds,
+        const std::string &className,
+        std::optional<utils::Date> first,
+        std::optional<utils::Date> last) const;
+
+    // The store as of now, read without locks for as long as it is held.
+    // Shards are copied one at a time, each under its own locks only, and
+    // a copy shares the shard's copy-on-write chunks, so taking a snapshot
+    // costs a pointer per chunk of the shards written since the last one
+    // and a write after it clones only the chunks it touches. It holds
+    // every write up to its generation(); writes that land while it is
+    // taken may show in some shards and not others. While nothing is
+    // written, every call returns the same snapshot without taking a lock.
+    std::shared_ptr<const DataSnapshot> snapshot() const;
+
+    // Write generations, for caches of results derived from the store. Each
+    // write takes the next number of one sequence and records it against
+    // what it touched; a result computed when generation() was g is stale
+    // once anything it covers reports a later generation.
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    // Latest attendance write in [first, last] of a class, or of any class
+    // when empty. Missing bounds leave the range open.
+    uint64_t attendanceGeneration(const std::string &className,
+                                  std::optional<utils::Date> first,
+                                  std::optional<utils::Date> last) const;
+    // Latest change to the students of a class, or of any class when empty.
+    uint64_t rosterGeneration(const std::string &className) const;
+
+    // Class operations, answered from the maintained ClassRoster: names and
+    // sizes cost O(classes), a class's students O(class size). Classes are
+    // listed by name and students by id.
     std::vector<std::string> getAllClasses() const;
+    std::vector<ClassSize> getClassSizes() const;
     std::vector<Student> getStudentsByClass(const std::string &className) const;
+    // nullopt when no student is in the class
+    std::optional<std::vector<Student>> findClassStudents(const std::string &className) const;
     int getClassStudentCount(const std::string &className) const;
 
     // Data import/export
@@ -68,28 +151,99 @@ public:
     void importStudents(const std::vector<Student> &students);
     void importAttendances(const std::vector<Attendance> &attendances);
 
+    // Day of the sample attendance records. Fixed, so the memory store and
+    // the SQLite sample rows (db/schema.sql, DatabaseManager::reset()) agree
+    // whatever the current year.
+    static constexpr utils::Date kSampleDate = utils::Date::fromYmd(2025, 12, 15);
+
     // For tests
     void reset();
 
+    // Persistence. A journal, while set, is told of every change; nullptr
+    // detaches it.
+    void setJournal(StoreJournal *journal);
+    // Recovery: inserts records under the ids they carry. Records the store
+    // already holds, as a snapshot taken while they were written may, are
+    // skipped. Later inserts get ids above all of them.
+    void restoreAttendances(std::vector<Attendance> attendances);
+    // Recovery: replaces the whole store with an image from
+    // DataSnapshot::saveImage(), shards loading in parallel. Columns and
+    // indexes are copied out as blocks; only the class roster is rebuilt.
+    // The load is eager: nothing refers to `image` once it returns. Not
+    // journaled. Nullopt, with the store untouched,
+    // when the image is malformed.
+    std::optional<DataSnapshot::ImageInfo> loadImage(std::string_view image);
+    // Recovery: makes later writes draw generations above `generation` and
+    // later inserts ids from nextAttendanceId on, unless already past them.
+    void restoreCounters(uint64_t generation, int nextAttendanceId);
+
 private:
+    struct Shard
+    {
+        mutable std::shared_mutex studentMutex;
+        StudentMap students;
+        // Bumped on every write, for snapshot()
+        uint64_t studentVersion = 0;
+
+        mutable std::shared_mutex attendanceMutex;
+        AttendancePartition records;
+        uint64_t attendanceVersion = 0;
+    };
+
     DataStore();
     ~DataStore() = default;
     DataStore(const DataStore &) = delete;
     DataStore &operator=(const DataStore &) = delete;
 
-    void initSampleData();
-    void ensureDbClient();
-
-    mutable std::mutex studentMutex_;
-    mutable std::mutex attendanceMutex_;
-
-    std::unordered_map<std::string, Student> students_;
-    std::unordered_map<int, Attendance> attendances_;
-    int nextAttendanceId_;
+    static size_t shardOf(std::string_view studentId) { return DataSnapshot::shardOf(studentId); }
+    Shard &shardFor(const std::string &studentId) { return shards_[shardOf(studentId)]; }
+    const Shard &shardFor(const std::string &studentId) const
+    {
+        return shards_[shardOf(studentId)];
+    }
+    // Shard holding attendance `id`, found by probing each shard
+    std::optional<size_t> shardOfAttendance(int id) const;
+    size_t attendanceCount() const;
+    // Students by id under one shared lock per shard; unknown ids are skipped
+    std::vector<Student> lookupStudents(const std::vector<std::string> &studentIds) const;
 
-    drogon::orm::DbClientPtr dbClient_;
+    void initSampleData();
+    // Keep roster_ in step with the shard's students; caller holds the
+    // shard's student lock exclusively. Take the roster lock themselves.
+    void putStudent(Shard &shard, const Student &student);
+    void eraseStudent(Shard &shard, const std::string &studentId);
+    // Keep the shard's aggregates in step with its table; caller holds the
+    // shard's attendance lock exclusively.
+    int insertAttendance(Shard &shard, const Attendance &attendance, uint64_t generation);
+    int insertAttendance(Shard &shard, const Attendance &attendance, uint64_t generation, int id);
+    uint64_t nextGeneration();
+    // Returns the generation drawn
+    uint64_t touchRoster(const std::string &className);
+    void touchDay(const std::string &className, utils::Date day, uint64_t generation);
+    void clearShards();
+
+    std::array<Shard, kShards> shards_;
+    // Ids come from one counter, drawn under the shard lock, so ids within
+    // a shard ascend
+    std::atomic<int> nextAttendanceId_{1};
+
+    mutable std::shared_mutex rosterMutex_;
+    ClassRoster roster_;
+    // Per class, any class, and the last clear
+    std::unordered_map<std::string, uint64_t> rosterGenerations_;
+    uint64_t rosterLatest_ = 0;
+    uint64_t rosterCleared_ = 0;
+
+    std::atomic<uint64_t> generation_{0};
+    mutable std::mutex generationMutex_;
+    WriteGenerations attendanceGenerations_;
+
+    std::atomic<StoreJournal *> journal_{nullptr};
+
+    // Latest snapshot; snapshotMutex_ lets one caller at a time replace it
+    mutable std::mutex snapshotMutex_;
+    mutable std::atomic<std::shared_ptr<const DataSnapshot>> snapshot_;
 };
 
 }  // namespace models
 }  // namespace student_attendance
-
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "Student.h"
+#include "Attendance.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+// Receives every change made to the DataStore, each with the write
+// generation it drew. Called with the changed shard locked, so changes to
+// one shard arrive in the order they were applied; changes to different
+// shards may interleave. Implementations must return quickly and must not
+// call back into the store.
+class StoreJournal
+{
+public:
+    virtual ~StoreJournal() = default;
+
+    // Added or replaced
+    virtual void studentPut(uint64_t generation, const Student &student) = 0;
+    virtual void studentErased(uint64_t generation, const std::string &studentId) = 0;
+    // Stored under `id`; attendance.id is not used
+    virtual void attendanceInserted(uint64_t generation, int id, const Attendance &attendance) = 0;
+    virtual void attendanceUpdated(uint64_t generation, int id,
+                                   std::optional<utils::StatusCode> status,
+                                   const std::string &remark) = 0;
+    virtual void attendanceErased(uint64_t generation, int id) = 0;
+    // Everything removed
+    virtual void cleared(uint64_t generation) = 0;
+};
+
+}  // namespace models
+}  // namespace student_attendance
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "CopyOnWrite.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+// Interns strings into dense integer keys. Keys are never reused, so a key
+// stays valid until clear(). Values and the lookup map are held in
+// copy-on-write parts, so copying a pool is cheap and interning after a copy
+// clones one chunk of values and one bucket of the map.
+class StringPool
+{
+public:
+    uint32_t intern(std::string_view value)
+    {
+        if (auto key = find(value))
+        {
+            return *key;
+        }
+        auto key = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::string(value));
+        keys_.insert(std::string(value), key);
+        return key;
+    }
+
+    std::optional<uint32_t> find(std::string_view value) const
+    {
+        auto it = keys_.find(value);
+        if (it != keys_.end())
+        {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    const std::string &value(uint32_t key) const { return values_[key]; }
+
+    size_t size() const { return values_.size(); }
+
+    void clear()
+    {
+        keys_.clear();
+        values_.clear();
+    }
+
+private:
+    ChunkedVector<std::string, 8> values_;
+    BucketedMap<uint32_t> keys_;
+};
+
+}  // namespace models
+}  // namespace student_attendance
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <json/json.h>
+#include "student_attendance/utils/JsonWriter.h"
 
 namespace student_attendance
 {
@@ -30,6 +31,16 @@ struct Student
         return json;
     }
 
+    // Same members as toJson(), written without building a tree.
+    void writeJson(utils::JsonWriter &json) const
+    {
+        json.beginObject()
+            .member("student_id", studentId)
+            .member("name", name)
+            .member("class", className)
+            .endObject();
+    }
+
     Json::Value toBasicJson() const
     {
         Json::Value json;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "student_attendance/utils/Date.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+// Remembers, per (class, day) cell, the generation of the last attendance
+// write that touched it, so a cache can ask whether anything in a class and
+// date range changed after a given generation. Generations come from one
+// sequence that only grows; DataStore hands them out.
+//
+// Class is the one recorded on the attendance row, as in AttendanceAggregates.
+// clear() stands for a change to every cell and is remembered as such, and
+// touchClass() for a change to every day of one class.
+//
+// Not synchronized; its owner updates it under a lock of its own.
+class WriteGenerations
+{
+public:
+    void touch(const std::string &className, utils::Date day, uint64_t generation);
+    void touchClass(const std::string &className, uint64_t generation);
+    void clear(uint64_t generation);
+
+    // Latest generation that touched [first, last] in one class, or in any
+    // class when empty. Missing bounds leave the range open.
+    uint64_t latest(const std::string &className,
+                    std::optional<utils::Date> first,
+                    std::optional<utils::Date> last) const;
+
+private:
+    using DayCells = std::map<int32_t, uint64_t>;
+
+    static uint64_t latestIn(const DayCells &cells,
+                             std::optional<utils::Date> first,
+                             std::optional<utils::Date> last);
+
+    std::unordered_map<std::string, DayCells> classes_;
+    DayCells days_;
+    // touchClass(): per class, and the latest over all classes
+    std::unordered_map<std::string, uint64_t> wholeClasses_;
+    uint64_t wholeClassLatest_ = 0;
+    uint64_t cleared_ = 0;
+};
+
+}  // namespace models
+}  // namespace student_attendance
@@ -10,6 +10,8 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
 
 namespace student_attendance
 {
@@ -29,8 +31,8 @@ public:
     // Getters
     int64_t getId() const noexcept { return id_; }
     const std::string &getStudentId() const noexcept { return studentId_; }
-    const std::string &getDate() const noexcept { return date_; }
-    const std::string &getStatus() const noexcept { return status_; }
+    utils::Date getDate() const noexcept { return date_; }
+    utils::StatusCode getStatus() const noexcept { return status_; }
     const std::string &getRemark() const noexcept { return remark_; }
     const trantor::Date &getCreatedAt() const noexcept { return createdAt_; }
     const trantor::Date &getUpdatedAt() const noexcept { return updatedAt_; }
@@ -38,8 +40,8 @@ public:
     // Setters
     void setId(int64_t id) { id_ = id; }
     void setStudentId(const std::string &id) { studentId_ = id; }
-    void setDate(const std::string &date) { date_ = date; }
-    void setStatus(const std::string &status) { status_ = status; }
+    void setDate(utils::Date date) { date_ = date; }
+    void setStatus(utils::StatusCode status) { status_ = status; }
     void setRemark(const std::string &remark) { remark_ = remark; }
     void setCreatedAt(const trantor::Date &dt) { createdAt_ = dt; }
     void setUpdatedAt(const trantor::Date &dt) { updatedAt_ = dt; }
@@ -59,8 +61,8 @@ public:
 private:
     int64_t id_{0};
     std::string studentId_;
-    std::string date_;
-    std::string status_;
+    utils::Date date_;
+    utils::StatusCode status_{utils::StatusCode::Present};
     std::string remark_;
     trantor::Date createdAt_;
     trantor::Date updatedAt_;
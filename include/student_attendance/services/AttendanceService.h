@@ -4,8 +4,9 @@
 #include <vector>
 #include <optional>
 #include <json/json.h>
+#include <drogon/utils/coroutine.h>
 #include "student_attendance/models/Attendance.h"
-#include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/PageCursor.h"
 
 namespace student_attendance
 {
@@ -24,11 +25,52 @@ public:
     struct AttendanceListResult
     {
         std::vector<models::Attendance> attendances;
-        int total;
-        int page;
-        int pageSize;
+        int total = 0;  // -1 when not counted
+        int page = 1;
+        int pageSize = 0;
+        std::string nextCursor;  // empty on the last page
     };
 
+    // Reads and writes go to the selected db::Storage backend. Coroutine
+    // variants run their queries without blocking the calling event loop.
+    // Arguments are referenced until the task completes, so co_await the
+    // task directly.
+    //
+    // Lists are ordered by the sort column, then id. With a cursor the page
+    // resumes after the cursor's row and `page` is ignored; withTotal = false
+    // skips counting the whole listing.
+    drogon::Task<AttendanceListResult> getAttendancesCoro(
+        int page, int pageSize,
+        const std::string &studentId,
+        const std::string &name,
+        const std::string &className,
+        const std::string &date,
+        const std::string &startDate,
+        const std::string &endDate,
+        const std::string &status,
+        const std::string &sortBy,
+        const std::string &order,
+        const std::optional<utils::PageCursor> &cursor = std::nullopt,
+        bool withTotal = true) const;
+
+    drogon::Task<std::optional<models::Attendance>> getAttendanceCoro(int id) const;
+
+    // Fails for an unknown student, status or date
+    drogon::Task<std::pair<bool, models::Attendance>> createAttendanceCoro(
+        const std::string &studentId,
+        const std::string &date,
+        const std::string &status,
+        const std::string &remark);
+
+    // An empty status leaves it as it is
+    drogon::Task<std::pair<bool, std::string>> updateAttendanceCoro(
+        int id,
+        const std::string &status,
+        const std::string &remark);
+
+    drogon::Task<bool> deleteAttendanceCoro(int id);
+
+    // Blocking wrappers for callers outside an event loop, such as tests
     AttendanceListResult getAttendances(
         int page, int pageSize,
         const std::string &studentId,
@@ -39,7 +81,9 @@ public:
         const std::string &endDate,
         const std::string &status,
         const std::string &sortBy,
-        const std::string &order) const;
+        const std::string &order,
+        const std::optional<utils::PageCursor> &cursor = std::nullopt,
+        bool withTotal = true) const;
 
     std::optional<models::Attendance> getAttendance(int id) const;
 
@@ -49,9 +93,36 @@ public:
         const std::string &status,
         const std::string &remark);
 
-    int batchCreateAttendances(
+    struct BatchRecord
+    {
+        std::string studentId;
+        std::string status;
+        std::string remark = {};
+    };
+
+    // Outcome of one batch record, in submission order
+    struct BatchRowResult
+    {
+        bool created = false;
+        int id = 0;
+        std::string error;
+    };
+
+    struct BatchResult
+    {
+        int createdCount = 0;
+        std::vector<BatchRowResult> rows;
+    };
+
+    // Validates every record, then inserts the valid ones in a single pass.
+    // Rejected records are reported per row and do not stop the others.
+    drogon::Task<BatchResult> batchCreateAttendancesCoro(
+        const std::string &date,
+        const std::vector<BatchRecord> &records);
+
+    BatchResult batchCreateAttendances(
         const std::string &date,
-        const std::vector<std::pair<std::string, std::string>> &records);
+        const std::vector<BatchRecord> &records);
 
     std::pair<bool, std::string> updateAttendance(
         int id,
@@ -65,8 +136,6 @@ private:
     ~AttendanceService() = default;
     AttendanceService(const AttendanceService &) = delete;
     AttendanceService &operator=(const AttendanceService &) = delete;
-
-    models::DataStore &dataStore_ = models::DataStore::getInstance();
 };
 
 }  // namespace services
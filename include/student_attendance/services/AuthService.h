@@ -3,6 +3,8 @@
 #include <optional>
 #include <string>
 
+#include <drogon/utils/coroutine.h>
+
 #include "student_attendance/models/User.h"
 
 namespace student_attendance
@@ -19,6 +21,12 @@ public:
         return instance;
     }
 
+    // Checks the credentials without blocking the calling event loop.
+    drogon::Task<std::optional<models::User>> authenticateCoro(
+        const std::string &username,
+        const std::string &password) const;
+
+    // Blocking wrapper for callers outside an event loop, such as tests
     std::optional<models::User> authenticate(const std::string &username,
                                             const std::string &password) const;
 
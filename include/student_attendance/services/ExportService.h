@@ -0,0 +1,107 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "student_attendance/models/DataSnapshot.h"
+
+namespace student_attendance
+{
+namespace db
+{
+class Storage;
+}
+
+namespace services
+{
+
+class ExportService
+{
+public:
+    static ExportService &getInstance()
+    {
+        static ExportService instance;
+        return instance;
+    }
+
+    enum class Format
+    {
+        Json,
+        Csv
+    };
+
+    // An export produced incrementally from the selected db::Storage: each
+    // refill reads one batch of rows and encodes it, so the output buffered
+    // stays bounded by the batch size however large the tables are. A
+    // storage with snapshots is read from one, and rows written while the
+    // export runs are not included; SQLite is paged by id with one query per
+    // batch, so rows committed meanwhile past the cursor may be. Each query
+    // is issued as soon as the batch before it is taken and answered on the
+    // database client's thread, so the I/O loop pulling the output does not
+    // run it.
+    class Stream
+    {
+    public:
+        // Copies up to `size` bytes of output into buffer; returns 0 once the
+        // export is complete.
+        size_t read(char *buffer, size_t size);
+
+    private:
+        friend class ExportService;
+
+        enum class Table
+        {
+            Students,
+            Attendances
+        };
+
+        Stream(db::Storage &storage, Format format, std::vector<Table> tables);
+
+        // Rows of one query-paged batch; only the current table's are set
+        struct Batch
+        {
+            std::vector<models::Student> students;
+            std::vector<models::Attendance> attendances;
+        };
+
+        // Appends the next piece of output to pending_; false when done.
+        bool fill();
+        // Requests the current table's batch after the cursor into next_.
+        void prefetch();
+        size_t appendStudents();
+        size_t appendAttendances();
+
+        db::Storage &storage_;
+        // Null when the storage is paged through queries instead
+        std::shared_ptr<const models::DataSnapshot> data_;
+        Format format_;
+        std::vector<Table> tables_;
+        size_t table_ = 0;
+        bool opened_ = false;
+        bool closed_ = false;
+        bool firstRow_ = true;
+        std::string lastStudentId_;
+        int lastAttendanceId_ = 0;
+        std::future<Batch> next_;
+        std::string pending_;
+        size_t offset_ = 0;
+    };
+
+    // type 为 students、attendances 或 all; CSV 不支持 all. Returns nullptr
+    // for combinations that cannot be exported.
+    std::unique_ptr<Stream> open(const std::string &type, Format format) const;
+
+    // Writes the whole export to out; false when the type is not supported.
+    bool exportTo(const std::string &type, Format format, std::ostream &out) const;
+
+private:
+    ExportService() = default;
+    ~ExportService() = default;
+    ExportService(const ExportService &) = delete;
+    ExportService &operator=(const ExportService &) = delete;
+};
+
+}  // namespace services
+}  // namespace student_attendance
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <drogon/utils/coroutine.h>
+#include <json/json.h>
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/models/Attendance.h"
+#include "student_attendance/models/Student.h"
+#include "student_attendance/utils/CsvReader.h"
+#include "student_attendance/utils/JsonArrayReader.h"
+
+namespace student_attendance
+{
+namespace services
+{
+
+class ImportService
+{
+public:
+    static ImportService &getInstance()
+    {
+        static ImportService instance;
+        return instance;
+    }
+
+    enum class Type
+    {
+        Students,
+        Attendances
+    };
+
+    enum class Format
+    {
+        Csv,
+        Json
+    };
+
+    struct LineError
+    {
+        int64_t line = 0;
+        std::string message;
+    };
+
+    struct Result
+    {
+        int importedCount = 0;
+        int skippedCount = 0;
+        // In line order, at most kMaxErrors of them
+        std::vector<LineError> errors;
+        bool errorsTruncated = false;
+        // Set when the input as a whole was rejected, e.g. a missing column
+        std::string fatal;
+    };
+
+    // Errors listed per import; skipped rows beyond this are only counted.
+    static constexpr size_t kMaxErrors = 1000;
+    // Rows validated before they are handed to the storage as one batch.
+    static constexpr size_t kBatchSize = 1000;
+
+    // Incremental import: validates rows as they arrive and seals them into
+    // batches of kBatchSize, which apply() hands to the storage, so neither
+    // the input nor the rows are ever held as a whole. CSV input needs a
+    // header row; columns are matched by name and extra columns are ignored,
+    // so an export can be imported back. JSON input is a top-level array of
+    // objects.
+    class Importer
+    {
+    public:
+        Importer(Type type, Format format);
+
+        // Parses the next piece of the input.
+        void feed(std::string_view chunk);
+        // One already parsed record; line is what errors report for it.
+        void add(int64_t line, const Json::Value &record);
+        // Seals the rows buffered so far into a batch.
+        void flush();
+        // Checks the input was complete, then flushes.
+        void finish();
+        // Writes the sealed batches to `storage`, in input order.
+        drogon::Task<> apply(db::Storage &storage);
+
+        bool failed() const { return !result_.fatal.empty(); }
+        bool hasBatches() const { return !batches_.empty(); }
+        // Complete once every batch is applied
+        const Result &result() const { return result_; }
+
+    private:
+        // Valid rows with their lines, and the rows rejected among them
+        struct Batch
+        {
+            std::vector<models::Student> students;
+            std::vector<models::Attendance> attendances;
+            std::vector<int64_t> lines;
+            std::vector<LineError> errors;
+        };
+
+        void addCsvRecord(int64_t line, const std::vector<std::string_view> &fields);
+        void addJsonElement(int64_t line, std::string_view text);
+        bool readHeader(const std::vector<std::string_view> &fields);
+        void addStudent(int64_t line, models::Student student);
+        void addAttendance(int64_t line, std::string_view studentId, std::string_view date,
+                           std::string_view status, std::string_view remark);
+        void reject(int64_t line, std::string message);
+        void record(LineError error);
+
+        Type type_;
+        Format format_;
+        utils::CsvReader csv_;
+        utils::JsonArrayReader json_;
+        std::unique_ptr<Json::CharReader> jsonReader_;
+        // Field index per expected column, filled from the CSV header
+        std::vector<int> columns_;
+        bool headerRead_ = false;
+
+        // The batch being validated
+        Batch batch_;
+        std::deque<Batch> batches_;
+        Result result_;
+    };
+
+    // Imports a whole upload into the selected db::Storage, applying each
+    // batch before parsing on. Parsing runs on the ComputePool; a caller on
+    // an I/O loop is resumed there for the storage writes.
+    drogon::Task<Result> importCoro(Type type, Format format, std::string_view content);
+    // Imports the records of a JSON request body.
+    drogon::Task<Result> importCoro(Type type, const Json::Value &records);
+
+    Result import(Type type, Format format, std::string_view content);
+    Result import(Type type, const Json::Value &records);
+
+private:
+    ImportService() = default;
+    ~ImportService() = default;
+    ImportService(const ImportService &) = delete;
+    ImportService &operator=(const ImportService &) = delete;
+};
+
+}  // namespace services
+}  // namespace student_attendance
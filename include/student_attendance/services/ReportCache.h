@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/utils/Date.h"
+#include "student_attendance/utils/JsonWriter.h"
+
+namespace student_attendance
+{
+namespace services
+{
+
+// Serialized report bodies, reused until a write touches what they cover.
+//
+// Entries are keyed by report type and parameters. Each remembers the
+// storage backend and generation it was computed at, and its scope: a class (or all classes), a
+// date range and whether it lists the roster. A lookup serves the entry only
+// while the store reports no later write within that scope, so a change to
+// one class or day leaves the reports of other classes and days cached.
+// Entries are evicted least recently used first, within an entry count and
+// a byte budget.
+//
+// Concurrent misses on one key compute the report once; the other callers
+// wait for that result instead of scanning the store again, unless a write
+// in scope landed after it started or the caller runs on an I/O loop, which
+// never waits.
+class ReportCache
+{
+public:
+    using Body = std::shared_ptr<const std::string>;
+    using Write = std::function<void(utils::JsonWriter &)>;
+
+    // What a report reads from the store
+    struct Scope
+    {
+        // Empty for every class
+        std::string className;
+        std::optional<utils::Date> first;
+        std::optional<utils::Date> last;
+        // Whether it lists students from the roster, not only attendance rows
+        bool roster = false;
+    };
+
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Entries found stale on lookup
+        uint64_t invalidations = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+
+        double hitRate() const
+        {
+            auto lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+        }
+    };
+
+    static constexpr size_t kMaxEntries = 256;
+    static constexpr size_t kMaxBytes = 64u << 20;
+
+    static ReportCache &getInstance()
+    {
+        static ReportCache instance;
+        return instance;
+    }
+
+    // The body `write` produces for `key`, from the cache while it is fresh.
+    Body get(const std::string &key, const Scope &scope, const Write &write);
+
+    // A budget of zero entries turns caching off.
+    void setCapacity(size_t maxEntries, size_t maxBytes);
+    void clear();
+    Stats stats() const;
+    void resetStats();
+
+private:
+    struct Entry
+    {
+        std::string key;
+        Scope scope;
+        // Generations of one backend say nothing about another's
+        const db::Storage *storage = nullptr;
+        uint64_t generation = 0;
+        // Distinguishes this computation from a later one under the same key
+        uint64_t ticket = 0;
+        std::shared_future<Body> body;
+        bool ready = false;
+        size_t bytes = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    ReportCache() = default;
+    ~ReportCache() = default;
+    ReportCache(const ReportCache &) = delete;
+    ReportCache &operator=(const ReportCache &) = delete;
+
+    static Body compute(const Write &write);
+    bool fresh(const Entry &entry) const;
+    // Caller holds mutex_.
+    void erase(EntryList::iterator entry);
+    void evict();
+
+    mutable std::mutex mutex_;
+    // Most recently used first
+    EntryList entries_;
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    size_t maxEntries_ = kMaxEntries;
+    size_t maxBytes_ = kMaxBytes;
+    size_t bytes_ = 0;
+    uint64_t tickets_ = 0;
+    Stats stats_;
+};
+
+}  // namespace services
+}  // namespace student_attendance
@@ -5,7 +5,8 @@
 #include <json/json.h>
 #include "student_attendance/models/Attendance.h"
 #include "student_attendance/models/Student.h"
-#include "student_attendance/models/DataStore.h"
+#include "student_attendance/services/ReportCache.h"
+#include "student_attendance/utils/JsonWriter.h"
 
 namespace student_attendance
 {
@@ -21,32 +22,62 @@ public:
         return instance;
     }
 
+    // Each report comes in two forms: write*Report() writes the JSON straight
+    // into a response body, get*Report() returns the same document as a tree.
+    // Both are served from the ReportCache while nothing they cover changed.
+    // A report is computed from a view of the selected db::Storage and
+    // never holds up writers. In memory that is one snapshot, so the report
+    // reflects a single point in time; on SQLite it reads only the students
+    // and records the report covers.
+
     // 考勤明细表
     Json::Value getDetailsReport(const std::string &startDate,
                                  const std::string &endDate,
                                  const std::string &className,
                                  const std::string &studentId) const;
+    void writeDetailsReport(utils::JsonWriter &json,
+                            const std::string &startDate,
+                            const std::string &endDate,
+                            const std::string &className,
+                            const std::string &studentId) const;
 
     // 考勤日报表
     Json::Value getDailyReport(const std::string &date,
                                const std::string &className) const;
+    void writeDailyReport(utils::JsonWriter &json,
+                          const std::string &date,
+                          const std::string &className) const;
 
     // 考勤汇总表
     Json::Value getSummaryReport(const std::string &startDate,
                                  const std::string &endDate,
                                  const std::string &className) const;
+    void writeSummaryReport(utils::JsonWriter &json,
+                            const std::string &startDate,
+                            const std::string &endDate,
+                            const std::string &className) const;
 
     // 考勤异常表
     Json::Value getAbnormalReport(const std::string &startDate,
                                   const std::string &endDate,
                                   const std::string &className,
                                   const std::string &type) const;
+    void writeAbnormalReport(utils::JsonWriter &json,
+                             const std::string &startDate,
+                             const std::string &endDate,
+                             const std::string &className,
+                             const std::string &type) const;
 
     // 请假汇总表
     Json::Value getLeaveReport(const std::string &startDate,
                                const std::string &endDate,
                                const std::string &className,
                                const std::string &type) const;
+    void writeLeaveReport(utils::JsonWriter &json,
+                          const std::string &startDate,
+                          const std::string &endDate,
+                          const std::string &className,
+                          const std::string &type) const;
 
 private:
     ReportService() = default;
@@ -54,7 +85,31 @@ private:
     ReportService(const ReportService &) = delete;
     ReportService &operator=(const ReportService &) = delete;
 
-    models::DataStore &dataStore_ = models::DataStore::getInstance();
+    // Compute the reports from the store, bypassing the cache
+    void buildDetailsReport(utils::JsonWriter &json,
+                            const std::string &startDate,
+                            const std::string &endDate,
+                            const std::string &className,
+                            const std::string &studentId) const;
+    void buildDailyReport(utils::JsonWriter &json,
+                          const std::string &date,
+                          const std::string &className) const;
+    void buildSummaryReport(utils::JsonWriter &json,
+                            const std::string &startDate,
+                            const std::string &endDate,
+                            const std::string &className) const;
+    void buildAbnormalReport(utils::JsonWriter &json,
+                             const std::string &startDate,
+                             const std::string &endDate,
+                             const std::string &className,
+                             const std::string &type) const;
+    void buildLeaveReport(utils::JsonWriter &json,
+                          const std::string &startDate,
+                          const std::string &endDate,
+                          const std::string &className,
+                          const std::string &type) const;
+
+    ReportCache &cache_ = ReportCache::getInstance();
 };
 
 }  // namespace services
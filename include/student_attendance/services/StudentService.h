@@ -4,8 +4,9 @@
 #include <vector>
 #include <optional>
 #include <json/json.h>
+#include <drogon/utils/coroutine.h>
 #include "student_attendance/models/Student.h"
-#include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/PageCursor.h"
 
 namespace student_attendance
 {
@@ -24,16 +25,50 @@ public:
     struct StudentListResult
     {
         std::vector<models::Student> students;
-        int total;
-        int page;
-        int pageSize;
+        int total = 0;  // -1 when not counted
+        int page = 1;
+        int pageSize = 0;
+        std::string nextCursor;  // empty on the last page
     };
 
+    // Reads and writes go to the selected db::Storage backend. Coroutine
+    // variants run their queries without blocking the calling event loop.
+    // Arguments are referenced until the task completes, so co_await the
+    // task directly.
+    //
+    // Lists are ordered by the sort column, then student_id. With a cursor
+    // the page resumes after the cursor's row and `page` is ignored;
+    // withTotal = false skips counting the whole listing.
+    drogon::Task<StudentListResult> getStudentsCoro(
+        int page, int pageSize,
+        const std::string &sortBy,
+        const std::string &order,
+        const std::string &className,
+        const std::string &keyword,
+        const std::optional<utils::PageCursor> &cursor = std::nullopt,
+        bool withTotal = true) const;
+
+    drogon::Task<std::optional<models::Student>> getStudentCoro(
+        const std::string &studentId) const;
+
+    drogon::Task<std::pair<bool, std::string>> createStudentCoro(
+        const models::Student &student);
+
+    drogon::Task<std::pair<bool, std::string>> updateStudentCoro(
+        const std::string &studentId,
+        const std::string &name,
+        const std::string &className);
+
+    drogon::Task<bool> deleteStudentCoro(const std::string &studentId);
+
+    // Blocking wrappers for callers outside an event loop, such as tests
     StudentListResult getStudents(int page, int pageSize,
                                   const std::string &sortBy,
                                   const std::string &order,
                                   const std::string &className,
-                                  const std::string &keyword) const;
+                                  const std::string &keyword,
+                                  const std::optional<utils::PageCursor> &cursor = std::nullopt,
+                                  bool withTotal = true) const;
 
     std::optional<models::Student> getStudent(const std::string &studentId) const;
 
@@ -50,8 +85,6 @@ private:
     ~StudentService() = default;
     StudentService(const StudentService &) = delete;
     StudentService &operator=(const StudentService &) = delete;
-
-    models::DataStore &dataStore_ = models::DataStore::getInstance();
 };
 
 }  // namespace services
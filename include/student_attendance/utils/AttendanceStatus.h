@@ -1,14 +1,51 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <vector>
+#include <string_view>
 
 namespace student_attendance
 {
 namespace utils
 {
 
+// Attendance status as stored by the models, the in-memory store and the
+// integer `attendances.status` column. The values are persisted, so never
+// reorder or reuse them.
+enum class StatusCode : uint8_t
+{
+    Present = 0,
+    Absent = 1,
+    PersonalLeave = 2,
+    SickLeave = 3,
+    Late = 4,
+    EarlyLeave = 5
+};
+
+inline constexpr size_t kStatusCount = 6;
+
+struct StatusInfo
+{
+    std::string_view name;
+    std::string_view symbol;
+    std::string_view chineseName;
+    bool abnormal;
+    bool leave;
+};
+
+// Indexed by StatusCode.
+inline constexpr std::array<StatusInfo, kStatusCount> kStatusTable = {{
+    {"present", "√", "出勤", false, false},
+    {"absent", "X", "旷课", true, false},
+    {"personal_leave", "△", "事假", false, true},
+    {"sick_leave", "○", "病假", false, true},
+    {"late", "+", "迟到", true, false},
+    {"early_leave", "–", "早退", true, false},
+}};
+
 class AttendanceStatus
 {
 public:
@@ -19,85 +56,82 @@ public:
     static const std::string LATE;
     static const std::string EARLY_LEAVE;
 
-    static std::string getSymbol(const std::string &status)
+    // ---- StatusCode API (hot paths) ----
+
+    static constexpr const StatusInfo &info(StatusCode code)
+    {
+        return kStatusTable[static_cast<size_t>(code)];
+    }
+
+    static constexpr std::optional<StatusCode> fromString(std::string_view status)
     {
-        static const std::unordered_map<std::string, std::string> symbolMap = {
-            {"present", "√"},
-            {"absent", "X"},
-            {"personal_leave", "△"},
-            {"sick_leave", "○"},
-            {"late", "+"},
-            {"early_leave", "–"}
-        };
-
-        auto it = symbolMap.find(status);
-        if (it != symbolMap.end())
+        for (size_t i = 0; i < kStatusCount; ++i)
         {
-            return it->second;
+            if (kStatusTable[i].name == status)
+                return static_cast<StatusCode>(i);
         }
-        return "";
+        return std::nullopt;
     }
 
-    static std::string getStatusFromSymbol(const std::string &symbol)
+    static constexpr std::optional<StatusCode> fromSymbol(std::string_view symbol)
     {
-        static const std::unordered_map<std::string, std::string> statusMap = {
-            {"√", "present"},
-            {"X", "absent"},
-            {"△", "personal_leave"},
-            {"○", "sick_leave"},
-            {"+", "late"},
-            {"–", "early_leave"}
-        };
-
-        auto it = statusMap.find(symbol);
-        if (it != statusMap.end())
+        for (size_t i = 0; i < kStatusCount; ++i)
         {
-            return it->second;
+            if (kStatusTable[i].symbol == symbol)
+                return static_cast<StatusCode>(i);
         }
-        return "";
+        return std::nullopt;
     }
 
-    static bool isValidStatus(const std::string &status)
+    // Maps a persisted integer back to a StatusCode, rejecting unknown values.
+    static constexpr std::optional<StatusCode> fromInt(int value)
     {
-        static const std::vector<std::string> validStatuses = {
-            "present", "absent", "personal_leave", "sick_leave", "late", "early_leave"
-        };
+        if (value < 0 || value >= static_cast<int>(kStatusCount))
+            return std::nullopt;
+        return static_cast<StatusCode>(value);
+    }
 
-        for (const auto &s : validStatuses)
-        {
-            if (s == status)
-                return true;
-        }
-        return false;
+    static constexpr std::string_view toString(StatusCode code) { return info(code).name; }
+    static constexpr std::string_view getSymbol(StatusCode code) { return info(code).symbol; }
+    static constexpr std::string_view getChineseName(StatusCode code) { return info(code).chineseName; }
+    static constexpr bool isAbnormalStatus(StatusCode code) { return info(code).abnormal; }
+    static constexpr bool isLeaveStatus(StatusCode code) { return info(code).leave; }
+
+    // ---- String API (request/response edge) ----
+
+    static std::string getSymbol(const std::string &status)
+    {
+        auto code = fromString(status);
+        return code ? std::string(getSymbol(*code)) : std::string();
+    }
+
+    static std::string getStatusFromSymbol(const std::string &symbol)
+    {
+        auto code = fromSymbol(symbol);
+        return code ? std::string(toString(*code)) : std::string();
+    }
+
+    static bool isValidStatus(const std::string &status)
+    {
+        return fromString(status).has_value();
     }
 
     static bool isAbnormalStatus(const std::string &status)
     {
-        return status == "absent" || status == "late" || status == "early_leave";
+        auto code = fromString(status);
+        return code && isAbnormalStatus(*code);
     }
 
     static bool isLeaveStatus(const std::string &status)
     {
-        return status == "personal_leave" || status == "sick_leave";
+        auto code = fromString(status);
+        return code && isLeaveStatus(*code);
     }
 
     static std::string getChineseName(const std::string &status)
     {
-        static const std::unordered_map<std::string, std::string> nameMap = {
-            {"present", "出勤"},
-            {"absent", "旷课"},
-            {"personal_leave", "事假"},
-            {"sick_leave", "病假"},
-            {"late", "迟到"},
-            {"early_leave", "早退"}
-        };
-
-        auto it = nameMap.find(status);
-        if (it != nameMap.end())
-        {
-            return it->second;
-        }
-        return "";
+        auto code = fromString(status);
+        return code ? std::string(getChineseName(*code)) : std::string();
     }
 };
 
@@ -110,4 +144,3 @@ inline const std::string AttendanceStatus::EARLY_LEAVE = "early_leave";
 
 }  // namespace utils
 }  // namespace student_attendance
-
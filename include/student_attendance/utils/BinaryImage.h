@@ -0,0 +1,224 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// CRC-32 (IEEE), eight bytes per step (slicing-by-8), since whole snapshot
+// files are checked on load
+inline uint32_t crc32(std::string_view data)
+{
+    static const auto tables = [] {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (size_t k = 1; k < t.size(); ++k)
+            {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    auto *p = reinterpret_cast<const unsigned char *>(data.data());
+    size_t n = data.size();
+    for (; n >= 8; p += 8, n -= 8)
+    {
+        uint32_t lo = c ^ (uint32_t{p[0]} | uint32_t{p[1]} << 8 | uint32_t{p[2]} << 16 |
+                           uint32_t{p[3]} << 24);
+        c = tables[7][lo & 0xFF] ^ tables[6][(lo >> 8) & 0xFF] ^ tables[5][(lo >> 16) & 0xFF] ^
+            tables[4][lo >> 24] ^ tables[3][p[4]] ^ tables[2][p[5]] ^ tables[1][p[6]] ^
+            tables[0][p[7]];
+    }
+    for (; n > 0; ++p, --n)
+    {
+        c = tables[0][(c ^ *p) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Builds a binary image meant to be read back in place from a mapping of
+// the file: arrays start on 8-byte boundaries (relative to the start of the
+// image) so a reader can copy them out as whole blocks. Host byte order.
+class ImageWriter
+{
+public:
+    explicit ImageWriter(std::string &out) : out_(out) {}
+
+    template <typename T>
+    void put(T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void putString(std::string_view text)
+    {
+        put(static_cast<uint32_t>(text.size()));
+        out_ += text;
+    }
+
+    // Element count, then the elements, aligned
+    template <typename T>
+    void putArray(const T *values, size_t count)
+    {
+        beginArray(count);
+        appendArray(values, count);
+        endArray();
+    }
+
+    // putArray() in parts, for elements not held in one block: the total
+    // count, then each part in order, then endArray()
+    void beginArray(size_t count)
+    {
+        put(static_cast<uint64_t>(count));
+        align();
+    }
+
+    template <typename T>
+    void appendArray(const T *values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.append(reinterpret_cast<const char *>(values), count * sizeof(T));
+    }
+
+    void endArray() { align(); }
+
+    template <typename T>
+    void putArray(const std::vector<T> &values)
+    {
+        putArray(values.data(), values.size());
+    }
+
+    void putBlob(std::string_view bytes) { putArray(bytes.data(), bytes.size()); }
+
+    void align()
+    {
+        out_.resize((out_.size() + 7) & ~size_t{7}, '\0');
+    }
+
+    size_t size() const { return out_.size(); }
+
+    // For writing a value whose position is reserved before it is known
+    template <typename T>
+    void patch(size_t offset, T value)
+    {
+        std::memcpy(out_.data() + offset, &value, sizeof(value));
+    }
+
+private:
+    std::string &out_;
+};
+
+// Reads what ImageWriter wrote. Every read is bounds-checked; once one
+// fails the reader stays failed, so callers check ok() after a run of reads.
+class ImageReader
+{
+public:
+    ImageReader(const char *data, size_t size) : begin_(data), pos_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (!ok_ || static_cast<size_t>(end_ - pos_) < sizeof(T))
+            return ok_ = false;
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string &text)
+    {
+        uint32_t size = 0;
+        if (!get(size) || static_cast<size_t>(end_ - pos_) < size)
+            return ok_ = false;
+        text.assign(pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    template <typename T>
+    bool getArray(std::vector<T> &values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t count = 0;
+        const char *data = nullptr;
+        if (!getRange(count, sizeof(T), data))
+            return false;
+        values.resize(count);
+        if (count > 0)
+            std::memcpy(values.data(), data, count * sizeof(T));
+        return true;
+    }
+
+    bool getBlob(std::string &bytes)
+    {
+        uint64_t count = 0;
+        const char *data = nullptr;
+        if (!getRange(count, 1, data))
+            return false;
+        bytes.assign(data, count);
+        return true;
+    }
+
+    // Moves to `offset` from the start of the image
+    bool seek(uint64_t offset)
+    {
+        if (!ok_ || offset > static_cast<uint64_t>(end_ - begin_))
+            return ok_ = false;
+        pos_ = begin_ + offset;
+        return true;
+    }
+
+    // Skips to the next 8-byte boundary, as ImageWriter::align() did
+    bool align()
+    {
+        auto offset = static_cast<size_t>(pos_ - begin_);
+        auto padding = ((offset + 7) & ~size_t{7}) - offset;
+        if (!ok_ || static_cast<size_t>(end_ - pos_) < padding)
+            return ok_ = false;
+        pos_ += padding;
+        return true;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    bool getRange(uint64_t &count, size_t width, const char *&data)
+    {
+        if (!get(count) || !align())
+            return false;
+        if (count > static_cast<uint64_t>(end_ - pos_) / width)
+            return ok_ = false;
+        data = pos_;
+        pos_ += count * width;
+        return align();
+    }
+
+    const char *begin_;
+    const char *pos_;
+    const char *end_;
+    bool ok_ = true;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
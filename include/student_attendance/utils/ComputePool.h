@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Worker threads for CPU-bound work such as reports, kept apart from
+// Drogon's I/O loops so a long computation does not stall other requests.
+// One worker per hardware thread.
+//
+// parallelFor() may be called from a worker: the caller claims indices like
+// any helper, so nested use cannot deadlock on a pool that is all busy.
+class ComputePool
+{
+public:
+    static ComputePool &getInstance()
+    {
+        static ComputePool instance;
+        return instance;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // Runs `task` on a worker. Exceptions it throws are dropped, so tasks
+    // report their own failures.
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+    }
+
+    // Calls fn(i) for every i in [0, count), spread over the caller and idle
+    // workers, and returns once all calls have. The first exception thrown
+    // is rethrown here after the rest have finished.
+    template <typename Fn>
+    void parallelFor(size_t count, Fn &&fn)
+    {
+        if (count <= 1 || workers_.empty())
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                fn(i);
+            }
+            return;
+        }
+
+        auto batch = std::make_shared<Batch>();
+        batch->count = count;
+        batch->fn = [&fn](size_t i) { fn(i); };
+
+        size_t helpers = std::min(count - 1, workers_.size());
+        for (size_t h = 0; h < helpers; ++h)
+        {
+            submit([batch] { batch->drain(); });
+        }
+        batch->drain();
+
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&batch] { return batch->done == batch->count; });
+        if (batch->error)
+        {
+            std::rethrow_exception(batch->error);
+        }
+    }
+
+    // How many parts to split `items` into: enough to keep every worker
+    // busy, but none smaller than `minItems`.
+    size_t partitions(size_t items, size_t minItems) const
+    {
+        size_t most = std::max<size_t>(1, items / std::max<size_t>(1, minItems));
+        return std::min(most, std::max<size_t>(1, workers_.size()) * 4);
+    }
+
+private:
+    // One parallelFor() call. Helpers that start after every index was
+    // claimed return without touching fn, which may be gone by then.
+    struct Batch
+    {
+        std::atomic<size_t> next{0};
+        size_t count = 0;
+        std::function<void(size_t)> fn;
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t done = 0;
+        std::exception_ptr error;
+
+        void drain()
+        {
+            size_t ran = 0;
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            {
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                ++ran;
+            }
+            if (ran > 0)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                done += ran;
+                if (done == count)
+                    finished.notify_all();
+            }
+        }
+    };
+
+    ComputePool()
+    {
+        size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ComputePool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    ComputePool(const ComputePool &) = delete;
+    ComputePool &operator=(const ComputePool &) = delete;
+
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty())
+                {
+                    return;
+                }
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::function<void()>> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "student_attendance/utils/CsvScanner.h"
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Incremental RFC 4180 reader: feed the input in pieces of any size and it
+// reports each complete record, so a file never has to be held as a whole.
+// Quoted fields may contain separators, doubled quotes and line breaks.
+// CRLF and LF line endings are accepted, a leading UTF-8 BOM is skipped
+// and blank lines produce no record.
+//
+// Runs between special bytes are found with CsvScanner and copied into one
+// record buffer; fields are handed out as views into it, so parsing does no
+// allocation per field once the buffers have grown to the longest record.
+class CsvReader
+{
+public:
+    explicit CsvReader(CsvScanner::Level level = CsvScanner::bestLevel()) : level_(level) {}
+
+    // onRecord(int64_t line, const std::vector<std::string_view> &fields),
+    // where line is the 1-based line the record starts on. The views are
+    // valid until onRecord returns.
+    template <typename OnRecord>
+    void feed(std::string_view chunk, OnRecord &&onRecord)
+    {
+        size_t i = 0;
+        // A leading byte order mark may itself arrive split across chunks
+        while (bomMatched_ < 3 && i < chunk.size())
+        {
+            if (chunk[i] != kBom[bomMatched_])
+            {
+                bomMatched_ = 3;
+                break;
+            }
+            ++bomMatched_;
+            ++i;
+        }
+
+        CsvScanner scanner(chunk, level_);
+        while (i < chunk.size())
+        {
+            if (inQuotes_)
+            {
+                if (quotePending_)
+                {
+                    quotePending_ = false;
+                    if (chunk[i] == '"')
+                    {
+                        record_ += '"';
+                        ++i;
+                        continue;
+                    }
+                    inQuotes_ = false;
+                    continue;
+                }
+
+                auto quote = chunk.find('"', i);
+                auto end = quote == std::string_view::npos ? chunk.size() : quote;
+                for (size_t j = i; j < end; ++j)
+                {
+                    line_ += chunk[j] == '\n';
+                }
+                record_.append(chunk.data() + i, end - i);
+                if (quote == std::string_view::npos)
+                {
+                    break;
+                }
+                quotePending_ = true;
+                i = quote + 1;
+                continue;
+            }
+
+            auto stop = scanner.next(i);
+            record_.append(chunk.data() + i, stop - i);
+            if (stop == chunk.size())
+            {
+                break;
+            }
+            i = stop + 1;
+
+            switch (chunk[stop])
+            {
+            case '"':
+                if (record_.size() == fieldStart() && !fieldQuoted_)
+                {
+                    inQuotes_ = true;
+                    fieldQuoted_ = true;
+                }
+                else
+                {
+                    record_ += '"';
+                }
+                break;
+            case ',':
+                endField();
+                break;
+            case '\n':
+                endRecord(onRecord);
+                ++line_;
+                recordLine_ = line_;
+                break;
+            default:  // '\r'
+                break;
+            }
+        }
+    }
+
+    // Reports the last record when the input does not end with a newline.
+    template <typename OnRecord>
+    void finish(OnRecord &&onRecord)
+    {
+        inQuotes_ = false;
+        quotePending_ = false;
+        endRecord(onRecord);
+    }
+
+    // Whether the input ended inside a quoted field; meaningful before finish().
+    bool inQuotedField() const { return inQuotes_ && !quotePending_; }
+
+private:
+    static constexpr char kBom[] = "\xEF\xBB\xBF";
+
+    size_t fieldStart() const { return fieldEnds_.empty() ? 0 : fieldEnds_.back(); }
+
+    void endField()
+    {
+        fieldEnds_.push_back(record_.size());
+        fieldQuoted_ = false;
+    }
+
+    template <typename OnRecord>
+    void endRecord(OnRecord &onRecord)
+    {
+        bool blank = fieldEnds_.empty() && record_.empty() && !fieldQuoted_;
+        if (!blank)
+        {
+            endField();
+            fields_.clear();
+            size_t start = 0;
+            for (size_t end : fieldEnds_)
+            {
+                fields_.emplace_back(record_.data() + start, end - start);
+                start = end;
+            }
+            onRecord(recordLine_, fields_);
+        }
+        record_.clear();
+        fieldEnds_.clear();
+        fieldQuoted_ = false;
+    }
+
+    CsvScanner::Level level_;
+    // Text of the record so far and where each completed field ends in it
+    std::string record_;
+    std::vector<size_t> fieldEnds_;
+    std::vector<std::string_view> fields_;
+    int bomMatched_ = 0;
+    bool inQuotes_ = false;
+    bool quotePending_ = false;
+    bool fieldQuoted_ = false;
+    int64_t line_ = 1;
+    int64_t recordLine_ = 1;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
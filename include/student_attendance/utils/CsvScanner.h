@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define STUDENT_ATTENDANCE_CSV_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Finds the bytes a CSV parser has to stop at: separator, quote, CR and LF.
+//
+// The text is classified 64 bytes at a time into a bitmask of those bytes,
+// and successive next() calls walk the set bits, so the short fields of a
+// typical import cost a bit scan each rather than a byte loop. SSE2 (part
+// of every x86-64 CPU) and AVX2 kernels are picked at runtime; other
+// targets, and the last partial block, use a plain byte loop.
+class CsvScanner
+{
+public:
+    enum class Level
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // Fastest kernel this CPU supports, detected once per process.
+    static Level bestLevel()
+    {
+        static const Level level = detectLevel();
+        return level;
+    }
+
+    static const char *levelName(Level level)
+    {
+        switch (level)
+        {
+        case Level::Avx2:
+            return "avx2";
+        case Level::Sse2:
+            return "sse2";
+        default:
+            return "scalar";
+        }
+    }
+
+    // A level above bestLevel() is lowered to it.
+    explicit CsvScanner(std::string_view text, Level level = bestLevel())
+        : text_(text), mask_(kernel(std::min(level, bestLevel())))
+    {
+    }
+
+    // Position of the next special byte at or after `from`, or the size of
+    // the text when there is none.
+    size_t next(size_t from)
+    {
+        while (true)
+        {
+            size_t block = from & ~static_cast<size_t>(63);
+            if (block + 64 > text_.size())
+            {
+                break;
+            }
+            if (block != block_)
+            {
+                block_ = block;
+                bits_ = mask_(text_.data() + block);
+            }
+            uint64_t bits = bits_ & (~uint64_t(0) << (from - block));
+            if (bits != 0)
+            {
+                return block + static_cast<size_t>(std::countr_zero(bits));
+            }
+            from = block + 64;
+        }
+
+        for (; from < text_.size(); ++from)
+        {
+            if (isSpecial(text_[from]))
+                return from;
+        }
+        return text_.size();
+    }
+
+    static bool isSpecial(char c)
+    {
+        return c == ',' || c == '"' || c == '\r' || c == '\n';
+    }
+
+private:
+    // Bit i set when byte i of the 64 at p is special.
+    using MaskFn = uint64_t (*)(const char *p);
+
+    static uint64_t maskScalar(const char *p)
+    {
+        uint64_t mask = 0;
+        for (int i = 0; i < 64; ++i)
+        {
+            mask |= static_cast<uint64_t>(isSpecial(p[i])) << i;
+        }
+        return mask;
+    }
+
+#ifdef STUDENT_ATTENDANCE_CSV_SIMD
+    static uint64_t maskSse2(const char *p)
+    {
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i lf = _mm_set1_epi8('\n');
+        uint64_t mask = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16 * i));
+            __m128i hit = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, quote)),
+                _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+            mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(hit)))
+                    << (16 * i);
+        }
+        return mask;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((target("avx2")))
+#endif
+    static uint64_t maskAvx2(const char *p)
+    {
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        const __m256i lf = _mm256_set1_epi8('\n');
+        uint64_t mask = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32 * i));
+            __m256i hit = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, quote)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, lf)));
+            mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hit)))
+                    << (32 * i);
+        }
+        return mask;
+    }
+
+    static bool cpuHasAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        // AVX and OS support for saving the YMM registers
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+            return false;
+        if ((_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    static Level detectLevel()
+    {
+#ifdef STUDENT_ATTENDANCE_CSV_SIMD
+        return cpuHasAvx2() ? Level::Avx2 : Level::Sse2;
+#else
+        return Level::Scalar;
+#endif
+    }
+
+    static MaskFn kernel(Level level)
+    {
+#ifdef STUDENT_ATTENDANCE_CSV_SIMD
+        if (level == Level::Avx2)
+            return &maskAvx2;
+        if (level == Level::Sse2)
+            return &maskSse2;
+#endif
+        (void)level;
+        return &maskScalar;
+    }
+
+    std::string_view text_;
+    MaskFn mask_;
+    size_t block_ = ~static_cast<size_t>(0);
+    uint64_t bits_ = 0;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
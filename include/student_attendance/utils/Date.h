@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Calendar day stored as a signed count of days since 1970-01-01, the value
+// persisted in the `attendances.date` column. Ordering and range checks are
+// integer compares. A default-constructed Date is invalid and sorts first.
+class Date
+{
+public:
+    constexpr Date() = default;
+
+    static constexpr Date fromOrdinal(int32_t days)
+    {
+        Date date;
+        date.days_ = days;
+        return date;
+    }
+
+    // Returns an invalid Date when the fields do not name a real day.
+    static constexpr Date fromYmd(int year, unsigned month, unsigned day)
+    {
+        std::chrono::year_month_day ymd{std::chrono::year{year},
+                                        std::chrono::month{month},
+                                        std::chrono::day{day}};
+        if (!ymd.ok())
+        {
+            return Date();
+        }
+        return fromOrdinal(static_cast<int32_t>(
+            std::chrono::sys_days{ymd}.time_since_epoch().count()));
+    }
+
+    // Parses `YYYY-MM-DD`, or the legacy `MM-DD` form resolved against
+    // defaultYear(). Anything else is rejected.
+    static std::optional<Date> parse(std::string_view text)
+    {
+        int year = 0;
+        if (text.size() == 10 && text[4] == '-')
+        {
+            if (!parseDigits(text.substr(0, 4), year))
+                return std::nullopt;
+            text.remove_prefix(5);
+        }
+        else if (text.size() == 5)
+        {
+            year = defaultYear();
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        int month = 0;
+        int day = 0;
+        if (text[2] != '-' || !parseDigits(text.substr(0, 2), month) ||
+            !parseDigits(text.substr(3, 2), day))
+        {
+            return std::nullopt;
+        }
+
+        Date date = fromYmd(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+        if (!date.valid())
+            return std::nullopt;
+        return date;
+    }
+
+    // Year assumed for `MM-DD` input: the current UTC year.
+    static int defaultYear()
+    {
+        auto today = std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now());
+        return static_cast<int>(std::chrono::year_month_day{today}.year());
+    }
+
+    constexpr bool valid() const { return days_ != kInvalid; }
+    constexpr int32_t ordinal() const { return days_; }
+
+    constexpr std::chrono::year_month_day ymd() const
+    {
+        return std::chrono::year_month_day{
+            std::chrono::sys_days{std::chrono::days{days_}}};
+    }
+
+    // `YYYY-MM-DD`, or an empty string for an invalid Date.
+    std::string toString() const
+    {
+        if (!valid())
+        {
+            return std::string();
+        }
+        auto date = ymd();
+        char buffer[16];
+        auto length = std::snprintf(buffer, sizeof(buffer), "%04d-%02u-%02u",
+                                    static_cast<int>(date.year()),
+                                    static_cast<unsigned>(date.month()),
+                                    static_cast<unsigned>(date.day()));
+        return std::string(buffer, static_cast<size_t>(length));
+    }
+
+    friend constexpr bool operator==(Date, Date) = default;
+    friend constexpr auto operator<=>(Date, Date) = default;
+
+private:
+    static constexpr int32_t kInvalid = std::numeric_limits<int32_t>::min();
+
+    static constexpr bool parseDigits(std::string_view text, int &value)
+    {
+        value = 0;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    }
+
+    int32_t days_ = kInvalid;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Incremental splitter for a top-level JSON array: feed the document in
+// pieces and it reports the raw text of each element as soon as the
+// element is complete, so only one element is buffered at a time. The
+// elements themselves are not validated; parse them individually.
+class JsonArrayReader
+{
+public:
+    // onElement(int64_t index, std::string_view text), index being 1-based.
+    // Returns false once the document is known not to be an array.
+    template <typename OnElement>
+    bool feed(std::string_view chunk, OnElement &&onElement)
+    {
+        for (char c : chunk)
+        {
+            switch (state_)
+            {
+            case State::Start:
+                if (c == '[')
+                    state_ = State::Between;
+                else if (!isSpace(c) && !isBom(c))
+                    state_ = State::Invalid;
+                break;
+
+            case State::Between:
+                if (c == ']')
+                {
+                    state_ = State::Done;
+                }
+                else if (c == ',')
+                {
+                    // empty element, e.g. `[1,,2]`
+                    ++index_;
+                    onElement(index_, std::string_view());
+                }
+                else if (!isSpace(c))
+                {
+                    state_ = State::Element;
+                    element_.clear();
+                    appendElementChar(c, onElement);
+                }
+                break;
+
+            case State::Element:
+                appendElementChar(c, onElement);
+                break;
+
+            case State::Done:
+            case State::Invalid:
+                break;
+            }
+            if (state_ == State::Invalid)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // True once the opening bracket has been seen.
+    bool opened() const { return state_ != State::Start && state_ != State::Invalid; }
+    // True when the closing bracket has been seen.
+    bool complete() const { return state_ == State::Done; }
+    // Elements reported so far.
+    int64_t count() const { return index_; }
+
+private:
+    enum class State
+    {
+        Start,
+        Between,
+        Element,
+        Done,
+        Invalid
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    // Bytes of a UTF-8 byte order mark
+    static bool isBom(char c)
+    {
+        auto byte = static_cast<unsigned char>(c);
+        return byte == 0xEF || byte == 0xBB || byte == 0xBF;
+    }
+
+    template <typename OnElement>
+    void appendElementChar(char c, OnElement &onElement)
+    {
+        if (inString_)
+        {
+            element_ += c;
+            if (escaped_)
+                escaped_ = false;
+            else if (c == '\\')
+                escaped_ = true;
+            else if (c == '"')
+                inString_ = false;
+            return;
+        }
+
+        if (depth_ == 0 && (c == ',' || c == ']'))
+        {
+            ++index_;
+            onElement(index_, std::string_view(element_));
+            element_.clear();
+            state_ = c == ']' ? State::Done : State::Between;
+            return;
+        }
+
+        element_ += c;
+        if (c == '"')
+            inString_ = true;
+        else if (c == '{' || c == '[')
+            ++depth_;
+        else if ((c == '}' || c == ']') && depth_ > 0)
+            --depth_;
+    }
+
+    State state_ = State::Start;
+    std::string element_;
+    int depth_ = 0;
+    bool inString_ = false;
+    bool escaped_ = false;
+    int64_t index_ = 0;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
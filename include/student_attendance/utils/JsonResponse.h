@@ -2,7 +2,9 @@
 
 #include <drogon/HttpResponse.h>
 #include <json/json.h>
+#include <concepts>
 #include <string>
+#include "student_attendance/utils/JsonWriter.h"
 
 namespace student_attendance
 {
@@ -36,6 +38,24 @@ public:
         return resp;
     }
 
+    // Writer variants: writeData(JsonWriter &) writes the `data` value
+    // straight into the response body, with no Json::Value tree in between.
+    template <typename WriteData>
+        requires std::invocable<WriteData &, JsonWriter &>
+    static drogon::HttpResponsePtr success(WriteData &&writeData,
+                                           const std::string &message = "success")
+    {
+        return writtenResponse(200, drogon::k200OK, message, writeData);
+    }
+
+    template <typename WriteData>
+        requires std::invocable<WriteData &, JsonWriter &>
+    static drogon::HttpResponsePtr created(WriteData &&writeData,
+                                           const std::string &message = "创建成功")
+    {
+        return writtenResponse(201, drogon::k201Created, message, writeData);
+    }
+
     static drogon::HttpResponsePtr noContent()
     {
         auto resp = drogon::HttpResponse::newHttpResponse();
@@ -98,17 +118,47 @@ public:
         return resp;
     }
 
+    // A negative total was not counted and is left out. `next_cursor` is
+    // null on the last page.
     static Json::Value paginatedData(int total, int page, int pageSize,
-                                     const Json::Value &items)
+                                     const Json::Value &items,
+                                     const std::string &nextCursor = "")
     {
         Json::Value data;
-        data["total"] = total;
+        if (total >= 0)
+        {
+            data["total"] = total;
+        }
         data["page"] = page;
         data["page_size"] = pageSize;
         data["items"] = items;
+        data["next_cursor"] = nextCursor.empty() ? Json::Value() : Json::Value(nextCursor);
         return data;
     }
 
+    // paginatedData() for the writer variants; writeItems(JsonWriter &)
+    // writes the elements of the `items` array.
+    template <typename WriteItems>
+    static void writePage(JsonWriter &json, int total, int page, int pageSize,
+                          WriteItems &&writeItems, const std::string &nextCursor = "")
+    {
+        json.beginObject();
+        if (total >= 0)
+        {
+            json.member("total", total);
+        }
+        json.member("page", page).member("page_size", pageSize);
+        json.key("items").beginArray();
+        writeItems(json);
+        json.endArray();
+        json.key("next_cursor");
+        if (nextCursor.empty())
+            json.null();
+        else
+            json.value(nextCursor);
+        json.endObject();
+    }
+
     static Json::Value periodData(const std::string &startDate,
                                   const std::string &endDate)
     {
@@ -117,6 +167,34 @@ public:
         period["end_date"] = endDate;
         return period;
     }
+
+private:
+    // Larger buffers are released after use rather than kept per thread
+    static constexpr size_t kRetainedBufferSize = 1 << 20;
+
+    template <typename WriteData>
+    static drogon::HttpResponsePtr writtenResponse(int code, drogon::HttpStatusCode status,
+                                                   const std::string &message,
+                                                   WriteData &writeData)
+    {
+        // Reused across responses, so steady-state traffic does not regrow it
+        thread_local std::string buffer;
+        buffer.clear();
+        JsonWriter json(buffer);
+        json.beginObject().member("code", code).member("message", message).key("data");
+        writeData(json);
+        json.endObject();
+
+        auto resp = drogon::HttpResponse::newHttpResponse();
+        resp->setStatusCode(status);
+        resp->setContentTypeCode(drogon::CT_APPLICATION_JSON);
+        resp->setBody(buffer);
+        if (buffer.capacity() > kRetainedBufferSize)
+        {
+            std::string().swap(buffer);
+        }
+        return resp;
+    }
 };
 
 }  // namespace utils
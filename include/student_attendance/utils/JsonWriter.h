@@ -0,0 +1,208 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Appends compact JSON text straight to a string, for responses too hot to
+// build as a Json::Value tree first. Separators are placed automatically;
+// the caller is responsible for balancing begin/end calls and for giving
+// every object member a key.
+//
+//     JsonWriter json(out);
+//     json.beginObject();
+//     json.member("code", 200).member("message", "success");
+//     json.key("items").beginArray().value(1).value(2).endArray();
+//     json.endObject();
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string &out) : out_(out) {}
+
+    JsonWriter &beginObject()
+    {
+        separate();
+        out_ += '{';
+        comma_ = false;
+        return *this;
+    }
+
+    JsonWriter &endObject()
+    {
+        out_ += '}';
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter &beginArray()
+    {
+        separate();
+        out_ += '[';
+        comma_ = false;
+        return *this;
+    }
+
+    JsonWriter &endArray()
+    {
+        out_ += ']';
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter &key(std::string_view name)
+    {
+        separate();
+        appendString(name);
+        out_ += ':';
+        comma_ = false;
+        return *this;
+    }
+
+    JsonWriter &value(std::string_view text)
+    {
+        separate();
+        appendString(text);
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+    JsonWriter &value(const std::string &text) { return value(std::string_view(text)); }
+
+    JsonWriter &value(bool flag)
+    {
+        separate();
+        out_ += flag ? "true" : "false";
+        comma_ = true;
+        return *this;
+    }
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    JsonWriter &value(T number)
+    {
+        separate();
+        char buffer[24];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), number).ptr;
+        out_.append(buffer, end);
+        comma_ = true;
+        return *this;
+    }
+
+    // Shortest text that reads back as the same double; null when not finite,
+    // which JSON cannot represent.
+    JsonWriter &value(double number)
+    {
+        if (!std::isfinite(number))
+        {
+            return null();
+        }
+        separate();
+        char buffer[32];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), number).ptr;
+        out_.append(buffer, end);
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter &null()
+    {
+        separate();
+        out_ += "null";
+        comma_ = true;
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter &member(std::string_view name, const T &v)
+    {
+        key(name);
+        return value(v);
+    }
+
+    // Appends text that is already valid JSON, e.g. a cached fragment.
+    JsonWriter &raw(std::string_view json)
+    {
+        separate();
+        out_ += json;
+        comma_ = true;
+        return *this;
+    }
+
+    std::string &buffer() { return out_; }
+
+private:
+    void separate()
+    {
+        if (comma_)
+        {
+            out_ += ',';
+        }
+    }
+
+    // Escapes quotes, backslashes and control characters; other bytes,
+    // UTF-8 included, are copied as they are. Runs without anything to
+    // escape are appended in one go.
+    void appendString(std::string_view text)
+    {
+        static constexpr char kHex[] = "0123456789abcdef";
+        out_ += '"';
+        size_t run = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+            out_.append(text.data() + run, i - run);
+            run = i + 1;
+            switch (c)
+            {
+            case '"':
+                out_ += "\\\"";
+                break;
+            case '\\':
+                out_ += "\\\\";
+                break;
+            case '\n':
+                out_ += "\\n";
+                break;
+            case '\r':
+                out_ += "\\r";
+                break;
+            case '\t':
+                out_ += "\\t";
+                break;
+            case '\b':
+                out_ += "\\b";
+                break;
+            case '\f':
+                out_ += "\\f";
+                break;
+            default:
+                out_ += "\\u00";
+                out_ += kHex[c >> 4];
+                out_ += kHex[c & 0xF];
+                break;
+            }
+        }
+        out_.append(text.data() + run, text.size() - run);
+        out_ += '"';
+    }
+
+    std::string &out_;
+    // Whether the next value or key needs a comma before it
+    bool comma_ = false;
+};
+
+}  // namespace utils
+}  // namespace student_attendance
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// Position in a keyset-paginated listing: the ordering a page was produced
+// under plus the sort key and unique id of its last row. The next page seeks
+// past (key, id) instead of skipping rows with OFFSET, so every page costs
+// the same regardless of depth.
+//
+// Clients see it as an opaque base64url token; the meaning of sortColumn,
+// key and id belongs to the service that issued it.
+struct PageCursor
+{
+    uint8_t sortColumn = 0;
+    bool descending = false;
+    std::string key;
+    std::string id;
+
+    std::string encode() const
+    {
+        // version, column, direction, key length, key, id
+        std::string payload = "1";
+        payload += static_cast<char>('0' + sortColumn);
+        payload += descending ? 'd' : 'a';
+        payload += std::to_string(key.size());
+        payload += ':';
+        payload += key;
+        payload += id;
+        return base64UrlEncode(payload);
+    }
+
+    // Rejects anything encode() could not have produced.
+    static std::optional<PageCursor> decode(std::string_view text)
+    {
+        auto payload = base64UrlDecode(text);
+        if (!payload || payload->size() < 5 || (*payload)[0] != '1')
+        {
+            return std::nullopt;
+        }
+
+        PageCursor cursor;
+        char column = (*payload)[1];
+        char direction = (*payload)[2];
+        if (column < '0' || column > '9' || (direction != 'a' && direction != 'd'))
+        {
+            return std::nullopt;
+        }
+        cursor.sortColumn = static_cast<uint8_t>(column - '0');
+        cursor.descending = direction == 'd';
+
+        std::string_view rest(*payload);
+        rest.remove_prefix(3);
+        size_t keyLength = 0;
+        size_t digits = 0;
+        while (digits < rest.size() && rest[digits] >= '0' && rest[digits] <= '9')
+        {
+            keyLength = keyLength * 10 + static_cast<size_t>(rest[digits] - '0');
+            if (keyLength > rest.size())
+                return std::nullopt;
+            ++digits;
+        }
+        if (digits == 0 || digits >= rest.size() || rest[digits] != ':')
+        {
+            return std::nullopt;
+        }
+        rest.remove_prefix(digits + 1);
+        if (keyLength > rest.size() || keyLength == rest.size())
+        {
+            return std::nullopt;
+        }
+        cursor.key = std::string(rest.substr(0, keyLength));
+        cursor.id = std::string(rest.substr(keyLength));
+        return cursor;
+    }
+
+private:
+    static constexpr char kAlphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    static std::string base64UrlEncode(std::string_view data)
+    {
+        std::string out;
+        out.reserve((data.size() + 2) / 3 * 4);
+        size_t i = 0;
+        for (; i + 2 < data.size(); i += 3)
+        {
+            uint32_t n = (static_cast<uint8_t>(data[i]) << 16) |
+                         (static_cast<uint8_t>(data[i + 1]) << 8) |
+                         static_cast<uint8_t>(data[i + 2]);
+            out += kAlphabet[(n >> 18) & 63];
+            out += kAlphabet[(n >> 12) & 63];
+            out += kAlphabet[(n >> 6) & 63];
+            out += kAlphabet[n & 63];
+        }
+        if (i < data.size())
+        {
+            uint32_t n = static_cast<uint8_t>(data[i]) << 16;
+            if (i + 1 < data.size())
+                n |= static_cast<uint8_t>(data[i + 1]) << 8;
+            out += kAlphabet[(n >> 18) & 63];
+            out += kAlphabet[(n >> 12) & 63];
+            if (i + 1 < data.size())
+                out += kAlphabet[(n >> 6) & 63];
+        }
+        return out;
+    }
+
+    static std::optional<std::string> base64UrlDecode(std::string_view text)
+    {
+        if (text.size() % 4 == 1)
+        {
+            return std::nullopt;
+        }
+
+        std::string out;
+        out.reserve(text.size() * 3 / 4);
+        uint32_t buffer = 0;
+        int bits = 0;
+        for (char c : text)
+        {
+            int value;
+            if (c >= 'A' && c <= 'Z')
+                value = c - 'A';
+            else if (c >= 'a' && c <= 'z')
+                value = c - 'a' + 26;
+            else if (c >= '0' && c <= '9')
+                value = c - '0' + 52;
+            else if (c == '-')
+                value = 62;
+            else if (c == '_')
+                value = 63;
+            else
+                return std::nullopt;
+
+            buffer = (buffer << 6) | static_cast<uint32_t>(value);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                out += static_cast<char>((buffer >> bits) & 0xFF);
+            }
+        }
+        return out;
+    }
+};
+
+}  // namespace utils
+}  // namespace student_attendance
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace student_attendance
+{
+namespace utils
+{
+
+// A file written through the platform's descriptor API (POSIX, or the
+// Windows CRT), for logs and snapshots that have to reach the disk. Failed
+// calls return false and leave the reason in error().
+class PlatformFile
+{
+public:
+    enum class Mode
+    {
+        // Created when missing; every write goes to the end
+        Append,
+        // Created when missing, emptied when not
+        Truncate
+    };
+
+    PlatformFile() = default;
+    PlatformFile(const PlatformFile &) = delete;
+    PlatformFile &operator=(const PlatformFile &) = delete;
+    PlatformFile(PlatformFile &&other) noexcept;
+    PlatformFile &operator=(PlatformFile &&other) noexcept;
+    ~PlatformFile() { close(); }
+
+    bool open(const std::filesystem::path &path, Mode mode);
+    bool isOpen() const { return fd_ >= 0; }
+    void close();
+
+    // Writes all of `data`. On failure `written` tells how much went out.
+    bool writeAll(std::string_view data, size_t *written = nullptr);
+    // Makes what was written survive a power loss: fdatasync on Linux,
+    // F_FULLFSYNC on Apple (fsync where the file system lacks it), _commit
+    // on Windows.
+    bool sync();
+    // Cuts the file back to `size` bytes
+    bool truncate(uint64_t size);
+
+    const std::string &error() const { return error_; }
+
+private:
+    bool failed(const char *what);
+
+    int fd_ = -1;
+    std::string path_;
+    std::string error_;
+};
+
+// A read-only mapping of a whole file (mmap, or a file mapping on Windows).
+// Pages are read in on first touch.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { unmap(); }
+
+    // False, with the reason in error(), when the file cannot be opened or
+    // mapped
+    bool map(const std::filesystem::path &path);
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+    const std::string &error() const { return error_; }
+
+private:
+    void unmap();
+    bool failed(const char *what, const std::filesystem::path &path);
+
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    std::string error_;
+};
+
+// Makes a created, renamed or removed entry of `dir` durable. Windows has no
+// way to sync a directory, and NTFS journals the change itself, so there it
+// does nothing.
+void syncDirectory(const std::filesystem::path &dir);
+
+}  // namespace utils
+}  // namespace student_attendance
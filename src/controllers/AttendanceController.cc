@@ -1,19 +1,22 @@
 #include "student_attendance/controllers/AttendanceController.h"
 #include "student_attendance/services/AttendanceService.h"
 #include "student_attendance/utils/JsonResponse.h"
+#include "student_attendance/utils/PageCursor.h"
+#include "student_attendance/utils/Date.h"
 
 using namespace drogon;
 using namespace student_attendance::services;
 using namespace student_attendance::utils;
+using student_attendance::utils::Date;
 
 namespace api
 {
 namespace v1
 {
 
-void AttendanceController::getAttendances(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> AttendanceController::getAttendances(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
     int page = 1;
     int pageSize = 20;
@@ -57,30 +60,52 @@ void AttendanceController::getAttendances(
         order = orderParam;
     }
 
-    auto result = AttendanceService::getInstance().getAttendances(
-        page, pageSize, studentId, name, className, date,
-        startDate, endDate, status, sortBy, order);
-
-    Json::Value items(Json::arrayValue);
-    for (const auto &att : result.attendances)
+    // Keyset paging: a cursor replaces `page`, and the total is only counted
+    // on request since it costs a scan of the whole listing
+    std::optional<PageCursor> cursor;
+    auto cursorParam = req->getParameter("cursor");
+    if (!cursorParam.empty())
     {
-        items.append(att.toJson());
+        cursor = PageCursor::decode(cursorParam);
+        if (!cursor)
+        {
+            callback(JsonResponse::badRequest("无效的分页游标"));
+            co_return;
+        }
+    }
+    bool withTotal = !cursor;
+    auto withTotalParam = req->getParameter("with_total");
+    if (!withTotalParam.empty())
+    {
+        withTotal = (withTotalParam == "true" || withTotalParam == "1");
     }
 
-    auto data = JsonResponse::paginatedData(result.total, result.page,
-                                            result.pageSize, items);
-    callback(JsonResponse::success(data));
+    auto result = co_await AttendanceService::getInstance().getAttendancesCoro(
+        page, pageSize, studentId, name, className, date,
+        startDate, endDate, status, sortBy, order, cursor, withTotal);
+
+    callback(JsonResponse::success([&result](JsonWriter &json) {
+        JsonResponse::writePage(
+            json, result.total, result.page, result.pageSize,
+            [&result](JsonWriter &items) {
+                for (const auto &att : result.attendances)
+                {
+                    att.writeJson(items);
+                }
+            },
+            result.nextCursor);
+    }));
 }
 
-void AttendanceController::createAttendance(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> AttendanceController::createAttendance(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     std::string studentId = (*json)["student_id"].asString();
@@ -95,10 +120,10 @@ void AttendanceController::createAttendance(
     if (studentId.empty() || date.empty() || status.empty())
     {
         callback(JsonResponse::badRequest("缺少必填字段"));
-        return;
+        co_return;
     }
 
-    auto [success, att] = AttendanceService::getInstance().createAttendance(
+    auto [success, att] = co_await AttendanceService::getInstance().createAttendanceCoro(
         studentId, date, status, remark);
 
     if (success)
@@ -107,58 +132,83 @@ void AttendanceController::createAttendance(
     }
     else
     {
-        callback(JsonResponse::badRequest("创建失败，请检查学号是否存在或状态是否有效"));
+        callback(JsonResponse::badRequest("创建失败，请检查学号是否存在、日期和状态是否有效"));
     }
 }
 
-void AttendanceController::batchCreateAttendances(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> AttendanceController::batchCreateAttendances(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     std::string date = (*json)["date"].asString();
     if (date.empty())
     {
         callback(JsonResponse::badRequest("日期不能为空"));
-        return;
+        co_return;
+    }
+    if (!Date::parse(date))
+    {
+        callback(JsonResponse::badRequest("日期格式错误，应为YYYY-MM-DD或MM-DD"));
+        co_return;
     }
 
     if (!json->isMember("records") || !(*json)["records"].isArray())
     {
         callback(JsonResponse::badRequest("records字段必须是数组"));
-        return;
+        co_return;
     }
 
-    std::vector<std::pair<std::string, std::string>> records;
-    for (const auto &record : (*json)["records"])
+    const auto &items = (*json)["records"];
+    std::vector<AttendanceService::BatchRecord> records;
+    records.reserve(items.size());
+    for (const auto &record : items)
     {
-        std::string studentId = record["student_id"].asString();
-        std::string status = record["status"].asString();
-        if (!studentId.empty() && !status.empty())
+        records.push_back({record["student_id"].asString(),
+                           record["status"].asString(),
+                           record["remark"].asString()});
+    }
+
+    auto batch = co_await AttendanceService::getInstance().batchCreateAttendancesCoro(
+        date, records);
+
+    Json::Value results(Json::arrayValue);
+    for (size_t i = 0; i < batch.rows.size(); ++i)
+    {
+        const auto &row = batch.rows[i];
+        Json::Value item;
+        item["index"] = static_cast<Json::UInt>(i);
+        item["student_id"] = records[i].studentId;
+        item["success"] = row.created;
+        if (row.created)
         {
-            records.emplace_back(studentId, status);
+            item["id"] = row.id;
         }
+        else
+        {
+            item["error"] = row.error;
+        }
+        results.append(std::move(item));
     }
 
-    int count = AttendanceService::getInstance().batchCreateAttendances(date, records);
-
     Json::Value data;
-    data["created_count"] = count;
+    data["created_count"] = batch.createdCount;
+    data["results"] = std::move(results);
     callback(JsonResponse::created(data, "批量创建成功"));
 }
 
-void AttendanceController::getAttendance(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
+drogon::Task<> AttendanceController::getAttendance(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
     int id) const
 {
-    auto att = AttendanceService::getInstance().getAttendance(id);
+    auto att = co_await AttendanceService::getInstance().getAttendanceCoro(id);
 
     if (att)
     {
@@ -170,16 +220,16 @@ void AttendanceController::getAttendance(
     }
 }
 
-void AttendanceController::updateAttendance(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
+drogon::Task<> AttendanceController::updateAttendance(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
     int id) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     std::string status;
@@ -194,12 +244,12 @@ void AttendanceController::updateAttendance(
         remark = (*json)["remark"].asString();
     }
 
-    auto [success, message] = AttendanceService::getInstance().updateAttendance(
+    auto [success, message] = co_await AttendanceService::getInstance().updateAttendanceCoro(
         id, status, remark);
 
     if (success)
     {
-        auto att = AttendanceService::getInstance().getAttendance(id);
+        auto att = co_await AttendanceService::getInstance().getAttendanceCoro(id);
         if (att)
         {
             callback(JsonResponse::success(att->toJson(), message));
@@ -215,12 +265,12 @@ void AttendanceController::updateAttendance(
     }
 }
 
-void AttendanceController::deleteAttendance(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
+drogon::Task<> AttendanceController::deleteAttendance(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
     int id) const
 {
-    if (AttendanceService::getInstance().deleteAttendance(id))
+    if (co_await AttendanceService::getInstance().deleteAttendanceCoro(id))
     {
         callback(JsonResponse::noContent());
     }
@@ -11,37 +11,37 @@ namespace api
 namespace v1
 {
 
-void AuthController::login(
-    const drogon::HttpRequestPtr &req,
-    std::function<void(const drogon::HttpResponsePtr &)> &&callback) const
+drogon::Task<> AuthController::login(
+    drogon::HttpRequestPtr req,
+    std::function<void(const drogon::HttpResponsePtr &)> callback) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     if (!json->isMember("username") || !json->isMember("password"))
     {
         callback(JsonResponse::badRequest("缺少必要字段"));
-        return;
+        co_return;
     }
 
     auto username = (*json)["username"].asString();
     auto password = (*json)["password"].asString();
 
-    auto userOpt = AuthService::getInstance().authenticate(username, password);
+    auto userOpt = co_await AuthService::getInstance().authenticateCoro(username, password);
     if (!userOpt)
     {
         callback(JsonResponse::unauthorized("用户名或密码错误"));
-        return;
+        co_return;
     }
 
     if (!req->session())
     {
         callback(JsonResponse::serverError("Session未启用"));
-        return;
+        co_return;
     }
 
     req->session()->insert("user_id", userOpt->id);
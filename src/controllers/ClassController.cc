@@ -1,9 +1,9 @@
 #include "student_attendance/controllers/ClassController.h"
-#include "student_attendance/models/DataStore.h"
+#include "student_attendance/db/Storage.h"
 #include "student_attendance/utils/JsonResponse.h"
 
 using namespace drogon;
-using namespace student_attendance::models;
+using namespace student_attendance::db;
 using namespace student_attendance::utils;
 
 namespace api
@@ -11,63 +11,43 @@ namespace api
 namespace v1
 {
 
-void ClassController::getClasses(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> ClassController::getClasses(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
-    auto &dataStore = DataStore::getInstance();
-    auto classes = dataStore.getAllClasses();
-
+    auto classes = co_await Storage::current().classSizes();
     Json::Value data(Json::arrayValue);
-    for (const auto &className : classes)
+    for (const auto &cls : classes)
     {
         Json::Value classInfo;
-        classInfo["name"] = className;
-        classInfo["student_count"] = dataStore.getClassStudentCount(className);
+        classInfo["name"] = cls.name;
+        classInfo["student_count"] = cls.studentCount;
         data.append(classInfo);
     }
 
     callback(JsonResponse::success(data));
 }
 
-void ClassController::getClassStudents(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
-    const std::string &className) const
+drogon::Task<> ClassController::getClassStudents(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
+    std::string className) const
 {
-    auto &dataStore = DataStore::getInstance();
-
     // URL decode the class name (handle Chinese characters)
     std::string decodedClassName = className;
 
-    auto students = dataStore.getStudentsByClass(decodedClassName);
-
-    if (students.empty())
+    auto students = co_await Storage::current().classStudents(decodedClassName);
+    if (!students)
     {
-        // Check if class exists
-        auto allClasses = dataStore.getAllClasses();
-        bool classExists = false;
-        for (const auto &cls : allClasses)
-        {
-            if (cls == decodedClassName)
-            {
-                classExists = true;
-                break;
-            }
-        }
-
-        if (!classExists)
-        {
-            callback(JsonResponse::notFound("班级不存在"));
-            return;
-        }
+        callback(JsonResponse::notFound("班级不存在"));
+        co_return;
     }
 
     Json::Value data;
     data["class"] = decodedClassName;
 
     Json::Value studentArray(Json::arrayValue);
-    for (const auto &student : students)
+    for (const auto &student : *students)
     {
         studentArray.append(student.toBasicJson());
     }
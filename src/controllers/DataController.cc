@@ -1,12 +1,13 @@
 #include "student_attendance/controllers/DataController.h"
-#include "student_attendance/models/DataStore.h"
-#include "student_attendance/models/Student.h"
-#include "student_attendance/models/Attendance.h"
+#include "student_attendance/services/ExportService.h"
+#include "student_attendance/services/ImportService.h"
 #include "student_attendance/utils/JsonResponse.h"
-#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <optional>
 
 using namespace drogon;
-using namespace student_attendance::models;
+using namespace student_attendance::services;
 using namespace student_attendance::utils;
 
 namespace api
@@ -32,225 +33,183 @@ void DataController::exportData(
         format = "json";
     }
 
-    auto &dataStore = DataStore::getInstance();
-
+    ExportService::Format exportFormat;
     if (format == "json")
     {
-        Json::Value data;
-
-        if (type == "students" || type == "all")
-        {
-            Json::Value students(Json::arrayValue);
-            for (const auto &student : dataStore.getAllStudents())
-            {
-                students.append(student.toJson());
-            }
-            data["students"] = students;
-        }
-
-        if (type == "attendances" || type == "all")
-        {
-            Json::Value attendances(Json::arrayValue);
-            for (const auto &att : dataStore.getAllAttendances())
-            {
-                attendances.append(att.toJson());
-            }
-            data["attendances"] = attendances;
-        }
-
-        auto resp = HttpResponse::newHttpJsonResponse(data);
-        resp->addHeader("Content-Disposition",
-                       "attachment; filename=\"export.json\"");
-        callback(resp);
+        exportFormat = ExportService::Format::Json;
     }
     else if (format == "csv")
     {
-        std::ostringstream csv;
-
-        if (type == "students")
-        {
-            csv << "student_id,name,class\n";
-            for (const auto &student : dataStore.getAllStudents())
-            {
-                csv << student.studentId << ","
-                    << student.name << ","
-                    << student.className << "\n";
-            }
-        }
-        else if (type == "attendances")
-        {
-            csv << "id,student_id,name,class,date,status,remark\n";
-            for (const auto &att : dataStore.getAllAttendances())
-            {
-                csv << att.id << ","
-                    << att.studentId << ","
-                    << att.name << ","
-                    << att.className << ","
-                    << att.date << ","
-                    << att.status << ","
-                    << att.remark << "\n";
-            }
-        }
-        else
-        {
-            callback(JsonResponse::badRequest("CSV格式不支持导出all类型"));
-            return;
-        }
-
-        auto resp = HttpResponse::newHttpResponse();
-        resp->setBody(csv.str());
-        resp->setContentTypeCode(CT_TEXT_PLAIN);
-        resp->addHeader("Content-Disposition",
-                       "attachment; filename=\"export.csv\"");
-        callback(resp);
+        exportFormat = ExportService::Format::Csv;
     }
     else
     {
         callback(JsonResponse::badRequest("不支持的导出格式"));
+        return;
     }
+
+    if (type != "students" && type != "attendances" && type != "all")
+    {
+        callback(JsonResponse::badRequest("不支持的导出类型"));
+        return;
+    }
+
+    std::shared_ptr<ExportService::Stream> stream =
+        ExportService::getInstance().open(type, exportFormat);
+    if (!stream)
+    {
+        callback(JsonResponse::badRequest("CSV格式不支持导出all类型"));
+        return;
+    }
+
+    // Sent with chunked transfer encoding; the store is read one batch per
+    // refill instead of materializing the whole export first
+    bool json = exportFormat == ExportService::Format::Json;
+    auto resp = HttpResponse::newStreamResponse(
+        [stream](char *buffer, std::size_t size) -> std::size_t {
+            // A null buffer means the connection went away
+            return buffer ? stream->read(buffer, size) : 0;
+        },
+        "",
+        json ? CT_APPLICATION_JSON : CT_TEXT_PLAIN);
+    resp->addHeader("Content-Disposition",
+                   json ? "attachment; filename=\"export.json\""
+                        : "attachment; filename=\"export.csv\"");
+    callback(resp);
 }
 
-void DataController::importData(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+namespace
+{
+
+Json::Value importResultJson(const ImportService::Result &result)
+{
+    Json::Value data;
+    data["imported_count"] = result.importedCount;
+    data["skipped_count"] = result.skippedCount;
+    Json::Value errors(Json::arrayValue);
+    for (const auto &error : result.errors)
+    {
+        Json::Value item;
+        item["line"] = static_cast<Json::Int64>(error.line);
+        item["message"] = error.message;
+        errors.append(item);
+    }
+    data["errors"] = errors;
+    data["errors_truncated"] = result.errorsTruncated;
+    return data;
+}
+
+std::optional<ImportService::Type> importType(const std::string &type)
+{
+    if (type == "students")
+        return ImportService::Type::Students;
+    if (type == "attendances")
+        return ImportService::Type::Attendances;
+    return std::nullopt;
+}
+
+}  // namespace
+
+drogon::Task<> DataController::importData(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
-    auto &dataStore = DataStore::getInstance();
+    auto &importService = ImportService::getInstance();
 
     // Try to get JSON body first
     auto json = req->getJsonObject();
     if (json)
     {
-        std::string type;
-        if (json->isMember("type"))
+        std::optional<ImportService::Type> type;
+        if (json->isMember("type") && (*json)["type"].isString())
         {
-            type = (*json)["type"].asString();
+            type = importType((*json)["type"].asString());
         }
-
-        int importedCount = 0;
-        int skippedCount = 0;
-        Json::Value errors(Json::arrayValue);
-
-        if (type == "students" && json->isMember("data"))
-        {
-            const auto &data = (*json)["data"];
-            for (Json::ArrayIndex i = 0; i < data.size(); ++i)
-            {
-                try
-                {
-                    Student student = Student::fromJson(data[i]);
-                    if (dataStore.addStudent(student))
-                    {
-                        importedCount++;
-                    }
-                    else
-                    {
-                        skippedCount++;
-                        Json::Value error;
-                        error["line"] = static_cast<int>(i + 1);
-                        error["message"] = "学号已存在";
-                        errors.append(error);
-                    }
-                }
-                catch (...)
-                {
-                    skippedCount++;
-                    Json::Value error;
-                    error["line"] = static_cast<int>(i + 1);
-                    error["message"] = "数据格式错误";
-                    errors.append(error);
-                }
-            }
-        }
-        else if (type == "attendances" && json->isMember("data"))
-        {
-            const auto &data = (*json)["data"];
-            for (Json::ArrayIndex i = 0; i < data.size(); ++i)
-            {
-                try
-                {
-                    Attendance att = Attendance::fromJson(data[i]);
-                    // Get student info
-                    auto student = dataStore.getStudentById(att.studentId);
-                    if (student)
-                    {
-                        att.name = student->name;
-                        att.className = student->className;
-                        dataStore.addAttendance(att);
-                        importedCount++;
-                    }
-                    else
-                    {
-                        skippedCount++;
-                        Json::Value error;
-                        error["line"] = static_cast<int>(i + 1);
-                        error["message"] = "学生不存在";
-                        errors.append(error);
-                    }
-                }
-                catch (...)
-                {
-                    skippedCount++;
-                    Json::Value error;
-                    error["line"] = static_cast<int>(i + 1);
-                    error["message"] = "数据格式错误";
-                    errors.append(error);
-                }
-            }
-        }
-        else
+        if (!type || !json->isMember("data") || !(*json)["data"].isArray())
         {
             callback(JsonResponse::badRequest("无效的导入类型或数据"));
-            return;
+            co_return;
         }
 
-        Json::Value result;
-        result["imported_count"] = importedCount;
-        result["skipped_count"] = skippedCount;
-        result["errors"] = errors;
+        auto result = co_await importService.importCoro(*type, (*json)["data"]);
+        callback(JsonResponse::success(importResultJson(result), "导入成功"));
+        co_return;
+    }
 
-        callback(JsonResponse::success(result, "导入成功"));
+    // Handle multipart form data
+    MultiPartParser fileParser;
+    if (fileParser.parse(req) != 0)
+    {
+        callback(JsonResponse::badRequest("无法解析上传的文件"));
+        co_return;
     }
-    else
+
+    auto &files = fileParser.getFiles();
+    if (files.empty())
     {
-        // Handle multipart form data
-        MultiPartParser fileParser;
-        if (fileParser.parse(req) != 0)
-        {
-            callback(JsonResponse::badRequest("无法解析上传的文件"));
-            return;
-        }
+        callback(JsonResponse::badRequest("未找到上传的文件"));
+        co_return;
+    }
 
-        auto &files = fileParser.getFiles();
-        if (files.empty())
-        {
-            callback(JsonResponse::badRequest("未找到上传的文件"));
-            return;
-        }
+    auto &params = fileParser.getParameters();
+    std::string typeName;
+    auto it = params.find("type");
+    if (it != params.end())
+    {
+        typeName = it->second;
+    }
 
-        auto &params = fileParser.getParameters();
-        std::string type;
-        auto it = params.find("type");
-        if (it != params.end())
-        {
-            type = it->second;
-        }
+    if (typeName.empty())
+    {
+        callback(JsonResponse::badRequest("type参数为必填"));
+        co_return;
+    }
+    auto type = importType(typeName);
+    if (!type)
+    {
+        callback(JsonResponse::badRequest("无效的导入类型或数据"));
+        co_return;
+    }
 
-        if (type.empty())
-        {
-            callback(JsonResponse::badRequest("type参数为必填"));
-            return;
-        }
+    // An explicit format wins over the file extension
+    std::string format;
+    it = params.find("format");
+    if (it != params.end())
+    {
+        format = it->second;
+    }
+    if (format.empty())
+    {
+        format = std::string(files[0].getFileExtension());
+        std::transform(format.begin(), format.end(), format.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    }
 
-        // For now, return a placeholder response
-        // Full file parsing would require more complex logic
-        Json::Value result;
-        result["imported_count"] = 0;
-        result["skipped_count"] = 0;
-        result["errors"] = Json::Value(Json::arrayValue);
-        result["message"] = "文件上传功能已接收，请使用JSON格式导入";
+    ImportService::Format importFormat;
+    if (format == "csv")
+    {
+        importFormat = ImportService::Format::Csv;
+    }
+    else if (format == "json")
+    {
+        importFormat = ImportService::Format::Json;
+    }
+    else
+    {
+        callback(JsonResponse::badRequest("不支持的导入格式"));
+        co_return;
+    }
 
-        callback(JsonResponse::success(result, "导入完成"));
+    // Parsed in chunks and applied batch by batch; the file is never turned
+    // into one Json::Value
+    auto result = co_await importService.importCoro(*type, importFormat,
+                                                    files[0].fileContent());
+    if (!result.fatal.empty())
+    {
+        callback(JsonResponse::badRequest(result.fatal));
+        co_return;
     }
+    callback(JsonResponse::success(importResultJson(result), "导入成功"));
 }
 
 }  // namespace v1
@@ -1,10 +1,42 @@
 #include "student_attendance/controllers/ReportController.h"
 #include "student_attendance/services/ReportService.h"
+#include "student_attendance/utils/ComputePool.h"
 #include "student_attendance/utils/JsonResponse.h"
+#include "student_attendance/utils/Date.h"
+#include <exception>
 
 using namespace drogon;
 using namespace student_attendance::services;
 using namespace student_attendance::utils;
+using student_attendance::utils::Date;
+
+namespace
+{
+
+const char *const kInvalidDateMessage = "日期格式错误，应为YYYY-MM-DD或MM-DD";
+
+// Reports are computed on the ComputePool, not on the I/O loop that received
+// the request, and the response is sent from the worker. writeData must own
+// what it refers to.
+template <typename WriteData>
+void respondFromPool(std::function<void(const HttpResponsePtr &)> &&callback,
+                     WriteData &&writeData)
+{
+    ComputePool::getInstance().submit(
+        [callback = std::move(callback), writeData = std::forward<WriteData>(writeData)]() {
+            try
+            {
+                callback(JsonResponse::success(writeData));
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR << "Report failed: " << e.what();
+                callback(JsonResponse::serverError("报表生成失败"));
+            }
+        });
+}
+
+}  // namespace
 
 namespace api
 {
@@ -25,11 +57,16 @@ void ReportController::getDetailsReport(
         callback(JsonResponse::badRequest("start_date和end_date为必填参数"));
         return;
     }
+    if (!Date::parse(startDate) || !Date::parse(endDate))
+    {
+        callback(JsonResponse::badRequest(kInvalidDateMessage));
+        return;
+    }
 
-    auto data = ReportService::getInstance().getDetailsReport(
-        startDate, endDate, className, studentId);
-
-    callback(JsonResponse::success(data));
+    respondFromPool(std::move(callback), [=](JsonWriter &json) {
+        ReportService::getInstance().writeDetailsReport(
+            json, startDate, endDate, className, studentId);
+    });
 }
 
 void ReportController::getDailyReport(
@@ -44,10 +81,15 @@ void ReportController::getDailyReport(
         callback(JsonResponse::badRequest("date为必填参数"));
         return;
     }
+    if (!Date::parse(date))
+    {
+        callback(JsonResponse::badRequest(kInvalidDateMessage));
+        return;
+    }
 
-    auto data = ReportService::getInstance().getDailyReport(date, className);
-
-    callback(JsonResponse::success(data));
+    respondFromPool(std::move(callback), [=](JsonWriter &json) {
+        ReportService::getInstance().writeDailyReport(json, date, className);
+    });
 }
 
 void ReportController::getSummaryReport(
@@ -63,11 +105,16 @@ void ReportController::getSummaryReport(
         callback(JsonResponse::badRequest("start_date和end_date为必填参数"));
         return;
     }
+    if (!Date::parse(startDate) || !Date::parse(endDate))
+    {
+        callback(JsonResponse::badRequest(kInvalidDateMessage));
+        return;
+    }
 
-    auto data = ReportService::getInstance().getSummaryReport(
-        startDate, endDate, className);
-
-    callback(JsonResponse::success(data));
+    respondFromPool(std::move(callback), [=](JsonWriter &json) {
+        ReportService::getInstance().writeSummaryReport(
+            json, startDate, endDate, className);
+    });
 }
 
 void ReportController::getAbnormalReport(
@@ -84,11 +131,16 @@ void ReportController::getAbnormalReport(
         callback(JsonResponse::badRequest("start_date和end_date为必填参数"));
         return;
     }
+    if (!Date::parse(startDate) || !Date::parse(endDate))
+    {
+        callback(JsonResponse::badRequest(kInvalidDateMessage));
+        return;
+    }
 
-    auto data = ReportService::getInstance().getAbnormalReport(
-        startDate, endDate, className, type);
-
-    callback(JsonResponse::success(data));
+    respondFromPool(std::move(callback), [=](JsonWriter &json) {
+        ReportService::getInstance().writeAbnormalReport(
+            json, startDate, endDate, className, type);
+    });
 }
 
 void ReportController::getLeaveReport(
@@ -105,11 +157,16 @@ void ReportController::getLeaveReport(
         callback(JsonResponse::badRequest("start_date和end_date为必填参数"));
         return;
     }
+    if (!Date::parse(startDate) || !Date::parse(endDate))
+    {
+        callback(JsonResponse::badRequest(kInvalidDateMessage));
+        return;
+    }
 
-    auto data = ReportService::getInstance().getLeaveReport(
-        startDate, endDate, className, type);
-
-    callback(JsonResponse::success(data));
+    respondFromPool(std::move(callback), [=](JsonWriter &json) {
+        ReportService::getInstance().writeLeaveReport(
+            json, startDate, endDate, className, type);
+    });
 }
 
 }  // namespace v1
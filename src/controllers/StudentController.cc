@@ -1,6 +1,7 @@
 #include "student_attendance/controllers/StudentController.h"
 #include "student_attendance/services/StudentService.h"
 #include "student_attendance/utils/JsonResponse.h"
+#include "student_attendance/utils/PageCursor.h"
 
 using namespace drogon;
 using namespace student_attendance::services;
@@ -11,9 +12,9 @@ namespace api
 namespace v1
 {
 
-void StudentController::getStudents(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> StudentController::getStudents(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
     // Parse query parameters
     int page = 1;
@@ -47,34 +48,56 @@ void StudentController::getStudents(
     className = req->getParameter("class");
     keyword = req->getParameter("keyword");
 
-    auto result = StudentService::getInstance().getStudents(
-        page, pageSize, sortBy, order, className, keyword);
-
-    Json::Value items(Json::arrayValue);
-    for (const auto &student : result.students)
+    // Keyset paging: a cursor replaces `page`, and the total is only counted
+    // on request since it costs a scan of the whole listing
+    std::optional<PageCursor> cursor;
+    auto cursorParam = req->getParameter("cursor");
+    if (!cursorParam.empty())
+    {
+        cursor = PageCursor::decode(cursorParam);
+        if (!cursor)
+        {
+            callback(JsonResponse::badRequest("无效的分页游标"));
+            co_return;
+        }
+    }
+    bool withTotal = !cursor;
+    auto withTotalParam = req->getParameter("with_total");
+    if (!withTotalParam.empty())
     {
-        items.append(student.toJson());
+        withTotal = (withTotalParam == "true" || withTotalParam == "1");
     }
 
-    auto data = JsonResponse::paginatedData(result.total, result.page,
-                                            result.pageSize, items);
-    callback(JsonResponse::success(data));
+    auto result = co_await StudentService::getInstance().getStudentsCoro(
+        page, pageSize, sortBy, order, className, keyword, cursor, withTotal);
+
+    callback(JsonResponse::success([&result](JsonWriter &json) {
+        JsonResponse::writePage(
+            json, result.total, result.page, result.pageSize,
+            [&result](JsonWriter &items) {
+                for (const auto &student : result.students)
+                {
+                    student.writeJson(items);
+                }
+            },
+            result.nextCursor);
+    }));
 }
 
-void StudentController::createStudent(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback) const
+drogon::Task<> StudentController::createStudent(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     student_attendance::models::Student student = student_attendance::models::Student::fromJson(*json);
 
-    auto [success, message] = StudentService::getInstance().createStudent(student);
+    auto [success, message] = co_await StudentService::getInstance().createStudentCoro(student);
 
     if (success)
     {
@@ -93,12 +116,12 @@ void StudentController::createStudent(
     }
 }
 
-void StudentController::getStudent(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
-    const std::string &studentId) const
+drogon::Task<> StudentController::getStudent(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
+    std::string studentId) const
 {
-    auto student = StudentService::getInstance().getStudent(studentId);
+    auto student = co_await StudentService::getInstance().getStudentCoro(studentId);
 
     if (student)
     {
@@ -110,16 +133,16 @@ void StudentController::getStudent(
     }
 }
 
-void StudentController::updateStudent(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
-    const std::string &studentId) const
+drogon::Task<> StudentController::updateStudent(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
+    std::string studentId) const
 {
     auto json = req->getJsonObject();
     if (!json)
     {
         callback(JsonResponse::badRequest("无效的JSON数据"));
-        return;
+        co_return;
     }
 
     std::string name;
@@ -134,12 +157,12 @@ void StudentController::updateStudent(
         className = (*json)["class"].asString();
     }
 
-    auto [success, message] = StudentService::getInstance().updateStudent(
+    auto [success, message] = co_await StudentService::getInstance().updateStudentCoro(
         studentId, name, className);
 
     if (success)
     {
-        auto student = StudentService::getInstance().getStudent(studentId);
+        auto student = co_await StudentService::getInstance().getStudentCoro(studentId);
         if (student)
         {
             callback(JsonResponse::success(student->toJson(), message));
@@ -155,12 +178,12 @@ void StudentController::updateStudent(
     }
 }
 
-void StudentController::deleteStudent(
-    const HttpRequestPtr &req,
-    std::function<void(const HttpResponsePtr &)> &&callback,
-    const std::string &studentId) const
+drogon::Task<> StudentController::deleteStudent(
+    HttpRequestPtr req,
+    std::function<void(const HttpResponsePtr &)> callback,
+    std::string studentId) const
 {
-    if (StudentService::getInstance().deleteStudent(studentId))
+    if (co_await StudentService::getInstance().deleteStudentCoro(studentId))
     {
         callback(JsonResponse::noContent());
     }
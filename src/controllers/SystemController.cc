@@ -0,0 +1,48 @@
+#include "student_attendance/controllers/SystemController.h"
+#include "student_attendance/db/StudentCache.h"
+#include "student_attendance/services/ReportCache.h"
+#include "student_attendance/utils/JsonResponse.h"
+
+using namespace drogon;
+using namespace student_attendance::db;
+using namespace student_attendance::services;
+using namespace student_attendance::utils;
+
+namespace api
+{
+namespace v1
+{
+
+void SystemController::getStats(
+    const HttpRequestPtr &req,
+    std::function<void(const HttpResponsePtr &)> &&callback) const
+{
+    auto reports = ReportCache::getInstance().stats();
+
+    Json::Value reportCache;
+    reportCache["hits"] = static_cast<Json::UInt64>(reports.hits);
+    reportCache["misses"] = static_cast<Json::UInt64>(reports.misses);
+    reportCache["invalidations"] = static_cast<Json::UInt64>(reports.invalidations);
+    reportCache["evictions"] = static_cast<Json::UInt64>(reports.evictions);
+    reportCache["entries"] = static_cast<Json::UInt64>(reports.entries);
+    reportCache["bytes"] = static_cast<Json::UInt64>(reports.bytes);
+    reportCache["hit_rate"] = reports.hitRate();
+
+    auto students = StudentCache::getInstance().stats();
+
+    Json::Value studentCache;
+    studentCache["hits"] = static_cast<Json::UInt64>(students.hits);
+    studentCache["misses"] = static_cast<Json::UInt64>(students.misses);
+    studentCache["loads"] = static_cast<Json::UInt64>(students.loads);
+    studentCache["invalidations"] = static_cast<Json::UInt64>(students.invalidations);
+    studentCache["students"] = static_cast<Json::UInt64>(students.students);
+    studentCache["hit_rate"] = students.hitRate();
+
+    Json::Value data;
+    data["report_cache"] = reportCache;
+    data["student_cache"] = studentCache;
+    callback(JsonResponse::success(data));
+}
+
+}  // namespace v1
+}  // namespace api
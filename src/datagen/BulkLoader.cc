@@ -0,0 +1,162 @@
+#include "student_attendance/datagen/BulkLoader.h"
+#include "student_attendance/db/StudentCache.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+namespace student_attendance
+{
+namespace datagen
+{
+
+namespace
+{
+
+// Records handed over per generator batch
+constexpr size_t kBatchSize = 1 << 16;
+// Rows per INSERT; at three parameters each this stays under SQLite's
+// default limit of 999 bound parameters
+constexpr size_t kRowsPerInsert = 300;
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string multiRowInsert(const char *head, const char *tuple, size_t rows)
+{
+    std::string sql = head;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        sql += i == 0 ? " VALUES " : ", ";
+        sql += tuple;
+    }
+    return sql;
+}
+
+// execSqlSync for an argument list whose length is only known at run time
+template <typename Bind>
+void execBlocking(drogon::orm::DbClient &client, const std::string &sql, Bind &&bind)
+{
+    auto binder = client << sql;
+    bind(binder);
+    binder << drogon::orm::Mode::Blocking;
+    binder >> [](const drogon::orm::Result &) {};
+    binder.exec();
+}
+
+// Inserts items in statements of kRowsPerInsert rows, reusing the full-size
+// statement text
+template <typename Item, typename BindRow>
+void insertRows(drogon::orm::DbClient &client, const char *head, const char *tuple,
+                const std::vector<Item> &items, BindRow &&bindRow)
+{
+    const auto fullSql = multiRowInsert(head, tuple, kRowsPerInsert);
+    for (size_t first = 0; first < items.size(); first += kRowsPerInsert)
+    {
+        auto count = std::min(kRowsPerInsert, items.size() - first);
+        std::string partialSql;
+        if (count < kRowsPerInsert)
+        {
+            partialSql = multiRowInsert(head, tuple, count);
+        }
+        execBlocking(client, count == kRowsPerInsert ? fullSql : partialSql, [&](auto &binder) {
+            for (size_t i = first; i < first + count; ++i)
+            {
+                bindRow(binder, items[i]);
+            }
+        });
+    }
+}
+
+}  // namespace
+
+BulkLoader::Stats BulkLoader::loadDataStore(const SchoolGenerator &generator,
+                                            models::DataStore &store)
+{
+    auto start = std::chrono::steady_clock::now();
+    Stats stats;
+
+    store.clear();
+    auto roster = generator.students();
+    store.importStudents(roster);
+    stats.students = static_cast<int64_t>(roster.size());
+
+    generator.generateAttendances(kBatchSize, [&](const std::vector<models::Attendance> &batch) {
+        store.importAttendances(batch);
+        stats.attendances += static_cast<int64_t>(batch.size());
+    });
+
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+BulkLoader::Stats BulkLoader::loadSqlite(const SchoolGenerator &generator,
+                                         const drogon::orm::DbClientPtr &client)
+{
+    auto start = std::chrono::steady_clock::now();
+    Stats stats;
+
+    // The transaction commits asynchronously once released; wait for it
+    std::promise<bool> committed;
+    auto commitDone = committed.get_future();
+    auto trans = client->newTransaction([&committed](bool ok) { committed.set_value(ok); });
+    try
+    {
+        // Maintaining indexes row by row dominates a large load; build them
+        // once over the finished tables instead
+        auto indexes = trans->execSqlSync(
+            "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND sql IS NOT NULL "
+            "AND tbl_name IN ('students', 'attendances')");
+        std::vector<std::string> rebuild;
+        for (const auto &index : indexes)
+        {
+            trans->execSqlSync("DROP INDEX \"" + index["name"].as<std::string>() + "\"");
+            rebuild.push_back(index["sql"].as<std::string>());
+        }
+
+        trans->execSqlSync("DELETE FROM attendances");
+        trans->execSqlSync("DELETE FROM students");
+        trans->execSqlSync("DELETE FROM sqlite_sequence WHERE name = 'attendances'");
+
+        auto roster = generator.students();
+        insertRows(*trans, "INSERT INTO students (student_id, name, class_name)", "(?, ?, ?)",
+                   roster, [](auto &binder, const models::Student &student) {
+                       binder << student.studentId << student.name << student.className;
+                   });
+        stats.students = static_cast<int64_t>(roster.size());
+
+        generator.generateAttendances(kBatchSize, [&](const std::vector<models::Attendance> &batch) {
+            insertRows(*trans, "INSERT INTO attendances (student_id, date, status)", "(?, ?, ?)",
+                       batch, [](auto &binder, const models::Attendance &att) {
+                           binder << att.studentId << att.date.ordinal()
+                                  << static_cast<int>(att.status);
+                       });
+            stats.attendances += static_cast<int64_t>(batch.size());
+        });
+
+        for (const auto &sql : rebuild)
+        {
+            trans->execSqlSync(sql);
+        }
+        trans->execSqlSync("ANALYZE");
+    }
+    catch (...)
+    {
+        trans->rollback();
+        throw;
+    }
+    trans.reset();
+    bool ok = commitDone.get();
+    db::StudentCache::getInstance().invalidate();
+    if (!ok)
+    {
+        throw drogon::orm::Failure("bulk load commit failed");
+    }
+
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+}  // namespace datagen
+}  // namespace student_attendance
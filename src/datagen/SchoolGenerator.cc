@@ -0,0 +1,186 @@
+#include "student_attendance/datagen/SchoolGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <random>
+
+namespace student_attendance
+{
+namespace datagen
+{
+
+namespace
+{
+
+constexpr const char *kDepartments[] = {"人文", "理工", "经管", "艺术", "医学", "法学"};
+constexpr size_t kDepartmentCount = std::size(kDepartments);
+
+constexpr const char *kSurnames[] = {
+    "王", "李", "张", "刘", "陈", "杨", "黄", "赵", "吴", "周",
+    "徐", "孙", "马", "朱", "胡", "郭", "何", "林", "罗", "高",
+    "郑", "梁", "谢", "宋", "唐", "许", "韩", "冯", "邓", "曹"};
+
+constexpr const char *kGivenNames[] = {
+    "伟", "芳", "娜", "敏", "静", "丽", "强", "磊", "军", "洋",
+    "勇", "艳", "杰", "娟", "涛", "明", "超", "秀", "霞", "平",
+    "刚", "桂", "华", "鹏", "辉", "玲", "婷", "宇", "浩", "欣",
+    "晨", "琳", "博", "雪", "睿", "佳", "子", "思", "雨", "轩"};
+
+// Extra sick days after the first, drawn uniformly
+constexpr uint64_t kMaxSickStreak = 3;
+
+// Uniform in [0, 1); spelled out so output does not depend on the
+// standard library's distribution implementations
+double unit(std::mt19937_64 &rng)
+{
+    return static_cast<double>(rng() >> 11) * 0x1.0p-53;
+}
+
+// Log-normal with mean 1: most students near the baseline, a long tail of
+// frequent absentees
+double propensity(std::mt19937_64 &rng)
+{
+    double u1 = 1.0 - unit(rng);
+    double u2 = unit(rng);
+    double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * std::numbers::pi * u2);
+    return std::exp(-0.5 + normal);
+}
+
+}  // namespace
+
+SchoolGenerator::SchoolGenerator(const SchoolSpec &spec) : spec_(spec)
+{
+}
+
+std::string SchoolGenerator::className(int classIndex) const
+{
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%s%02d%02d班",
+                  kDepartments[static_cast<size_t>(classIndex) % kDepartmentCount],
+                  spec_.enrollmentYear % 100,
+                  classIndex / static_cast<int>(kDepartmentCount) + 1);
+    return buffer;
+}
+
+std::string SchoolGenerator::studentId(int classIndex, int seat) const
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04d%07lld", spec_.enrollmentYear,
+                  static_cast<long long>(classIndex) * spec_.studentsPerClass + seat + 1);
+    return buffer;
+}
+
+std::vector<models::Student> SchoolGenerator::students() const
+{
+    std::vector<models::Student> roster;
+    roster.reserve(static_cast<size_t>(spec_.studentCount()));
+    std::mt19937_64 rng(spec_.seed);
+    for (int c = 0; c < spec_.classes; ++c)
+    {
+        auto cls = className(c);
+        for (int seat = 0; seat < spec_.studentsPerClass; ++seat)
+        {
+            std::string name = kSurnames[rng() % std::size(kSurnames)];
+            name += kGivenNames[rng() % std::size(kGivenNames)];
+            if (rng() % 3 != 0)
+            {
+                name += kGivenNames[rng() % std::size(kGivenNames)];
+            }
+            roster.emplace_back(studentId(c, seat), name, cls);
+        }
+    }
+    return roster;
+}
+
+std::vector<utils::Date> SchoolGenerator::termDays() const
+{
+    std::vector<utils::Date> days;
+    days.reserve(static_cast<size_t>(std::max(spec_.termDays, 0)));
+    auto ordinal = spec_.termStart.ordinal();
+    while (static_cast<int>(days.size()) < spec_.termDays)
+    {
+        std::chrono::weekday weekday{std::chrono::sys_days{std::chrono::days{ordinal}}};
+        if (weekday != std::chrono::Saturday && weekday != std::chrono::Sunday)
+        {
+            days.push_back(utils::Date::fromOrdinal(ordinal));
+        }
+        ++ordinal;
+    }
+    return days;
+}
+
+void SchoolGenerator::generateAttendances(
+    size_t batchSize,
+    const std::function<void(const std::vector<models::Attendance> &)> &sink) const
+{
+    auto roster = students();
+    std::mt19937_64 rng(spec_.seed ^ 0x5A17E5u);
+
+    std::vector<double> propensities(roster.size());
+    for (auto &p : propensities)
+    {
+        p = propensity(rng);
+    }
+    std::vector<uint64_t> sickDaysLeft(roster.size(), 0);
+
+    const auto &weights = spec_.statusWeights;
+    double presentWeight = weights[0];
+    double deviationWeight = 0.0;
+    for (size_t code = 1; code < weights.size(); ++code)
+    {
+        deviationWeight += weights[code];
+    }
+
+    batchSize = std::max<size_t>(batchSize, 1);
+    std::vector<models::Attendance> batch;
+    batch.reserve(batchSize);
+    for (auto day : termDays())
+    {
+        for (size_t s = 0; s < roster.size(); ++s)
+        {
+            auto status = utils::StatusCode::Present;
+            if (sickDaysLeft[s] > 0)
+            {
+                status = utils::StatusCode::SickLeave;
+                --sickDaysLeft[s];
+            }
+            else
+            {
+                double r = unit(rng) * (presentWeight + deviationWeight * propensities[s]);
+                if (r >= presentWeight)
+                {
+                    // Pick among the deviations by their own weights
+                    r = (r - presentWeight) / propensities[s];
+                    size_t code = 1;
+                    while (code + 1 < weights.size() && r >= weights[code])
+                    {
+                        r -= weights[code];
+                        ++code;
+                    }
+                    status = static_cast<utils::StatusCode>(code);
+                    if (status == utils::StatusCode::SickLeave)
+                    {
+                        sickDaysLeft[s] = rng() % (kMaxSickStreak + 1);
+                    }
+                }
+            }
+
+            const auto &student = roster[s];
+            batch.emplace_back(0, student.studentId, student.name, student.className, day, status);
+            if (batch.size() == batchSize)
+            {
+                sink(batch);
+                batch.clear();
+            }
+        }
+    }
+    if (!batch.empty())
+    {
+        sink(batch);
+    }
+}
+
+}  // namespace datagen
+}  // namespace student_attendance
@@ -0,0 +1,193 @@
+#include "student_attendance/datagen/BulkLoader.h"
+#include "student_attendance/datagen/SchoolGenerator.h"
+#include "student_attendance/db/DatabaseManager.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using student_attendance::datagen::BulkLoader;
+using student_attendance::datagen::SchoolGenerator;
+using student_attendance::datagen::SchoolSpec;
+
+namespace
+{
+
+void printUsage()
+{
+    std::cout << "Usage: student_attendance_datagen [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  --target sqlite|memory    Load into SQLite (default) or the in-memory store" << std::endl;
+    std::cout << "  --db PATH                 SQLite file (default ./student_attendance.db)" << std::endl;
+    std::cout << "  --profile small|production" << std::endl;
+    std::cout << "                            small: 20 classes x 40 students, 100 days (default)" << std::endl;
+    std::cout << "                            production: 1250 classes x 40 students, 200 days" << std::endl;
+    std::cout << "  --classes N               Number of classes" << std::endl;
+    std::cout << "  --students-per-class N    Students in each class" << std::endl;
+    std::cout << "  --days N                  School days in the term" << std::endl;
+    std::cout << "  --start YYYY-MM-DD        First day of the term" << std::endl;
+    std::cout << "  --year N                  Enrollment year used in ids and class names" << std::endl;
+    std::cout << "  --weights P,A,PL,SL,L,EL  Relative weights of present, absent, personal" << std::endl;
+    std::cout << "                            leave, sick leave, late and early leave" << std::endl;
+    std::cout << "  --seed N                  Random seed" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Existing students and attendances in the target are replaced." << std::endl;
+}
+
+bool parseWeights(const std::string &text, SchoolSpec &spec)
+{
+    std::istringstream in(text);
+    std::string item;
+    size_t code = 0;
+    while (std::getline(in, item, ','))
+    {
+        if (code >= spec.statusWeights.size())
+            return false;
+        char *end = nullptr;
+        double weight = std::strtod(item.c_str(), &end);
+        if (end == item.c_str() || *end != '\0' || weight < 0)
+            return false;
+        spec.statusWeights[code++] = weight;
+    }
+    return code == spec.statusWeights.size();
+}
+
+bool parseCount(const std::string &text, int &value)
+{
+    char *end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0' || parsed <= 0 || parsed > 10'000'000)
+        return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    SchoolSpec spec;
+    std::string target = "sqlite";
+    std::string dbPath = "./student_attendance.db";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        bool ok = true;
+        if (arg == "--target")
+        {
+            target = value;
+            ok = target == "sqlite" || target == "memory";
+        }
+        else if (arg == "--db")
+        {
+            dbPath = value;
+        }
+        else if (arg == "--profile")
+        {
+            if (value == "production")
+            {
+                spec.classes = 1250;
+                spec.studentsPerClass = 40;
+                spec.termDays = 200;
+            }
+            else
+            {
+                ok = value == "small";
+            }
+        }
+        else if (arg == "--classes")
+        {
+            ok = parseCount(value, spec.classes);
+        }
+        else if (arg == "--students-per-class")
+        {
+            ok = parseCount(value, spec.studentsPerClass);
+        }
+        else if (arg == "--days")
+        {
+            ok = parseCount(value, spec.termDays);
+        }
+        else if (arg == "--year")
+        {
+            ok = parseCount(value, spec.enrollmentYear) && spec.enrollmentYear <= 9999;
+        }
+        else if (arg == "--start")
+        {
+            auto start = student_attendance::utils::Date::parse(value);
+            ok = start.has_value();
+            if (start)
+                spec.termStart = *start;
+        }
+        else if (arg == "--weights")
+        {
+            ok = parseWeights(value, spec);
+        }
+        else if (arg == "--seed")
+        {
+            spec.seed = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage();
+            return 1;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            return 1;
+        }
+    }
+
+    SchoolGenerator generator(spec);
+    std::cout << "Generating " << spec.studentCount() << " students in " << spec.classes
+              << " classes, " << spec.attendanceCount() << " attendance records over "
+              << spec.termDays << " school days" << std::endl;
+
+    BulkLoader::Stats stats;
+    try
+    {
+        if (target == "memory")
+        {
+            stats = BulkLoader::loadDataStore(generator,
+                                              student_attendance::models::DataStore::getInstance());
+        }
+        else
+        {
+            auto client = drogon::orm::DbClient::newSqlite3Client("filename=" + dbPath, 1);
+            auto &database = student_attendance::db::DatabaseManager::getInstance();
+            database.initialize(client);
+            stats = BulkLoader::loadSqlite(generator, client);
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        std::cerr << "Load failed: " << e.base().what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Loaded " << stats.students << " students and " << stats.attendances
+              << " attendance records into " << (target == "memory" ? "memory" : dbPath)
+              << " in " << stats.seconds << " s";
+    if (stats.seconds > 0)
+    {
+        std::cout << " (" << static_cast<int64_t>(stats.attendances / stats.seconds)
+                  << " records/s)";
+    }
+    std::cout << std::endl;
+    return 0;
+}
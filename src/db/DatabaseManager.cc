@@ -1,14 +1,94 @@
 #include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/StudentCache.h"
+#include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/Date.h"
 #include <drogon/drogon.h>
 #include <drogon/utils/Utilities.h>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <sqlite3.h>
 
 namespace student_attendance
 {
 namespace db
 {
 
+namespace
+{
+
+// date holds days since 1970-01-01 (utils::Date), status a utils::StatusCode
+std::string attendancesTableSql(const std::string &name)
+{
+    return "CREATE TABLE IF NOT EXISTS " + name + R"( (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            student_id TEXT NOT NULL,
+            date INTEGER NOT NULL,
+            status INTEGER NOT NULL CHECK(status BETWEEN 0 AND 5),
+            remark TEXT DEFAULT '',
+            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
+            FOREIGN KEY (student_id) REFERENCES students(student_id) ON DELETE CASCADE
+        )
+    )";
+}
+
+std::mutex tuningMutex;
+std::optional<SqliteTuning> configuredTuning;
+// What applyTuning() runs; null until configure() is called
+std::shared_ptr<const std::vector<std::string>> tuningPragmas;
+
+// Registered with sqlite3_auto_extension(), so SQLite calls it on each
+// connection it opens, whoever opens it
+int applyTuning(sqlite3 *db, char **, const sqlite3_api_routines *)
+{
+    std::shared_ptr<const std::vector<std::string>> pragmas;
+    {
+        std::lock_guard<std::mutex> lock(tuningMutex);
+        pragmas = tuningPragmas;
+    }
+    if (!pragmas)
+    {
+        return SQLITE_OK;
+    }
+    for (const auto &pragma : *pragmas)
+    {
+        // A setting SQLite refuses leaves the connection usable as it is
+        char *message = nullptr;
+        if (sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, &message) != SQLITE_OK)
+        {
+            LOG_WARN << pragma << " failed: " << (message ? message : "unknown error");
+            sqlite3_free(message);
+        }
+    }
+    return SQLITE_OK;
+}
+
+// Stored in PRAGMA user_version once the schema below is in place; bump it
+// whenever the DDL in initializeSchema() changes
+constexpr int kSchemaVersion = 1;
+
+}  // namespace
+
+void DatabaseManager::configure(const SqliteTuning &tuning)
+{
+    {
+        std::lock_guard<std::mutex> lock(tuningMutex);
+        configuredTuning = tuning;
+        tuningPragmas = std::make_shared<const std::vector<std::string>>(tuning.pragmas());
+    }
+    // Registering the same entry point again is a no-op
+    sqlite3_auto_extension(reinterpret_cast<void (*)()>(applyTuning));
+}
+
+std::optional<SqliteTuning> DatabaseManager::tuning() const
+{
+    std::lock_guard<std::mutex> lock(tuningMutex);
+    return configuredTuning;
+}
+
 void DatabaseManager::initialize(const std::string &dbPath)
 {
     dbPath_ = dbPath;
@@ -36,6 +116,14 @@ void DatabaseManager::initialize(const std::string &dbPath)
 
     // Initialize schema
     initializeSchema();
+    StudentCache::getInstance().invalidate();
+}
+
+void DatabaseManager::initialize(const drogon::orm::DbClientPtr &client)
+{
+    dbClient_ = client;
+    initializeSchema();
+    StudentCache::getInstance().invalidate();
 }
 
 void DatabaseManager::initializeSchema()
@@ -66,23 +154,16 @@ void DatabaseManager::initializeSchema()
         )
     )";
 
-    const char *createAttendancesTable = R"(
-        CREATE TABLE IF NOT EXISTS attendances (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            student_id TEXT NOT NULL,
-            date TEXT NOT NULL,
-            status TEXT NOT NULL CHECK(status IN ('present', 'absent', 'late', 'early_leave', 'sick_leave', 'personal_leave')),
-            remark TEXT DEFAULT '',
-            created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            updated_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-            FOREIGN KEY (student_id) REFERENCES students(student_id) ON DELETE CASCADE
-        )
-    )";
+    const std::string createAttendancesTable = attendancesTableSql("attendances");
 
     const char *createIndexes[] = {
         "CREATE INDEX IF NOT EXISTS idx_users_username ON users(username)",
-        "CREATE INDEX IF NOT EXISTS idx_students_class ON students(class_name)",
-        "CREATE INDEX IF NOT EXISTS idx_students_name ON students(name)",
+        // Sorted listings seek on (column, student_id); these replace the
+        // single-column indexes older versions created
+        "DROP INDEX IF EXISTS idx_students_class",
+        "DROP INDEX IF EXISTS idx_students_name",
+        "CREATE INDEX IF NOT EXISTS idx_students_class_id ON students(class_name, student_id)",
+        "CREATE INDEX IF NOT EXISTS idx_students_name_id ON students(name, student_id)",
         "CREATE INDEX IF NOT EXISTS idx_attendances_student ON attendances(student_id)",
         "CREATE INDEX IF NOT EXISTS idx_attendances_date ON attendances(date)",
         "CREATE INDEX IF NOT EXISTS idx_attendances_status ON attendances(status)",
@@ -92,13 +173,22 @@ void DatabaseManager::initializeSchema()
     // Execute schema creation synchronously
     try
     {
-        dbClient_->execSqlSync(createUsersTable);
-        dbClient_->execSqlSync(createStudentsTable);
-        dbClient_->execSqlSync(createAttendancesTable);
-
-        for (const auto &indexSql : createIndexes)
+        // A database already at this version skips the DDL, which otherwise
+        // costs a round trip per statement on every start
+        auto version = dbClient_->execSqlSync("PRAGMA user_version");
+        if (version.empty() || version[0][0].as<int>() < kSchemaVersion)
         {
-            dbClient_->execSqlSync(indexSql);
+            dbClient_->execSqlSync(createUsersTable);
+            dbClient_->execSqlSync(createStudentsTable);
+            dbClient_->execSqlSync(createAttendancesTable);
+
+            migrateSchema();
+
+            for (const auto &indexSql : createIndexes)
+            {
+                dbClient_->execSqlSync(indexSql);
+            }
+            dbClient_->execSqlSync("PRAGMA user_version = " + std::to_string(kSchemaVersion));
         }
 
         auto exists = dbClient_->execSqlSync(
@@ -125,6 +215,66 @@ void DatabaseManager::initializeSchema()
     }
 }
 
+void DatabaseManager::migrateSchema()
+{
+    // Older databases stored attendances.status as its text name and
+    // attendances.date as `MM-DD` text
+    auto columns = dbClient_->execSqlSync("PRAGMA table_info(attendances)");
+    bool textStatus = false;
+    bool textDate = false;
+    for (const auto &column : columns)
+    {
+        auto name = column["name"].as<std::string>();
+        bool isText = column["type"].as<std::string>() == "TEXT";
+        if (name == "status")
+            textStatus = isText;
+        else if (name == "date")
+            textDate = isText;
+    }
+    if (!textStatus && !textDate)
+        return;
+
+    std::string statusExpr = "status";
+    if (textStatus)
+    {
+        statusExpr = "CASE status";
+        for (size_t i = 0; i < utils::kStatusCount; ++i)
+        {
+            statusExpr += " WHEN '" + std::string(utils::kStatusTable[i].name) +
+                          "' THEN " + std::to_string(i);
+        }
+        statusExpr += " END";
+    }
+
+    // `MM-DD` rows get the default year; julianday 2440587.5 is 1970-01-01
+    std::string dateExpr = "date";
+    if (textDate)
+    {
+        dateExpr = "CAST(julianday(CASE WHEN length(date) = 5 THEN '" +
+                   std::to_string(utils::Date::defaultYear()) +
+                   "-' || date ELSE date END) - 2440587.5 AS INTEGER)";
+    }
+
+    LOG_INFO << "Migrating attendances to integer status and date columns";
+    auto trans = dbClient_->newTransaction();
+    try
+    {
+        trans->execSqlSync(attendancesTableSql("attendances_new"));
+        trans->execSqlSync(
+            "INSERT INTO attendances_new "
+            "(id, student_id, date, status, remark, created_at, updated_at) "
+            "SELECT id, student_id, " + dateExpr + ", " + statusExpr +
+            ", remark, created_at, updated_at FROM attendances");
+        trans->execSqlSync("DROP TABLE attendances");
+        trans->execSqlSync("ALTER TABLE attendances_new RENAME TO attendances");
+    }
+    catch (...)
+    {
+        trans->rollback();
+        throw;
+    }
+}
+
 void DatabaseManager::reset()
 {
     if (!dbClient_)
@@ -176,23 +326,27 @@ void DatabaseManager::reset()
 
         const char *insertAttendances = R"(
             INSERT INTO attendances (student_id, date, status, remark) VALUES
-            ('2024001', '12-15', 'present', ''),
-            ('2024002', '12-15', 'present', ''),
-            ('2024003', '12-15', 'late', '迟到5分钟'),
-            ('2024004', '12-15', 'absent', ''),
-            ('2024005', '12-15', 'present', ''),
-            ('2024006', '12-15', 'sick_leave', '感冒'),
-            ('2024007', '12-15', 'present', ''),
-            ('2024008', '12-15', 'personal_leave', '家中有事')
+            ('2024001', ?1, 0, ''),
+            ('2024002', ?1, 0, ''),
+            ('2024003', ?1, 4, '迟到5分钟'),
+            ('2024004', ?1, 1, ''),
+            ('2024005', ?1, 0, ''),
+            ('2024006', ?1, 3, '感冒'),
+            ('2024007', ?1, 0, ''),
+            ('2024008', ?1, 2, '家中有事')
         )";
+        // db/schema.sql seeds the same day
+        static_assert(models::DataStore::kSampleDate.ordinal() == 20437);
+        const int sampleDate = models::DataStore::kSampleDate.ordinal();
 
         dbClient_->execSqlSync(insertStudents);
-        dbClient_->execSqlSync(insertAttendances);
+        dbClient_->execSqlSync(insertAttendances, sampleDate);
     }
     catch (const drogon::orm::DrogonDbException &e)
     {
         LOG_ERROR << "Database reset failed: " << e.base().what();
     }
+    StudentCache::getInstance().invalidate();
 }
 
 }  // namespace db
@@ -0,0 +1,103 @@
+#include "student_attendance/db/HybridStorage.h"
+#include "student_attendance/db/WriteThrough.h"
+
+namespace student_attendance
+{
+namespace db
+{
+
+drogon::Task<bool> HybridStorage::addStudent(const models::Student &student)
+{
+    bool applied = co_await MemoryStorage::addStudent(student);
+    if (!applied)
+    {
+        co_return false;
+    }
+    co_await writeThroughStudentChange(student);
+    co_return true;
+}
+
+drogon::Task<int> HybridStorage::addStudents(const std::vector<models::Student> &students,
+                                             std::vector<bool> &added)
+{
+    int count = co_await MemoryStorage::addStudents(students, added);
+    if (count > 0)
+    {
+        std::vector<models::Student> inserted;
+        inserted.reserve(static_cast<size_t>(count));
+        for (size_t i = 0; i < students.size(); ++i)
+        {
+            if (added[i])
+            {
+                inserted.push_back(students[i]);
+            }
+        }
+        co_await writeThroughStudents(inserted);
+    }
+    co_return count;
+}
+
+drogon::Task<bool> HybridStorage::updateStudent(const std::string &studentId,
+                                                const std::string &name,
+                                                const std::string &className)
+{
+    bool applied = co_await MemoryStorage::updateStudent(studentId, name, className);
+    if (!applied)
+    {
+        co_return false;
+    }
+    // The whole row, so a mirror that missed the insert catches up
+    if (auto student = store_.getStudentById(studentId))
+    {
+        co_await writeThroughStudentChange(*student);
+    }
+    co_return true;
+}
+
+drogon::Task<bool> HybridStorage::deleteStudent(const std::string &studentId)
+{
+    bool applied = co_await MemoryStorage::deleteStudent(studentId);
+    if (!applied)
+    {
+        co_return false;
+    }
+    co_await writeThroughStudentRemoval(studentId);
+    co_return true;
+}
+
+drogon::Task<int> HybridStorage::addAttendances(std::vector<models::Attendance> &attendances)
+{
+    int count = co_await MemoryStorage::addAttendances(attendances);
+    if (count > 0)
+    {
+        co_await writeThroughAttendances(attendances);
+    }
+    co_return count;
+}
+
+drogon::Task<bool> HybridStorage::updateAttendance(int id,
+                                                   std::optional<utils::StatusCode> status,
+                                                   const std::string &remark)
+{
+    bool applied = co_await MemoryStorage::updateAttendance(id, status, remark);
+    if (!applied)
+    {
+        co_return false;
+    }
+    co_await writeThroughAttendanceChange(id, status, remark);
+    co_return true;
+}
+
+drogon::Task<bool> HybridStorage::deleteAttendance(int id)
+{
+    bool applied = co_await MemoryStorage::deleteAttendance(id);
+    if (!applied)
+    {
+        co_return false;
+    }
+    co_await writeThroughAttendanceRemoval(id);
+    co_return true;
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,269 @@
+#include "student_attendance/db/MemoryStorage.h"
+#include "student_attendance/db/WriteAheadLog.h"
+#include <algorithm>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+using models::DataSnapshot;
+
+DataSnapshot::StudentOrder studentOrder(uint8_t column)
+{
+    switch (column)
+    {
+    case StudentQuery::ByName:
+        return DataSnapshot::StudentOrder::ByName;
+    case StudentQuery::ByClass:
+        return DataSnapshot::StudentOrder::ByClass;
+    default:
+        return DataSnapshot::StudentOrder::ById;
+    }
+}
+
+models::AttendanceTable::Order attendanceOrder(uint8_t column)
+{
+    switch (column)
+    {
+    case AttendanceQuery::ByStudent:
+        return models::AttendanceTable::Order::ByStudent;
+    case AttendanceQuery::ByName:
+        return models::AttendanceTable::Order::ByName;
+    case AttendanceQuery::ByDate:
+        return models::AttendanceTable::Order::ByDate;
+    default:
+        return models::AttendanceTable::Order::ById;
+    }
+}
+
+// The snapshot's listing for a query, reading one row past the page to
+// tell whether more follow
+template <typename Listing, typename Query>
+Listing listingFor(const Query &query)
+{
+    Listing listing;
+    listing.descending = query.descending;
+    listing.after = query.after ? &*query.after : nullptr;
+    listing.offset = static_cast<size_t>(std::max(query.offset, 0));
+    listing.limit = static_cast<size_t>(std::max(query.limit, 0)) + 1;
+    return listing;
+}
+
+template <typename Row, typename Query>
+Page<Row> pageOf(std::vector<Row> rows, const Query &query)
+{
+    Page<Row> page;
+    auto limit = static_cast<size_t>(std::max(query.limit, 0));
+    page.more = rows.size() > limit;
+    rows.resize(std::min(rows.size(), limit));
+    page.rows = std::move(rows);
+    return page;
+}
+
+// Suspends the writer until its change is logged, without holding up the
+// event loop it runs on
+drogon::Task<> waitDurable()
+{
+    bool durable = co_await WriteAheadLog::getInstance().waitDurableCoro();
+    if (!durable)
+    {
+        throw DurabilityError("数据未能写入磁盘");
+    }
+}
+
+}  // namespace
+
+drogon::Task<Page<models::Student>> MemoryStorage::listStudents(const StudentQuery &query)
+{
+    auto data = store_.snapshot();
+    auto listing = listingFor<DataSnapshot::StudentListing>(query);
+    listing.order = studentOrder(query.sortColumn);
+    auto page = pageOf(data->listStudents(query.className, query.keyword, listing), query);
+    if (query.withTotal)
+    {
+        page.total = static_cast<int>(data->countStudents(query.className, query.keyword));
+    }
+    co_return page;
+}
+
+drogon::Task<std::optional<models::Student>> MemoryStorage::getStudent(
+    const std::string &studentId)
+{
+    co_return store_.getStudentById(studentId);
+}
+
+drogon::Task<bool> MemoryStorage::addStudent(const models::Student &student)
+{
+    if (!store_.addStudent(student))
+    {
+        co_return false;
+    }
+    co_await waitDurable();
+    co_return true;
+}
+
+drogon::Task<int> MemoryStorage::addStudents(const std::vector<models::Student> &students,
+                                             std::vector<bool> &added)
+{
+    int count = store_.addStudents(students, added);
+    if (count > 0)
+    {
+        co_await waitDurable();
+    }
+    co_return count;
+}
+
+drogon::Task<bool> MemoryStorage::updateStudent(const std::string &studentId,
+                                                const std::string &name,
+                                                const std::string &className)
+{
+    models::Student change;
+    change.name = name;
+    change.className = className;
+    if (!store_.updateStudent(studentId, change))
+    {
+        co_return false;
+    }
+    co_await waitDurable();
+    co_return true;
+}
+
+drogon::Task<bool> MemoryStorage::deleteStudent(const std::string &studentId)
+{
+    if (!store_.deleteStudent(studentId))
+    {
+        co_return false;
+    }
+    co_await waitDurable();
+    co_return true;
+}
+
+drogon::Task<Page<models::Attendance>> MemoryStorage::listAttendances(
+    const AttendanceQuery &query)
+{
+    auto data = store_.snapshot();
+    auto listing = listingFor<DataSnapshot::AttendanceListing>(query);
+    listing.order = attendanceOrder(query.sortColumn);
+    auto page = pageOf(data->listAttendances(query.filter, listing), query);
+    if (query.withTotal)
+    {
+        page.total = static_cast<int>(data->countAttendances(query.filter));
+    }
+    co_return page;
+}
+
+drogon::Task<std::optional<models::Attendance>> MemoryStorage::getAttendance(int id)
+{
+    co_return store_.getAttendanceById(id);
+}
+
+drogon::Task<int> MemoryStorage::addAttendances(std::vector<models::Attendance> &attendances)
+{
+    int count = store_.addAttendances(attendances);
+    if (count > 0)
+    {
+        co_await waitDurable();
+    }
+    co_return count;
+}
+
+drogon::Task<bool> MemoryStorage::updateAttendance(int id,
+                                                   std::optional<utils::StatusCode> status,
+                                                   const std::string &remark)
+{
+    if (!store_.updateAttendance(id, status, remark))
+    {
+        co_return false;
+    }
+    co_await waitDurable();
+    co_return true;
+}
+
+drogon::Task<bool> MemoryStorage::deleteAttendance(int id)
+{
+    if (!store_.deleteAttendance(id))
+    {
+        co_return false;
+    }
+    co_await waitDurable();
+    co_return true;
+}
+
+drogon::Task<std::vector<models::ClassSize>> MemoryStorage::classSizes()
+{
+    co_return store_.getClassSizes();
+}
+
+drogon::Task<std::optional<std::vector<models::Student>>> MemoryStorage::classStudents(
+    const std::string &className)
+{
+    co_return store_.findClassStudents(className);
+}
+
+std::shared_ptr<const models::DataSnapshot> MemoryStorage::snapshot()
+{
+    return store_.snapshot();
+}
+
+std::shared_ptr<const models::DataSnapshot> MemoryStorage::snapshot(const ReportScope &)
+{
+    return store_.snapshot();
+}
+
+std::vector<StudentSummary> MemoryStorage::studentSummaries(const std::string &className,
+                                                            std::optional<utils::Date> first,
+                                                            std::optional<utils::Date> last)
+{
+    // Roster and counts from one snapshot, so they agree
+    auto data = store_.snapshot();
+    auto students = className.empty() ? data->getAllStudents()
+                                      : data->getStudentsByClass(className);
+    std::sort(students.begin(), students.end(),
+              [](const models::Student &a, const models::Student &b) {
+                  return a.className != b.className ? a.className < b.className
+                                                    : a.studentId < b.studentId;
+              });
+
+    std::vector<std::string> studentIds;
+    studentIds.reserve(students.size());
+    for (const auto &student : students)
+    {
+        studentIds.push_back(student.studentId);
+    }
+    auto histograms = data->studentHistograms(studentIds, className, first, last);
+
+    std::vector<StudentSummary> summaries(students.size());
+    for (size_t i = 0; i < students.size(); ++i)
+    {
+        summaries[i].student = std::move(students[i]);
+        if (i < histograms.size())
+        {
+            summaries[i].histogram = histograms[i];
+        }
+    }
+    return summaries;
+}
+
+uint64_t MemoryStorage::generation() const
+{
+    return store_.generation();
+}
+
+uint64_t MemoryStorage::attendanceGeneration(const std::string &className,
+                                             std::optional<utils::Date> first,
+                                             std::optional<utils::Date> last) const
+{
+    return store_.attendanceGeneration(className, first, last);
+}
+
+uint64_t MemoryStorage::rosterGeneration(const std::string &className) const
+{
+    return store_.rosterGeneration(className);
+}
+
+}  // namespace db
+}  // namespace student_attendance
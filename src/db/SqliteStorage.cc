@@ -0,0 +1,1126 @@
+#include "student_attendance/db/SqliteStorage.h"
+#include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqlAwait.h"
+#include "student_attendance/db/SqlText.h"
+#include "student_attendance/db/StudentCache.h"
+#include <stdexcept>
+#include <unordered_map>
+#include <drogon/orm/DbClient.h>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+// Filter bits of the student list statement shapes
+enum StudentFilter : uint32_t
+{
+    kByClass = 1u << 0,
+    kByKeyword = 1u << 1,
+    kStudentAfter = 1u << 2,
+};
+
+// Indexed by StudentQuery::Column
+constexpr const char *kStudentColumns[] = {"student_id", "name", "class_name"};
+
+// Filter bits of the attendance list statement shapes, in binding order
+enum AttendanceFilterBit : uint32_t
+{
+    kOfStudent = 1u << 0,
+    kByName = 1u << 1,
+    kInClass = 1u << 2,
+    kOnDate = 1u << 3,
+    kFromDate = 1u << 4,
+    kToDate = 1u << 5,
+    kWithStatus = 1u << 6,
+    kAttendanceAfter = 1u << 7,
+};
+
+// Indexed by AttendanceQuery::Column
+constexpr const char *kAttendanceColumns[] = {"a.id", "a.student_id", "s.name", "a.date"};
+
+constexpr const char *kAttendanceSelect =
+    "SELECT "
+    "  a.id AS id, "
+    "  a.student_id AS student_id, "
+    "  s.name AS name, "
+    "  s.class_name AS class_name, "
+    "  a.date AS date, "
+    "  a.status AS status, "
+    "  a.remark AS remark "
+    "FROM attendances a "
+    "JOIN students s ON a.student_id = s.student_id";
+
+models::Student studentFromRow(const drogon::orm::Row &row)
+{
+    models::Student s;
+    s.studentId = row["student_id"].as<std::string>();
+    s.name = row["name"].as<std::string>();
+    s.className = row["class_name"].as<std::string>();
+    return s;
+}
+
+models::Attendance attendanceFromRow(const drogon::orm::Row &row)
+{
+    models::Attendance a;
+    a.id = row["id"].as<int>();
+    a.studentId = row["student_id"].as<std::string>();
+    a.name = row["name"].as<std::string>();
+    a.className = row["class_name"].as<std::string>();
+    a.date = utils::Date::fromOrdinal(row["date"].as<int>());
+    a.status = utils::AttendanceStatus::fromInt(row["status"].as<int>())
+                   .value_or(utils::StatusCode::Present);
+    a.remark = row["remark"].isNull() ? "" : row["remark"].as<std::string>();
+    return a;
+}
+
+std::string studentWhereSql(uint32_t filters, const StudentQuery &query)
+{
+    std::string sql;
+    const char *keyword = " WHERE ";
+    if (filters & kByClass)
+    {
+        sql += keyword;
+        sql += "class_name = ?";
+        keyword = " AND ";
+    }
+    if (filters & kByKeyword)
+    {
+        sql += keyword;
+        sql += "(student_id LIKE ? OR name LIKE ?)";
+        keyword = " AND ";
+    }
+    if (filters & kStudentAfter)
+    {
+        const char *op = query.descending ? " < " : " > ";
+        sql += keyword;
+        if (query.sortColumn == StudentQuery::ById)
+        {
+            sql += std::string("student_id") + op + "?";
+        }
+        else
+        {
+            sql += std::string("(") + kStudentColumns[query.sortColumn] + ", student_id)" + op +
+                   "(?, ?)";
+        }
+    }
+    return sql;
+}
+
+std::string studentOrderSql(const StudentQuery &query)
+{
+    const char *direction = query.descending ? " DESC" : " ASC";
+    std::string sql = std::string(" ORDER BY ") + kStudentColumns[query.sortColumn] + direction;
+    if (query.sortColumn != StudentQuery::ById)
+    {
+        sql += std::string(", student_id") + direction;
+    }
+    return sql;
+}
+
+std::string attendanceWhereSql(uint32_t filters, const AttendanceQuery &query)
+{
+    static constexpr std::pair<AttendanceFilterBit, const char *> kConditions[] = {
+        {kOfStudent, "a.student_id = ?"},
+        {kByName, "s.name LIKE ?"},
+        {kInClass, "s.class_name = ?"},
+        {kOnDate, "a.date = ?"},
+        {kFromDate, "a.date >= ?"},
+        {kToDate, "a.date <= ?"},
+        {kWithStatus, "a.status = ?"},
+    };
+
+    std::string sql;
+    const char *keyword = " WHERE ";
+    for (const auto &[bit, condition] : kConditions)
+    {
+        if (filters & bit)
+        {
+            sql += keyword;
+            sql += condition;
+            keyword = " AND ";
+        }
+    }
+    if (filters & kAttendanceAfter)
+    {
+        const char *op = query.descending ? " < " : " > ";
+        sql += keyword;
+        if (query.sortColumn == AttendanceQuery::ById)
+        {
+            sql += std::string("a.id") + op + "?";
+        }
+        else
+        {
+            sql += std::string("(") + kAttendanceColumns[query.sortColumn] + ", a.id)" + op +
+                   "(?, ?)";
+        }
+    }
+    return sql;
+}
+
+// The attendanceWhereSql() bits for `filter`, and their arguments. Integer
+// arguments are bound after the text ones, so their conditions come last in
+// attendanceWhereSql().
+uint32_t attendanceFilterArgs(const models::AttendanceFilter &filter,
+                              std::vector<std::string> &args,
+                              std::vector<int> &intArgs)
+{
+    uint32_t filters = 0;
+    if (!filter.studentId.empty())
+    {
+        filters |= kOfStudent;
+        args.push_back(filter.studentId);
+    }
+    if (!filter.name.empty())
+    {
+        filters |= kByName;
+        args.push_back("%" + filter.name + "%");
+    }
+    if (!filter.className.empty())
+    {
+        filters |= kInClass;
+        args.push_back(filter.className);
+    }
+    if (filter.date)
+    {
+        filters |= kOnDate;
+        intArgs.push_back(filter.date->ordinal());
+    }
+    if (filter.startDate)
+    {
+        filters |= kFromDate;
+        intArgs.push_back(filter.startDate->ordinal());
+    }
+    if (filter.endDate)
+    {
+        filters |= kToDate;
+        intArgs.push_back(filter.endDate->ordinal());
+    }
+    if (filter.status)
+    {
+        filters |= kWithStatus;
+        intArgs.push_back(static_cast<int>(*filter.status));
+    }
+    return filters;
+}
+
+std::string attendanceOrderSql(const AttendanceQuery &query)
+{
+    const char *direction = query.descending ? " DESC" : " ASC";
+    std::string sql =
+        std::string(" ORDER BY ") + kAttendanceColumns[query.sortColumn] + direction;
+    if (query.sortColumn != AttendanceQuery::ById)
+    {
+        sql += std::string(", a.id") + direction;
+    }
+    return sql;
+}
+
+const std::string &studentByIdSql()
+{
+    return SqlText::getInstance().get(SqlText::shape(QueryId::StudentById), [] {
+        return std::string("SELECT student_id, name, class_name FROM students WHERE student_id = ?");
+    });
+}
+
+// The student from the roster cache. Queries the table only when the
+// roster cannot be loaded; throws DrogonDbException if that query fails.
+drogon::Task<std::optional<models::Student>> findStudent(const drogon::orm::DbClientPtr &client,
+                                                         const std::string &studentId)
+{
+    auto &cache = StudentCache::getInstance();
+    std::optional<models::Student> student;
+    bool cached = cache.lookup(studentId, student);
+    if (!cached)
+    {
+        bool loaded = co_await cache.load(client);
+        cached = loaded && cache.lookup(studentId, student);
+    }
+    if (cached)
+    {
+        co_return student;
+    }
+
+    auto r = co_await client->execSqlCoro(studentByIdSql(), studentId);
+    if (!r.empty())
+    {
+        co_return studentFromRow(r[0]);
+    }
+    co_return std::nullopt;
+}
+
+// The class and day of a record, for the generations its update stamps.
+// Neither changes while the record exists.
+drogon::Task<std::optional<std::pair<std::string, utils::Date>>> findCell(
+    const drogon::orm::DbClientPtr &client, int id)
+{
+    auto r = co_await client->execSqlCoro(
+        "SELECT s.class_name AS class_name, a.date AS date "
+        "FROM attendances a "
+        "JOIN students s ON a.student_id = s.student_id "
+        "WHERE a.id = ?",
+        id);
+    if (r.empty())
+    {
+        co_return std::nullopt;
+    }
+    co_return std::make_pair(r[0]["class_name"].as<std::string>(),
+                             utils::Date::fromOrdinal(r[0]["date"].as<int>()));
+}
+
+// The students and records of a report scope, as a view
+drogon::Task<std::shared_ptr<const models::DataSnapshot>> readScope(
+    drogon::orm::DbClientPtr client, const ReportScope &scope, uint64_t generation)
+{
+    const auto &filter = scope.filter;
+    std::vector<models::Student> students;
+    if (scope.students)
+    {
+        auto add = [&](const drogon::orm::Result &r) {
+            students.reserve(r.size());
+            for (const auto &row : r)
+            {
+                auto student = studentFromRow(row);
+                if (filter.className.empty() || student.className == filter.className)
+                {
+                    students.push_back(std::move(student));
+                }
+            }
+        };
+        if (!filter.studentId.empty())
+        {
+            add(co_await client->execSqlCoro(studentByIdSql(), filter.studentId));
+        }
+        else if (!filter.className.empty())
+        {
+            add(co_await client->execSqlCoro(
+                "SELECT student_id, name, class_name FROM students WHERE class_name = ?",
+                filter.className));
+        }
+        else
+        {
+            add(co_await client->execSqlCoro(
+                "SELECT student_id, name, class_name FROM students"));
+        }
+    }
+
+    std::vector<models::Attendance> attendances;
+    if (scope.attendances)
+    {
+        std::vector<std::string> args;
+        std::vector<int> intArgs;
+        uint32_t filters = attendanceFilterArgs(filter, args, intArgs);
+        const auto &sql = SqlText::getInstance().get(
+            SqlText::shape(QueryId::AttendanceScan, filters), [filters] {
+                return kAttendanceSelect + attendanceWhereSql(filters, AttendanceQuery{}) +
+                       " ORDER BY a.id";
+            });
+        auto binder = (*client) << sql;
+        for (const auto &arg : args)
+        {
+            binder << arg;
+        }
+        for (int arg : intArgs)
+        {
+            binder << arg;
+        }
+        auto r = co_await execBinderCoro(std::move(binder));
+        attendances.reserve(r.size());
+        for (const auto &row : r)
+        {
+            attendances.push_back(attendanceFromRow(row));
+        }
+    }
+    co_return models::DataSnapshot::fromRecords(students, attendances, generation);
+}
+
+// Every student of the class with their status counts over the range, from
+// one aggregate query; students without records come out of the LEFT JOIN
+// with a NULL status.
+drogon::Task<std::vector<StudentSummary>> summarize(drogon::orm::DbClientPtr client,
+                                                    const std::string &className,
+                                                    std::optional<utils::Date> first,
+                                                    std::optional<utils::Date> last)
+{
+    uint32_t filters = 0;
+    if (first)
+        filters |= kFromDate;
+    if (last)
+        filters |= kToDate;
+    if (!className.empty())
+        filters |= kInClass;
+    const auto &sql = SqlText::getInstance().get(
+        SqlText::shape(QueryId::StudentSummary, filters), [filters] {
+            std::string text =
+                "SELECT s.student_id AS student_id, s.name AS name, "
+                "  s.class_name AS class_name, a.status AS status, COUNT(a.id) AS cnt "
+                "FROM students s "
+                "LEFT JOIN attendances a ON a.student_id = s.student_id";
+            if (filters & kFromDate)
+                text += " AND a.date >= ?";
+            if (filters & kToDate)
+                text += " AND a.date <= ?";
+            if (filters & kInClass)
+                text += " WHERE s.class_name = ?";
+            return text +
+                   " GROUP BY s.student_id, a.status ORDER BY s.class_name, s.student_id";
+        });
+    auto binder = (*client) << sql;
+    if (first)
+        binder << first->ordinal();
+    if (last)
+        binder << last->ordinal();
+    if (!className.empty())
+        binder << className;
+    auto r = co_await execBinderCoro(std::move(binder));
+
+    std::vector<StudentSummary> summaries;
+    for (const auto &row : r)
+    {
+        auto studentId = row["student_id"].as<std::string>();
+        if (summaries.empty() || summaries.back().student.studentId != studentId)
+        {
+            summaries.push_back({studentFromRow(row), {}});
+        }
+        if (row["status"].isNull())
+        {
+            continue;
+        }
+        auto status = utils::AttendanceStatus::fromInt(row["status"].as<int>());
+        if (status)
+        {
+            summaries.back().histogram[static_cast<size_t>(*status)] += row["cnt"].as<int>();
+        }
+    }
+    co_return summaries;
+}
+
+}  // namespace
+
+drogon::Task<Page<models::Student>> SqliteStorage::listStudents(const StudentQuery &query)
+{
+    Page<models::Student> page;
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client || query.sortColumn >= StudentQuery::kColumns)
+    {
+        page.total = query.withTotal ? 0 : -1;
+        co_return page;
+    }
+
+    try
+    {
+        uint32_t filters = 0;
+        std::vector<std::string> stringArgs;
+        if (!query.className.empty())
+        {
+            filters |= kByClass;
+            stringArgs.push_back(query.className);
+        }
+        if (!query.keyword.empty())
+        {
+            filters |= kByKeyword;
+            std::string pattern = "%" + query.keyword + "%";
+            stringArgs.push_back(pattern);
+            stringArgs.push_back(pattern);
+        }
+
+        auto &sqlText = SqlText::getInstance();
+
+        // The total covers the whole filtered listing, so it ignores paging
+        if (query.withTotal)
+        {
+            const auto &countSql = sqlText.get(
+                SqlText::shape(QueryId::StudentCount, filters), [filters, &query] {
+                    return "SELECT COUNT(1) AS cnt FROM students" +
+                           studentWhereSql(filters, query);
+                });
+            auto binder = (*client) << countSql;
+            for (const auto &arg : stringArgs)
+            {
+                binder << arg;
+            }
+            auto r = co_await execBinderCoro(std::move(binder));
+            page.total = r.empty() ? 0 : r[0]["cnt"].as<int>();
+        }
+
+        if (query.after)
+        {
+            filters |= kStudentAfter;
+        }
+
+        // One row past the page tells whether another page follows
+        const auto &querySql = sqlText.get(
+            SqlText::shape(QueryId::StudentPage, filters, query.sortColumn,
+                                  query.descending),
+            [filters, &query] {
+                return "SELECT student_id, name, class_name FROM students" +
+                       studentWhereSql(filters, query) + studentOrderSql(query) +
+                       " LIMIT ? OFFSET ?";
+            });
+
+        auto binder = (*client) << querySql;
+        for (const auto &arg : stringArgs)
+        {
+            binder << arg;
+        }
+        if (query.after)
+        {
+            if (query.sortColumn == StudentQuery::ByName)
+                binder << query.after->name;
+            else if (query.sortColumn == StudentQuery::ByClass)
+                binder << query.after->className;
+            binder << query.after->studentId;
+        }
+        binder << query.limit + 1 << (query.after ? 0 : query.offset);
+
+        auto r = co_await execBinderCoro(std::move(binder));
+        page.rows.reserve(r.size());
+        for (const auto &row : r)
+        {
+            page.rows.push_back(studentFromRow(row));
+        }
+        if (page.rows.size() > static_cast<size_t>(query.limit))
+        {
+            page.rows.pop_back();
+            page.more = true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return page;
+}
+
+drogon::Task<std::optional<models::Student>> SqliteStorage::getStudent(
+    const std::string &studentId)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return std::nullopt;
+    }
+
+    try
+    {
+        co_return co_await findStudent(client, studentId);
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return std::nullopt;
+}
+
+drogon::Task<bool> SqliteStorage::addStudent(const models::Student &student)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return false;
+    }
+
+    try
+    {
+        const auto &sql = SqlText::getInstance().get(
+            SqlText::shape(QueryId::StudentInsert), [] {
+                return std::string(
+                    "INSERT OR IGNORE INTO students (student_id, name, class_name) "
+                    "VALUES (?, ?, ?)");
+            });
+        auto r = co_await client->execSqlCoro(sql, student.studentId, student.name,
+                                              student.className);
+        if (r.affectedRows() > 0)
+        {
+            StudentCache::getInstance().put(student);
+            rosterWritten({student.className}, false);
+            co_return true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return false;
+}
+
+drogon::Task<int> SqliteStorage::addStudents(const std::vector<models::Student> &students,
+                                             std::vector<bool> &added)
+{
+    added.assign(students.size(), false);
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client || students.empty())
+    {
+        co_return 0;
+    }
+
+    int count = 0;
+    try
+    {
+        const auto &sql = SqlText::getInstance().get(
+            SqlText::shape(QueryId::StudentInsert), [] {
+                return std::string(
+                    "INSERT OR IGNORE INTO students (student_id, name, class_name) "
+                    "VALUES (?, ?, ?)");
+            });
+        // Row by row, to learn which ids were taken; one transaction keeps
+        // that to a single commit
+        auto transaction = co_await client->newTransactionCoro();
+        for (size_t i = 0; i < students.size(); ++i)
+        {
+            const auto &student = students[i];
+            auto r = co_await transaction->execSqlCoro(sql, student.studentId, student.name,
+                                                       student.className);
+            added[i] = r.affectedRows() > 0;
+            count += added[i] ? 1 : 0;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+        added.assign(students.size(), false);
+        count = 0;
+    }
+    catch (const std::exception &)
+    {
+        added.assign(students.size(), false);
+        count = 0;
+    }
+    if (count > 0)
+    {
+        auto &cache = StudentCache::getInstance();
+        std::vector<std::string> classes;
+        for (size_t i = 0; i < students.size(); ++i)
+        {
+            if (added[i])
+            {
+                cache.put(students[i]);
+                classes.push_back(students[i].className);
+            }
+        }
+        rosterWritten(classes, false);
+    }
+    co_return count;
+}
+
+drogon::Task<bool> SqliteStorage::updateStudent(const std::string &studentId,
+                                                const std::string &name,
+                                                const std::string &className)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return false;
+    }
+
+    try
+    {
+        // The class the student leaves
+        auto before = co_await findStudent(client, studentId);
+        if (!before)
+        {
+            co_return false;
+        }
+        auto r = co_await client->execSqlCoro(
+            "UPDATE students "
+            "SET name = COALESCE(NULLIF(?, ''), name), "
+            "    class_name = COALESCE(NULLIF(?, ''), class_name) "
+            "WHERE student_id = ?",
+            name,
+            className,
+            studentId);
+        if (r.affectedRows() > 0)
+        {
+            StudentCache::getInstance().update(studentId, name, className);
+            rosterWritten({before->className, className.empty() ? before->className : className},
+                          true);
+            co_return true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return false;
+}
+
+drogon::Task<bool> SqliteStorage::deleteStudent(const std::string &studentId)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return false;
+    }
+
+    try
+    {
+        auto before = co_await findStudent(client, studentId);
+        if (!before)
+        {
+            co_return false;
+        }
+        // Their records go with them (ON DELETE CASCADE)
+        auto r = co_await client->execSqlCoro("DELETE FROM students WHERE student_id = ?",
+                                              studentId);
+        if (r.affectedRows() > 0)
+        {
+            StudentCache::getInstance().erase(studentId);
+            rosterWritten({before->className}, true);
+            co_return true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return false;
+}
+
+drogon::Task<Page<models::Attendance>> SqliteStorage::listAttendances(
+    const AttendanceQuery &query)
+{
+    Page<models::Attendance> page;
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client || query.sortColumn >= AttendanceQuery::kColumns)
+    {
+        page.total = query.withTotal ? 0 : -1;
+        co_return page;
+    }
+
+    try
+    {
+        std::vector<std::string> args;
+        std::vector<int> intArgs;
+        uint32_t filters = attendanceFilterArgs(query.filter, args, intArgs);
+
+        auto &sqlText = SqlText::getInstance();
+
+        // The total covers the whole filtered listing, so it ignores paging
+        if (query.withTotal)
+        {
+            const auto &countSql = sqlText.get(
+                SqlText::shape(QueryId::AttendanceCount, filters), [filters, &query] {
+                    return "SELECT COUNT(1) AS cnt "
+                           "FROM attendances a "
+                           "JOIN students s ON a.student_id = s.student_id" +
+                           attendanceWhereSql(filters, query);
+                });
+            auto binder = (*client) << countSql;
+            for (const auto &arg : args)
+            {
+                binder << arg;
+            }
+            for (int arg : intArgs)
+            {
+                binder << arg;
+            }
+            auto r = co_await execBinderCoro(std::move(binder));
+            page.total = r.empty() ? 0 : r[0]["cnt"].as<int>();
+        }
+
+        if (query.after)
+        {
+            filters |= kAttendanceAfter;
+        }
+
+        // One row past the page tells whether another page follows
+        const auto &querySql = sqlText.get(
+            SqlText::shape(QueryId::AttendancePage, filters, query.sortColumn,
+                                  query.descending),
+            [filters, &query] {
+                return kAttendanceSelect + attendanceWhereSql(filters, query) +
+                       attendanceOrderSql(query) + " LIMIT ? OFFSET ?";
+            });
+
+        auto binder = (*client) << querySql;
+        for (const auto &arg : args)
+        {
+            binder << arg;
+        }
+        for (int arg : intArgs)
+        {
+            binder << arg;
+        }
+        if (query.after)
+        {
+            switch (query.sortColumn)
+            {
+            case AttendanceQuery::ByStudent:
+                binder << query.after->studentId;
+                break;
+            case AttendanceQuery::ByName:
+                binder << query.after->name;
+                break;
+            case AttendanceQuery::ByDate:
+                binder << query.after->date.ordinal();
+                break;
+            default:
+                break;
+            }
+            binder << query.after->id;
+        }
+        binder << query.limit + 1 << (query.after ? 0 : query.offset);
+
+        auto r = co_await execBinderCoro(std::move(binder));
+        page.rows.reserve(r.size());
+        for (const auto &row : r)
+        {
+            page.rows.push_back(attendanceFromRow(row));
+        }
+        if (page.rows.size() > static_cast<size_t>(query.limit))
+        {
+            page.rows.pop_back();
+            page.more = true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return page;
+}
+
+drogon::Task<std::optional<models::Attendance>> SqliteStorage::getAttendance(int id)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return std::nullopt;
+    }
+
+    try
+    {
+        auto r = co_await client->execSqlCoro(std::string(kAttendanceSelect) +
+                                                  " WHERE a.id = ?",
+                                              id);
+        if (!r.empty())
+        {
+            co_return attendanceFromRow(r[0]);
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return std::nullopt;
+}
+
+drogon::Task<int> SqliteStorage::addAttendances(std::vector<models::Attendance> &attendances)
+{
+    for (auto &att : attendances)
+    {
+        att.id = 0;
+    }
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client || attendances.empty())
+    {
+        co_return 0;
+    }
+
+    int count = 0;
+    try
+    {
+        // Each student is resolved once however many rows name them, from
+        // the roster cache
+        std::unordered_map<std::string, std::optional<models::Student>> students;
+        for (const auto &att : attendances)
+        {
+            auto [it, inserted] = students.try_emplace(att.studentId);
+            if (inserted)
+            {
+                it->second = co_await findStudent(client, att.studentId);
+            }
+        }
+
+        auto transaction = co_await client->newTransactionCoro();
+        for (auto &att : attendances)
+        {
+            const auto &student = students[att.studentId];
+            if (!student)
+            {
+                continue;
+            }
+            att.name = student->name;
+            att.className = student->className;
+            auto r = co_await transaction->execSqlCoro(
+                "INSERT INTO attendances (student_id, date, status, remark) VALUES (?, ?, ?, ?)",
+                att.studentId, att.date.ordinal(), static_cast<int>(att.status), att.remark);
+            att.id = static_cast<int>(r.insertId());
+            ++count;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+        for (auto &att : attendances)
+        {
+            att.id = 0;
+        }
+        count = 0;
+    }
+    catch (const std::exception &)
+    {
+        for (auto &att : attendances)
+        {
+            att.id = 0;
+        }
+        count = 0;
+    }
+    if (count > 0)
+    {
+        std::vector<Cell> cells;
+        cells.reserve(static_cast<size_t>(count));
+        for (const auto &att : attendances)
+        {
+            if (att.id != 0)
+            {
+                cells.emplace_back(att.className, att.date);
+            }
+        }
+        attendancesWritten(cells);
+    }
+    co_return count;
+}
+
+drogon::Task<bool> SqliteStorage::updateAttendance(int id,
+                                                   std::optional<utils::StatusCode> status,
+                                                   const std::string &remark)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return false;
+    }
+
+    try
+    {
+        auto cell = co_await findCell(client, id);
+        if (!cell)
+        {
+            co_return false;
+        }
+        size_t changed = 0;
+        if (status)
+        {
+            auto r = co_await client->execSqlCoro(
+                "UPDATE attendances SET status = ?, remark = ? WHERE id = ?",
+                static_cast<int>(*status), remark, id);
+            changed = r.affectedRows();
+        }
+        else
+        {
+            auto r = co_await client->execSqlCoro(
+                "UPDATE attendances SET remark = ? WHERE id = ?", remark, id);
+            changed = r.affectedRows();
+        }
+        if (changed > 0)
+        {
+            attendancesWritten({*cell});
+            co_return true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return false;
+}
+
+drogon::Task<bool> SqliteStorage::deleteAttendance(int id)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return false;
+    }
+
+    try
+    {
+        auto cell = co_await findCell(client, id);
+        if (!cell)
+        {
+            co_return false;
+        }
+        auto r = co_await client->execSqlCoro("DELETE FROM attendances WHERE id = ?", id);
+        if (r.affectedRows() > 0)
+        {
+            attendancesWritten({*cell});
+            co_return true;
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return false;
+}
+
+drogon::Task<std::vector<models::ClassSize>> SqliteStorage::classSizes()
+{
+    std::vector<models::ClassSize> result;
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return result;
+    }
+
+    try
+    {
+        auto r = co_await client->execSqlCoro(
+            "SELECT class_name, COUNT(1) AS cnt FROM students "
+            "GROUP BY class_name ORDER BY class_name");
+        result.reserve(r.size());
+        for (const auto &row : r)
+        {
+            result.push_back({row["class_name"].as<std::string>(), row["cnt"].as<int>()});
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return result;
+}
+
+drogon::Task<std::optional<std::vector<models::Student>>> SqliteStorage::classStudents(
+    const std::string &className)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return std::nullopt;
+    }
+
+    try
+    {
+        auto r = co_await client->execSqlCoro(
+            "SELECT student_id, name, class_name FROM students "
+            "WHERE class_name = ? ORDER BY student_id",
+            className);
+        if (r.empty())
+        {
+            co_return std::nullopt;
+        }
+        std::vector<models::Student> students;
+        students.reserve(r.size());
+        for (const auto &row : r)
+        {
+            students.push_back(studentFromRow(row));
+        }
+        co_return students;
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+    }
+    catch (const std::exception &)
+    {
+    }
+    co_return std::nullopt;
+}
+
+std::shared_ptr<const models::DataSnapshot> SqliteStorage::snapshot()
+{
+    return nullptr;
+}
+
+std::shared_ptr<const models::DataSnapshot> SqliteStorage::snapshot(const ReportScope &scope)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        throw std::runtime_error("database is not available");
+    }
+    // Read before the tables, so a write committing meanwhile leaves the
+    // view tagged as older than it
+    return drogon::sync_wait(readScope(client, scope, generation()));
+}
+
+std::vector<StudentSummary> SqliteStorage::studentSummaries(const std::string &className,
+                                                            std::optional<utils::Date> first,
+                                                            std::optional<utils::Date> last)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        throw std::runtime_error("database is not available");
+    }
+    return drogon::sync_wait(summarize(client, className, first, last));
+}
+
+uint64_t SqliteStorage::generation() const
+{
+    return writes_.load(std::memory_order_acquire);
+}
+
+uint64_t SqliteStorage::attendanceGeneration(const std::string &className,
+                                             std::optional<utils::Date> first,
+                                             std::optional<utils::Date> last) const
+{
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    return attendanceGenerations_.latest(className, first, last);
+}
+
+uint64_t SqliteStorage::rosterGeneration(const std::string &className) const
+{
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    if (className.empty())
+    {
+        return rosterLatest_;
+    }
+    auto it = rosterGenerations_.find(className);
+    return it == rosterGenerations_.end() ? 0 : it->second;
+}
+
+uint64_t SqliteStorage::nextGeneration()
+{
+    return writes_.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+void SqliteStorage::rosterWritten(const std::vector<std::string> &classes, bool records)
+{
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    auto generation = nextGeneration();
+    for (const auto &className : classes)
+    {
+        rosterGenerations_[className] = generation;
+        if (records)
+        {
+            attendanceGenerations_.touchClass(className, generation);
+        }
+    }
+    rosterLatest_ = generation;
+}
+
+void SqliteStorage::attendancesWritten(const std::vector<Cell> &cells)
+{
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    auto generation = nextGeneration();
+    for (const auto &[className, day] : cells)
+    {
+        attendanceGenerations_.touch(className, day, generation);
+    }
+}
+
+}  // namespace db
+}  // namespace student_attendance
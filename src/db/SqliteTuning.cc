@@ -0,0 +1,139 @@
+#include "student_attendance/db/SqliteTuning.h"
+#include <algorithm>
+#include <cctype>
+#include <type_traits>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+constexpr std::string_view kJournalModes[] = {"DELETE", "TRUNCATE", "PERSIST",
+                                              "MEMORY", "WAL",      "OFF"};
+constexpr std::string_view kSynchronous[] = {"OFF", "NORMAL", "FULL", "EXTRA"};
+constexpr std::string_view kTempStores[] = {"DEFAULT", "FILE", "MEMORY"};
+
+// `value` in upper case when it is one of `allowed`. The values end up in
+// PRAGMA text, so nothing else gets through.
+template <size_t N>
+std::optional<std::string> keyword(const std::string &value,
+                                   const std::string_view (&allowed)[N])
+{
+    std::string upper = value;
+    std::transform(upper.begin(), upper.end(), upper.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    for (auto candidate : allowed)
+    {
+        if (upper == candidate)
+        {
+            return upper;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+std::vector<std::string> SqliteTuning::profileNames()
+{
+    return {"default", "wal", "durable"};
+}
+
+std::optional<SqliteTuning> SqliteTuning::fromProfile(std::string_view name)
+{
+    SqliteTuning tuning;
+    if (name == "wal")
+    {
+        return tuning;
+    }
+    tuning.profile = std::string(name);
+    if (name == "durable")
+    {
+        tuning.synchronous = "FULL";
+        return tuning;
+    }
+    if (name == "default")
+    {
+        tuning.journalMode = "DELETE";
+        tuning.synchronous = "FULL";
+        tuning.mmapSize = 0;
+        tuning.cacheSize = -2000;
+        tuning.tempStore = "DEFAULT";
+        tuning.busyTimeoutMs = 0;
+        return tuning;
+    }
+    return std::nullopt;
+}
+
+std::optional<SqliteTuning> SqliteTuning::fromConfig(const Json::Value &config,
+                                                     std::string &error)
+{
+    auto name = config.get("profile", "wal").asString();
+    auto tuning = fromProfile(name);
+    if (!tuning)
+    {
+        error = "unknown profile \"" + name + "\"";
+        return std::nullopt;
+    }
+
+    auto pick = [&](const char *key, auto &field, const auto &allowed) {
+        if (!config.isMember(key))
+        {
+            return true;
+        }
+        auto value = keyword(config[key].asString(), allowed);
+        if (!value)
+        {
+            error = std::string("bad ") + key + " \"" + config[key].asString() + "\"";
+            return false;
+        }
+        field = *value;
+        return true;
+    };
+    if (!pick("journal_mode", tuning->journalMode, kJournalModes) ||
+        !pick("synchronous", tuning->synchronous, kSynchronous) ||
+        !pick("temp_store", tuning->tempStore, kTempStores))
+    {
+        return std::nullopt;
+    }
+
+    auto number = [&](const char *key, auto &field) {
+        if (!config.isMember(key))
+        {
+            return true;
+        }
+        if (!config[key].isIntegral())
+        {
+            error = std::string(key) + " must be an integer";
+            return false;
+        }
+        field = static_cast<std::decay_t<decltype(field)>>(config[key].asInt64());
+        return true;
+    };
+    if (!number("mmap_size", tuning->mmapSize) || !number("cache_size", tuning->cacheSize) ||
+        !number("busy_timeout", tuning->busyTimeoutMs))
+    {
+        return std::nullopt;
+    }
+    tuning->mmapSize = std::max<int64_t>(tuning->mmapSize, 0);
+    tuning->busyTimeoutMs = std::max(tuning->busyTimeoutMs, 0);
+    return tuning;
+}
+
+std::vector<std::string> SqliteTuning::pragmas() const
+{
+    return {
+        "PRAGMA journal_mode = " + journalMode,
+        "PRAGMA synchronous = " + synchronous,
+        "PRAGMA mmap_size = " + std::to_string(mmapSize),
+        "PRAGMA cache_size = " + std::to_string(cacheSize),
+        "PRAGMA temp_store = " + tempStore,
+        "PRAGMA busy_timeout = " + std::to_string(busyTimeoutMs),
+    };
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,70 @@
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/db/HybridStorage.h"
+#include "student_attendance/db/MemoryStorage.h"
+#include "student_attendance/db/SqliteStorage.h"
+#include <atomic>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+std::atomic<Storage::Backend> selected{Storage::Backend::Hybrid};
+
+}  // namespace
+
+std::optional<Storage::Backend> Storage::parseBackend(std::string_view name)
+{
+    if (name == "memory")
+        return Backend::Memory;
+    if (name == "sqlite")
+        return Backend::Sqlite;
+    if (name == "hybrid")
+        return Backend::Hybrid;
+    return std::nullopt;
+}
+
+const char *Storage::backendName(Backend backend)
+{
+    switch (backend)
+    {
+    case Backend::Memory:
+        return "memory";
+    case Backend::Sqlite:
+        return "sqlite";
+    default:
+        return "hybrid";
+    }
+}
+
+Storage &Storage::current()
+{
+    return of(selected.load(std::memory_order_acquire));
+}
+
+void Storage::select(Backend backend)
+{
+    selected.store(backend, std::memory_order_release);
+}
+
+Storage &Storage::of(Backend backend)
+{
+    static MemoryStorage memory(models::DataStore::getInstance());
+    static SqliteStorage sqlite;
+    static HybridStorage hybrid(models::DataStore::getInstance());
+    switch (backend)
+    {
+    case Backend::Memory:
+        return memory;
+    case Backend::Sqlite:
+        return sqlite;
+    default:
+        return hybrid;
+    }
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,156 @@
+#include "student_attendance/db/StudentCache.h"
+#include <mutex>
+
+namespace student_attendance
+{
+namespace db
+{
+
+drogon::Task<bool> StudentCache::load(drogon::orm::DbClientPtr client)
+{
+    uint64_t version = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (loaded_)
+        {
+            co_return true;
+        }
+        version = version_;
+    }
+    if (!client)
+    {
+        co_return false;
+    }
+
+    std::unordered_map<std::string, models::Student> students;
+    try
+    {
+        auto r = co_await client->execSqlCoro(
+            "SELECT student_id, name, class_name FROM students");
+        students.reserve(r.size());
+        for (const auto &row : r)
+        {
+            auto id = row["student_id"].as<std::string>();
+            students.try_emplace(id, id, row["name"].as<std::string>(),
+                                 row["class_name"].as<std::string>());
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &)
+    {
+        co_return false;
+    }
+    catch (const std::exception &)
+    {
+        co_return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (loaded_)
+    {
+        co_return true;
+    }
+    if (version_ != version)
+    {
+        co_return false;
+    }
+    students_ = std::move(students);
+    loaded_ = true;
+    loads_.fetch_add(1, std::memory_order_relaxed);
+    co_return true;
+}
+
+bool StudentCache::lookup(const std::string &studentId, std::optional<models::Student> &student)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (!loaded_)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    auto it = students_.find(studentId);
+    if (it == students_.end())
+    {
+        student.reset();
+    }
+    else
+    {
+        student = it->second;
+    }
+    return true;
+}
+
+void StudentCache::put(const models::Student &student)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ++version_;
+    if (loaded_)
+    {
+        students_.insert_or_assign(student.studentId, student);
+    }
+}
+
+void StudentCache::update(const std::string &studentId, const std::string &name,
+                          const std::string &className)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ++version_;
+    if (!loaded_)
+    {
+        return;
+    }
+    auto it = students_.find(studentId);
+    if (it == students_.end())
+    {
+        // The table has a row the roster lacks; read it again
+        students_.clear();
+        loaded_ = false;
+        return;
+    }
+    if (!name.empty())
+        it->second.name = name;
+    if (!className.empty())
+        it->second.className = className;
+}
+
+void StudentCache::erase(const std::string &studentId)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ++version_;
+    students_.erase(studentId);
+}
+
+void StudentCache::invalidate()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ++version_;
+    if (loaded_)
+    {
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    students_.clear();
+    loaded_ = false;
+}
+
+StudentCache::Stats StudentCache::stats() const
+{
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.loads = loads_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    stats.students = students_.size();
+    return stats;
+}
+
+void StudentCache::resetStats()
+{
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+    loads_.store(0, std::memory_order_relaxed);
+    invalidations_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace db
+}  // namespace student_attendance
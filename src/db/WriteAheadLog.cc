@@ -0,0 +1,822 @@
+#include "student_attendance/db/WriteAheadLog.h"
+#include "student_attendance/utils/BinaryImage.h"
+#include "student_attendance/utils/PlatformFile.h"
+#include <trantor/net/EventLoop.h>
+#include <trantor/utils/Logger.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+enum class RecordType : uint8_t
+{
+    StudentPut = 1,
+    StudentErased,
+    AttendanceInserted,
+    AttendanceUpdated,
+    AttendanceErased,
+    Cleared
+};
+
+// Snapshot files start with one of these. Version 1 is a stream of
+// records; version 2 is a DataSnapshot image, loaded as blocks from a mapping.
+constexpr char kSnapshotMagic[8] = {'S', 'A', 'S', 'N', 'A', 'P', '0', '2'};
+constexpr char kSnapshotFile[] = "snapshot.bin";
+constexpr char kSnapshotTempFile[] = "snapshot.bin.tmp";
+// Payload size and CRC-32 ahead of every record
+constexpr size_t kRecordHeader = 2 * sizeof(uint32_t);
+
+template <typename T>
+void put(std::string &out, T value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void putString(std::string &out, std::string_view text)
+{
+    put(out, static_cast<uint32_t>(text.size()));
+    out += text;
+}
+
+// Reads fields back in the order they were put, failing once the data runs out
+class Reader
+{
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    bool get(T &value)
+    {
+        if (data_.size() < sizeof(T))
+            return false;
+        std::memcpy(&value, data_.data(), sizeof(T));
+        data_.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    bool getString(std::string &text)
+    {
+        uint32_t size = 0;
+        if (!get(size) || data_.size() < size)
+            return false;
+        text.assign(data_.data(), size);
+        data_.remove_prefix(size);
+        return true;
+    }
+
+    bool getStatus(utils::StatusCode &status)
+    {
+        uint8_t code = 0;
+        if (!get(code) || code >= utils::kStatusCount)
+            return false;
+        status = static_cast<utils::StatusCode>(code);
+        return true;
+    }
+
+    bool getStudent(models::Student &student)
+    {
+        return getString(student.studentId) && getString(student.name) &&
+               getString(student.className);
+    }
+
+    bool getAttendance(models::Attendance &att)
+    {
+        int32_t id = 0;
+        int32_t day = 0;
+        if (!get(id) || !getString(att.studentId) || !getString(att.name) ||
+            !getString(att.className) || !get(day) || !getStatus(att.status) ||
+            !getString(att.remark))
+        {
+            return false;
+        }
+        att.id = id;
+        att.date = utils::Date::fromOrdinal(day);
+        return true;
+    }
+
+    size_t remaining() const { return data_.size(); }
+
+private:
+    std::string_view data_;
+};
+
+void putStudent(std::string &out, const models::Student &student)
+{
+    putString(out, student.studentId);
+    putString(out, student.name);
+    putString(out, student.className);
+}
+
+fs::path segmentPath(const fs::path &dir, uint64_t segment)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "wal-%08llu.log", static_cast<unsigned long long>(segment));
+    return dir / name;
+}
+
+utils::PlatformFile openSegment(const fs::path &dir, uint64_t segment)
+{
+    utils::PlatformFile file;
+    if (!file.open(segmentPath(dir, segment), utils::PlatformFile::Mode::Append))
+    {
+        throw std::runtime_error(file.error());
+    }
+    utils::syncDirectory(dir);
+    return file;
+}
+
+// Segment numbers found in the directory, in order
+std::vector<uint64_t> listSegments(const fs::path &dir)
+{
+    std::vector<uint64_t> segments;
+    for (const auto &entry : fs::directory_iterator(dir))
+    {
+        unsigned long long segment = 0;
+        char tail = 0;
+        auto name = entry.path().filename().string();
+        if (std::sscanf(name.c_str(), "wal-%llu.lo%c", &segment, &tail) == 2 && tail == 'g' &&
+            name.size() == segmentPath("", segment).string().size())
+        {
+            segments.push_back(segment);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+std::string readFile(const fs::path &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("cannot read " + path.string());
+    }
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::string encodeSnapshot(const models::DataSnapshot &data)
+{
+    std::string out(kSnapshotMagic, sizeof(kSnapshotMagic));
+    data.saveImage(out);
+    return out;
+}
+
+// Applies logged changes to the store. Consecutive inserts go in as one batch.
+// A snapshot may already hold some changes logged after its generation, in
+// the shards it copied after they were made; replaying them again is
+// harmless, as inserts the store already holds are skipped and every other
+// change sets a value outright.
+class Replayer
+{
+public:
+    Replayer(models::DataStore &store, uint64_t after) : store_(store), after_(after) {}
+
+    // False when the record does not parse
+    bool apply(std::string_view payload)
+    {
+        Reader reader(payload);
+        uint8_t type = 0;
+        uint64_t generation = 0;
+        if (!reader.get(type) || !reader.get(generation))
+        {
+            return false;
+        }
+        latest_ = std::max(latest_, generation);
+        // Already in the snapshot
+        if (generation <= after_)
+        {
+            return true;
+        }
+
+        if (static_cast<RecordType>(type) == RecordType::AttendanceInserted)
+        {
+            models::Attendance att;
+            if (!reader.getAttendance(att))
+                return false;
+            inserts_.push_back(std::move(att));
+            ++applied_;
+            return true;
+        }
+        flush();
+
+        switch (static_cast<RecordType>(type))
+        {
+        case RecordType::StudentPut:
+        {
+            models::Student student;
+            if (!reader.getStudent(student))
+                return false;
+            if (!store_.addStudent(student))
+            {
+                store_.updateStudent(student.studentId, student);
+            }
+            break;
+        }
+        case RecordType::StudentErased:
+        {
+            std::string studentId;
+            if (!reader.getString(studentId))
+                return false;
+            store_.deleteStudent(studentId);
+            break;
+        }
+        case RecordType::AttendanceUpdated:
+        {
+            int32_t id = 0;
+            uint8_t hasStatus = 0;
+            utils::StatusCode status{};
+            std::string remark;
+            if (!reader.get(id) || !reader.get(hasStatus) || !reader.getStatus(status) ||
+                !reader.getString(remark))
+            {
+                return false;
+            }
+            store_.updateAttendance(id, hasStatus ? std::optional(status) : std::nullopt, remark);
+            break;
+        }
+        case RecordType::AttendanceErased:
+        {
+            int32_t id = 0;
+            if (!reader.get(id))
+                return false;
+            store_.deleteAttendance(id);
+            break;
+        }
+        case RecordType::Cleared:
+            store_.clear();
+            break;
+        default:
+            return false;
+        }
+        ++applied_;
+        return true;
+    }
+
+    void flush()
+    {
+        if (!inserts_.empty())
+        {
+            store_.restoreAttendances(std::move(inserts_));
+            inserts_.clear();
+        }
+    }
+
+    size_t applied() const { return applied_; }
+    uint64_t latest() const { return latest_; }
+
+private:
+    models::DataStore &store_;
+    uint64_t after_;
+    uint64_t latest_ = 0;
+    size_t applied_ = 0;
+    std::vector<models::Attendance> inserts_;
+};
+
+}  // namespace
+
+WriteAheadLog::~WriteAheadLog()
+{
+    close();
+}
+
+bool WriteAheadLog::hasState(const std::string &directory)
+{
+    fs::path dir(directory);
+    std::error_code error;
+    if (!fs::is_directory(dir, error))
+    {
+        return false;
+    }
+    return fs::exists(dir / kSnapshotFile, error) || !listSegments(dir).empty();
+}
+
+WriteAheadLog::RecoveryStats WriteAheadLog::open(const Options &options, models::DataStore &store)
+{
+    close();
+
+    fs::path dir(options.directory);
+    std::error_code error;
+    fs::create_directories(dir, error);
+    if (error)
+    {
+        throw std::runtime_error("cannot create " + dir.string() + ": " + error.message());
+    }
+
+    RecoveryStats stats;
+    uint64_t covered = 0;
+    int nextAttendanceId = 1;
+    if (fs::exists(dir / kSnapshotFile))
+    {
+        utils::MappedFile file;
+        if (!file.map(dir / kSnapshotFile))
+        {
+            throw std::runtime_error(file.error());
+        }
+        // Only the image format is read; anything else is not a snapshot
+        auto text = file.view();
+        if (text.substr(0, sizeof(kSnapshotMagic)) !=
+            std::string_view(kSnapshotMagic, sizeof(kSnapshotMagic)))
+        {
+            throw std::runtime_error("corrupt snapshot");
+        }
+        auto info = store.loadImage(text.substr(sizeof(kSnapshotMagic)));
+        if (!info)
+        {
+            throw std::runtime_error("corrupt snapshot");
+        }
+        stats.students = info->students;
+        stats.attendances = info->attendances;
+        covered = info->generation;
+        nextAttendanceId = info->nextAttendanceId;
+        stats.fromSnapshot = true;
+    }
+    // Without a snapshot the log continues from the store as it is
+
+    auto segments = listSegments(dir);
+    Replayer replayer(store, covered);
+    for (auto segment : segments)
+    {
+        auto text = readFile(segmentPath(dir, segment));
+        std::string_view rest(text);
+        while (!rest.empty())
+        {
+            uint32_t size = 0;
+            uint32_t crc = 0;
+            if (rest.size() < kRecordHeader)
+            {
+                stats.tornTail = true;
+                break;
+            }
+            std::memcpy(&size, rest.data(), sizeof(size));
+            std::memcpy(&crc, rest.data() + sizeof(size), sizeof(crc));
+            auto payload = rest.substr(kRecordHeader, size);
+            if (payload.size() < size || utils::crc32(payload) != crc || !replayer.apply(payload))
+            {
+                stats.tornTail = true;
+                break;
+            }
+            rest.remove_prefix(kRecordHeader + size);
+        }
+        if (stats.tornTail)
+        {
+            if (segment != segments.back())
+            {
+                LOG_ERROR << "Write-ahead log segment " << segment
+                          << " is damaged; later segments are ignored";
+            }
+            break;
+        }
+    }
+    replayer.flush();
+    stats.replayed = replayer.applied();
+    store.restoreCounters(std::max(covered, replayer.latest()), nextAttendanceId);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_ = options;
+        store_ = &store;
+        segment_ = segments.empty() ? 1 : segments.back() + 1;
+        log_ = openSegment(dir, segment_);
+        pending_.clear();
+        appended_ = durable_ = sinceCheckpoint_ = logBytes_ = 0;
+        rotating_ = checkpointDue_ = stopping_ = failed_ = false;
+        stats_ = Stats{};
+        open_ = true;
+    }
+    flusher_ = std::thread([this] { flushLoop(); });
+    checkpointer_ = std::thread([this] { checkpointLoop(); });
+    store.setJournal(this);
+
+    // The recovered state becomes the new base; the replayed log goes
+    checkpoint();
+    return stats;
+}
+
+void WriteAheadLog::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!open_)
+        {
+            return;
+        }
+    }
+    store_->setJournal(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    checkpointWake_.notify_all();
+    flusher_.join();
+    checkpointer_.join();
+
+    std::vector<Waiter> answered;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        log_.close();
+        open_ = false;
+        // Whatever the flusher could not write stays not durable
+        flushed_.notify_all();
+        answered = takeAnsweredWaiters();
+    }
+    resume(answered);
+}
+
+bool WriteAheadLog::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_;
+}
+
+bool WriteAheadLog::waitDurable()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!open_)
+    {
+        return true;
+    }
+    auto target = appended_;
+    flushed_.wait(lock, [this, target] { return !open_ || failed_ || durable_ >= target; });
+    return durable_ >= target;
+}
+
+struct WriteAheadLog::DurableAwaiter
+{
+    WriteAheadLog &log;
+    trantor::EventLoop *loop;
+    bool durable = true;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        std::lock_guard<std::mutex> lock(log.mutex_);
+        if (!log.open_)
+        {
+            return false;
+        }
+        auto target = log.appended_;
+        if (log.failed_ || log.durable_ >= target)
+        {
+            durable = log.durable_ >= target;
+            return false;
+        }
+        log.waiters_.push_back({target, handle, loop, &durable});
+        return true;
+    }
+
+    bool await_resume() const noexcept { return durable; }
+};
+
+drogon::Task<bool> WriteAheadLog::waitDurableCoro()
+{
+    auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    if (!loop)
+    {
+        // Nothing would run the caller again; block instead
+        co_return waitDurable();
+    }
+    co_return co_await DurableAwaiter{*this, loop};
+}
+
+std::vector<WriteAheadLog::Waiter> WriteAheadLog::takeAnsweredWaiters()
+{
+    std::vector<Waiter> answered;
+    auto it = std::partition(waiters_.begin(), waiters_.end(), [this](const Waiter &waiter) {
+        return open_ && !failed_ && durable_ < waiter.target;
+    });
+    for (auto answer = it; answer != waiters_.end(); ++answer)
+    {
+        *answer->durable = durable_ >= answer->target;
+        answered.push_back(*answer);
+    }
+    waiters_.erase(it, waiters_.end());
+    return answered;
+}
+
+void WriteAheadLog::resume(const std::vector<Waiter> &waiters)
+{
+    for (const auto &waiter : waiters)
+    {
+        waiter.loop->queueInLoop([handle = waiter.handle] { handle.resume(); });
+    }
+}
+
+WriteAheadLog::Stats WriteAheadLog::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto stats = stats_;
+    stats.failed = failed_;
+    return stats;
+}
+
+void WriteAheadLog::append()
+{
+    put(pending_, static_cast<uint32_t>(payload_.size()));
+    put(pending_, utils::crc32(payload_));
+    pending_ += payload_;
+    ++appended_;
+    ++stats_.records;
+    sinceCheckpoint_ += kRecordHeader + payload_.size();
+    if (sinceCheckpoint_ >= options_.checkpointBytes && !checkpointDue_)
+    {
+        checkpointDue_ = true;
+        checkpointWake_.notify_one();
+    }
+    wake_.notify_one();
+}
+
+void WriteAheadLog::studentPut(uint64_t generation, const models::Student &student)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::StudentPut);
+    put(payload_, generation);
+    putStudent(payload_, student);
+    append();
+}
+
+void WriteAheadLog::studentErased(uint64_t generation, const std::string &studentId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::StudentErased);
+    put(payload_, generation);
+    putString(payload_, studentId);
+    append();
+}
+
+void WriteAheadLog::attendanceInserted(uint64_t generation, int id,
+                                       const models::Attendance &attendance)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::AttendanceInserted);
+    put(payload_, generation);
+    put(payload_, static_cast<int32_t>(id));
+    putString(payload_, attendance.studentId);
+    putString(payload_, attendance.name);
+    putString(payload_, attendance.className);
+    put(payload_, attendance.date.ordinal());
+    put(payload_, static_cast<uint8_t>(attendance.status));
+    putString(payload_, attendance.remark);
+    append();
+}
+
+void WriteAheadLog::attendanceUpdated(uint64_t generation, int id,
+                                      std::optional<utils::StatusCode> status,
+                                      const std::string &remark)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::AttendanceUpdated);
+    put(payload_, generation);
+    put(payload_, static_cast<int32_t>(id));
+    put(payload_, static_cast<uint8_t>(status.has_value()));
+    put(payload_, static_cast<uint8_t>(status.value_or(utils::StatusCode{})));
+    putString(payload_, remark);
+    append();
+}
+
+void WriteAheadLog::attendanceErased(uint64_t generation, int id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::AttendanceErased);
+    put(payload_, generation);
+    put(payload_, static_cast<int32_t>(id));
+    append();
+}
+
+void WriteAheadLog::cleared(uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_)
+        return;
+    payload_.clear();
+    put(payload_, RecordType::Cleared);
+    put(payload_, generation);
+    append();
+}
+
+// Whatever accumulated while the previous batch was being synced goes out
+// in the next write, under one sync.
+void WriteAheadLog::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [this] { return stopping_ || rotating_ || !pending_.empty(); });
+        if (pending_.empty() && !rotating_)
+        {
+            return;  // Stopping
+        }
+
+        std::string batch;
+        batch.swap(pending_);
+        auto upTo = appended_;
+        bool rotate = rotating_;
+        bool broken = failed_;
+        auto next = segment_ + 1;
+        lock.unlock();
+
+        // Only this thread touches log_ and logBytes_ while the log is open
+        bool ok = !broken;
+        std::string error;
+        if (!batch.empty() && ok)
+        {
+            size_t written = 0;
+            if (!log_.isOpen())
+            {
+                ok = false;
+                error = "no open segment";
+            }
+            else if (!log_.writeAll(batch, &written))
+            {
+                ok = false;
+                error = log_.error();
+                // A torn record would end replay there; cut it off
+                if (written > 0 && !log_.truncate(logBytes_))
+                {
+                    LOG_ERROR << "Write-ahead log could not drop a partial write: "
+                              << log_.error();
+                }
+            }
+            else if (!log_.sync())
+            {
+                // The kernel may have dropped the pages it failed to write,
+                // so a later sync proves nothing about them
+                ok = false;
+                error = log_.error();
+            }
+            else
+            {
+                logBytes_ += batch.size();
+            }
+        }
+        utils::PlatformFile nextLog;
+        if (rotate)
+        {
+            log_.close();
+            if (ok)
+            {
+                try
+                {
+                    nextLog = openSegment(options_.directory, next);
+                }
+                catch (const std::exception &e)
+                {
+                    ok = false;
+                    error = e.what();
+                }
+            }
+        }
+
+        lock.lock();
+        if (!ok && !failed_)
+        {
+            failed_ = true;
+            LOG_ERROR << "Write-ahead log failed, later writes are not durable: " << error;
+        }
+        if (!failed_)
+        {
+            if (!batch.empty())
+            {
+                ++stats_.syncs;
+                stats_.bytes += batch.size();
+            }
+            durable_ = upTo;
+        }
+        if (rotate)
+        {
+            if (nextLog.isOpen())
+            {
+                log_ = std::move(nextLog);
+                logBytes_ = 0;
+                segment_ = next;
+            }
+            rotating_ = false;
+        }
+        flushed_.notify_all();
+        auto answered = takeAnsweredWaiters();
+        if (!answered.empty())
+        {
+            lock.unlock();
+            resume(answered);
+            lock.lock();
+        }
+    }
+}
+
+void WriteAheadLog::checkpointLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        checkpointWake_.wait(lock, [this] { return stopping_ || checkpointDue_; });
+        if (stopping_)
+        {
+            return;
+        }
+        lock.unlock();
+        try
+        {
+            writeCheckpoint();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR << "Snapshot failed: " << e.what();
+        }
+        lock.lock();
+        checkpointDue_ = false;
+    }
+}
+
+void WriteAheadLog::checkpoint()
+{
+    if (isOpen())
+    {
+        writeCheckpoint();
+    }
+}
+
+uint64_t WriteAheadLog::rotate()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ended = segment_;
+    rotating_ = true;
+    sinceCheckpoint_ = 0;
+    wake_.notify_one();
+    flushed_.wait(lock, [this] { return !rotating_; });
+    return ended;
+}
+
+// Every record in the segments ended by rotate() was logged before the
+// snapshot was taken, so the snapshot includes it and they can go.
+void WriteAheadLog::writeCheckpoint()
+{
+    std::lock_guard<std::mutex> guard(checkpointMutex_);
+    {
+        // A failed log stays failed until it is opened again
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (failed_)
+        {
+            throw DurabilityError("write-ahead log has failed");
+        }
+    }
+    auto ended = rotate();
+    auto text = encodeSnapshot(*store_->snapshot());
+
+    fs::path dir(options_.directory);
+    auto temp = dir / kSnapshotTempFile;
+    {
+        utils::PlatformFile file;
+        if (!file.open(temp, utils::PlatformFile::Mode::Truncate) || !file.writeAll(text) ||
+            !file.sync())
+        {
+            throw std::runtime_error(file.error());
+        }
+    }
+    fs::rename(temp, dir / kSnapshotFile);
+    utils::syncDirectory(dir);
+
+    for (auto segment : listSegments(dir))
+    {
+        if (segment <= ended)
+        {
+            fs::remove(segmentPath(dir, segment));
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.checkpoints;
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,341 @@
+#include "student_attendance/db/WriteThrough.h"
+#include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqlAwait.h"
+#include "student_attendance/db/SqlText.h"
+#include "student_attendance/db/StudentCache.h"
+#include <algorithm>
+#include <string>
+#include <drogon/orm/DbClient.h>
+#include <trantor/utils/Logger.h>
+
+namespace student_attendance
+{
+namespace db
+{
+
+namespace
+{
+
+// Rows per multi-row INSERT, keeping the bound parameters well under
+// SQLite's default limit of 999.
+constexpr size_t kStudentRowsPerInsert = 300;
+constexpr size_t kAttendanceRowsPerInsert = 100;
+
+// `prefix` followed by `count` copies of `tuple`, comma separated.
+std::string multiRowInsert(const char *prefix, const char *tuple, size_t count)
+{
+    std::string sql = prefix;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i != 0)
+            sql += ", ";
+        sql += tuple;
+    }
+    return sql;
+}
+
+}  // namespace
+
+drogon::Task<> writeThroughStudents(const std::vector<models::Student> &students)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client || students.empty())
+    {
+        co_return;
+    }
+
+    try
+    {
+        auto transaction = co_await client->newTransactionCoro();
+        auto &sqlText = SqlText::getInstance();
+        for (size_t first = 0; first < students.size(); first += kStudentRowsPerInsert)
+        {
+            auto count = std::min(kStudentRowsPerInsert, students.size() - first);
+            const auto &sql = sqlText.get(
+                SqlText::shape(QueryId::StudentInsertRows, static_cast<uint32_t>(count)),
+                [count] {
+                    return multiRowInsert(
+                        "INSERT OR IGNORE INTO students (student_id, name, class_name) VALUES ",
+                        "(?, ?, ?)", count);
+                });
+
+            auto binder = (*transaction) << sql;
+            for (size_t i = first; i < first + count; ++i)
+            {
+                binder << students[i].studentId << students[i].name << students[i].className;
+            }
+            co_await execBinderCoro(std::move(binder));
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed inserting " << students.size() << " students: "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed inserting " << students.size() << " students: "
+                 << e.what();
+    }
+    // Written around SqliteStorage, which resolves students from the cache
+    StudentCache::getInstance().invalidate();
+}
+
+drogon::Task<> writeThroughAttendances(const std::vector<models::Attendance> &attendances)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return;
+    }
+
+    std::vector<const models::Attendance *> inserted;
+    inserted.reserve(attendances.size());
+    for (const auto &row : attendances)
+    {
+        if (row.id != 0)
+        {
+            inserted.push_back(&row);
+        }
+    }
+    if (inserted.empty())
+    {
+        co_return;
+    }
+
+    try
+    {
+        auto transaction = co_await client->newTransactionCoro();
+        auto &sqlText = SqlText::getInstance();
+        for (size_t first = 0; first < inserted.size(); first += kAttendanceRowsPerInsert)
+        {
+            auto count = std::min(kAttendanceRowsPerInsert, inserted.size() - first);
+            const auto &sql = sqlText.get(
+                SqlText::shape(QueryId::AttendanceInsertRows,
+                                      static_cast<uint32_t>(count)),
+                [count] {
+                    return multiRowInsert(
+                        "INSERT INTO attendances (id, student_id, date, status, remark) VALUES ",
+                        "(?, ?, ?, ?, ?)", count);
+                });
+
+            auto binder = (*transaction) << sql;
+            for (size_t i = first; i < first + count; ++i)
+            {
+                const auto &att = *inserted[i];
+                binder << att.id << att.studentId << att.date.ordinal()
+                       << static_cast<int>(att.status) << att.remark;
+            }
+            co_await execBinderCoro(std::move(binder));
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed inserting " << inserted.size() << " attendance records: "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed inserting " << inserted.size() << " attendance records: "
+                 << e.what();
+    }
+}
+
+drogon::Task<> writeThroughStudentChange(const models::Student &student)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return;
+    }
+
+    try
+    {
+        const auto &sql = SqlText::getInstance().get(
+            SqlText::shape(QueryId::StudentUpsert), [] {
+                return std::string(
+                    "INSERT INTO students (student_id, name, class_name) VALUES (?, ?, ?) "
+                    "ON CONFLICT(student_id) DO UPDATE SET "
+                    "name = excluded.name, class_name = excluded.class_name");
+            });
+        co_await client->execSqlCoro(sql, student.studentId, student.name, student.className);
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed writing student " << student.studentId << ": "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed writing student " << student.studentId << ": "
+                 << e.what();
+    }
+    StudentCache::getInstance().invalidate();
+}
+
+drogon::Task<> writeThroughStudentRemoval(const std::string &studentId)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return;
+    }
+
+    try
+    {
+        co_await client->execSqlCoro("DELETE FROM students WHERE student_id = ?", studentId);
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed deleting student " << studentId << ": "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed deleting student " << studentId << ": " << e.what();
+    }
+    StudentCache::getInstance().invalidate();
+}
+
+drogon::Task<> writeThroughAttendanceChange(int id,
+                                            std::optional<utils::StatusCode> status,
+                                            const std::string &remark)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return;
+    }
+
+    try
+    {
+        if (status)
+        {
+            co_await client->execSqlCoro(
+                "UPDATE attendances SET status = ?, remark = ? WHERE id = ?",
+                static_cast<int>(*status), remark, id);
+        }
+        else
+        {
+            co_await client->execSqlCoro(
+                "UPDATE attendances SET remark = ? WHERE id = ?", remark, id);
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed updating attendance record " << id << ": "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed updating attendance record " << id << ": " << e.what();
+    }
+}
+
+drogon::Task<> writeThroughAttendanceRemoval(int id)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        co_return;
+    }
+
+    try
+    {
+        co_await client->execSqlCoro("DELETE FROM attendances WHERE id = ?", id);
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "SQLite mirror failed deleting attendance record " << id << ": "
+                 << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "SQLite mirror failed deleting attendance record " << id << ": " << e.what();
+    }
+}
+
+bool loadFromMirror(models::DataStore &store)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        return false;
+    }
+
+    std::vector<models::Student> students;
+    std::vector<models::Attendance> attendances;
+    try
+    {
+        auto r = client->execSqlSync("SELECT student_id, name, class_name FROM students");
+        students.reserve(r.size());
+        for (const auto &row : r)
+        {
+            students.emplace_back(row["student_id"].as<std::string>(),
+                                  row["name"].as<std::string>(),
+                                  row["class_name"].as<std::string>());
+        }
+
+        r = client->execSqlSync(
+            "SELECT a.id AS id, a.student_id AS student_id, s.name AS name, "
+            "  s.class_name AS class_name, a.date AS date, a.status AS status, "
+            "  a.remark AS remark "
+            "FROM attendances a JOIN students s ON s.student_id = a.student_id "
+            "ORDER BY a.id");
+        attendances.reserve(r.size());
+        for (const auto &row : r)
+        {
+            attendances.emplace_back(
+                row["id"].as<int>(), row["student_id"].as<std::string>(),
+                row["name"].as<std::string>(), row["class_name"].as<std::string>(),
+                utils::Date::fromOrdinal(row["date"].as<int>()),
+                utils::AttendanceStatus::fromInt(row["status"].as<int>())
+                    .value_or(utils::StatusCode::Present),
+                row["remark"].isNull() ? "" : row["remark"].as<std::string>());
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "Cannot load the store from SQLite: " << e.base().what();
+        return false;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "Cannot load the store from SQLite: " << e.what();
+        return false;
+    }
+
+    store.clear();
+    store.importStudents(students);
+    store.restoreAttendances(std::move(attendances));
+    return true;
+}
+
+void reseedFromMirror(models::DataStore &store)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        return;
+    }
+
+    try
+    {
+        auto r = client->execSqlSync("SELECT COALESCE(MAX(id), 0) AS max_id FROM attendances");
+        if (!r.empty())
+        {
+            store.restoreCounters(0, r[0]["max_id"].as<int>() + 1);
+        }
+    }
+    catch (const drogon::orm::DrogonDbException &e)
+    {
+        LOG_WARN << "Cannot read the largest SQLite attendance id: " << e.base().what();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN << "Cannot read the largest SQLite attendance id: " << e.what();
+    }
+}
+
+}  // namespace db
+}  // namespace student_attendance
@@ -0,0 +1,274 @@
+#include "student_attendance/models/AttendanceAggregates.h"
+#include "student_attendance/utils/BinaryImage.h"
+#include <limits>
+
+namespace student_attendance
+{
+namespace models
+{
+
+namespace
+{
+
+void addInto(StatusHistogram &sum, const StatusHistogram &cell)
+{
+    for (size_t code = 0; code < sum.size(); ++code)
+    {
+        sum[code] += cell[code];
+    }
+}
+
+bool isEmpty(const StatusHistogram &cell)
+{
+    for (int count : cell)
+    {
+        if (count != 0)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+const StatusHistogram *AttendanceAggregates::DayCells::find(int32_t day) const
+{
+    auto bucket = buckets_->find(bucketOf(day));
+    if (bucket == buckets_->end())
+    {
+        return nullptr;
+    }
+    auto it = bucket->second->find(day);
+    return it == bucket->second->end() ? nullptr : &it->second;
+}
+
+void AttendanceAggregates::DayCells::adjust(int32_t day, size_t code, int delta)
+{
+    auto &buckets = buckets_.mutate();
+    auto bucket = buckets.try_emplace(bucketOf(day)).first;
+    auto &cells = bucket->second.mutate();
+    auto it = cells.try_emplace(day).first;
+    it->second[code] += delta;
+    if (isEmpty(it->second))
+    {
+        cells.erase(it);
+        if (cells.empty())
+        {
+            buckets.erase(bucket);
+        }
+    }
+}
+
+void AttendanceAggregates::DayCells::put(int32_t day, const StatusHistogram &cell)
+{
+    buckets_.mutate()[bucketOf(day)].mutate()[day] = cell;
+}
+
+// Days and their histograms as two parallel arrays, in day order
+void AttendanceAggregates::saveCells(utils::ImageWriter &out, const DayCells &cells)
+{
+    std::vector<int32_t> days;
+    std::vector<StatusHistogram> histograms;
+    cells.forEach(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max(),
+                  [&](int32_t day, const StatusHistogram &histogram) {
+                      days.push_back(day);
+                      histograms.push_back(histogram);
+                  });
+    out.putArray(days);
+    out.putArray(histograms);
+}
+
+bool AttendanceAggregates::loadCells(utils::ImageReader &in, DayCells &cells)
+{
+    std::vector<int32_t> days;
+    std::vector<StatusHistogram> histograms;
+    if (!in.getArray(days) || !in.getArray(histograms) || days.size() != histograms.size())
+        return false;
+    for (size_t i = 0; i < days.size(); ++i)
+    {
+        cells.put(days[i], histograms[i]);
+    }
+    return true;
+}
+
+void AttendanceAggregates::add(const std::string &studentId, const std::string &className,
+                               utils::Date day, utils::StatusCode status)
+{
+    auto code = static_cast<size_t>(status);
+    auto &student = students_.mutate(studentId)[className];
+    student.days.adjust(day.ordinal(), code, 1);
+    student.total[code]++;
+    classes_.mutate(className).adjust(day.ordinal(), code, 1);
+    days_.adjust(day.ordinal(), code, 1);
+}
+
+void AttendanceAggregates::remove(const std::string &studentId, const std::string &className,
+                                  utils::Date day, utils::StatusCode status)
+{
+    auto code = static_cast<size_t>(status);
+
+    if (students_.find(studentId) != students_.end())
+    {
+        auto &student = students_.mutate(studentId);
+        auto cells = student.find(className);
+        if (cells != student.end())
+        {
+            cells->second.days.adjust(day.ordinal(), code, -1);
+            cells->second.total[code]--;
+            if (cells->second.days.empty())
+            {
+                student.erase(cells);
+            }
+        }
+        if (student.empty())
+        {
+            students_.erase(studentId);
+        }
+    }
+
+    if (classes_.find(className) != classes_.end())
+    {
+        auto &cells = classes_.mutate(className);
+        cells.adjust(day.ordinal(), code, -1);
+        if (cells.empty())
+        {
+            classes_.erase(className);
+        }
+    }
+
+    days_.adjust(day.ordinal(), code, -1);
+}
+
+void AttendanceAggregates::clear()
+{
+    students_.clear();
+    classes_.clear();
+    days_ = {};
+}
+
+StatusHistogram AttendanceAggregates::day(utils::Date day, const std::string &className) const
+{
+    const DayCells *cells = &days_;
+    if (!className.empty())
+    {
+        auto cls = classes_.find(className);
+        if (cls == classes_.end())
+        {
+            return {};
+        }
+        cells = &cls->second;
+    }
+
+    const auto *cell = cells->find(day.ordinal());
+    return cell ? *cell : StatusHistogram{};
+}
+
+StatusHistogram AttendanceAggregates::student(const std::string &studentId,
+                                              const std::string &className,
+                                              std::optional<utils::Date> first,
+                                              std::optional<utils::Date> last) const
+{
+    StatusHistogram sum{};
+    auto student = students_.find(studentId);
+    if (student == students_.end())
+    {
+        return sum;
+    }
+
+    int32_t firstDay = first ? first->ordinal() : std::numeric_limits<int32_t>::min();
+    int32_t lastDay = last ? last->ordinal() : std::numeric_limits<int32_t>::max();
+    if (!className.empty())
+    {
+        auto cells = student->second.find(className);
+        if (cells != student->second.end())
+        {
+            sum = sumRange(cells->second, firstDay, lastDay);
+        }
+        return sum;
+    }
+
+    for (const auto &[cls, cells] : student->second)
+    {
+        addInto(sum, sumRange(cells, firstDay, lastDay));
+    }
+    return sum;
+}
+
+StatusHistogram AttendanceAggregates::sumRange(const StudentCells &cells,
+                                               int32_t first, int32_t last)
+{
+    if (cells.days.empty())
+    {
+        return {};
+    }
+    // A range covering every recorded day is answered by the running total
+    if (first <= cells.days.firstDay() && cells.days.lastDay() <= last)
+    {
+        return cells.total;
+    }
+
+    StatusHistogram sum{};
+    cells.days.forEach(first, last,
+                       [&sum](int32_t, const StatusHistogram &cell) { addInto(sum, cell); });
+    return sum;
+}
+
+void AttendanceAggregates::saveImage(utils::ImageWriter &out) const
+{
+    out.put(static_cast<uint64_t>(students_.size()));
+    for (const auto &[studentId, classes] : students_)
+    {
+        out.putString(studentId);
+        out.put(static_cast<uint64_t>(classes.size()));
+        for (const auto &[className, cells] : classes)
+        {
+            out.putString(className);
+            out.put(cells.total);
+            saveCells(out, cells.days);
+        }
+    }
+    out.put(static_cast<uint64_t>(classes_.size()));
+    for (const auto &[className, cells] : classes_)
+    {
+        out.putString(className);
+        saveCells(out, cells);
+    }
+    saveCells(out, days_);
+}
+
+bool AttendanceAggregates::loadImage(utils::ImageReader &in)
+{
+    clear();
+    uint64_t count = 0;
+    in.get(count);
+    std::string studentId;
+    std::string className;
+    for (uint64_t i = 0; i < count && in.ok(); ++i)
+    {
+        uint64_t classCount = 0;
+        in.getString(studentId);
+        in.get(classCount);
+        auto &classes = students_.mutate(studentId);
+        for (uint64_t c = 0; c < classCount && in.ok(); ++c)
+        {
+            in.getString(className);
+            auto &cells = classes[className];
+            in.get(cells.total);
+            loadCells(in, cells.days);
+        }
+    }
+    in.get(count);
+    for (uint64_t i = 0; i < count && in.ok(); ++i)
+    {
+        in.getString(className);
+        loadCells(in, classes_.mutate(className));
+    }
+    if (!loadCells(in, days_) || !in.ok())
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace models
+}  // namespace student_attendance
@@ -0,0 +1,757 @@
+#include "student_attendance/models/AttendanceTable.h"
+#include "student_attendance/utils/BinaryImage.h"
+#include <algorithm>
+#include <bit>
+
+namespace student_attendance
+{
+namespace models
+{
+
+namespace
+{
+
+constexpr size_t kCompactMinRows = 1024;
+constexpr size_t kCompactMinRemarkGarbage = 64 * 1024;
+
+// A driving index must cut the table to under 1/kIndexSelectivity of its rows
+// to beat a sequential scan of the columns.
+constexpr size_t kIndexSelectivity = 4;
+// Below this many candidates, verifying rows is cheaper than intersecting.
+constexpr size_t kIntersectMinRows = 64;
+
+template <typename Index, typename Key>
+auto &postingsFor(Index &index, Key key)
+{
+    if (index.size() <= key)
+    {
+        index.resize(static_cast<size_t>(key) + 1);
+    }
+    return index.mutate(key);
+}
+
+// Keeps the rows of `rows` that also appear in `other`; both are ascending.
+template <typename Rows>
+void intersectSorted(std::vector<uint32_t> &rows, const Rows &other)
+{
+    size_t out = 0;
+    auto from = other.begin();
+    for (uint32_t row : rows)
+    {
+        from = std::lower_bound(from, other.end(), row);
+        if (from == other.end())
+        {
+            break;
+        }
+        if (*from == row)
+        {
+            rows[out++] = row;
+        }
+    }
+    rows.resize(out);
+}
+
+void savePool(utils::ImageWriter &out, const StringPool &pool)
+{
+    out.put(static_cast<uint64_t>(pool.size()));
+    for (uint32_t key = 0; key < pool.size(); ++key)
+    {
+        out.putString(pool.value(key));
+    }
+}
+
+// Keys come back as they were, since the pool starts empty
+bool loadPool(utils::ImageReader &in, StringPool &pool)
+{
+    uint64_t count = 0;
+    if (!in.get(count))
+        return false;
+    std::string value;
+    for (uint64_t key = 0; key < count; ++key)
+    {
+        if (!in.getString(value) || pool.intern(value) != key)
+            return false;
+    }
+    return true;
+}
+
+// In putArray() format, so the image reads back the same as from a vector
+template <typename T, size_t ChunkBits>
+void saveColumn(utils::ImageWriter &out, const ChunkedVector<T, ChunkBits> &column)
+{
+    out.beginArray(column.size());
+    column.forEachChunk([&out](const T *values, size_t count) { out.appendArray(values, count); });
+    out.endArray();
+}
+
+template <typename T, size_t ChunkBits>
+bool loadColumn(utils::ImageReader &in, ChunkedVector<T, ChunkBits> &column)
+{
+    std::vector<T> values;
+    if (!in.getArray(values))
+        return false;
+    column.assign(values.data(), values.size());
+    return true;
+}
+
+template <typename Index>
+void savePostings(utils::ImageWriter &out, const Index &index)
+{
+    out.put(static_cast<uint64_t>(index.size()));
+    for (const auto &rows : index)
+    {
+        saveColumn(out, rows);
+    }
+}
+
+template <typename Index>
+bool loadPostings(utils::ImageReader &in, Index &index)
+{
+    uint64_t count = 0;
+    if (!in.get(count) || count > std::numeric_limits<uint32_t>::max())
+        return false;
+    index.resize(count);
+    for (size_t key = 0; key < count; ++key)
+    {
+        if (!loadColumn(in, index.mutate(key)))
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+Attendance AttendanceTable::Row::toAttendance() const
+{
+    return Attendance(id(), studentId(), name(), className(), date(), status(),
+                      std::string(remark()));
+}
+
+void AttendanceTable::Row::writeJson(utils::JsonWriter &json) const
+{
+    json.beginObject()
+        .member("id", id())
+        .member("student_id", studentId())
+        .member("name", name())
+        .member("class", className())
+        .member("date", date().toString())
+        .member("status", utils::AttendanceStatus::toString(status()))
+        .member("status_symbol", utils::AttendanceStatus::getSymbol(status()))
+        .member("remark", remark())
+        .endObject();
+}
+
+void AttendanceTable::indexRow(size_t row)
+{
+    auto rowNumber = static_cast<uint32_t>(row);
+    postingsFor(studentRows_, studentKeys_[row]).push_back(rowNumber);
+    postingsFor(nameRows_, nameKeys_[row]).push_back(rowNumber);
+    postingsFor(classRows_, classKeys_[row]).push_back(rowNumber);
+    dayRows_.mutate(daySlot(days_[row])).push_back(rowNumber);
+    setStatusBit(row, statusCodes_[row], true);
+}
+
+uint32_t AttendanceTable::daySlot(int32_t day)
+{
+    auto it = daySlots_->find(day);
+    if (it != daySlots_->end())
+    {
+        return it->second;
+    }
+    auto slot = static_cast<uint32_t>(dayRows_.size());
+    daySlots_.mutate().emplace(day, slot);
+    dayRows_.push_back({});
+    return slot;
+}
+
+void AttendanceTable::setStatusBit(size_t row, uint8_t code, bool value)
+{
+    if (code == kTombstone)
+    {
+        return;
+    }
+    auto &bitmap = statusBitmaps_[code];
+    size_t word = row / 64;
+    uint64_t mask = uint64_t{1} << (row % 64);
+    if (bitmap.size() <= word)
+    {
+        bitmap.resize(word + 1, 0);
+    }
+
+    bool isSet = (bitmap[word] & mask) != 0;
+    if (value && !isSet)
+    {
+        bitmap.mutate(word) |= mask;
+        ++statusCounts_[code];
+    }
+    else if (!value && isSet)
+    {
+        bitmap.mutate(word) &= ~mask;
+        --statusCounts_[code];
+    }
+}
+
+uint32_t AttendanceTable::intern(StringPool &pool, CopyOnWrite<KeyOrder> &order,
+                                 std::string_view value)
+{
+    size_t known = pool.size();
+    uint32_t key = pool.intern(value);
+    if (pool.size() != known)
+    {
+        order.mutate().emplace(std::string(value), key);
+    }
+    return key;
+}
+
+void AttendanceTable::rebuildIndexes()
+{
+    studentRows_.clear();
+    nameRows_.clear();
+    classRows_.clear();
+    daySlots_ = {};
+    dayRows_.clear();
+    for (auto &bitmap : statusBitmaps_)
+        bitmap.clear();
+    statusCounts_.fill(0);
+
+    for (size_t row = 0; row < ids_.size(); ++row)
+    {
+        indexRow(row);
+    }
+}
+
+int AttendanceTable::insert(const Attendance &attendance)
+{
+    return insert(attendance, nextId_);
+}
+
+int AttendanceTable::insert(const Attendance &attendance, int id)
+{
+    auto statusCode = static_cast<uint8_t>(attendance.status);
+
+    nextId_ = id + 1;
+    ids_.push_back(id);
+    studentKeys_.push_back(intern(studentIds_, studentOrder_, attendance.studentId));
+    nameKeys_.push_back(intern(names_, nameOrder_, attendance.name));
+    classKeys_.push_back(classNames_.intern(attendance.className));
+    days_.push_back(attendance.date.ordinal());
+    statusCodes_.push_back(statusCode);
+    remarkOffsets_.push_back(0);
+    remarkLengths_.push_back(0);
+
+    ++liveRows_;
+    indexRow(ids_.size() - 1);
+    storeRemark(ids_.size() - 1, attendance.remark);
+    return id;
+}
+
+std::optional<Attendance> AttendanceTable::find(int id) const
+{
+    auto row = rowOf(id);
+    if (!row)
+    {
+        return std::nullopt;
+    }
+    return Row(*this, *row).toAttendance();
+}
+
+std::optional<AttendanceTable::Row> AttendanceTable::row(int id) const
+{
+    auto index = rowOf(id);
+    if (!index)
+    {
+        return std::nullopt;
+    }
+    return Row(*this, *index);
+}
+
+bool AttendanceTable::update(int id, std::optional<utils::StatusCode> status,
+                             std::string_view remark)
+{
+    auto row = rowOf(id);
+    if (!row)
+    {
+        return false;
+    }
+    if (status)
+    {
+        auto code = static_cast<uint8_t>(*status);
+        setStatusBit(*row, statusCodes_[*row], false);
+        setStatusBit(*row, code, true);
+        statusCodes_.mutate(*row) = code;
+    }
+    storeRemark(*row, remark);
+    return true;
+}
+
+bool AttendanceTable::erase(int id)
+{
+    auto row = rowOf(id);
+    if (!row)
+    {
+        return false;
+    }
+    setStatusBit(*row, statusCodes_[*row], false);
+    statusCodes_.mutate(*row) = kTombstone;
+    remarkGarbage_ += remarkLengths_[*row];
+    remarkLengths_.mutate(*row) = 0;
+    --liveRows_;
+    maybeCompact();
+    return true;
+}
+
+void AttendanceTable::reserve(size_t rows)
+{
+    ids_.reserve(rows);
+    studentKeys_.reserve(rows);
+    nameKeys_.reserve(rows);
+    classKeys_.reserve(rows);
+    days_.reserve(rows);
+    statusCodes_.reserve(rows);
+    remarkOffsets_.reserve(rows);
+    remarkLengths_.reserve(rows);
+}
+
+void AttendanceTable::clear()
+{
+    ids_.clear();
+    studentKeys_.clear();
+    nameKeys_.clear();
+    classKeys_.clear();
+    days_.clear();
+    statusCodes_.clear();
+    remarkOffsets_.clear();
+    remarkLengths_.clear();
+    remarkBlocks_.clear();
+    remarkSize_ = 0;
+    remarkGarbage_ = 0;
+
+    studentIds_.clear();
+    names_.clear();
+    classNames_.clear();
+
+    studentRows_.clear();
+    nameRows_.clear();
+    classRows_.clear();
+    studentOrder_ = {};
+    nameOrder_ = {};
+    daySlots_ = {};
+    dayRows_.clear();
+    for (auto &bitmap : statusBitmaps_)
+        bitmap.clear();
+    statusCounts_.fill(0);
+
+    liveRows_ = 0;
+    nextId_ = 1;
+}
+
+std::vector<Attendance> AttendanceTable::select(const AttendanceFilter &filter) const
+{
+    std::vector<Attendance> result;
+    scan(filter, [&result](const Row &row) { result.push_back(row.toAttendance()); });
+    return result;
+}
+
+bool AttendanceTable::compile(const AttendanceFilter &filter, Predicate &predicate) const
+{
+    // An equality filter on a value that was never interned cannot match.
+    if (!filter.studentId.empty())
+    {
+        predicate.studentKey = studentIds_.find(filter.studentId);
+        if (!predicate.studentKey)
+            return false;
+    }
+    if (!filter.className.empty())
+    {
+        predicate.classKey = classNames_.find(filter.className);
+        if (!predicate.classKey)
+            return false;
+    }
+    if (filter.status)
+    {
+        predicate.statusCode = static_cast<uint8_t>(*filter.status);
+    }
+
+    if (!filter.name.empty())
+    {
+        predicate.nameMask.resize(names_.size());
+        for (uint32_t key = 0; key < names_.size(); ++key)
+        {
+            predicate.nameMask[key] =
+                names_.value(key).find(filter.name) != std::string::npos;
+        }
+    }
+
+    if (filter.date)
+    {
+        predicate.firstDay = filter.date->ordinal();
+        predicate.lastDay = filter.date->ordinal();
+    }
+    if (filter.startDate)
+    {
+        predicate.firstDay = std::max(predicate.firstDay, filter.startDate->ordinal());
+    }
+    if (filter.endDate)
+    {
+        predicate.lastDay = std::min(predicate.lastDay, filter.endDate->ordinal());
+    }
+    return predicate.firstDay <= predicate.lastDay;
+}
+
+size_t AttendanceTable::count(const AttendanceFilter &filter) const
+{
+    Predicate predicate;
+    if (!compile(filter, predicate))
+    {
+        return 0;
+    }
+    if (!predicate.studentKey && !predicate.classKey && predicate.nameMask.empty() &&
+        !predicate.hasDayRange())
+    {
+        return predicate.statusCode ? statusCounts_[*predicate.statusCode] : liveRows_;
+    }
+
+    size_t rows = 0;
+    scan(filter, [&rows](const Row &) { ++rows; });
+    return rows;
+}
+
+size_t AttendanceTable::estimateRows(const AttendanceFilter &filter) const
+{
+    Predicate predicate;
+    if (!compile(filter, predicate))
+    {
+        return 0;
+    }
+    auto candidates = plan(predicate);
+    return candidates ? candidates->size() : ids_.size();
+}
+
+std::vector<AttendanceTable::Access> AttendanceTable::accessPaths(
+    const Predicate &predicate) const
+{
+    static const Postings kNoRows;
+    auto postings = [](const PostingsIndex &index, uint32_t key) -> const Postings & {
+        return key < index.size() ? index[key] : kNoRows;
+    };
+
+    std::vector<Access> paths;
+    if (predicate.studentKey)
+    {
+        const auto &rows = postings(studentRows_, *predicate.studentKey);
+        paths.push_back({Access::Kind::Postings, rows.size(), &rows});
+    }
+    if (predicate.classKey)
+    {
+        const auto &rows = postings(classRows_, *predicate.classKey);
+        paths.push_back({Access::Kind::Postings, rows.size(), &rows});
+    }
+    if (predicate.singleDay())
+    {
+        auto it = daySlots_->find(predicate.firstDay);
+        const auto &rows = it != daySlots_->end() ? dayRows_[it->second] : kNoRows;
+        paths.push_back({Access::Kind::Postings, rows.size(), &rows});
+    }
+    else if (predicate.hasDayRange())
+    {
+        size_t estimate = 0;
+        auto last = daySlots_->upper_bound(predicate.lastDay);
+        for (auto it = daySlots_->lower_bound(predicate.firstDay); it != last; ++it)
+        {
+            estimate += dayRows_[it->second].size();
+        }
+        paths.push_back({Access::Kind::DayRange, estimate});
+    }
+    if (predicate.statusCode)
+    {
+        paths.push_back({Access::Kind::Status, statusCounts_[*predicate.statusCode]});
+    }
+    return paths;
+}
+
+std::optional<std::vector<uint32_t>> AttendanceTable::plan(const Predicate &predicate) const
+{
+    auto paths = accessPaths(predicate);
+    if (paths.empty())
+    {
+        return std::nullopt;
+    }
+    std::stable_sort(paths.begin(), paths.end(), [](const Access &a, const Access &b) {
+        return a.estimate < b.estimate;
+    });
+
+    const auto &driver = paths.front();
+    if (driver.estimate * kIndexSelectivity >= ids_.size())
+    {
+        return std::nullopt;
+    }
+
+    std::vector<uint32_t> rows;
+    switch (driver.kind)
+    {
+    case Access::Kind::Postings:
+        rows.assign(driver.postings->begin(), driver.postings->end());
+        break;
+    case Access::Kind::DayRange:
+        rows = rowsInDayRange(predicate);
+        break;
+    case Access::Kind::Status:
+        rows = rowsWithStatus(*predicate.statusCode);
+        break;
+    }
+
+    // Narrow the driver with the next most selective posting lists; every
+    // remaining predicate is checked against the columns afterwards.
+    for (size_t i = 1; i < paths.size() && rows.size() >= kIntersectMinRows; ++i)
+    {
+        if (paths[i].kind == Access::Kind::Postings)
+        {
+            intersectSorted(rows, *paths[i].postings);
+        }
+    }
+    return rows;
+}
+
+std::vector<uint32_t> AttendanceTable::rowsInDayRange(const Predicate &predicate) const
+{
+    std::vector<uint32_t> rows;
+    auto last = daySlots_->upper_bound(predicate.lastDay);
+    for (auto it = daySlots_->lower_bound(predicate.firstDay); it != last; ++it)
+    {
+        const auto &dayRows = dayRows_[it->second];
+        rows.insert(rows.end(), dayRows.begin(), dayRows.end());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+std::vector<uint32_t> AttendanceTable::rowsWithStatus(uint8_t code) const
+{
+    std::vector<uint32_t> rows;
+    rows.reserve(statusCounts_[code]);
+    const auto &bitmap = statusBitmaps_[code];
+    for (size_t word = 0; word < bitmap.size(); ++word)
+    {
+        uint64_t bits = bitmap[word];
+        while (bits != 0)
+        {
+            auto bit = static_cast<uint32_t>(std::countr_zero(bits));
+            rows.push_back(static_cast<uint32_t>(word * 64 + bit));
+            bits &= bits - 1;
+        }
+    }
+    return rows;
+}
+
+std::optional<size_t> AttendanceTable::rowOf(int id) const
+{
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end() || *it != id)
+    {
+        return std::nullopt;
+    }
+    auto row = static_cast<size_t>(it - ids_.begin());
+    if (statusCodes_[row] == kTombstone)
+    {
+        return std::nullopt;
+    }
+    return row;
+}
+
+void AttendanceTable::storeRemark(size_t row, std::string_view remark)
+{
+    remarkGarbage_ += remarkLengths_[row];
+    remarkOffsets_.mutate(row) = remarkSize_;
+    remarkLengths_.mutate(row) = static_cast<uint32_t>(remark.size());
+    if (!remark.empty())
+    {
+        if (remarkBlocks_.empty() || remarkBlocks_.back().bytes->size() + remark.size() > kRemarkBlock)
+        {
+            remarkBlocks_.push_back({remarkSize_, {}});
+        }
+        remarkBlocks_.back().bytes.mutate().append(remark);
+        remarkSize_ += remark.size();
+    }
+
+    if (remarkGarbage_ > kCompactMinRemarkGarbage && remarkGarbage_ * 2 > remarkSize_)
+    {
+        compact();
+    }
+}
+
+std::string_view AttendanceTable::remarkAt(size_t row) const
+{
+    uint32_t length = remarkLengths_[row];
+    if (length == 0)
+    {
+        return {};
+    }
+    uint64_t offset = remarkOffsets_[row];
+    auto block = std::upper_bound(remarkBlocks_.begin(), remarkBlocks_.end(), offset,
+                                  [](uint64_t at, const RemarkBlock &b) { return at < b.start; });
+    --block;
+    return std::string_view(*block->bytes).substr(offset - block->start, length);
+}
+
+void AttendanceTable::maybeCompact()
+{
+    size_t deadRows = ids_.size() - liveRows_;
+    if (deadRows >= kCompactMinRows && deadRows * 2 > ids_.size())
+    {
+        compact();
+    }
+}
+
+void AttendanceTable::compact()
+{
+    // Live rows go into fresh columns, leaving any copy of the table intact
+    AttendanceTable live;
+    live.reserve(liveRows_);
+    for (size_t row = 0; row < ids_.size(); ++row)
+    {
+        if (statusCodes_[row] == kTombstone)
+        {
+            continue;
+        }
+        live.ids_.push_back(ids_[row]);
+        live.studentKeys_.push_back(studentKeys_[row]);
+        live.nameKeys_.push_back(nameKeys_[row]);
+        live.classKeys_.push_back(classKeys_[row]);
+        live.days_.push_back(days_[row]);
+        live.statusCodes_.push_back(statusCodes_[row]);
+        live.remarkOffsets_.push_back(0);
+        live.remarkLengths_.push_back(0);
+        live.storeRemark(live.ids_.size() - 1, remarkAt(row));
+    }
+
+    ids_ = std::move(live.ids_);
+    studentKeys_ = std::move(live.studentKeys_);
+    nameKeys_ = std::move(live.nameKeys_);
+    classKeys_ = std::move(live.classKeys_);
+    days_ = std::move(live.days_);
+    statusCodes_ = std::move(live.statusCodes_);
+    remarkOffsets_ = std::move(live.remarkOffsets_);
+    remarkLengths_ = std::move(live.remarkLengths_);
+    remarkBlocks_ = std::move(live.remarkBlocks_);
+    remarkSize_ = live.remarkSize_;
+    remarkGarbage_ = 0;
+
+    rebuildIndexes();
+}
+
+void AttendanceTable::saveImage(utils::ImageWriter &out) const
+{
+    out.put(static_cast<uint64_t>(liveRows_));
+    out.put(static_cast<int64_t>(nextId_));
+    out.put(static_cast<uint64_t>(remarkGarbage_));
+    saveColumn(out, ids_);
+    saveColumn(out, studentKeys_);
+    saveColumn(out, nameKeys_);
+    saveColumn(out, classKeys_);
+    saveColumn(out, days_);
+    saveColumn(out, statusCodes_);
+    saveColumn(out, remarkOffsets_);
+    saveColumn(out, remarkLengths_);
+    // The blocks are back to back, so they make up one blob
+    out.beginArray(remarkSize_);
+    for (const auto &block : remarkBlocks_)
+    {
+        out.appendArray(block.bytes->data(), block.bytes->size());
+    }
+    out.endArray();
+
+    savePool(out, studentIds_);
+    savePool(out, names_);
+    savePool(out, classNames_);
+
+    savePostings(out, studentRows_);
+    savePostings(out, classRows_);
+    out.put(static_cast<uint64_t>(daySlots_->size()));
+    for (const auto &[day, slot] : *daySlots_)
+    {
+        out.put(day);
+        saveColumn(out, dayRows_[slot]);
+    }
+    for (size_t code = 0; code < utils::kStatusCount; ++code)
+    {
+        out.put(static_cast<uint64_t>(statusCounts_[code]));
+        saveColumn(out, statusBitmaps_[code]);
+    }
+}
+
+bool AttendanceTable::loadImage(utils::ImageReader &in)
+{
+    clear();
+    uint64_t liveRows = 0;
+    int64_t nextId = 0;
+    uint64_t remarkGarbage = 0;
+    in.get(liveRows);
+    in.get(nextId);
+    in.get(remarkGarbage);
+    loadColumn(in, ids_);
+    loadColumn(in, studentKeys_);
+    loadColumn(in, nameKeys_);
+    loadColumn(in, classKeys_);
+    loadColumn(in, days_);
+    loadColumn(in, statusCodes_);
+    loadColumn(in, remarkOffsets_);
+    loadColumn(in, remarkLengths_);
+    std::string remarks;
+    in.getBlob(remarks);
+    remarkSize_ = remarks.size();
+    if (!remarks.empty())
+    {
+        remarkBlocks_.push_back({0, CopyOnWrite<std::string>(std::move(remarks))});
+    }
+    if (!in.ok() || !loadPool(in, studentIds_) || !loadPool(in, names_) ||
+        !loadPool(in, classNames_) || !loadPostings(in, studentRows_) ||
+        !loadPostings(in, classRows_))
+    {
+        clear();
+        return false;
+    }
+
+    uint64_t days = 0;
+    in.get(days);
+    for (uint64_t i = 0; i < days && in.ok(); ++i)
+    {
+        int32_t day = 0;
+        in.get(day);
+        loadColumn(in, dayRows_.mutate(daySlot(day)));
+    }
+    for (size_t code = 0; code < utils::kStatusCount && in.ok(); ++code)
+    {
+        uint64_t count = 0;
+        in.get(count);
+        loadColumn(in, statusBitmaps_[code]);
+        statusCounts_[code] = count;
+    }
+
+    // Columns are trusted to be as written (the file is checksummed); only
+    // their lengths are checked
+    size_t rows = ids_.size();
+    if (!in.ok() || studentKeys_.size() != rows || nameKeys_.size() != rows ||
+        classKeys_.size() != rows || days_.size() != rows || statusCodes_.size() != rows ||
+        remarkOffsets_.size() != rows || remarkLengths_.size() != rows || liveRows > rows)
+    {
+        clear();
+        return false;
+    }
+
+    auto &students = studentOrder_.mutate();
+    for (uint32_t key = 0; key < studentIds_.size(); ++key)
+        students.emplace(studentIds_.value(key), key);
+    auto &names = nameOrder_.mutate();
+    for (uint32_t key = 0; key < names_.size(); ++key)
+        names.emplace(names_.value(key), key);
+    for (size_t row = 0; row < rows; ++row)
+        postingsFor(nameRows_, nameKeys_[row]).push_back(static_cast<uint32_t>(row));
+
+    liveRows_ = liveRows;
+    nextId_ = static_cast<int>(nextId);
+    remarkGarbage_ = remarkGarbage;
+    return true;
+}
+
+}  // namespace models
+}  // namespace student_attendance
@@ -0,0 +1,63 @@
+#include "student_attendance/models/ClassRoster.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+void ClassRoster::add(const std::string &className, const std::string &studentId)
+{
+    classes()[className].mutate().insert(studentId);
+}
+
+void ClassRoster::remove(const std::string &className, const std::string &studentId)
+{
+    auto known = classes_->find(className);
+    if (known == classes_->end() || known->second->count(studentId) == 0)
+    {
+        return;
+    }
+    auto cls = classes().find(className);
+    cls->second.mutate().erase(studentId);
+    if (cls->second->empty())
+    {
+        classes().erase(cls);
+    }
+}
+
+int ClassRoster::count(const std::string &className) const
+{
+    auto cls = classes_->find(className);
+    return cls == classes_->end() ? 0 : static_cast<int>(cls->second->size());
+}
+
+const std::set<std::string> *ClassRoster::members(const std::string &className) const
+{
+    auto cls = classes_->find(className);
+    return cls == classes_->end() ? nullptr : &*cls->second;
+}
+
+std::vector<std::string> ClassRoster::names() const
+{
+    std::vector<std::string> result;
+    result.reserve(classes_->size());
+    for (const auto &[className, _] : *classes_)
+    {
+        result.push_back(className);
+    }
+    return result;
+}
+
+std::vector<ClassSize> ClassRoster::sizes() const
+{
+    std::vector<ClassSize> result;
+    result.reserve(classes_->size());
+    for (const auto &[className, members] : *classes_)
+    {
+        result.push_back({className, static_cast<int>(members->size())});
+    }
+    return result;
+}
+
+}  // namespace models
+}  // namespace student_attendance
@@ -0,0 +1,552 @@
+#include "student_attendance/models/DataSnapshot.h"
+#include "student_attendance/utils/BinaryImage.h"
+
+namespace student_attendance
+{
+namespace models
+{
+
+namespace
+{
+
+// Below this many candidate records a listing sorts them rather than walk
+// the shards in order
+constexpr size_t kSortedListingRows = 2048;
+
+template <typename T>
+int compareValues(const T &a, const T &b)
+{
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+// Listing order of students: the order's column, then id
+int compareStudents(const Student &a, const Student &b, DataSnapshot::StudentOrder order)
+{
+    int cmp = 0;
+    switch (order)
+    {
+    case DataSnapshot::StudentOrder::ByName:
+        cmp = a.name.compare(b.name);
+        break;
+    case DataSnapshot::StudentOrder::ByClass:
+        cmp = a.className.compare(b.className);
+        break;
+    default:
+        break;
+    }
+    return cmp != 0 ? cmp : a.studentId.compare(b.studentId);
+}
+
+// Column values of a stored row or of a record, so either compares to the
+// other
+const std::string &studentIdOf(const AttendanceTable::Row &row) { return row.studentId(); }
+const std::string &studentIdOf(const Attendance &record) { return record.studentId; }
+const std::string &nameOf(const AttendanceTable::Row &row) { return row.name(); }
+const std::string &nameOf(const Attendance &record) { return record.name; }
+utils::Date dateOf(const AttendanceTable::Row &row) { return row.date(); }
+utils::Date dateOf(const Attendance &record) { return record.date; }
+int idOf(const AttendanceTable::Row &row) { return row.id(); }
+int idOf(const Attendance &record) { return record.id; }
+
+// Listing order of records: the order's column, then id
+template <typename A, typename B>
+int compareRecords(const A &a, const B &b, AttendanceTable::Order order)
+{
+    int cmp = 0;
+    switch (order)
+    {
+    case AttendanceTable::Order::ByStudent:
+        cmp = studentIdOf(a).compare(studentIdOf(b));
+        break;
+    case AttendanceTable::Order::ByName:
+        cmp = nameOf(a).compare(nameOf(b));
+        break;
+    case AttendanceTable::Order::ByDate:
+        cmp = compareValues(dateOf(a), dateOf(b));
+        break;
+    default:
+        break;
+    }
+    return cmp != 0 ? cmp : compareValues(idOf(a), idOf(b));
+}
+
+bool matchesKeyword(const Student &student, const std::string &keyword)
+{
+    return keyword.empty() || student.studentId.find(keyword) != std::string::npos ||
+           student.name.find(keyword) != std::string::npos;
+}
+
+// Puts the first skip + limit rows in order and keeps the last `limit` of
+// them
+template <typename Row, typename Less>
+void cutPage(std::vector<Row> &rows, size_t skip, size_t limit, Less &&less)
+{
+    skip = std::min(skip, rows.size());
+    auto end = rows.begin() + static_cast<std::ptrdiff_t>(std::min(skip + limit, rows.size()));
+    std::partial_sort(rows.begin(), end, rows.end(), less);
+    rows.erase(end, rows.end());
+    rows.erase(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(skip));
+}
+
+}  // namespace
+
+size_t DataSnapshot::shardOf(std::string_view studentId)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : studentId)
+    {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash % kShards);
+}
+
+std::shared_ptr<const DataSnapshot> DataSnapshot::fromRecords(
+    const std::vector<Student> &students,
+    const std::vector<Attendance> &attendances,
+    uint64_t generation)
+{
+    std::array<std::shared_ptr<StudentMap>, kShards> studentShards;
+    std::array<std::shared_ptr<AttendancePartition>, kShards> attendanceShards;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        studentShards[s] = std::make_shared<StudentMap>();
+        attendanceShards[s] = std::make_shared<AttendancePartition>();
+    }
+
+    auto roster = std::make_shared<ClassRoster>();
+    for (const auto &student : students)
+    {
+        studentShards[shardOf(student.studentId)]->insert(student.studentId, student);
+        roster->add(student.className, student.studentId);
+    }
+    for (const auto &attendance : attendances)
+    {
+        auto &partition = *attendanceShards[shardOf(attendance.studentId)];
+        partition.aggregates.add(attendance.studentId, attendance.className, attendance.date,
+                                 attendance.status);
+        partition.table.insert(attendance, attendance.id);
+    }
+
+    auto view = std::make_shared<DataSnapshot>();
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        view->shards_[s].students = std::move(studentShards[s]);
+        view->shards_[s].attendances = std::move(attendanceShards[s]);
+    }
+    view->roster_ = std::move(roster);
+    view->generation_ = generation;
+    view->nextAttendanceId_ = attendances.empty() ? 1 : attendances.back().id + 1;
+    return view;
+}
+
+std::vector<Student> DataSnapshot::getAllStudents() const
+{
+    std::vector<Student> result;
+    for (const auto &shard : shards_)
+    {
+        for (const auto &[id, student] : *shard.students)
+        {
+            result.push_back(student);
+        }
+    }
+    return result;
+}
+
+std::optional<Student> DataSnapshot::getStudentById(const std::string &studentId) const
+{
+    const auto &students = *shards_[shardOf(studentId)].students;
+    auto it = students.find(studentId);
+    if (it != students.end())
+    {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+std::vector<Student> DataSnapshot::getStudentsByClass(const std::string &className) const
+{
+    std::vector<Student> result;
+    const auto *members = roster_->members(className);
+    if (!members)
+    {
+        return result;
+    }
+    result.reserve(members->size());
+    for (const auto &studentId : *members)
+    {
+        // The roster is copied apart from the shards, so a student moved
+        // or removed meanwhile is left out
+        const auto &students = *shards_[shardOf(studentId)].students;
+        auto it = students.find(studentId);
+        if (it != students.end() && it->second.className == className)
+        {
+            result.push_back(it->second);
+        }
+    }
+    return result;
+}
+
+const std::vector<const Student *> &DataSnapshot::studentsInOrder(const Shard &shard,
+                                                                StudentOrder order) const
+{
+    auto &index = *shard.index;
+    auto o = static_cast<size_t>(order);
+    std::call_once(index.sorted[o], [&] {
+        auto &rows = index.rows[o];
+        rows.reserve(shard.students->size());
+        for (const auto &entry : *shard.students)
+        {
+            rows.push_back(&entry.second);
+        }
+        std::sort(rows.begin(), rows.end(), [order](const Student *a, const Student *b) {
+            return compareStudents(*a, *b, order) < 0;
+        });
+    });
+    return index.rows[o];
+}
+
+std::vector<Student> DataSnapshot::getStudentsAfter(const std::string &afterId,
+                                                    size_t limit) const
+{
+    std::vector<Student> result;
+    if (limit == 0)
+    {
+        return result;
+    }
+
+    // One cursor per shard, past afterId, merged through a min-heap
+    using Cursor = std::pair<std::vector<const Student *>::const_iterator,
+                             std::vector<const Student *>::const_iterator>;
+    std::vector<Cursor> cursors;
+    for (const auto &shard : shards_)
+    {
+        const auto &rows = studentsInOrder(shard, StudentOrder::ById);
+        auto it = std::upper_bound(
+            rows.begin(), rows.end(), afterId,
+            [](const std::string &id, const Student *student) { return id < student->studentId; });
+        if (it != rows.end())
+        {
+            cursors.emplace_back(it, rows.end());
+        }
+    }
+    auto later = [](const Cursor &a, const Cursor &b) {
+        return (*a.first)->studentId > (*b.first)->studentId;
+    };
+    std::make_heap(cursors.begin(), cursors.end(), later);
+    while (!cursors.empty() && result.size() < limit)
+    {
+        std::pop_heap(cursors.begin(), cursors.end(), later);
+        auto &cursor = cursors.back();
+        result.push_back(**cursor.first);
+        if (++cursor.first == cursor.second)
+        {
+            cursors.pop_back();
+        }
+        else
+        {
+            std::push_heap(cursors.begin(), cursors.end(), later);
+        }
+    }
+    return result;
+}
+
+std::vector<Student> DataSnapshot::listStudents(const std::string &className,
+                                                const std::string &keyword,
+                                                const StudentListing &listing) const
+{
+    auto less = [&listing](const Student *a, const Student *b) {
+        int cmp = compareStudents(*a, *b, listing.order);
+        return listing.descending ? cmp > 0 : cmp < 0;
+    };
+    size_t skip = listing.after ? 0 : listing.offset;
+    size_t need = skip + listing.limit;
+    if (listing.limit == 0)
+    {
+        return {};
+    }
+
+    // Whether a student belongs in the listing past `after`
+    auto wanted = [&](const Student &student) {
+        return (className.empty() || student.className == className) &&
+               matchesKeyword(student, keyword) &&
+               (!listing.after || less(listing.after, &student));
+    };
+
+    std::vector<const Student *> rows;
+    if (!className.empty())
+    {
+        const auto *members = roster_->members(className);
+        if (!members)
+        {
+            return {};
+        }
+        // The roster is copied apart from the shards, so a student moved
+        // or removed meanwhile is left out
+        auto visit = [&](const std::string &studentId) {
+            const auto &students = *shards_[shardOf(studentId)].students;
+            auto it = students.find(studentId);
+            if (it != students.end() && wanted(it->second))
+            {
+                rows.push_back(&it->second);
+            }
+        };
+        if (listing.order != StudentOrder::ById)
+        {
+            // A class is small enough to sort
+            for (const auto &studentId : *members)
+                visit(studentId);
+        }
+        else if (!listing.descending)
+        {
+            auto it = listing.after ? members->upper_bound(listing.after->studentId) : members->begin();
+            for (; it != members->end() && rows.size() < need; ++it)
+                visit(*it);
+        }
+        else
+        {
+            auto it = listing.after ? members->lower_bound(listing.after->studentId) : members->end();
+            while (it != members->begin() && rows.size() < need)
+                visit(*--it);
+        }
+    }
+    else
+    {
+        // Up to `need` students from each shard, from a seek past `after`
+        for (const auto &shard : shards_)
+        {
+            const auto &index = studentsInOrder(shard, listing.order);
+            size_t taken = 0;
+            auto take = [&](const Student *student) {
+                if (matchesKeyword(*student, keyword))
+                {
+                    rows.push_back(student);
+                    ++taken;
+                }
+            };
+            auto byOrder = [&listing](const Student *a, const Student *b) {
+                return compareStudents(*a, *b, listing.order) < 0;
+            };
+            if (!listing.descending)
+            {
+                auto it = listing.after
+                              ? std::upper_bound(index.begin(), index.end(), listing.after, byOrder)
+                              : index.begin();
+                for (; it != index.end() && taken < need; ++it)
+                    take(*it);
+            }
+            else
+            {
+                auto it = listing.after
+                              ? std::lower_bound(index.begin(), index.end(), listing.after, byOrder)
+                              : index.end();
+                while (it != index.begin() && taken < need)
+                    take(*--it);
+            }
+        }
+    }
+
+    cutPage(rows, skip, listing.limit, less);
+    std::vector<Student> result;
+    result.reserve(rows.size());
+    for (const auto *student : rows)
+    {
+        result.push_back(*student);
+    }
+    return result;
+}
+
+size_t DataSnapshot::countStudents(const std::string &className, const std::string &keyword) const
+{
+    size_t count = 0;
+    if (!className.empty())
+    {
+        const auto *members = roster_->members(className);
+        if (!members)
+        {
+            return 0;
+        }
+        for (const auto &studentId : *members)
+        {
+            const auto &students = *shards_[shardOf(studentId)].students;
+            auto it = students.find(studentId);
+            count += it != students.end() && it->second.className == className &&
+                     matchesKeyword(it->second, keyword);
+        }
+        return count;
+    }
+    for (const auto &shard : shards_)
+    {
+        if (keyword.empty())
+        {
+            count += shard.students->size();
+            continue;
+        }
+        for (const auto &[id, student] : *shard.students)
+        {
+            count += matchesKeyword(student, keyword);
+        }
+    }
+    return count;
+}
+
+std::vector<Attendance> DataSnapshot::listAttendances(const AttendanceFilter &filter,
+                                                      const AttendanceListing &listing) const
+{
+    auto less = [&listing](const AttendanceTable::Row &a, const AttendanceTable::Row &b) {
+        int cmp = compareRecords(a, b, listing.order);
+        return listing.descending ? cmp > 0 : cmp < 0;
+    };
+    // Whether a row comes after `after` in the listing
+    auto pastAfter = [&listing](const AttendanceTable::Row &row) {
+        int cmp = compareRecords(row, *listing.after, listing.order);
+        return listing.descending ? cmp < 0 : cmp > 0;
+    };
+    size_t skip = listing.after ? 0 : listing.offset;
+    size_t need = skip + listing.limit;
+    if (listing.limit == 0)
+    {
+        return {};
+    }
+
+    size_t candidates = 0;
+    for (const auto &shard : shards_)
+    {
+        candidates += shard.attendances->table.estimateRows(filter);
+    }
+
+    std::vector<AttendanceTable::Row> rows;
+    if (candidates <= kSortedListingRows)
+    {
+        scanAttendances(filter, [&](const AttendanceTable::Row &row) {
+            if (!listing.after || pastAfter(row))
+            {
+                rows.push_back(row);
+            }
+        });
+    }
+    else
+    {
+        // Up to `need` records from each shard, walked in order past `after`
+        for (const auto &shard : shards_)
+        {
+            size_t taken = 0;
+            shard.attendances->table.walk(filter, listing.order, listing.descending, listing.after,
+                                          [&](const AttendanceTable::Row &row) {
+                                              rows.push_back(row);
+                                              return ++taken < need;
+                                          });
+        }
+    }
+
+    cutPage(rows, skip, listing.limit, less);
+    std::vector<Attendance> result;
+    result.reserve(rows.size());
+    for (const auto &row : rows)
+    {
+        result.push_back(row.toAttendance());
+    }
+    return result;
+}
+
+size_t DataSnapshot::countAttendances(const AttendanceFilter &filter) const
+{
+    size_t count = 0;
+    for (const auto &shard : shards_)
+    {
+        count += shard.attendances->table.count(filter);
+    }
+    return count;
+}
+
+size_t DataSnapshot::attendanceCount() const
+{
+    size_t count = 0;
+    for (const auto &shard : shards_)
+    {
+        count += shard.attendances->table.size();
+    }
+    return count;
+}
+
+StatusHistogram DataSnapshot::dailyHistogram(utils::Date day, const std::string &className) const
+{
+    StatusHistogram total{};
+    for (const auto &shard : shards_)
+    {
+        auto counts = shard.attendances->aggregates.day(day, className);
+        for (size_t code = 0; code < total.size(); ++code)
+        {
+            total[code] += counts[code];
+        }
+    }
+    return total;
+}
+
+std::vector<StatusHistogram> DataSnapshot::studentHistograms(
+    const std::vector<std::string> &studentIds,
+    const std::string &className,
+    std::optional<utils::Date> first,
+    std::optional<utils::Date> last) const
+{
+    // Long lists are summed in parallel, each part filling its own slots
+    constexpr size_t kMinStudentsPerPart = 256;
+    std::vector<StatusHistogram> result(studentIds.size());
+    auto &pool = utils::ComputePool::getInstance();
+    size_t parts = pool.partitions(studentIds.size(), kMinStudentsPerPart);
+    pool.parallelFor(parts, [&](size_t part) {
+        size_t end = studentIds.size() * (part + 1) / parts;
+        for (size_t i = studentIds.size() * part / parts; i < end; ++i)
+        {
+            const auto &shard = shards_[shardOf(studentIds[i])];
+            result[i] = shard.attendances->aggregates.student(studentIds[i], className, first, last);
+        }
+    });
+    return result;
+}
+
+// Image layout: generation, next attendance id, then per shard the offset
+// (from the start of the image), size and CRC-32 of its section, then a
+// CRC-32 of all that. Sections follow, each 8-byte aligned.
+void DataSnapshot::saveImage(std::string &out) const
+{
+    const size_t start = out.size();
+    utils::ImageWriter image(out);
+    image.put(generation_);
+    image.put(static_cast<int64_t>(nextAttendanceId_));
+    const size_t directory = out.size();
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        image.put(uint64_t{0});
+        image.put(uint64_t{0});
+        image.put(uint32_t{0});
+        image.put(uint32_t{0});
+    }
+    image.put(uint32_t{0});
+    image.align();
+
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        const size_t begin = out.size();
+        image.put(static_cast<uint64_t>(shards_[s].students->size()));
+        for (const auto &[id, student] : *shards_[s].students)
+        {
+            image.putString(student.studentId);
+            image.putString(student.name);
+            image.putString(student.className);
+        }
+        image.align();
+        shards_[s].attendances->table.saveImage(image);
+        shards_[s].attendances->aggregates.saveImage(image);
+        image.align();
+
+        const size_t entry = directory + s * 24;
+        image.patch(entry, static_cast<uint64_t>(begin - start));
+        image.patch(entry + 8, static_cast<uint64_t>(out.size() - begin));
+        image.patch(entry + 16, utils::crc32(std::string_view(out).substr(begin)));
+    }
+    const size_t header = directory + kShards * 24;
+    image.patch(header, utils::crc32(std::string_view(out).substr(start, header - start)));
+}
+
+}  // namespace models
+}  // namespace student_attendance
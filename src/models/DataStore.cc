@@ -1,11 +1,25 @@
 #include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/BinaryImage.h"
 
 namespace student_attendance
 {
 namespace models
 {
 
-DataStore::DataStore() : nextAttendanceId_(1)
+namespace
+{
+
+using SharedLock = std::shared_lock<std::shared_mutex>;
+using UniqueLock = std::unique_lock<std::shared_mutex>;
+
+bool byAttendanceId(const Attendance &a, const Attendance &b)
+{
+    return a.id < b.id;
+}
+
+}  // namespace
+
+DataStore::DataStore()
 {
     initSampleData();
 }
@@ -26,126 +40,303 @@ void DataStore::initSampleData()
 
     for (const auto &student : sampleStudents)
     {
-        students_[student.studentId] = student;
+        putStudent(shardFor(student.studentId), student);
     }
 
     // Add sample attendances
-    std::vector<std::pair<std::string, std::string>> sampleAttendances = {
-        {"2024001", "present"},
-        {"2024002", "present"},
-        {"2024003", "late"},
-        {"2024004", "absent"},
-        {"2024005", "present"},
-        {"2024006", "sick_leave"},
-        {"2024007", "present"},
-        {"2024008", "personal_leave"}
+    using utils::StatusCode;
+    const auto sampleDate = kSampleDate;
+    std::vector<std::pair<std::string, StatusCode>> sampleAttendances = {
+        {"2024001", StatusCode::Present},
+        {"2024002", StatusCode::Present},
+        {"2024003", StatusCode::Late},
+        {"2024004", StatusCode::Absent},
+        {"2024005", StatusCode::Present},
+        {"2024006", StatusCode::SickLeave},
+        {"2024007", StatusCode::Present},
+        {"2024008", StatusCode::PersonalLeave}
     };
 
     for (const auto &[studentId, status] : sampleAttendances)
     {
-        auto it = students_.find(studentId);
-        if (it != students_.end())
+        auto &shard = shardFor(studentId);
+        auto it = shard.students.find(studentId);
+        if (it != shard.students.end())
         {
             Attendance att;
-            att.id = nextAttendanceId_++;
             att.studentId = studentId;
             att.name = it->second.name;
             att.className = it->second.className;
-            att.date = "12-15";
+            att.date = sampleDate;
             att.status = status;
             att.remark = "";
-            attendances_[att.id] = att;
+            insertAttendance(shard, att, nextGeneration());
         }
     }
 }
 
+void DataStore::putStudent(Shard &shard, const Student &student)
+{
+    std::lock_guard<std::shared_mutex> lock(rosterMutex_);
+    ++shard.studentVersion;
+    auto it = shard.students.find(student.studentId);
+    if (it == shard.students.end())
+    {
+        roster_.add(student.className, student.studentId);
+    }
+    else if (it->second.className != student.className)
+    {
+        roster_.remove(it->second.className, student.studentId);
+        touchRoster(it->second.className);
+        roster_.add(student.className, student.studentId);
+    }
+    shard.students.put(student.studentId, student);
+    auto generation = touchRoster(student.className);
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->studentPut(generation, student);
+    }
+}
+
+void DataStore::eraseStudent(Shard &shard, const std::string &studentId)
+{
+    auto it = shard.students.find(studentId);
+    if (it == shard.students.end())
+    {
+        return;
+    }
+    std::lock_guard<std::shared_mutex> lock(rosterMutex_);
+    ++shard.studentVersion;
+    roster_.remove(it->second.className, studentId);
+    auto generation = touchRoster(it->second.className);
+    shard.students.erase(studentId);
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->studentErased(generation, studentId);
+    }
+}
+
+uint64_t DataStore::nextGeneration()
+{
+    return generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+// Caller holds rosterMutex_ exclusively.
+uint64_t DataStore::touchRoster(const std::string &className)
+{
+    auto generation = nextGeneration();
+    rosterGenerations_[className] = generation;
+    rosterLatest_ = generation;
+    return generation;
+}
+
+void DataStore::touchDay(const std::string &className, utils::Date day, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    attendanceGenerations_.touch(className, day, generation);
+}
+
+// Caller holds every shard lock exclusively.
+void DataStore::clearShards()
+{
+    for (auto &shard : shards_)
+    {
+        shard.students.clear();
+        shard.records.table.clear();
+        shard.records.aggregates.clear();
+        ++shard.studentVersion;
+        ++shard.attendanceVersion;
+    }
+    nextAttendanceId_ = 1;
+    {
+        std::lock_guard<std::shared_mutex> lock(rosterMutex_);
+        roster_.clear();
+        rosterGenerations_.clear();
+        rosterLatest_ = rosterCleared_ = nextGeneration();
+    }
+    auto generation = nextGeneration();
+    {
+        std::lock_guard<std::mutex> lock(generationMutex_);
+        attendanceGenerations_.clear(generation);
+    }
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->cleared(generation);
+    }
+}
+
 std::vector<Student> DataStore::getAllStudents() const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
     std::vector<Student> result;
-    result.reserve(students_.size());
-    for (const auto &[id, student] : students_)
+    for (const auto &shard : shards_)
     {
-        result.push_back(student);
+        SharedLock lock(shard.studentMutex);
+        for (const auto &[id, student] : shard.students)
+        {
+            result.push_back(student);
+        }
     }
     return result;
 }
 
 std::optional<Student> DataStore::getStudentById(const std::string &studentId) const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    auto it = students_.find(studentId);
-    if (it != students_.end())
+    const auto &shard = shardFor(studentId);
+    SharedLock lock(shard.studentMutex);
+    auto it = shard.students.find(studentId);
+    if (it != shard.students.end())
     {
         return it->second;
     }
     return std::nullopt;
 }
 
+std::vector<Student> DataStore::lookupStudents(const std::vector<std::string> &studentIds) const
+{
+    std::array<std::vector<size_t>, kShards> byShard;
+    for (size_t i = 0; i < studentIds.size(); ++i)
+    {
+        byShard[shardOf(studentIds[i])].push_back(i);
+    }
+
+    std::vector<std::optional<Student>> found(studentIds.size());
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (byShard[s].empty())
+            continue;
+        const auto &shard = shards_[s];
+        SharedLock lock(shard.studentMutex);
+        for (size_t i : byShard[s])
+        {
+            auto it = shard.students.find(studentIds[i]);
+            if (it != shard.students.end())
+            {
+                found[i] = it->second;
+            }
+        }
+    }
+
+    std::vector<Student> result;
+    result.reserve(studentIds.size());
+    for (auto &student : found)
+    {
+        if (student)
+        {
+            result.push_back(std::move(*student));
+        }
+    }
+    return result;
+}
+
 bool DataStore::addStudent(const Student &student)
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    if (students_.find(student.studentId) != students_.end())
+    auto &shard = shardFor(student.studentId);
+    UniqueLock lock(shard.studentMutex);
+    if (shard.students.find(student.studentId) != shard.students.end())
     {
         return false;  // Already exists
     }
-    students_[student.studentId] = student;
+    putStudent(shard, student);
     return true;
 }
 
+int DataStore::addStudents(const std::vector<Student> &students, std::vector<bool> &added)
+{
+    added.assign(students.size(), false);
+    std::array<size_t, kShards> perShard{};
+    for (const auto &student : students)
+    {
+        perShard[shardOf(student.studentId)]++;
+    }
+    // In shard order, so concurrent batches cannot deadlock
+    std::vector<UniqueLock> locks;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (perShard[s] == 0)
+            continue;
+        locks.emplace_back(shards_[s].studentMutex);
+    }
+
+    int count = 0;
+    for (size_t i = 0; i < students.size(); ++i)
+    {
+        auto &shard = shardFor(students[i].studentId);
+        if (shard.students.find(students[i].studentId) == shard.students.end())
+        {
+            putStudent(shard, students[i]);
+            added[i] = true;
+            ++count;
+        }
+    }
+    return count;
+}
+
 bool DataStore::updateStudent(const std::string &studentId, const Student &student)
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    auto it = students_.find(studentId);
-    if (it == students_.end())
+    auto &shard = shardFor(studentId);
+    UniqueLock lock(shard.studentMutex);
+    auto it = shard.students.find(studentId);
+    if (it == shard.students.end())
     {
         return false;
     }
-    it->second.name = student.name.empty() ? it->second.name : student.name;
-    it->second.className = student.className.empty() ? it->second.className : student.className;
+    Student updated = it->second;
+    updated.name = student.name.empty() ? updated.name : student.name;
+    updated.className = student.className.empty() ? updated.className : student.className;
+    putStudent(shard, updated);
     return true;
 }
 
 bool DataStore::deleteStudent(const std::string &studentId)
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    return students_.erase(studentId) > 0;
+    auto &shard = shardFor(studentId);
+    UniqueLock lock(shard.studentMutex);
+    if (shard.students.find(studentId) == shard.students.end())
+    {
+        return false;
+    }
+    eraseStudent(shard, studentId);
+    return true;
 }
 
 bool DataStore::studentExists(const std::string &studentId) const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    return students_.find(studentId) != students_.end();
+    const auto &shard = shardFor(studentId);
+    SharedLock lock(shard.studentMutex);
+    return shard.students.find(studentId) != shard.students.end();
 }
 
 std::vector<Student> DataStore::searchStudents(const std::string &keyword,
                                                const std::string &className) const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
     std::vector<Student> result;
 
-    for (const auto &[id, student] : students_)
+    for (const auto &shard : shards_)
     {
-        bool match = true;
-
-        if (!className.empty() && student.className != className)
+        SharedLock lock(shard.studentMutex);
+        for (const auto &[id, student] : shard.students)
         {
-            match = false;
-        }
+            bool match = true;
 
-        if (!keyword.empty())
-        {
-            bool keywordMatch = (student.studentId.find(keyword) != std::string::npos) ||
-                               (student.name.find(keyword) != std::string::npos);
-            if (!keywordMatch)
+            if (!className.empty() && student.className != className)
             {
                 match = false;
             }
-        }
 
-        if (match)
-        {
-            result.push_back(student);
+            if (!keyword.empty())
+            {
+                bool keywordMatch = (student.studentId.find(keyword) != std::string::npos) ||
+                                   (student.name.find(keyword) != std::string::npos);
+                if (!keywordMatch)
+                {
+                    match = false;
+                }
+            }
+
+            if (match)
+            {
+                result.push_back(student);
+            }
         }
     }
 
@@ -154,183 +345,602 @@ std::vector<Student> DataStore::searchStudents(const std::string &keyword,
 
 std::vector<Attendance> DataStore::getAllAttendances() const
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
     std::vector<Attendance> result;
-    result.reserve(attendances_.size());
-    for (const auto &[id, att] : attendances_)
+    for (const auto &shard : shards_)
     {
-        result.push_back(att);
+        SharedLock lock(shard.attendanceMutex);
+        shard.records.table.scan(AttendanceFilter{}, [&result](const AttendanceTable::Row &row) {
+            result.push_back(row.toAttendance());
+        });
     }
+    std::sort(result.begin(), result.end(), byAttendanceId);
     return result;
 }
 
+std::optional<size_t> DataStore::shardOfAttendance(int id) const
+{
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        SharedLock lock(shards_[s].attendanceMutex);
+        if (shards_[s].records.table.row(id))
+        {
+            return s;
+        }
+    }
+    return std::nullopt;
+}
+
+size_t DataStore::attendanceCount() const
+{
+    size_t count = 0;
+    for (const auto &shard : shards_)
+    {
+        SharedLock lock(shard.attendanceMutex);
+        count += shard.records.table.size();
+    }
+    return count;
+}
+
 std::optional<Attendance> DataStore::getAttendanceById(int id) const
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
-    auto it = attendances_.find(id);
-    if (it != attendances_.end())
+    for (const auto &shard : shards_)
     {
-        return it->second;
+        SharedLock lock(shard.attendanceMutex);
+        if (auto attendance = shard.records.table.find(id))
+        {
+            return attendance;
+        }
     }
     return std::nullopt;
 }
 
+int DataStore::insertAttendance(Shard &shard, const Attendance &attendance, uint64_t generation)
+{
+    return insertAttendance(shard, attendance, generation, nextAttendanceId_.fetch_add(1));
+}
+
+int DataStore::insertAttendance(Shard &shard, const Attendance &attendance, uint64_t generation,
+                                int id)
+{
+    ++shard.attendanceVersion;
+    shard.records.aggregates.add(attendance.studentId, attendance.className, attendance.date,
+                                 attendance.status);
+    touchDay(attendance.className, attendance.date, generation);
+    shard.records.table.insert(attendance, id);
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->attendanceInserted(generation, id, attendance);
+    }
+    return id;
+}
+
 int DataStore::addAttendance(const Attendance &attendance)
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
-    Attendance att = attendance;
-    att.id = nextAttendanceId_++;
-    attendances_[att.id] = att;
-    return att.id;
+    auto &shard = shardFor(attendance.studentId);
+    UniqueLock lock(shard.attendanceMutex);
+    return insertAttendance(shard, attendance, nextGeneration());
+}
+
+int DataStore::addAttendances(std::vector<Attendance> &attendances)
+{
+    std::vector<size_t> shardOfRow(attendances.size());
+    std::array<std::vector<size_t>, kShards> byShard;
+    for (size_t i = 0; i < attendances.size(); ++i)
+    {
+        shardOfRow[i] = shardOf(attendances[i].studentId);
+        byShard[shardOfRow[i]].push_back(i);
+    }
+
+    std::vector<bool> known(attendances.size(), false);
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (byShard[s].empty())
+            continue;
+        const auto &shard = shards_[s];
+        SharedLock lock(shard.studentMutex);
+        for (size_t i : byShard[s])
+        {
+            auto it = shard.students.find(attendances[i].studentId);
+            if (it != shard.students.end())
+            {
+                attendances[i].name = it->second.name;
+                attendances[i].className = it->second.className;
+                known[i] = true;
+            }
+        }
+    }
+
+    // Every shard involved stays locked for the batch, so it gets ids in
+    // input order and one generation covers all of it
+    std::vector<UniqueLock> locks;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (byShard[s].empty())
+            continue;
+        locks.emplace_back(shards_[s].attendanceMutex);
+        shards_[s].records.table.reserve(shards_[s].records.table.size() + byShard[s].size());
+    }
+    int inserted = 0;
+    auto generation = nextGeneration();
+    for (size_t i = 0; i < attendances.size(); ++i)
+    {
+        attendances[i].id = 0;
+        if (known[i])
+        {
+            attendances[i].id =
+                insertAttendance(shards_[shardOfRow[i]], attendances[i], generation);
+            ++inserted;
+        }
+    }
+    return inserted;
 }
 
 bool DataStore::updateAttendance(int id, const Attendance &attendance)
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
-    auto it = attendances_.find(id);
-    if (it == attendances_.end())
+    return updateAttendance(id, attendance.status, attendance.remark);
+}
+
+bool DataStore::updateAttendance(int id, std::optional<utils::StatusCode> status,
+                                 const std::string &remark)
+{
+    auto s = shardOfAttendance(id);
+    if (!s)
     {
         return false;
     }
-    if (!attendance.status.empty())
+    auto &shard = shards_[*s];
+    UniqueLock lock(shard.attendanceMutex);
+    // Records never change shard, but this one may be gone by now
+    auto row = shard.records.table.row(id);
+    if (!row)
     {
-        it->second.status = attendance.status;
+        return false;
+    }
+    if (status && *status != row->status())
+    {
+        shard.records.aggregates.remove(row->studentId(), row->className(), row->date(), row->status());
+        shard.records.aggregates.add(row->studentId(), row->className(), row->date(), *status);
+    }
+    // Remarks show in reports too, so any update counts as a change
+    ++shard.attendanceVersion;
+    auto generation = nextGeneration();
+    touchDay(row->className(), row->date(), generation);
+    shard.records.table.update(id, status, remark);
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->attendanceUpdated(generation, id, status, remark);
     }
-    it->second.remark = attendance.remark;
     return true;
 }
 
 bool DataStore::deleteAttendance(int id)
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
-    return attendances_.erase(id) > 0;
+    auto s = shardOfAttendance(id);
+    if (!s)
+    {
+        return false;
+    }
+    auto &shard = shards_[*s];
+    UniqueLock lock(shard.attendanceMutex);
+    auto row = shard.records.table.row(id);
+    if (!row)
+    {
+        return false;
+    }
+    shard.records.aggregates.remove(row->studentId(), row->className(), row->date(), row->status());
+    ++shard.attendanceVersion;
+    auto generation = nextGeneration();
+    touchDay(row->className(), row->date(), generation);
+    shard.records.table.erase(id);
+    if (auto *journal = journal_.load(std::memory_order_acquire))
+    {
+        journal->attendanceErased(generation, id);
+    }
+    return true;
 }
 
-std::vector<Attendance> DataStore::searchAttendances(
-    const std::string &studentId,
-    const std::string &name,
-    const std::string &className,
-    const std::string &date,
-    const std::string &startDate,
-    const std::string &endDate,
-    const std::string &status) const
+std::vector<Attendance> DataStore::searchAttendances(const AttendanceFilter &filter) const
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
+    // One student's records are all in one shard
+    if (!filter.studentId.empty())
+    {
+        const auto &shard = shardFor(filter.studentId);
+        SharedLock lock(shard.attendanceMutex);
+        return shard.records.table.select(filter);
+    }
+
     std::vector<Attendance> result;
+    for (const auto &shard : shards_)
+    {
+        SharedLock lock(shard.attendanceMutex);
+        auto rows = shard.records.table.select(filter);
+        result.insert(result.end(), std::make_move_iterator(rows.begin()),
+                      std::make_move_iterator(rows.end()));
+    }
+    std::sort(result.begin(), result.end(), byAttendanceId);
+    return result;
+}
 
-    for (const auto &[id, att] : attendances_)
-    {
-        bool match = true;
-
-        if (!studentId.empty() && att.studentId != studentId)
-            match = false;
-        if (!name.empty() && att.name.find(name) == std::string::npos)
-            match = false;
-        if (!className.empty() && att.className != className)
-            match = false;
-        if (!date.empty() && att.date != date)
-            match = false;
-        if (!startDate.empty() && att.date < startDate)
-            match = false;
-        if (!endDate.empty() && att.date > endDate)
-            match = false;
-        if (!status.empty() && att.status != status)
-            match = false;
-
-        if (match)
+StatusHistogram DataStore::dailyHistogram(utils::Date day, const std::string &className) const
+{
+    StatusHistogram total{};
+    for (const auto &shard : shards_)
+    {
+        SharedLock lock(shard.attendanceMutex);
+        auto counts = shard.records.aggregates.day(day, className);
+        for (size_t code = 0; code < total.size(); ++code)
         {
-            result.push_back(att);
+            total[code] += counts[code];
         }
     }
-
-    return result;
+    return total;
 }
 
-std::vector<std::string> DataStore::getAllClasses() const
+std::vector<StatusHistogram> DataStore::studentHistograms(
+    const std::vector<std::string> &studentIds,
+    const std::string &className,
+    std::optional<utils::Date> first,
+    std::optional<utils::Date> last) const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    std::unordered_map<std::string, bool> classSet;
-    for (const auto &[id, student] : students_)
+    // Each shard fills the slots of its own students
+    constexpr size_t kMinStudentsForPool = 256;
+    std::vector<StatusHistogram> result(studentIds.size());
+    std::array<std::vector<size_t>, kShards> byShard;
+    for (size_t i = 0; i < studentIds.size(); ++i)
     {
-        classSet[student.className] = true;
+        byShard[shardOf(studentIds[i])].push_back(i);
     }
 
-    std::vector<std::string> result;
-    for (const auto &[className, _] : classSet)
+    auto fillShard = [&](size_t s) {
+        if (byShard[s].empty())
+            return;
+        const auto &shard = shards_[s];
+        SharedLock lock(shard.attendanceMutex);
+        for (size_t i : byShard[s])
+        {
+            result[i] = shard.records.aggregates.student(studentIds[i], className, first, last);
+        }
+    };
+    if (studentIds.size() < kMinStudentsForPool)
+    {
+        for (size_t s = 0; s < kShards; ++s)
+            fillShard(s);
+    }
+    else
     {
-        result.push_back(className);
+        utils::ComputePool::getInstance().parallelFor(kShards, fillShard);
     }
-    std::sort(result.begin(), result.end());
     return result;
 }
 
-std::vector<Student> DataStore::getStudentsByClass(const std::string &className) const
+std::shared_ptr<const DataSnapshot> DataStore::snapshot() const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    std::vector<Student> result;
-    for (const auto &[id, student] : students_)
+    auto current = snapshot_.load();
+    if (current && current->generation() == generation())
     {
-        if (student.className == className)
+        return current;
+    }
+
+    std::lock_guard<std::mutex> publish(snapshotMutex_);
+    current = snapshot_.load();
+    if (current && current->generation() == generation())
+    {
+        return current;
+    }
+    // A write draws its generation under the locks of what it changes and
+    // is in place before it lets them go, so every write up to this one is
+    // in whatever is copied after it
+    auto next = std::make_shared<DataSnapshot>();
+    next->generation_ = generation();
+
+    // One shard at a time; copies share every chunk with the store, so
+    // this costs one pointer per chunk of a shard written since `current`
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        const auto &shard = shards_[s];
+        auto &view = next->shards_[s];
+        SharedLock studentLock(shard.studentMutex);
+        SharedLock attendanceLock(shard.attendanceMutex);
+        if (current && current->shards_[s].studentVersion == shard.studentVersion)
         {
-            result.push_back(student);
+            view.students = current->shards_[s].students;
+            view.index = current->shards_[s].index;
         }
+        else
+        {
+            view.students = std::make_shared<const StudentMap>(shard.students);
+        }
+        if (current && current->shards_[s].attendanceVersion == shard.attendanceVersion)
+        {
+            view.attendances = current->shards_[s].attendances;
+        }
+        else
+        {
+            view.attendances = std::make_shared<const AttendancePartition>(shard.records);
+        }
+        view.studentVersion = shard.studentVersion;
+        view.attendanceVersion = shard.attendanceVersion;
     }
-    return result;
+    {
+        SharedLock rosterLock(rosterMutex_);
+        if (current && current->rosterVersion_ == rosterLatest_)
+        {
+            next->roster_ = current->roster_;
+        }
+        else
+        {
+            next->roster_ = std::make_shared<const ClassRoster>(roster_);
+        }
+        next->rosterVersion_ = rosterLatest_;
+    }
+    // Read last, so it is above every id copied
+    next->nextAttendanceId_ = nextAttendanceId_.load();
+
+    snapshot_.store(next);
+    return next;
 }
 
-int DataStore::getClassStudentCount(const std::string &className) const
+uint64_t DataStore::attendanceGeneration(const std::string &className,
+                                         std::optional<utils::Date> first,
+                                         std::optional<utils::Date> last) const
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
-    int count = 0;
-    for (const auto &[id, student] : students_)
+    std::lock_guard<std::mutex> lock(generationMutex_);
+    return attendanceGenerations_.latest(className, first, last);
+}
+
+uint64_t DataStore::rosterGeneration(const std::string &className) const
+{
+    SharedLock lock(rosterMutex_);
+    if (className.empty())
+    {
+        return rosterLatest_;
+    }
+    auto it = rosterGenerations_.find(className);
+    return it == rosterGenerations_.end() ? rosterCleared_ : it->second;
+}
+
+std::vector<std::string> DataStore::getAllClasses() const
+{
+    SharedLock lock(rosterMutex_);
+    return roster_.names();
+}
+
+std::vector<ClassSize> DataStore::getClassSizes() const
+{
+    SharedLock lock(rosterMutex_);
+    return roster_.sizes();
+}
+
+std::vector<Student> DataStore::getStudentsByClass(const std::string &className) const
+{
+    return findClassStudents(className).value_or(std::vector<Student>());
+}
+
+std::optional<std::vector<Student>> DataStore::findClassStudents(
+    const std::string &className) const
+{
+    std::vector<std::string> studentIds;
     {
-        if (student.className == className)
+        SharedLock lock(rosterMutex_);
+        const auto *members = roster_.members(className);
+        if (!members)
         {
-            count++;
+            return std::nullopt;
         }
+        studentIds.assign(members->begin(), members->end());
     }
-    return count;
+    // Students removed since are left out
+    return lookupStudents(studentIds);
+}
+
+int DataStore::getClassStudentCount(const std::string &className) const
+{
+    SharedLock lock(rosterMutex_);
+    return roster_.count(className);
 }
 
 void DataStore::clear()
 {
+    std::vector<UniqueLock> locks;
+    for (auto &shard : shards_)
     {
-        std::lock_guard<std::mutex> lock(studentMutex_);
-        students_.clear();
-    }
-    {
-        std::lock_guard<std::mutex> lock(attendanceMutex_);
-        attendances_.clear();
-        nextAttendanceId_ = 1;
+        locks.emplace_back(shard.studentMutex);
+        locks.emplace_back(shard.attendanceMutex);
     }
+    clearShards();
 }
 
 void DataStore::importStudents(const std::vector<Student> &students)
 {
-    std::lock_guard<std::mutex> lock(studentMutex_);
+    std::array<bool, kShards> involved{};
     for (const auto &student : students)
     {
-        students_[student.studentId] = student;
+        involved[shardOf(student.studentId)] = true;
+    }
+    std::vector<UniqueLock> locks;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (involved[s])
+            locks.emplace_back(shards_[s].studentMutex);
+    }
+    for (const auto &student : students)
+    {
+        putStudent(shardFor(student.studentId), student);
     }
 }
 
 void DataStore::importAttendances(const std::vector<Attendance> &attendances)
 {
-    std::lock_guard<std::mutex> lock(attendanceMutex_);
+    std::array<size_t, kShards> perShard{};
+    for (const auto &att : attendances)
+    {
+        perShard[shardOf(att.studentId)]++;
+    }
+    std::vector<UniqueLock> locks;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (perShard[s] == 0)
+            continue;
+        locks.emplace_back(shards_[s].attendanceMutex);
+        shards_[s].records.table.reserve(shards_[s].records.table.size() + perShard[s]);
+    }
+    auto generation = nextGeneration();
+    for (const auto &att : attendances)
+    {
+        insertAttendance(shardFor(att.studentId), att, generation);
+    }
+}
+
+void DataStore::setJournal(StoreJournal *journal)
+{
+    journal_.store(journal, std::memory_order_release);
+}
+
+void DataStore::restoreAttendances(std::vector<Attendance> attendances)
+{
+    // Each shard's table takes ids in ascending order
+    std::sort(attendances.begin(), attendances.end(), byAttendanceId);
+    std::array<size_t, kShards> perShard{};
     for (const auto &att : attendances)
     {
-        Attendance newAtt = att;
-        newAtt.id = nextAttendanceId_++;
-        attendances_[newAtt.id] = newAtt;
+        perShard[shardOf(att.studentId)]++;
+    }
+    std::vector<UniqueLock> locks;
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        if (perShard[s] == 0)
+            continue;
+        locks.emplace_back(shards_[s].attendanceMutex);
+        shards_[s].records.table.reserve(shards_[s].records.table.size() + perShard[s]);
+    }
+    if (attendances.empty())
+    {
+        return;
+    }
+    auto generation = nextGeneration();
+    for (const auto &att : attendances)
+    {
+        auto &shard = shardFor(att.studentId);
+        // Ids within a shard ascend in the order records went in, so the
+        // shard already holds a record its table's ids have passed
+        if (att.id < shard.records.table.nextId())
+            continue;
+        insertAttendance(shard, att, generation, att.id);
+    }
+    restoreCounters(0, attendances.back().id + 1);
+}
+
+std::optional<DataSnapshot::ImageInfo> DataStore::loadImage(std::string_view image)
+{
+    constexpr size_t kEntry = 24;
+    DataSnapshot::ImageInfo info;
+    int64_t nextId = 0;
+    utils::ImageReader header(image.data(), image.size());
+    header.get(info.generation);
+    header.get(nextId);
+    const size_t directory = 16;
+    uint32_t crc = 0;
+    if (!header.seek(directory + kShards * kEntry) || !header.get(crc) ||
+        utils::crc32(image.substr(0, directory + kShards * kEntry)) != crc)
+    {
+        return std::nullopt;
+    }
+    info.nextAttendanceId = static_cast<int>(nextId);
+
+    std::array<StudentMap, kShards> students;
+    std::array<AttendancePartition, kShards> records;
+    std::array<bool, kShards> loaded{};
+    utils::ComputePool::getInstance().parallelFor(kShards, [&](size_t s) {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t sectionCrc = 0;
+        utils::ImageReader entry(image.data() + directory + s * kEntry, kEntry);
+        entry.get(offset);
+        entry.get(size);
+        entry.get(sectionCrc);
+        if (offset % 8 != 0 || offset > image.size() || size > image.size() - offset)
+            return;
+        auto section = image.substr(offset, size);
+        if (utils::crc32(section) != sectionCrc)
+            return;
+
+        utils::ImageReader in(section.data(), section.size());
+        uint64_t count = 0;
+        in.get(count);
+        for (uint64_t i = 0; i < count && in.ok(); ++i)
+        {
+            Student student;
+            in.getString(student.studentId);
+            in.getString(student.name);
+            in.getString(student.className);
+            auto studentId = student.studentId;
+            students[s].insert(std::move(studentId), std::move(student));
+        }
+        loaded[s] = in.align() && records[s].table.loadImage(in) &&
+                    records[s].aggregates.loadImage(in);
+    });
+    if (std::find(loaded.begin(), loaded.end(), false) != loaded.end())
+    {
+        return std::nullopt;
+    }
+
+    std::vector<UniqueLock> locks;
+    for (auto &shard : shards_)
+    {
+        locks.emplace_back(shard.studentMutex);
+        locks.emplace_back(shard.attendanceMutex);
+    }
+    restoreCounters(info.generation, 0);
+    nextAttendanceId_ = info.nextAttendanceId;
+    std::lock_guard<std::shared_mutex> rosterLock(rosterMutex_);
+    roster_.clear();
+    for (size_t s = 0; s < kShards; ++s)
+    {
+        auto &shard = shards_[s];
+        shard.students = std::move(students[s]);
+        shard.records = std::move(records[s]);
+        ++shard.studentVersion;
+        ++shard.attendanceVersion;
+        for (const auto &[id, student] : shard.students)
+        {
+            roster_.add(student.className, id);
+        }
+        info.students += shard.students.size();
+        info.attendances += shard.records.table.size();
+    }
+    // Cached reports go stale as after clear()
+    rosterGenerations_.clear();
+    rosterLatest_ = rosterCleared_ = nextGeneration();
+    {
+        std::lock_guard<std::mutex> lock(generationMutex_);
+        attendanceGenerations_.clear(nextGeneration());
+    }
+    return info;
+}
+
+void DataStore::restoreCounters(uint64_t generation, int nextAttendanceId)
+{
+    uint64_t currentGeneration = generation_.load();
+    while (currentGeneration < generation &&
+           !generation_.compare_exchange_weak(currentGeneration, generation))
+    {
+    }
+    int currentId = nextAttendanceId_.load();
+    while (currentId < nextAttendanceId &&
+           !nextAttendanceId_.compare_exchange_weak(currentId, nextAttendanceId))
+    {
     }
 }
 
 void DataStore::reset()
 {
-    std::scoped_lock lock(studentMutex_, attendanceMutex_);
-    students_.clear();
-    attendances_.clear();
-    nextAttendanceId_ = 1;
+    std::vector<UniqueLock> locks;
+    for (auto &shard : shards_)
+    {
+        locks.emplace_back(shard.studentMutex);
+        locks.emplace_back(shard.attendanceMutex);
+    }
+    clearShards();
     initSampleData();
 }
 
@@ -0,0 +1,72 @@
+#include "student_attendance/models/WriteGenerations.h"
+#include <algorithm>
+
+namespace student_attendance
+{
+namespace models
+{
+
+void WriteGenerations::touch(const std::string &className, utils::Date day, uint64_t generation)
+{
+    classes_[className][day.ordinal()] = generation;
+    days_[day.ordinal()] = generation;
+}
+
+void WriteGenerations::touchClass(const std::string &className, uint64_t generation)
+{
+    wholeClasses_[className] = generation;
+    wholeClassLatest_ = std::max(wholeClassLatest_, generation);
+}
+
+void WriteGenerations::clear(uint64_t generation)
+{
+    classes_.clear();
+    days_.clear();
+    wholeClasses_.clear();
+    wholeClassLatest_ = 0;
+    cleared_ = generation;
+}
+
+uint64_t WriteGenerations::latest(const std::string &className,
+                                  std::optional<utils::Date> first,
+                                  std::optional<utils::Date> last) const
+{
+    if (className.empty())
+    {
+        return std::max({cleared_, wholeClassLatest_, latestIn(days_, first, last)});
+    }
+    uint64_t latest = cleared_;
+    auto whole = wholeClasses_.find(className);
+    if (whole != wholeClasses_.end())
+    {
+        latest = std::max(latest, whole->second);
+    }
+    auto cls = classes_.find(className);
+    if (cls != classes_.end())
+    {
+        latest = std::max(latest, latestIn(cls->second, first, last));
+    }
+    return latest;
+}
+
+uint64_t WriteGenerations::latestIn(const DayCells &cells,
+                                    std::optional<utils::Date> first,
+                                    std::optional<utils::Date> last)
+{
+    uint64_t latest = 0;
+    // A reversed range covers nothing
+    if (first && last && last->ordinal() < first->ordinal())
+    {
+        return latest;
+    }
+    auto begin = first ? cells.lower_bound(first->ordinal()) : cells.begin();
+    auto end = last ? cells.upper_bound(last->ordinal()) : cells.end();
+    for (auto it = begin; it != end; ++it)
+    {
+        latest = std::max(latest, it->second);
+    }
+    return latest;
+}
+
+}  // namespace models
+}  // namespace student_attendance
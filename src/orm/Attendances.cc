@@ -16,9 +16,10 @@ Attendances::Attendances(const drogon::orm::Row &row)
     if (!row["student_id"].isNull())
         studentId_ = row["student_id"].as<std::string>();
     if (!row["date"].isNull())
-        date_ = row["date"].as<std::string>();
+        date_ = utils::Date::fromOrdinal(row["date"].as<int>());
     if (!row["status"].isNull())
-        status_ = row["status"].as<std::string>();
+        status_ = utils::AttendanceStatus::fromInt(row["status"].as<int>())
+                      .value_or(utils::StatusCode::Present);
     if (!row["remark"].isNull())
         remark_ = row["remark"].as<std::string>();
     if (!row["created_at"].isNull())
@@ -32,9 +33,9 @@ Json::Value Attendances::toJson() const
     Json::Value json;
     json["id"] = static_cast<Json::Int64>(id_);
     json["student_id"] = studentId_;
-    json["date"] = date_;
-    json["status"] = status_;
-    json["status_symbol"] = utils::AttendanceStatus::getSymbol(status_);
+    json["date"] = date_.toString();
+    json["status"] = std::string(utils::AttendanceStatus::toString(status_));
+    json["status_symbol"] = std::string(utils::AttendanceStatus::getSymbol(status_));
     json["remark"] = remark_;
     json["created_at"] = createdAt_.toDbStringLocal();
     json["updated_at"] = updatedAt_.toDbStringLocal();
@@ -49,9 +50,15 @@ Attendances Attendances::fromJson(const Json::Value &json)
     if (json.isMember("student_id"))
         att.setStudentId(json["student_id"].asString());
     if (json.isMember("date"))
-        att.setDate(json["date"].asString());
+    {
+        if (auto date = utils::Date::parse(json["date"].asString()))
+            att.setDate(*date);
+    }
     if (json.isMember("status"))
-        att.setStatus(json["status"].asString());
+    {
+        if (auto status = utils::AttendanceStatus::fromString(json["status"].asString()))
+            att.setStatus(*status);
+    }
     if (json.isMember("remark"))
         att.setRemark(json["remark"].asString());
     return att;
@@ -67,12 +74,12 @@ const std::vector<std::string> &Attendances::insertColumns()
 
 void Attendances::outputArgs(drogon::orm::internal::SqlBinder &binder) const
 {
-    binder << studentId_ << date_ << status_ << remark_;
+    binder << studentId_ << date_.ordinal() << static_cast<int>(status_) << remark_;
 }
 
 void Attendances::updateArgs(drogon::orm::internal::SqlBinder &binder) const
 {
-    binder << status_ << remark_ << id_;
+    binder << static_cast<int>(status_) << remark_ << id_;
 }
 
 }  // namespace orm
@@ -1,6 +1,12 @@
 #include <drogon/drogon.h>
 #include <iostream>
 #include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqliteTuning.h"
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/db/WriteAheadLog.h"
+#include "student_attendance/db/WriteThrough.h"
+#include "student_attendance/models/DataStore.h"
+#include "student_attendance/utils/JsonResponse.h"
 
 int main()
 {
@@ -19,9 +25,38 @@ int main()
             .setLogPath("./logs")
             .setLogLevel(trantor::Logger::kDebug)
             .addListener("0.0.0.0", 8080)
-            .setThreadNum(4);
+            .setThreadNum(4)
+            // Large imports; bodies past 1M are buffered in a temp file
+            .setClientMaxBodySize(1024 * 1024 * 1024)
+            .setClientMaxMemoryBodySize(1024 * 1024);
     }
 
+    // SQLite connection settings. The framework opens its connection pool
+    // when the app runs, so they are in place before the first connection.
+    {
+        using student_attendance::db::SqliteTuning;
+        std::string error;
+        auto tuning = SqliteTuning::fromConfig(drogon::app().getCustomConfig()["sqlite"], error);
+        if (!tuning)
+        {
+            std::cerr << "Invalid sqlite settings (" << error << "), using the wal profile."
+                      << std::endl;
+            tuning = SqliteTuning::fromProfile("wal");
+        }
+        student_attendance::db::DatabaseManager::getInstance().configure(*tuning);
+        std::cout << "SQLite profile: " << tuning->profile << " (journal " << tuning->journalMode
+                  << ", synchronous " << tuning->synchronous << ")" << std::endl;
+    }
+
+    // Uncaught errors, such as a write that could not be logged, answer
+    // with the API's JSON error body
+    drogon::app().setExceptionHandler(
+        [](const std::exception &e, const drogon::HttpRequestPtr &,
+           std::function<void(const drogon::HttpResponsePtr &)> &&callback) {
+            LOG_ERROR << "Request failed: " << e.what();
+            callback(student_attendance::utils::JsonResponse::serverError("服务器内部错误"));
+        });
+
     // Register database initialization callback
     drogon::app().registerBeginningAdvice([]() {
         std::cout << "Initializing database..." << std::endl;
@@ -29,6 +64,53 @@ int main()
             "./student_attendance.db"
         );
         std::cout << "Database initialized successfully." << std::endl;
+
+        // Where the services read and write: memory, sqlite or hybrid
+        using student_attendance::db::Storage;
+        auto backendName =
+            drogon::app().getCustomConfig()["storage"].get("backend", "hybrid").asString();
+        auto backend = Storage::parseBackend(backendName);
+        if (!backend)
+        {
+            std::cerr << "Unknown storage backend \"" << backendName
+                      << "\", using hybrid." << std::endl;
+            backend = Storage::Backend::Hybrid;
+        }
+        Storage::select(*backend);
+        std::cout << "Storage backend: " << Storage::backendName(*backend) << std::endl;
+
+        // Recover in-memory attendance data and keep logging its changes;
+        // the SQLite backend keeps nothing in memory. Hybrid starts from its
+        // SQLite mirror when the log has nothing to restore.
+        using student_attendance::db::WriteAheadLog;
+        auto &store = student_attendance::models::DataStore::getInstance();
+        const auto &persistence = drogon::app().getCustomConfig()["persistence"];
+        bool logged =
+            *backend != Storage::Backend::Sqlite && persistence.get("enabled", true).asBool();
+        WriteAheadLog::Options options;
+        options.directory = persistence.get("directory", options.directory).asString();
+        options.checkpointBytes =
+            persistence.get("checkpoint_bytes", Json::UInt64(options.checkpointBytes)).asUInt64();
+        if (*backend == Storage::Backend::Hybrid &&
+            !(logged && WriteAheadLog::hasState(options.directory)) &&
+            student_attendance::db::loadFromMirror(store))
+        {
+            std::cout << "Loaded " << store.getAllStudents().size() << " students and "
+                      << store.snapshot()->attendanceCount()
+                      << " attendance records from SQLite." << std::endl;
+        }
+        if (logged)
+        {
+            auto recovered = WriteAheadLog::getInstance().open(options, store);
+            std::cout << "Recovered " << recovered.students << " students and "
+                      << recovered.attendances << " attendance records"
+                      << (recovered.fromSnapshot ? " from snapshot" : "") << ", replayed "
+                      << recovered.replayed << " log records." << std::endl;
+        }
+        if (*backend == Storage::Backend::Hybrid)
+        {
+            student_attendance::db::reseedFromMirror(store);
+        }
     });
 
     // Print startup information
@@ -70,6 +152,9 @@ int main()
     std::cout << "    GET    /api/v1/classes" << std::endl;
     std::cout << "    GET    /api/v1/classes/{class_name}/students" << std::endl;
     std::cout << std::endl;
+    std::cout << "  System:" << std::endl;
+    std::cout << "    GET    /api/v1/system/stats" << std::endl;
+    std::cout << std::endl;
     std::cout << "Server starting..." << std::endl;
 
     // Run the server
@@ -1,334 +1,362 @@
 #include "student_attendance/services/AttendanceService.h"
 #include "student_attendance/utils/AttendanceStatus.h"
-#include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/utils/Date.h"
+#include "student_attendance/db/Storage.h"
 #include <algorithm>
-#include <drogon/orm/DbClient.h>
+#include <charconv>
+#include <utility>
 
 namespace student_attendance
 {
 namespace services
 {
 
-AttendanceService::AttendanceListResult AttendanceService::getAttendances(
-    int page, int pageSize,
-    const std::string &studentId,
-    const std::string &name,
-    const std::string &className,
-    const std::string &date,
-    const std::string &startDate,
-    const std::string &endDate,
-    const std::string &status,
-    const std::string &sortBy,
-    const std::string &order) const
+namespace
 {
-    auto fallback = [&]() -> AttendanceListResult {
-        auto attendances = dataStore_.searchAttendances(
-            studentId, name, className, date, startDate, endDate, status);
-
-        // Sort
-        if (!sortBy.empty())
-        {
-            bool ascending = (order != "desc");
-            std::sort(attendances.begin(), attendances.end(),
-                [&sortBy, ascending](const models::Attendance &a, const models::Attendance &b) {
-                    int cmp = 0;
-                    if (sortBy == "student_id")
-                    {
-                        cmp = a.studentId.compare(b.studentId);
-                    }
-                    else if (sortBy == "name")
-                    {
-                        cmp = a.name.compare(b.name);
-                    }
-                    else if (sortBy == "date")
-                    {
-                        cmp = a.date.compare(b.date);
-                    }
-                    return ascending ? (cmp < 0) : (cmp > 0);
-                });
-        }
-
-        int total = static_cast<int>(attendances.size());
-
-        // Pagination
-        int startIndex = (page - 1) * pageSize;
-        int endIndex = std::min(startIndex + pageSize, total);
-
-        std::vector<models::Attendance> pagedAttendances;
-        if (startIndex < total)
-        {
-            pagedAttendances.assign(attendances.begin() + startIndex,
-                                   attendances.begin() + endIndex);
-        }
-
-        return {pagedAttendances, total, page, pageSize};
-    };
 
-    auto client = db::DatabaseManager::getInstance().getClient();
-    if (!client)
+// A cursor carries the ordering it was issued under and overrides the
+// request's sort_by/order.
+void applyOrder(db::AttendanceQuery &query, const std::string &sortBy,
+                const std::string &order, const std::optional<utils::PageCursor> &cursor)
+{
+    if (cursor)
     {
-        return fallback();
+        query.sortColumn = cursor->sortColumn;
+        query.descending = cursor->descending;
+        return;
     }
 
-    try
-    {
-        std::string sortCol;
-        if (sortBy == "student_id")
-            sortCol = "a.student_id";
-        else if (sortBy == "name")
-            sortCol = "s.name";
-        else if (sortBy == "date")
-            sortCol = "a.date";
-        if (sortCol.empty())
-            sortCol = "a.id";
-
-        std::string sortOrder = (order == "desc") ? "DESC" : "ASC";
-
-        std::string whereSql = " WHERE 1=1";
-        std::vector<std::string> args;
-
-        if (!studentId.empty())
-        {
-            whereSql += " AND a.student_id = ?";
-            args.push_back(studentId);
-        }
-        if (!name.empty())
-        {
-            whereSql += " AND s.name LIKE ?";
-            args.push_back("%" + name + "%");
-        }
-        if (!className.empty())
-        {
-            whereSql += " AND s.class_name = ?";
-            args.push_back(className);
-        }
-        if (!date.empty())
-        {
-            whereSql += " AND a.date = ?";
-            args.push_back(date);
-        }
-        if (!startDate.empty())
-        {
-            whereSql += " AND a.date >= ?";
-            args.push_back(startDate);
-        }
-        if (!endDate.empty())
-        {
-            whereSql += " AND a.date <= ?";
-            args.push_back(endDate);
-        }
-        if (!status.empty())
-        {
-            whereSql += " AND a.status = ?";
-            args.push_back(status);
-        }
-
-        int total = 0;
-        {
-            std::string countSql =
-                "SELECT COUNT(1) AS cnt "
-                "FROM attendances a "
-                "JOIN students s ON a.student_id = s.student_id" + whereSql;
-
-            auto binder = (*client) << countSql;
-            for (const auto &arg : args)
-            {
-                binder << arg;
-            }
-
-            drogon::orm::Result r(nullptr);
-            binder << drogon::orm::Mode::Blocking;
-            binder >> [&r](const drogon::orm::Result &result) { r = result; };
-            binder.exec();
-
-            if (!r.empty())
-            {
-                total = r[0]["cnt"].as<int>();
-            }
-        }
+    if (sortBy == "student_id")
+        query.sortColumn = db::AttendanceQuery::ByStudent;
+    else if (sortBy == "name")
+        query.sortColumn = db::AttendanceQuery::ByName;
+    else if (sortBy == "date")
+        query.sortColumn = db::AttendanceQuery::ByDate;
+    query.descending = (order == "desc");
+}
 
-        int offset = (page - 1) * pageSize;
-        std::string querySql =
-            "SELECT "
-            "  a.id AS id, "
-            "  a.student_id AS student_id, "
-            "  s.name AS name, "
-            "  s.class_name AS class_name, "
-            "  a.date AS date, "
-            "  a.status AS status, "
-            "  a.remark AS remark "
-            "FROM attendances a "
-            "JOIN students s ON a.student_id = s.student_id" + whereSql +
-            " ORDER BY " + sortCol + " " + sortOrder +
-            " LIMIT ? OFFSET ?";
-
-        std::vector<models::Attendance> pagedAttendances;
-        {
-            auto binder = (*client) << querySql;
-            for (const auto &arg : args)
-            {
-                binder << arg;
-            }
-            binder << pageSize << offset;
-
-            drogon::orm::Result r(nullptr);
-            binder << drogon::orm::Mode::Blocking;
-            binder >> [&r](const drogon::orm::Result &result) { r = result; };
-            binder.exec();
-
-            pagedAttendances.reserve(r.size());
-            for (const auto &row : r)
-            {
-                models::Attendance a;
-                a.id = row["id"].as<int>();
-                a.studentId = row["student_id"].as<std::string>();
-                a.name = row["name"].as<std::string>();
-                a.className = row["class_name"].as<std::string>();
-                a.date = row["date"].as<std::string>();
-                a.status = row["status"].as<std::string>();
-                a.remark = row["remark"].isNull() ? "" : row["remark"].as<std::string>();
-                pagedAttendances.push_back(std::move(a));
-            }
-        }
+bool parseInt(const std::string &text, int &value)
+{
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
 
-        return {pagedAttendances, total, page, pageSize};
-    }
-    catch (const drogon::orm::DrogonDbException &)
+// The row a cursor points at, holding just the fields the ordering reads.
+// Returns nullopt for a cursor this service could not have issued.
+std::optional<models::Attendance> cursorRow(const utils::PageCursor &cursor)
+{
+    models::Attendance row;
+    if (cursor.sortColumn >= db::AttendanceQuery::kColumns || !parseInt(cursor.id, row.id))
     {
+        return std::nullopt;
     }
-    catch (const std::exception &)
+    switch (cursor.sortColumn)
+    {
+    case db::AttendanceQuery::ByStudent:
+        row.studentId = cursor.key;
+        break;
+    case db::AttendanceQuery::ByName:
+        row.name = cursor.key;
+        break;
+    case db::AttendanceQuery::ByDate:
     {
+        int day = 0;
+        if (!parseInt(cursor.key, day))
+            return std::nullopt;
+        row.date = utils::Date::fromOrdinal(day);
+        break;
+    }
+    default:
+        break;
     }
+    return row;
+}
 
-    return fallback();
+std::string cursorAfter(const models::Attendance &last, const db::AttendanceQuery &query)
+{
+    utils::PageCursor cursor;
+    cursor.sortColumn = query.sortColumn;
+    cursor.descending = query.descending;
+    switch (query.sortColumn)
+    {
+    case db::AttendanceQuery::ByStudent:
+        cursor.key = last.studentId;
+        break;
+    case db::AttendanceQuery::ByName:
+        cursor.key = last.name;
+        break;
+    case db::AttendanceQuery::ByDate:
+        cursor.key = std::to_string(last.date.ordinal());
+        break;
+    default:
+        break;
+    }
+    cursor.id = std::to_string(last.id);
+    return cursor.encode();
 }
 
-std::optional<models::Attendance> AttendanceService::getAttendance(int id) const
+// Parses the request's filter fields. Returns nullopt when a date or status
+// is malformed, since such a query cannot match anything.
+std::optional<models::AttendanceFilter> parseFilter(
+    const std::string &studentId,
+    const std::string &name,
+    const std::string &className,
+    const std::string &date,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &status)
 {
-    auto client = db::DatabaseManager::getInstance().getClient();
-    if (!client)
+    models::AttendanceFilter filter;
+    filter.studentId = studentId;
+    filter.name = name;
+    filter.className = className;
+
+    auto parseDate = [](const std::string &text, std::optional<utils::Date> &out) {
+        if (text.empty())
+            return true;
+        out = utils::Date::parse(text);
+        return out.has_value();
+    };
+    if (!parseDate(date, filter.date) || !parseDate(startDate, filter.startDate) ||
+        !parseDate(endDate, filter.endDate))
     {
-        return dataStore_.getAttendanceById(id);
+        return std::nullopt;
     }
 
-    try
+    if (!status.empty())
     {
-        auto r = client->execSqlSync(
-            "SELECT "
-            "  a.id AS id, "
-            "  a.student_id AS student_id, "
-            "  s.name AS name, "
-            "  s.class_name AS class_name, "
-            "  a.date AS date, "
-            "  a.status AS status, "
-            "  a.remark AS remark "
-            "FROM attendances a "
-            "JOIN students s ON a.student_id = s.student_id "
-            "WHERE a.id = ?",
-            id);
-
-        if (r.empty())
-        {
+        filter.status = utils::AttendanceStatus::fromString(status);
+        if (!filter.status)
             return std::nullopt;
-        }
+    }
+    return filter;
+}
 
-        models::Attendance a;
-        a.id = r[0]["id"].as<int>();
-        a.studentId = r[0]["student_id"].as<std::string>();
-        a.name = r[0]["name"].as<std::string>();
-        a.className = r[0]["class_name"].as<std::string>();
-        a.date = r[0]["date"].as<std::string>();
-        a.status = r[0]["status"].as<std::string>();
-        a.remark = r[0]["remark"].isNull() ? "" : r[0]["remark"].as<std::string>();
-        return a;
+}  // namespace
+
+drogon::Task<AttendanceService::AttendanceListResult> AttendanceService::getAttendancesCoro(
+    int page, int pageSize,
+    const std::string &studentId,
+    const std::string &name,
+    const std::string &className,
+    const std::string &date,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &status,
+    const std::string &sortBy,
+    const std::string &order,
+    const std::optional<utils::PageCursor> &cursor,
+    bool withTotal) const
+{
+    page = std::max(page, 1);
+    pageSize = std::max(pageSize, 1);
+
+    AttendanceListResult result;
+    result.total = withTotal ? 0 : -1;
+    result.page = page;
+    result.pageSize = pageSize;
+
+    auto filter = parseFilter(studentId, name, className, date, startDate, endDate, status);
+    db::AttendanceQuery query;
+    applyOrder(query, sortBy, order, cursor);
+    if (cursor)
+    {
+        query.after = cursorRow(*cursor);
     }
-    catch (const drogon::orm::DrogonDbException &)
+    if (!filter || (cursor && !query.after))
     {
+        co_return result;
     }
-    catch (const std::exception &)
+    query.filter = std::move(*filter);
+    query.offset = (page - 1) * pageSize;
+    query.limit = pageSize;
+    query.withTotal = withTotal;
+
+    auto rows = co_await db::Storage::current().listAttendances(query);
+    result.attendances = std::move(rows.rows);
+    result.total = rows.total;
+    if (rows.more && !result.attendances.empty())
     {
+        result.nextCursor = cursorAfter(result.attendances.back(), query);
     }
+    co_return result;
+}
 
-    return dataStore_.getAttendanceById(id);
+drogon::Task<std::optional<models::Attendance>> AttendanceService::getAttendanceCoro(int id) const
+{
+    co_return co_await db::Storage::current().getAttendance(id);
 }
 
-std::pair<bool, models::Attendance> AttendanceService::createAttendance(
+AttendanceService::AttendanceListResult AttendanceService::getAttendances(
+    int page, int pageSize,
+    const std::string &studentId,
+    const std::string &name,
+    const std::string &className,
+    const std::string &date,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &status,
+    const std::string &sortBy,
+    const std::string &order,
+    const std::optional<utils::PageCursor> &cursor,
+    bool withTotal) const
+{
+    return drogon::sync_wait(getAttendancesCoro(page, pageSize, studentId, name,
+                                                className, date, startDate, endDate,
+                                                status, sortBy, order, cursor, withTotal));
+}
+
+std::optional<models::Attendance> AttendanceService::getAttendance(int id) const
+{
+    return drogon::sync_wait(getAttendanceCoro(id));
+}
+
+drogon::Task<std::pair<bool, models::Attendance>> AttendanceService::createAttendanceCoro(
     const std::string &studentId,
     const std::string &date,
     const std::string &status,
     const std::string &remark)
 {
-    auto student = dataStore_.getStudentById(studentId);
-    if (!student)
+    auto statusCode = utils::AttendanceStatus::fromString(status);
+    if (!statusCode)
     {
-        return {false, models::Attendance()};
+        co_return {false, models::Attendance()};
     }
 
-    if (!utils::AttendanceStatus::isValidStatus(status))
+    auto day = utils::Date::parse(date);
+    if (!day)
     {
-        return {false, models::Attendance()};
+        co_return {false, models::Attendance()};
     }
 
-    models::Attendance att;
+    // The storage resolves the student's name and class, and leaves the id
+    // at 0 when there is no such student
+    std::vector<models::Attendance> rows(1);
+    auto &att = rows.front();
     att.studentId = studentId;
-    att.name = student->name;
-    att.className = student->className;
-    att.date = date;
-    att.status = status;
+    att.date = *day;
+    att.status = *statusCode;
     att.remark = remark;
 
-    int id = dataStore_.addAttendance(att);
-    att.id = id;
+    int added = co_await db::Storage::current().addAttendances(rows);
+    if (added == 0)
+    {
+        co_return {false, models::Attendance()};
+    }
+    co_return {true, std::move(att)};
+}
 
-    return {true, att};
+std::pair<bool, models::Attendance> AttendanceService::createAttendance(
+    const std::string &studentId,
+    const std::string &date,
+    const std::string &status,
+    const std::string &remark)
+{
+    return drogon::sync_wait(createAttendanceCoro(studentId, date, status, remark));
 }
 
-int AttendanceService::batchCreateAttendances(
+drogon::Task<AttendanceService::BatchResult> AttendanceService::batchCreateAttendancesCoro(
     const std::string &date,
-    const std::vector<std::pair<std::string, std::string>> &records)
+    const std::vector<BatchRecord> &records)
 {
-    int count = 0;
-    for (const auto &[studentId, status] : records)
+    BatchResult result;
+    result.rows.resize(records.size());
+
+    auto day = utils::Date::parse(date);
+    std::vector<models::Attendance> pending;
+    std::vector<size_t> pendingRows;
+    pending.reserve(records.size());
+    pendingRows.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i)
     {
-        auto result = createAttendance(studentId, date, status, "");
-        if (result.first)
+        const auto &record = records[i];
+        auto &row = result.rows[i];
+        if (!day)
+        {
+            row.error = "无效的考勤日期";
+            continue;
+        }
+        if (record.studentId.empty())
         {
-            count++;
+            row.error = "学号不能为空";
+            continue;
+        }
+        auto statusCode = utils::AttendanceStatus::fromString(record.status);
+        if (!statusCode)
+        {
+            row.error = "无效的考勤状态";
+            continue;
+        }
+
+        models::Attendance att;
+        att.studentId = record.studentId;
+        att.date = *day;
+        att.status = *statusCode;
+        att.remark = record.remark;
+        pending.push_back(std::move(att));
+        pendingRows.push_back(i);
+    }
+
+    result.createdCount = co_await db::Storage::current().addAttendances(pending);
+    for (size_t k = 0; k < pending.size(); ++k)
+    {
+        auto &row = result.rows[pendingRows[k]];
+        row.id = pending[k].id;
+        row.created = row.id != 0;
+        if (!row.created)
+        {
+            row.error = "学生不存在";
         }
     }
-    return count;
+    co_return result;
 }
 
-std::pair<bool, std::string> AttendanceService::updateAttendance(
+AttendanceService::BatchResult AttendanceService::batchCreateAttendances(
+    const std::string &date,
+    const std::vector<BatchRecord> &records)
+{
+    return drogon::sync_wait(batchCreateAttendancesCoro(date, records));
+}
+
+drogon::Task<std::pair<bool, std::string>> AttendanceService::updateAttendanceCoro(
     int id,
     const std::string &status,
     const std::string &remark)
 {
-    auto att = dataStore_.getAttendanceById(id);
-    if (!att)
+    std::optional<utils::StatusCode> statusCode;
+    if (!status.empty())
     {
-        return {false, "考勤记录不存在"};
+        statusCode = utils::AttendanceStatus::fromString(status);
+        if (!statusCode)
+        {
+            co_return {false, "无效的考勤状态"};
+        }
     }
 
-    if (!status.empty() && !utils::AttendanceStatus::isValidStatus(status))
+    bool updated = co_await db::Storage::current().updateAttendance(id, statusCode, remark);
+    if (updated)
     {
-        return {false, "无效的考勤状态"};
+        co_return {true, "考勤记录更新成功"};
     }
+    co_return {false, "考勤记录不存在"};
+}
 
-    models::Attendance updateData;
-    updateData.status = status;
-    updateData.remark = remark;
+drogon::Task<bool> AttendanceService::deleteAttendanceCoro(int id)
+{
+    co_return co_await db::Storage::current().deleteAttendance(id);
+}
 
-    if (dataStore_.updateAttendance(id, updateData))
-    {
-        return {true, "考勤记录更新成功"};
-    }
-    return {false, "更新失败"};
+std::pair<bool, std::string> AttendanceService::updateAttendance(
+    int id,
+    const std::string &status,
+    const std::string &remark)
+{
+    return drogon::sync_wait(updateAttendanceCoro(id, status, remark));
 }
 
 bool AttendanceService::deleteAttendance(int id)
 {
-    return dataStore_.deleteAttendance(id);
+    return drogon::sync_wait(deleteAttendanceCoro(id));
 }
 
 }  // namespace services
@@ -1,6 +1,7 @@
 #include "student_attendance/services/AuthService.h"
 
 #include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqlText.h"
 
 #include <drogon/utils/Utilities.h>
 
@@ -9,29 +10,32 @@ namespace student_attendance
 namespace services
 {
 
-std::optional<models::User> AuthService::authenticate(
+drogon::Task<std::optional<models::User>> AuthService::authenticateCoro(
     const std::string &username,
     const std::string &password) const
 {
     if (username.empty() || password.empty())
     {
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     auto client = db::DatabaseManager::getInstance().getClient();
     if (!client)
     {
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     try
     {
-        auto r = client->execSqlSync(
-            "SELECT id, username, role, password_hash, salt FROM users WHERE username = ? LIMIT 1",
-            username);
+        const auto &sql = db::SqlText::getInstance().get(
+            db::SqlText::shape(db::QueryId::UserByName), [] {
+                return std::string(
+                    "SELECT id, username, role, password_hash, salt FROM users WHERE username = ? LIMIT 1");
+            });
+        auto r = co_await client->execSqlCoro(sql, username);
         if (r.empty())
         {
-            return std::nullopt;
+            co_return std::nullopt;
         }
 
         auto salt = r[0]["salt"].as<std::string>();
@@ -40,20 +44,27 @@ std::optional<models::User> AuthService::authenticate(
 
         if (expectedHash != actualHash)
         {
-            return std::nullopt;
+            co_return std::nullopt;
         }
 
         models::User user;
         user.id = r[0]["id"].as<int>();
         user.username = r[0]["username"].as<std::string>();
         user.role = r[0]["role"].as<std::string>();
-        return user;
+        co_return user;
     }
     catch (const std::exception &)
     {
-        return std::nullopt;
+        co_return std::nullopt;
     }
 }
 
+std::optional<models::User> AuthService::authenticate(
+    const std::string &username,
+    const std::string &password) const
+{
+    return drogon::sync_wait(authenticateCoro(username, password));
+}
+
 }  // namespace services
 }  // namespace student_attendance
@@ -0,0 +1,339 @@
+#include "student_attendance/services/ExportService.h"
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/JsonWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <drogon/utils/coroutine.h>
+
+namespace student_attendance
+{
+namespace services
+{
+
+namespace
+{
+
+// Rows read per refill
+constexpr size_t kBatchRows = 512;
+
+const char *tableName(bool students)
+{
+    return students ? "students" : "attendances";
+}
+
+// Quotes a field when it holds a separator, quote or line break
+void appendCsvField(std::string &out, std::string_view field)
+{
+    if (field.find_first_of(",\"\r\n") == std::string_view::npos)
+    {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field)
+    {
+        if (c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+void appendCsvRow(std::string &out, const models::Student &student)
+{
+    appendCsvField(out, student.studentId);
+    out += ',';
+    appendCsvField(out, student.name);
+    out += ',';
+    appendCsvField(out, student.className);
+    out += '\n';
+}
+
+void appendCsvRow(std::string &out, int id, std::string_view studentId, std::string_view name,
+                  std::string_view className, utils::Date date, utils::StatusCode status,
+                  std::string_view remark)
+{
+    out += std::to_string(id);
+    out += ',';
+    appendCsvField(out, studentId);
+    out += ',';
+    appendCsvField(out, name);
+    out += ',';
+    appendCsvField(out, className);
+    out += ',';
+    out += date.toString();
+    out += ',';
+    out += utils::AttendanceStatus::toString(status);
+    out += ',';
+    appendCsvField(out, remark);
+    out += '\n';
+}
+
+}  // namespace
+
+ExportService::Stream::Stream(db::Storage &storage, Format format, std::vector<Table> tables)
+    : storage_(storage), data_(storage.snapshot()), format_(format), tables_(std::move(tables))
+{
+    if (!data_)
+    {
+        prefetch();
+    }
+}
+
+// Runs on the caller's thread up to the query, and finishes on the database
+// client's, so nothing here waits for the rows
+void ExportService::Stream::prefetch()
+{
+    auto promise = std::make_shared<std::promise<Batch>>();
+    next_ = promise->get_future();
+    auto &storage = storage_;
+    if (tables_[table_] == Table::Students)
+    {
+        db::StudentQuery query;
+        if (!lastStudentId_.empty())
+        {
+            query.after = models::Student(lastStudentId_, "", "");
+        }
+        query.limit = static_cast<int>(kBatchRows);
+        query.withTotal = false;
+        drogon::async_run([&storage, query, promise]() -> drogon::Task<> {
+            try
+            {
+                auto page = co_await storage.listStudents(query);
+                Batch batch;
+                batch.students = std::move(page.rows);
+                promise->set_value(std::move(batch));
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return;
+    }
+
+    db::AttendanceQuery query;
+    if (lastAttendanceId_ > 0)
+    {
+        query.after = models::Attendance();
+        query.after->id = lastAttendanceId_;
+    }
+    query.limit = static_cast<int>(kBatchRows);
+    query.withTotal = false;
+    drogon::async_run([&storage, query, promise]() -> drogon::Task<> {
+        try
+        {
+            auto page = co_await storage.listAttendances(query);
+            Batch batch;
+            batch.attendances = std::move(page.rows);
+            promise->set_value(std::move(batch));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    });
+}
+
+size_t ExportService::Stream::read(char *buffer, size_t size)
+{
+    while (pending_.size() - offset_ < size && fill())
+    {
+    }
+
+    auto count = std::min(size, pending_.size() - offset_);
+    std::memcpy(buffer, pending_.data() + offset_, count);
+    offset_ += count;
+    if (offset_ == pending_.size())
+    {
+        pending_.clear();
+        offset_ = 0;
+    }
+    return count;
+}
+
+bool ExportService::Stream::fill()
+{
+    bool json = format_ == Format::Json;
+    if (table_ >= tables_.size())
+    {
+        if (closed_)
+            return false;
+        if (json)
+            pending_ += '}';
+        closed_ = true;
+        return true;
+    }
+
+    bool students = tables_[table_] == Table::Students;
+    if (!opened_)
+    {
+        if (json)
+        {
+            pending_ += table_ == 0 ? "{\"" : ",\"";
+            pending_ += tableName(students);
+            pending_ += "\":[";
+        }
+        else
+        {
+            pending_ += students ? "student_id,name,class\n"
+                                 : "id,student_id,name,class,date,status,remark\n";
+        }
+        opened_ = true;
+        firstRow_ = true;
+        return true;
+    }
+
+    auto rows = students ? appendStudents() : appendAttendances();
+    if (rows < kBatchRows)
+    {
+        if (json)
+            pending_ += ']';
+        ++table_;
+        opened_ = false;
+        if (!data_ && table_ < tables_.size())
+        {
+            prefetch();
+        }
+    }
+    return true;
+}
+
+size_t ExportService::Stream::appendStudents()
+{
+    std::vector<models::Student> batch;
+    if (data_)
+    {
+        batch = data_->getStudentsAfter(lastStudentId_, kBatchRows);
+    }
+    else
+    {
+        // Only waits when the client took the last batch faster than the
+        // database produced this one
+        batch = next_.get().students;
+        if (batch.size() == kBatchRows)
+        {
+            lastStudentId_ = batch.back().studentId;
+            prefetch();
+        }
+    }
+    for (const auto &student : batch)
+    {
+        if (format_ == Format::Json)
+        {
+            if (!firstRow_)
+                pending_ += ',';
+            utils::JsonWriter json(pending_);
+            student.writeJson(json);
+        }
+        else
+        {
+            appendCsvRow(pending_, student);
+        }
+        firstRow_ = false;
+    }
+    if (!batch.empty())
+    {
+        lastStudentId_ = batch.back().studentId;
+    }
+    return batch.size();
+}
+
+size_t ExportService::Stream::appendAttendances()
+{
+    if (!data_)
+    {
+        auto batch = next_.get().attendances;
+        if (batch.size() == kBatchRows)
+        {
+            lastAttendanceId_ = batch.back().id;
+            prefetch();
+        }
+        for (const auto &att : batch)
+        {
+            if (format_ == Format::Json)
+            {
+                if (!firstRow_)
+                    pending_ += ',';
+                utils::JsonWriter json(pending_);
+                att.writeJson(json);
+            }
+            else
+            {
+                appendCsvRow(pending_, att.id, att.studentId, att.name, att.className, att.date,
+                             att.status, att.remark);
+            }
+            firstRow_ = false;
+        }
+        if (!batch.empty())
+        {
+            lastAttendanceId_ = batch.back().id;
+        }
+        return batch.size();
+    }
+
+    size_t rows = 0;
+    lastAttendanceId_ = data_->scanAttendancesAfter(
+        lastAttendanceId_, kBatchRows, [&](const models::AttendanceTable::Row &row) {
+            if (format_ == Format::Json)
+            {
+                if (!firstRow_)
+                    pending_ += ',';
+                utils::JsonWriter json(pending_);
+                row.writeJson(json);
+            }
+            else
+            {
+                appendCsvRow(pending_, row.id(), row.studentId(), row.name(), row.className(),
+                             row.date(), row.status(), row.remark());
+            }
+            firstRow_ = false;
+            ++rows;
+        });
+    return rows;
+}
+
+std::unique_ptr<ExportService::Stream> ExportService::open(const std::string &type,
+                                                           Format format) const
+{
+    std::vector<Stream::Table> tables;
+    if (type == "students")
+    {
+        tables = {Stream::Table::Students};
+    }
+    else if (type == "attendances")
+    {
+        tables = {Stream::Table::Attendances};
+    }
+    else if (type == "all" && format == Format::Json)
+    {
+        // Same key order as the previous Json::Value based export
+        tables = {Stream::Table::Attendances, Stream::Table::Students};
+    }
+    else
+    {
+        return nullptr;
+    }
+    return std::unique_ptr<Stream>(new Stream(db::Storage::current(), format, std::move(tables)));
+}
+
+bool ExportService::exportTo(const std::string &type, Format format, std::ostream &out) const
+{
+    auto stream = open(type, format);
+    if (!stream)
+    {
+        return false;
+    }
+
+    char buffer[1 << 16];
+    while (auto count = stream->read(buffer, sizeof(buffer)))
+    {
+        out.write(buffer, static_cast<std::streamsize>(count));
+    }
+    return true;
+}
+
+}  // namespace services
+}  // namespace student_attendance
@@ -0,0 +1,449 @@
+#include "student_attendance/services/ImportService.h"
+#include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/ComputePool.h"
+#include "student_attendance/utils/Date.h"
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <trantor/net/EventLoop.h>
+
+namespace student_attendance
+{
+namespace services
+{
+
+namespace
+{
+
+// Input is parsed this much at a time, with the batches it completes
+// applied in between
+constexpr size_t kChunkSize = 64 * 1024;
+
+// CSV columns per import type, in the order the importer reads them
+const std::vector<std::string> kStudentColumns = {"student_id", "name", "class"};
+const std::vector<std::string> kAttendanceColumns = {"student_id", "date", "status", "remark"};
+// Columns that may be left out of the header
+const std::string kOptionalColumn = "remark";
+
+std::string stringMember(const Json::Value &record, const char *name)
+{
+    return record.isMember(name) ? record[name].asString() : std::string();
+}
+
+// Runs `work` on the ComputePool while the awaiting coroutine is suspended,
+// then queues the coroutine back onto `loop`. Without a loop (a blocking
+// caller) the work runs in place.
+struct OnComputePool
+{
+    OnComputePool(std::function<void()> work, trantor::EventLoop *loop)
+        : work(std::move(work)), loop(loop)
+    {
+    }
+
+    std::function<void()> work;
+    trantor::EventLoop *loop;
+    std::exception_ptr error;
+
+    bool await_ready() const noexcept { return loop == nullptr; }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        utils::ComputePool::getInstance().submit([this, handle] {
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            loop->queueInLoop([handle] { handle.resume(); });
+        });
+    }
+
+    void await_resume()
+    {
+        if (!loop)
+        {
+            work();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}  // namespace
+
+ImportService::Importer::Importer(Type type, Format format)
+    : type_(type), format_(format)
+{
+    if (format_ == Format::Json)
+    {
+        Json::CharReaderBuilder builder;
+        jsonReader_.reset(builder.newCharReader());
+    }
+}
+
+void ImportService::Importer::feed(std::string_view chunk)
+{
+    if (failed())
+    {
+        return;
+    }
+
+    if (format_ == Format::Csv)
+    {
+        csv_.feed(chunk, [this](int64_t line, const std::vector<std::string_view> &fields) {
+            addCsvRecord(line, fields);
+        });
+    }
+    else if (!json_.feed(chunk, [this](int64_t index, std::string_view text) {
+                 addJsonElement(index, text);
+             }))
+    {
+        result_.fatal = "JSON数据须为数组";
+    }
+}
+
+void ImportService::Importer::finish()
+{
+    if (failed())
+    {
+        return;
+    }
+
+    if (format_ == Format::Csv)
+    {
+        bool unterminated = csv_.inQuotedField();
+        csv_.finish([this, unterminated](int64_t line,
+                                         const std::vector<std::string_view> &fields) {
+            if (unterminated && headerRead_)
+                reject(line, "数据格式错误");
+            else
+                addCsvRecord(line, fields);
+        });
+        if (!headerRead_ && !failed())
+        {
+            result_.fatal = "CSV缺少表头";
+        }
+    }
+    else if (!json_.opened())
+    {
+        result_.fatal = "JSON数据须为数组";
+    }
+    else if (!json_.complete())
+    {
+        // Truncated inside the last element
+        reject(json_.count() + 1, "数据格式错误");
+    }
+    flush();
+}
+
+// Fields are views into the reader's buffer; statuses and dates are parsed
+// straight from them and only stored strings are copied out.
+void ImportService::Importer::addCsvRecord(int64_t line,
+                                           const std::vector<std::string_view> &fields)
+{
+    if (failed())
+    {
+        return;
+    }
+    if (!headerRead_)
+    {
+        headerRead_ = readHeader(fields);
+        return;
+    }
+
+    auto field = [&](size_t column) {
+        int index = columns_[column];
+        return index >= 0 && static_cast<size_t>(index) < fields.size() ? fields[index]
+                                                                       : std::string_view();
+    };
+
+    if (type_ == Type::Students)
+    {
+        addStudent(line, models::Student(std::string(field(0)), std::string(field(1)),
+                                         std::string(field(2))));
+    }
+    else
+    {
+        addAttendance(line, field(0), field(1), field(2), field(3));
+    }
+}
+
+bool ImportService::Importer::readHeader(const std::vector<std::string_view> &fields)
+{
+    const auto &expected = type_ == Type::Students ? kStudentColumns : kAttendanceColumns;
+    columns_.assign(expected.size(), -1);
+    for (size_t column = 0; column < expected.size(); ++column)
+    {
+        auto it = std::find(fields.begin(), fields.end(), expected[column]);
+        if (it != fields.end())
+        {
+            columns_[column] = static_cast<int>(it - fields.begin());
+        }
+        else if (expected[column] != kOptionalColumn)
+        {
+            result_.fatal = "CSV缺少列: " + expected[column];
+            return false;
+        }
+    }
+    return true;
+}
+
+void ImportService::Importer::addJsonElement(int64_t line, std::string_view text)
+{
+    Json::Value record;
+    std::string errs;
+    if (text.empty() ||
+        !jsonReader_->parse(text.data(), text.data() + text.size(), &record, &errs))
+    {
+        reject(line, "数据格式错误");
+        return;
+    }
+    add(line, record);
+}
+
+void ImportService::Importer::add(int64_t line, const Json::Value &record)
+{
+    if (!record.isObject())
+    {
+        reject(line, "数据格式错误");
+        return;
+    }
+
+    try
+    {
+        if (type_ == Type::Students)
+        {
+            addStudent(line, models::Student::fromJson(record));
+        }
+        else
+        {
+            addAttendance(line,
+                          stringMember(record, "student_id"),
+                          stringMember(record, "date"),
+                          stringMember(record, "status"),
+                          stringMember(record, "remark"));
+        }
+    }
+    catch (const Json::Exception &)
+    {
+        // A member of the wrong type, e.g. an object where a string belongs
+        reject(line, "数据格式错误");
+    }
+}
+
+void ImportService::Importer::addStudent(int64_t line, models::Student student)
+{
+    if (student.studentId.empty())
+    {
+        reject(line, "学号不能为空");
+        return;
+    }
+    if (student.name.empty())
+    {
+        reject(line, "姓名不能为空");
+        return;
+    }
+    if (student.className.empty())
+    {
+        reject(line, "班级不能为空");
+        return;
+    }
+
+    batch_.students.push_back(std::move(student));
+    batch_.lines.push_back(line);
+    if (batch_.lines.size() + batch_.errors.size() >= kBatchSize)
+    {
+        flush();
+    }
+}
+
+void ImportService::Importer::addAttendance(int64_t line,
+                                            std::string_view studentId,
+                                            std::string_view date,
+                                            std::string_view status,
+                                            std::string_view remark)
+{
+    if (studentId.empty())
+    {
+        reject(line, "学号不能为空");
+        return;
+    }
+    auto code = utils::AttendanceStatus::fromString(status);
+    if (!code)
+    {
+        reject(line, "无效的考勤状态");
+        return;
+    }
+    auto day = utils::Date::parse(date);
+    if (!day)
+    {
+        reject(line, "无效的考勤日期");
+        return;
+    }
+
+    models::Attendance att;
+    att.studentId = studentId;
+    att.date = *day;
+    att.status = *code;
+    att.remark = remark;
+    batch_.attendances.push_back(std::move(att));
+    batch_.lines.push_back(line);
+    if (batch_.lines.size() + batch_.errors.size() >= kBatchSize)
+    {
+        flush();
+    }
+}
+
+void ImportService::Importer::reject(int64_t line, std::string message)
+{
+    result_.skippedCount++;
+    batch_.errors.push_back({line, std::move(message)});
+    if (batch_.lines.size() + batch_.errors.size() >= kBatchSize)
+    {
+        flush();
+    }
+}
+
+void ImportService::Importer::flush()
+{
+    if (!batch_.lines.empty() || !batch_.errors.empty())
+    {
+        batches_.push_back(std::move(batch_));
+        batch_ = Batch();
+    }
+}
+
+// Reports each batch's errors in line order: rows the storage turned away
+// are merged with those rejected up front.
+drogon::Task<> ImportService::Importer::apply(db::Storage &storage)
+{
+    while (!batches_.empty())
+    {
+        auto batch = std::move(batches_.front());
+        batches_.pop_front();
+
+        std::vector<LineError> storeErrors;
+        if (type_ == Type::Students && !batch.students.empty())
+        {
+            std::vector<bool> added;
+            co_await storage.addStudents(batch.students, added);
+            for (size_t i = 0; i < batch.students.size(); ++i)
+            {
+                if (!added[i])
+                {
+                    storeErrors.push_back({batch.lines[i], "学号已存在"});
+                }
+            }
+        }
+        else if (type_ == Type::Attendances && !batch.attendances.empty())
+        {
+            co_await storage.addAttendances(batch.attendances);
+            for (size_t i = 0; i < batch.attendances.size(); ++i)
+            {
+                if (batch.attendances[i].id == 0)
+                {
+                    storeErrors.push_back({batch.lines[i], "学生不存在"});
+                }
+            }
+        }
+        result_.importedCount += static_cast<int>(batch.lines.size() - storeErrors.size());
+        result_.skippedCount += static_cast<int>(storeErrors.size());
+
+        std::vector<LineError> errors;
+        errors.reserve(batch.errors.size() + storeErrors.size());
+        std::merge(std::make_move_iterator(batch.errors.begin()),
+                   std::make_move_iterator(batch.errors.end()),
+                   std::make_move_iterator(storeErrors.begin()),
+                   std::make_move_iterator(storeErrors.end()),
+                   std::back_inserter(errors),
+                   [](const LineError &a, const LineError &b) { return a.line < b.line; });
+        for (auto &error : errors)
+        {
+            record(std::move(error));
+        }
+    }
+}
+
+void ImportService::Importer::record(LineError error)
+{
+    if (result_.errors.size() < kMaxErrors)
+    {
+        result_.errors.push_back(std::move(error));
+    }
+    else
+    {
+        result_.errorsTruncated = true;
+    }
+}
+
+drogon::Task<ImportService::Result> ImportService::importCoro(Type type,
+                                                              Format format,
+                                                              std::string_view content)
+{
+    auto &storage = db::Storage::current();
+    auto *loop = trantor::EventLoop::getEventLoopOfCurrentThread();
+    Importer importer(type, format);
+    size_t offset = 0;
+    while (offset < content.size() && !importer.failed())
+    {
+        // Parsed on a worker up to the next full batch; only the storage
+        // writes run on the request's loop
+        co_await OnComputePool{[&] {
+            while (offset < content.size() && !importer.failed() && !importer.hasBatches())
+            {
+                importer.feed(content.substr(offset, kChunkSize));
+                offset += kChunkSize;
+            }
+        }, loop};
+        co_await importer.apply(storage);
+    }
+    importer.finish();
+    co_await importer.apply(storage);
+    co_return importer.result();
+}
+
+drogon::Task<ImportService::Result> ImportService::importCoro(Type type,
+                                                              const Json::Value &records)
+{
+    if (!records.isArray())
+    {
+        Result result;
+        result.fatal = "JSON数据须为数组";
+        co_return result;
+    }
+
+    auto &storage = db::Storage::current();
+    Importer importer(type, Format::Json);
+    for (Json::ArrayIndex i = 0; i < records.size(); ++i)
+    {
+        importer.add(static_cast<int64_t>(i) + 1, records[i]);
+        if (importer.hasBatches())
+        {
+            co_await importer.apply(storage);
+        }
+    }
+    importer.flush();
+    co_await importer.apply(storage);
+    co_return importer.result();
+}
+
+ImportService::Result ImportService::import(Type type, Format format, std::string_view content)
+{
+    return drogon::sync_wait(importCoro(type, format, content));
+}
+
+ImportService::Result ImportService::import(Type type, const Json::Value &records)
+{
+    return drogon::sync_wait(importCoro(type, records));
+}
+
+}  // namespace services
+}  // namespace student_attendance
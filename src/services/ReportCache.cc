@@ -0,0 +1,175 @@
+#include "student_attendance/services/ReportCache.h"
+#include <trantor/net/EventLoop.h>
+
+namespace student_attendance
+{
+namespace services
+{
+
+ReportCache::Body ReportCache::get(const std::string &key, const Scope &scope, const Write &write)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (maxEntries_ == 0)
+    {
+        stats_.misses++;
+        lock.unlock();
+        return compute(write);
+    }
+
+    auto found = index_.find(key);
+    if (found != index_.end())
+    {
+        auto entry = found->second;
+        // Checked in flight too: a write after the stamp may be missing from
+        // the result being computed
+        if (!fresh(*entry))
+        {
+            stats_.invalidations++;
+            erase(entry);
+        }
+        else if (entry->ready)
+        {
+            stats_.hits++;
+            entries_.splice(entries_.begin(), entries_, entry);
+            return entry->body.get();
+        }
+        else if (!trantor::EventLoop::getEventLoopOfCurrentThread())
+        {
+            // Someone is computing it right now; wait for that result
+            stats_.hits++;
+            auto body = entry->body;
+            lock.unlock();
+            return body.get();
+        }
+        else
+        {
+            // An I/O loop must not wait, so it computes its own copy
+            stats_.misses++;
+            lock.unlock();
+            return compute(write);
+        }
+    }
+
+    // Stamped before computing, so a write that lands meanwhile marks the
+    // result stale
+    stats_.misses++;
+    std::promise<Body> promise;
+    auto ticket = ++tickets_;
+    auto &storage = db::Storage::current();
+    entries_.push_front(Entry{key, scope, &storage, storage.generation(), ticket,
+                              promise.get_future().share()});
+    index_[key] = entries_.begin();
+    lock.unlock();
+
+    Body body;
+    try
+    {
+        body = compute(write);
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        auto it = index_.find(key);
+        if (it != index_.end() && it->second->ticket == ticket)
+        {
+            erase(it->second);
+        }
+        throw;
+    }
+    promise.set_value(body);
+
+    lock.lock();
+    auto it = index_.find(key);
+    if (it != index_.end() && it->second->ticket == ticket)
+    {
+        it->second->ready = true;
+        it->second->bytes = key.size() + body->capacity();
+        bytes_ += it->second->bytes;
+        evict();
+    }
+    return body;
+}
+
+ReportCache::Body ReportCache::compute(const Write &write)
+{
+    std::string text;
+    utils::JsonWriter json(text);
+    write(json);
+    return std::make_shared<const std::string>(std::move(text));
+}
+
+bool ReportCache::fresh(const Entry &entry) const
+{
+    const auto &storage = db::Storage::current();
+    if (entry.storage != &storage)
+    {
+        return false;
+    }
+    const auto &scope = entry.scope;
+    if (storage.attendanceGeneration(scope.className, scope.first, scope.last) >
+        entry.generation)
+    {
+        return false;
+    }
+    return !scope.roster || storage.rosterGeneration(scope.className) <= entry.generation;
+}
+
+void ReportCache::erase(EntryList::iterator entry)
+{
+    bytes_ -= entry->bytes;
+    index_.erase(entry->key);
+    entries_.erase(entry);
+}
+
+// Entries still being computed hold no bytes yet and are left alone.
+void ReportCache::evict()
+{
+    auto it = entries_.end();
+    while (it != entries_.begin() && (index_.size() > maxEntries_ || bytes_ > maxBytes_))
+    {
+        --it;
+        if (!it->ready)
+        {
+            continue;
+        }
+        stats_.evictions++;
+        auto victim = it++;
+        erase(victim);
+    }
+}
+
+void ReportCache::setCapacity(size_t maxEntries, size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxEntries_ = maxEntries;
+    maxBytes_ = maxBytes;
+    evict();
+}
+
+void ReportCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Computations in flight find their entry gone and keep their result
+    index_.clear();
+    entries_.clear();
+    bytes_ = 0;
+}
+
+ReportCache::Stats ReportCache::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = index_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+void ReportCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = Stats{};
+}
+
+}  // namespace services
+}  // namespace student_attendance
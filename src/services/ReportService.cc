@@ -1,231 +1,495 @@
 #include "student_attendance/services/ReportService.h"
+#include "student_attendance/db/Storage.h"
 #include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/ComputePool.h"
+#include "student_attendance/utils/Date.h"
 #include <unordered_map>
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <queue>
+#include <string_view>
 
 namespace student_attendance
 {
 namespace services
 {
 
-Json::Value ReportService::getDetailsReport(
-    const std::string &startDate,
-    const std::string &endDate,
-    const std::string &className,
-    const std::string &studentId) const
+namespace
+{
+
+using utils::AttendanceStatus;
+using utils::ComputePool;
+using utils::Date;
+using utils::StatusCode;
+
+// Smallest share of a report worth handing to another thread
+constexpr size_t kMinRowsPerPart = 16 * 1024;
+constexpr size_t kMinItemsPerPart = 512;
+
+struct StatusTally
 {
-    Json::Value result;
+    int total = 0;
+    models::StatusHistogram counts{};
 
-    // Period
-    Json::Value period;
-    period["start_date"] = startDate;
-    period["end_date"] = endDate;
-    result["period"] = period;
+    StatusTally() = default;
 
-    // Get students
-    auto students = dataStore_.getAllStudents();
-    if (!className.empty())
+    explicit StatusTally(const models::StatusHistogram &histogram) : counts(histogram)
     {
-        students.erase(
-            std::remove_if(students.begin(), students.end(),
-                [&className](const models::Student &s) {
-                    return s.className != className;
-                }),
-            students.end());
+        for (int count : counts)
+        {
+            total += count;
+        }
     }
-    if (!studentId.empty())
+
+    void add(StatusCode status)
     {
-        students.erase(
-            std::remove_if(students.begin(), students.end(),
-                [&studentId](const models::Student &s) {
-                    return s.studentId != studentId;
-                }),
-            students.end());
+        total++;
+        counts[static_cast<size_t>(status)]++;
     }
 
-    // Get attendances
-    auto attendances = dataStore_.searchAttendances(
-        "", "", className, "", startDate, endDate, "");
+    int operator[](StatusCode status) const
+    {
+        return counts[static_cast<size_t>(status)];
+    }
+};
 
-    // Group attendances by student
-    std::unordered_map<std::string, std::vector<models::Attendance>> studentAttendances;
-    for (const auto &att : attendances)
+// Narrows a report filter to an explicit status type. Returns false when the
+// type is not a known status, in which case nothing can match.
+bool applyStatusType(const std::string &type, models::AttendanceFilter &filter)
+{
+    if (type.empty())
     {
-        studentAttendances[att.studentId].push_back(att);
+        return true;
     }
+    filter.status = AttendanceStatus::fromString(type);
+    return filter.status.has_value();
+}
 
-    Json::Value records(Json::arrayValue);
-    for (const auto &student : students)
+// Report dates arrive as request text. An empty date leaves that side of the
+// range open; a malformed one makes the whole report match nothing.
+bool applyDateRange(const std::string &startDate, const std::string &endDate,
+                    models::AttendanceFilter &filter)
+{
+    if (!startDate.empty())
     {
-        Json::Value record;
-        record["student_id"] = student.studentId;
-        record["name"] = student.name;
-        record["class"] = student.className;
-
-        Json::Value details(Json::arrayValue);
-        auto it = studentAttendances.find(student.studentId);
-        if (it != studentAttendances.end())
-        {
-            for (const auto &att : it->second)
-            {
-                Json::Value detail;
-                detail["date"] = att.date;
-                detail["status"] = att.status;
-                detail["symbol"] = utils::AttendanceStatus::getSymbol(att.status);
-                details.append(detail);
-            }
-        }
-        record["attendance_details"] = details;
-        records.append(record);
+        filter.startDate = Date::parse(startDate);
+        if (!filter.startDate)
+            return false;
+    }
+    if (!endDate.empty())
+    {
+        filter.endDate = Date::parse(endDate);
+        if (!filter.endDate)
+            return false;
     }
+    return true;
+}
 
-    result["records"] = records;
-    return result;
+// Echoes a parsed date in canonical form, or the raw text when it did not parse.
+std::string formatDate(const std::optional<Date> &date, const std::string &text)
+{
+    return date ? date->toString() : text;
 }
 
-Json::Value ReportService::getDailyReport(
-    const std::string &date,
-    const std::string &className) const
+void writePeriod(utils::JsonWriter &json, const models::AttendanceFilter &filter,
+                 const std::string &startDate, const std::string &endDate)
 {
-    Json::Value result;
-    result["date"] = date;
+    json.key("period")
+        .beginObject()
+        .member("start_date", formatDate(filter.startDate, startDate))
+        .member("end_date", formatDate(filter.endDate, endDate))
+        .endObject();
+}
 
-    // Get attendances for the date
-    auto attendances = dataStore_.searchAttendances(
-        "", "", className, date, "", "", "");
+std::string formatRate(int present, int total)
+{
+    double rate = total > 0 ?
+        (static_cast<double>(present) / total * 100.0) : 0.0;
+    char buffer[32];
+    auto length = std::snprintf(buffer, sizeof(buffer), "%.2f%%", rate);
+    return std::string(buffer, static_cast<size_t>(length));
+}
 
-    // Count statistics
-    int totalStudents = static_cast<int>(attendances.size());
-    int present = 0, absent = 0, late = 0, earlyLeave = 0;
-    int personalLeave = 0, sickLeave = 0;
+// The tree form of a report, for callers that inspect it rather than send it.
+Json::Value parseReport(const std::string &text)
+{
+    static thread_local std::unique_ptr<Json::CharReader> reader = [] {
+        Json::CharReaderBuilder builder;
+        return std::unique_ptr<Json::CharReader>(builder.newCharReader());
+    }();
+    Json::Value value;
+    std::string errors;
+    reader->parse(text.data(), text.data() + text.size(), &value, &errors);
+    return value;
+}
 
-    for (const auto &att : attendances)
+// Students a report lists, by class and then id, so that output does not
+// depend on hash order.
+void sortRoster(std::vector<models::Student> &students)
+{
+    std::sort(students.begin(), students.end(),
+              [](const models::Student &a, const models::Student &b) {
+                  return a.className != b.className ? a.className < b.className
+                                                    : a.studentId < b.studentId;
+              });
+}
+
+// Writes items [0, count) as consecutive array elements. Long arrays are
+// written in parts on the ComputePool, each into its own buffer, and joined
+// in order, so the text is the same as a serial write.
+template <typename WriteItem>
+void writeItems(utils::JsonWriter &json, size_t count, WriteItem &&writeItem)
+{
+    auto &pool = ComputePool::getInstance();
+    size_t parts = pool.partitions(count, kMinItemsPerPart);
+    if (parts == 1)
     {
-        if (att.status == "present") present++;
-        else if (att.status == "absent") absent++;
-        else if (att.status == "late") late++;
-        else if (att.status == "early_leave") earlyLeave++;
-        else if (att.status == "personal_leave") personalLeave++;
-        else if (att.status == "sick_leave") sickLeave++;
+        for (size_t i = 0; i < count; ++i)
+        {
+            writeItem(json, i);
+        }
+        return;
     }
 
-    // Calculate attendance rate
-    double rate = totalStudents > 0 ?
-        (static_cast<double>(present) / totalStudents * 100.0) : 0.0;
-    std::ostringstream rateStr;
-    rateStr << std::fixed << std::setprecision(2) << rate << "%";
-
-    Json::Value summary;
-    summary["total_students"] = totalStudents;
-    summary["present"] = present;
-    summary["absent"] = absent;
-    summary["late"] = late;
-    summary["early_leave"] = earlyLeave;
-    summary["personal_leave"] = personalLeave;
-    summary["sick_leave"] = sickLeave;
-    summary["attendance_rate"] = rateStr.str();
-    result["summary"] = summary;
-
-    // Details
-    Json::Value details(Json::arrayValue);
-    for (const auto &att : attendances)
+    std::vector<std::string> texts(parts);
+    pool.parallelFor(parts, [&](size_t part) {
+        utils::JsonWriter out(texts[part]);
+        size_t end = count * (part + 1) / parts;
+        for (size_t i = count * part / parts; i < end; ++i)
+        {
+            writeItem(out, i);
+        }
+    });
+    for (const auto &text : texts)
     {
-        Json::Value detail;
-        detail["student_id"] = att.studentId;
-        detail["name"] = att.name;
-        detail["class"] = att.className;
-        detail["status"] = att.status;
-        detail["symbol"] = utils::AttendanceStatus::getSymbol(att.status);
-        details.append(detail);
+        if (!text.empty())
+        {
+            json.raw(text);
+        }
     }
-    result["details"] = details;
+}
 
-    return result;
+// Writes the records matching `filter` as array elements in id order.
+// writeRow(out, row) writes one element and returns true, or returns false to
+// skip the row. The snapshot's shards are written concurrently, each into its
+// own buffer, and their elements merged by id. Returns a tally of the rows
+// written.
+template <typename WriteRow>
+StatusTally writeRowsById(const models::DataSnapshot &data, utils::JsonWriter &json,
+                          const models::AttendanceFilter &filter, WriteRow &&writeRow)
+{
+    struct Part
+    {
+        std::string text;
+        // Id and end offset in text of each element
+        std::vector<std::pair<int, size_t>> rows;
+        StatusTally tally;
+    };
+    std::vector<Part> parts;
+    data.scanAttendancesPartitioned(
+        filter, kMinRowsPerPart,
+        [&parts](size_t count) { parts.resize(count); },
+        [&](size_t p, const models::AttendanceTable::Row &row) {
+            auto &part = parts[p];
+            // A fresh writer per element, so none starts with a separator
+            utils::JsonWriter out(part.text);
+            if (writeRow(out, row))
+            {
+                part.rows.emplace_back(row.id(), part.text.size());
+                part.tally.add(row.status());
+            }
+        });
+
+    // (next id, part), smallest id first
+    using Head = std::pair<int, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<size_t> next(parts.size(), 0);
+    StatusTally tally;
+    for (size_t p = 0; p < parts.size(); ++p)
+    {
+        if (!parts[p].rows.empty())
+        {
+            heads.emplace(parts[p].rows.front().first, p);
+        }
+        tally.total += parts[p].tally.total;
+        for (size_t code = 0; code < tally.counts.size(); ++code)
+        {
+            tally.counts[code] += parts[p].tally.counts[code];
+        }
+    }
+    while (!heads.empty())
+    {
+        size_t p = heads.top().second;
+        heads.pop();
+        const auto &part = parts[p];
+        size_t &i = next[p];
+        size_t begin = i == 0 ? 0 : part.rows[i - 1].second;
+        json.raw(std::string_view(part.text).substr(begin, part.rows[i].second - begin));
+        if (++i < part.rows.size())
+        {
+            heads.emplace(part.rows[i].first, p);
+        }
+    }
+    return tally;
 }
 
-Json::Value ReportService::getSummaryReport(
+// Cache key: the report type and its parameters as given
+std::string cacheKey(std::initializer_list<std::string_view> parts)
+{
+    std::string key;
+    for (auto part : parts)
+    {
+        key += part;
+        key += '\x1f';
+    }
+    return key;
+}
+
+// A date that does not parse leaves that side open, which only makes the
+// entry stale more often than needed.
+ReportCache::Scope cacheScope(const std::string &className,
+                              const std::string &startDate,
+                              const std::string &endDate,
+                              bool roster)
+{
+    ReportCache::Scope scope;
+    scope.className = className;
+    scope.first = Date::parse(startDate);
+    scope.last = Date::parse(endDate);
+    scope.roster = roster;
+    return scope;
+}
+
+// Runs one of the write*Report() members into a string and parses it.
+template <typename Write>
+Json::Value reportTree(Write &&write)
+{
+    std::string text;
+    utils::JsonWriter json(text);
+    write(json);
+    return parseReport(text);
+}
+
+}  // namespace
+
+Json::Value ReportService::getDetailsReport(
     const std::string &startDate,
     const std::string &endDate,
-    const std::string &className) const
+    const std::string &className,
+    const std::string &studentId) const
 {
-    Json::Value result;
-
-    Json::Value period;
-    period["start_date"] = startDate;
-    period["end_date"] = endDate;
-    result["period"] = period;
+    return reportTree([&](utils::JsonWriter &json) {
+        writeDetailsReport(json, startDate, endDate, className, studentId);
+    });
+}
 
-    // Get students
-    auto students = dataStore_.getAllStudents();
-    if (!className.empty())
+void ReportService::buildDetailsReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &studentId) const
+{
+    models::AttendanceFilter filter;
+    filter.studentId = studentId;
+    filter.className = className;
+    bool validRange = applyDateRange(startDate, endDate, filter);
+
+    json.beginObject();
+    writePeriod(json, filter, startDate, endDate);
+
+    db::ReportScope scope;
+    scope.filter = filter;
+    scope.attendances = validRange;
+    auto data = db::Storage::current().snapshot(scope);
+    std::vector<models::Student> students;
+    if (!studentId.empty())
     {
-        students.erase(
-            std::remove_if(students.begin(), students.end(),
-                [&className](const models::Student &s) {
-                    return s.className != className;
-                }),
-            students.end());
+        auto student = data->getStudentById(studentId);
+        if (student && (className.empty() || student->className == className))
+        {
+            students.push_back(std::move(*student));
+        }
     }
-
-    // Get attendances
-    auto attendances = dataStore_.searchAttendances(
-        "", "", className, "", startDate, endDate, "");
-
-    // Group by student
-    std::unordered_map<std::string, std::vector<models::Attendance>> studentAttendances;
-    for (const auto &att : attendances)
+    else
     {
-        studentAttendances[att.studentId].push_back(att);
+        students = className.empty() ? data->getAllStudents()
+                                     : data->getStudentsByClass(className);
+        sortRoster(students);
     }
 
-    Json::Value summaryArray(Json::arrayValue);
-    for (const auto &student : students)
+    // Rows are grouped by student within each part of the scan. A student's
+    // rows all fall in one part, in id order, as a serial scan would list
+    // them.
+    struct Detail
     {
-        Json::Value item;
-        item["student_id"] = student.studentId;
-        item["name"] = student.name;
-        item["class"] = student.className;
+        Date date;
+        StatusCode status;
+    };
+    using Details = std::unordered_map<std::string, std::vector<Detail>>;
+    std::vector<Details> slices;
+    if (validRange)
+    {
+        data->scanAttendancesPartitioned(
+            filter, kMinRowsPerPart,
+            [&slices](size_t parts) { slices.resize(parts); },
+            [&slices](size_t part, const models::AttendanceTable::Row &row) {
+                slices[part][row.studentId()].push_back({row.date(), row.status()});
+            });
+    }
 
-        int totalDays = 0, presentCount = 0, absentCount = 0;
-        int lateCount = 0, earlyLeaveCount = 0;
-        int personalLeaveCount = 0, sickLeaveCount = 0;
+    json.key("records").beginArray();
+    writeItems(json, students.size(), [&](utils::JsonWriter &out, size_t i) {
+        const auto &student = students[i];
+        out.beginObject()
+            .member("student_id", student.studentId)
+            .member("name", student.name)
+            .member("class", student.className);
 
-        auto it = studentAttendances.find(student.studentId);
-        if (it != studentAttendances.end())
+        out.key("attendance_details").beginArray();
+        for (const auto &slice : slices)
         {
-            totalDays = static_cast<int>(it->second.size());
-            for (const auto &att : it->second)
+            auto it = slice.find(student.studentId);
+            if (it == slice.end())
             {
-                if (att.status == "present") presentCount++;
-                else if (att.status == "absent") absentCount++;
-                else if (att.status == "late") lateCount++;
-                else if (att.status == "early_leave") earlyLeaveCount++;
-                else if (att.status == "personal_leave") personalLeaveCount++;
-                else if (att.status == "sick_leave") sickLeaveCount++;
+                continue;
+            }
+            for (const auto &detail : it->second)
+            {
+                out.beginObject()
+                    .member("date", detail.date.toString())
+                    .member("status", AttendanceStatus::toString(detail.status))
+                    .member("symbol", AttendanceStatus::getSymbol(detail.status))
+                    .endObject();
             }
         }
+        out.endArray();
+        out.endObject();
+    });
+    json.endArray();
+    json.endObject();
+}
 
-        double rate = totalDays > 0 ?
-            (static_cast<double>(presentCount) / totalDays * 100.0) : 0.0;
-        std::ostringstream rateStr;
-        rateStr << std::fixed << std::setprecision(2) << rate << "%";
-
-        item["total_days"] = totalDays;
-        item["present_count"] = presentCount;
-        item["absent_count"] = absentCount;
-        item["late_count"] = lateCount;
-        item["early_leave_count"] = earlyLeaveCount;
-        item["personal_leave_count"] = personalLeaveCount;
-        item["sick_leave_count"] = sickLeaveCount;
-        item["attendance_rate"] = rateStr.str();
-
-        summaryArray.append(item);
+Json::Value ReportService::getDailyReport(
+    const std::string &date,
+    const std::string &className) const
+{
+    return reportTree([&](utils::JsonWriter &json) {
+        writeDailyReport(json, date, className);
+    });
+}
+
+void ReportService::buildDailyReport(
+    utils::JsonWriter &json,
+    const std::string &date,
+    const std::string &className) const
+{
+    models::AttendanceFilter filter;
+    filter.className = className;
+    filter.date = Date::parse(date);
+
+    json.beginObject();
+    json.member("date", formatDate(filter.date, date));
+
+    // Statistics come from the per-day aggregates; details still list rows
+    db::ReportScope scope;
+    scope.filter = filter;
+    scope.students = false;
+    scope.attendances = filter.date.has_value();
+    auto data = db::Storage::current().snapshot(scope);
+    StatusTally tally;
+    if (filter.date)
+    {
+        tally = StatusTally(data->dailyHistogram(*filter.date, className));
+    }
+
+    json.key("summary")
+        .beginObject()
+        .member("total_students", tally.total)
+        .member("present", tally[StatusCode::Present])
+        .member("absent", tally[StatusCode::Absent])
+        .member("late", tally[StatusCode::Late])
+        .member("early_leave", tally[StatusCode::EarlyLeave])
+        .member("personal_leave", tally[StatusCode::PersonalLeave])
+        .member("sick_leave", tally[StatusCode::SickLeave])
+        .member("attendance_rate", formatRate(tally[StatusCode::Present], tally.total))
+        .endObject();
+
+    json.key("details").beginArray();
+    if (filter.date)
+    {
+        writeRowsById(*data, json, filter,
+                      [](utils::JsonWriter &out, const models::AttendanceTable::Row &row) {
+            out.beginObject()
+                .member("student_id", row.studentId())
+                .member("name", row.name())
+                .member("class", row.className())
+                .member("status", AttendanceStatus::toString(row.status()))
+                .member("symbol", AttendanceStatus::getSymbol(row.status()))
+                .endObject();
+            return true;
+        });
     }
+    json.endArray();
+    json.endObject();
+}
 
-    result["summary"] = summaryArray;
-    return result;
+Json::Value ReportService::getSummaryReport(
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className) const
+{
+    return reportTree([&](utils::JsonWriter &json) {
+        writeSummaryReport(json, startDate, endDate, className);
+    });
+}
+
+void ReportService::buildSummaryReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className) const
+{
+    models::AttendanceFilter filter;
+    filter.className = className;
+    bool validRange = applyDateRange(startDate, endDate, filter);
+
+    json.beginObject();
+    writePeriod(json, filter, startDate, endDate);
+
+    // Per-student counts over the range: summed from the pre-aggregated
+    // day cells in memory, or by one GROUP BY query in SQLite
+    auto summaries =
+        db::Storage::current().studentSummaries(className, filter.startDate, filter.endDate);
+
+    json.key("summary").beginArray();
+    writeItems(json, summaries.size(), [&](utils::JsonWriter &out, size_t i) {
+        const auto &student = summaries[i].student;
+        StatusTally tally;
+        if (validRange)
+        {
+            tally = StatusTally(summaries[i].histogram);
+        }
+
+        out.beginObject()
+            .member("student_id", student.studentId)
+            .member("name", student.name)
+            .member("class", student.className)
+            .member("total_days", tally.total)
+            .member("present_count", tally[StatusCode::Present])
+            .member("absent_count", tally[StatusCode::Absent])
+            .member("late_count", tally[StatusCode::Late])
+            .member("early_leave_count", tally[StatusCode::EarlyLeave])
+            .member("personal_leave_count", tally[StatusCode::PersonalLeave])
+            .member("sick_leave_count", tally[StatusCode::SickLeave])
+            .member("attendance_rate", formatRate(tally[StatusCode::Present], tally.total))
+            .endObject();
+    });
+    json.endArray();
+    json.endObject();
 }
 
 Json::Value ReportService::getAbnormalReport(
@@ -234,65 +498,67 @@ Json::Value ReportService::getAbnormalReport(
     const std::string &className,
     const std::string &type) const
 {
-    Json::Value result;
+    return reportTree([&](utils::JsonWriter &json) {
+        writeAbnormalReport(json, startDate, endDate, className, type);
+    });
+}
 
-    Json::Value period;
-    period["start_date"] = startDate;
-    period["end_date"] = endDate;
-    result["period"] = period;
+void ReportService::buildAbnormalReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &type) const
+{
+    models::AttendanceFilter filter;
+    filter.className = className;
+    bool validRange = applyDateRange(startDate, endDate, filter);
 
-    // Get attendances
-    auto attendances = dataStore_.searchAttendances(
-        "", "", className, "", startDate, endDate, "");
+    json.beginObject();
+    writePeriod(json, filter, startDate, endDate);
 
-    // Filter abnormal records
-    std::vector<models::Attendance> abnormalRecords;
-    int absentCount = 0, lateCount = 0, earlyLeaveCount = 0;
+    // Filter abnormal records; an explicit type narrows the scan to that status
+    StatusTally tally;
+    bool anyType = type.empty();
 
-    for (const auto &att : attendances)
+    json.key("abnormal_records").beginArray();
+    if (validRange && applyStatusType(type, filter))
     {
-        bool isAbnormal = false;
-        if (type.empty())
-        {
-            isAbnormal = utils::AttendanceStatus::isAbnormalStatus(att.status);
-        }
-        else
-        {
-            isAbnormal = (att.status == type);
-        }
-
-        if (isAbnormal)
-        {
-            abnormalRecords.push_back(att);
-            if (att.status == "absent") absentCount++;
-            else if (att.status == "late") lateCount++;
-            else if (att.status == "early_leave") earlyLeaveCount++;
-        }
-    }
+        db::ReportScope scope;
+        scope.filter = filter;
+        scope.students = false;
+        auto data = db::Storage::current().snapshot(scope);
+        tally = writeRowsById(*data, json, filter,
+                              [anyType](utils::JsonWriter &out,
+                                        const models::AttendanceTable::Row &row) {
+            StatusCode status = row.status();
+            if (anyType && !AttendanceStatus::isAbnormalStatus(status))
+            {
+                return false;
+            }
 
-    Json::Value records(Json::arrayValue);
-    for (const auto &att : abnormalRecords)
-    {
-        Json::Value record;
-        record["student_id"] = att.studentId;
-        record["name"] = att.name;
-        record["class"] = att.className;
-        record["date"] = att.date;
-        record["status"] = att.status;
-        record["symbol"] = utils::AttendanceStatus::getSymbol(att.status);
-        record["remark"] = att.remark;
-        records.append(record);
+            out.beginObject()
+                .member("student_id", row.studentId())
+                .member("name", row.name())
+                .member("class", row.className())
+                .member("date", row.date().toString())
+                .member("status", AttendanceStatus::toString(status))
+                .member("symbol", AttendanceStatus::getSymbol(status))
+                .member("remark", row.remark())
+                .endObject();
+            return true;
+        });
     }
-    result["abnormal_records"] = records;
-
-    Json::Value statistics;
-    statistics["total_abnormal"] = static_cast<int>(abnormalRecords.size());
-    statistics["absent_count"] = absentCount;
-    statistics["late_count"] = lateCount;
-    statistics["early_leave_count"] = earlyLeaveCount;
-    result["statistics"] = statistics;
-
-    return result;
+    json.endArray();
+
+    json.key("statistics")
+        .beginObject()
+        .member("total_abnormal", tally.total)
+        .member("absent_count", tally[StatusCode::Absent])
+        .member("late_count", tally[StatusCode::Late])
+        .member("early_leave_count", tally[StatusCode::EarlyLeave])
+        .endObject();
+    json.endObject();
 }
 
 Json::Value ReportService::getLeaveReport(
@@ -301,65 +567,142 @@ Json::Value ReportService::getLeaveReport(
     const std::string &className,
     const std::string &type) const
 {
-    Json::Value result;
+    return reportTree([&](utils::JsonWriter &json) {
+        writeLeaveReport(json, startDate, endDate, className, type);
+    });
+}
 
-    Json::Value period;
-    period["start_date"] = startDate;
-    period["end_date"] = endDate;
-    result["period"] = period;
+void ReportService::buildLeaveReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &type) const
+{
+    models::AttendanceFilter filter;
+    filter.className = className;
+    bool validRange = applyDateRange(startDate, endDate, filter);
 
-    // Get attendances
-    auto attendances = dataStore_.searchAttendances(
-        "", "", className, "", startDate, endDate, "");
+    json.beginObject();
+    writePeriod(json, filter, startDate, endDate);
 
-    // Filter leave records
-    std::vector<models::Attendance> leaveRecords;
-    int personalLeaveCount = 0, sickLeaveCount = 0;
+    // Filter leave records; an explicit type narrows the scan to that status
+    StatusTally tally;
+    bool anyType = type.empty();
 
-    for (const auto &att : attendances)
+    json.key("leave_records").beginArray();
+    if (validRange && applyStatusType(type, filter))
     {
-        bool isLeave = false;
-        if (type.empty())
-        {
-            isLeave = utils::AttendanceStatus::isLeaveStatus(att.status);
-        }
-        else
-        {
-            isLeave = (att.status == type);
-        }
+        db::ReportScope scope;
+        scope.filter = filter;
+        scope.students = false;
+        auto data = db::Storage::current().snapshot(scope);
+        tally = writeRowsById(*data, json, filter,
+                              [anyType](utils::JsonWriter &out,
+                                        const models::AttendanceTable::Row &row) {
+            StatusCode status = row.status();
+            if (anyType && !AttendanceStatus::isLeaveStatus(status))
+            {
+                return false;
+            }
 
-        if (isLeave)
-        {
-            leaveRecords.push_back(att);
-            if (att.status == "personal_leave") personalLeaveCount++;
-            else if (att.status == "sick_leave") sickLeaveCount++;
-        }
+            out.beginObject()
+                .member("student_id", row.studentId())
+                .member("name", row.name())
+                .member("class", row.className())
+                .member("date", row.date().toString())
+                .member("type", AttendanceStatus::toString(status))
+                .member("symbol", AttendanceStatus::getSymbol(status))
+                .member("remark", row.remark())
+                .endObject();
+            return true;
+        });
     }
+    json.endArray();
+
+    json.key("statistics")
+        .beginObject()
+        .member("total_leave", tally.total)
+        .member("personal_leave_count", tally[StatusCode::PersonalLeave])
+        .member("sick_leave_count", tally[StatusCode::SickLeave])
+        .endObject();
+    json.endObject();
+}
 
-    Json::Value records(Json::arrayValue);
-    for (const auto &att : leaveRecords)
-    {
-        Json::Value record;
-        record["student_id"] = att.studentId;
-        record["name"] = att.name;
-        record["class"] = att.className;
-        record["date"] = att.date;
-        record["type"] = att.status;
-        record["symbol"] = utils::AttendanceStatus::getSymbol(att.status);
-        record["remark"] = att.remark;
-        records.append(record);
-    }
-    result["leave_records"] = records;
+void ReportService::writeDetailsReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &studentId) const
+{
+    auto body = cache_.get(
+        cacheKey({"details", startDate, endDate, className, studentId}),
+        cacheScope(className, startDate, endDate, true),
+        [&](utils::JsonWriter &out) {
+            buildDetailsReport(out, startDate, endDate, className, studentId);
+        });
+    json.raw(*body);
+}
 
-    Json::Value statistics;
-    statistics["total_leave"] = static_cast<int>(leaveRecords.size());
-    statistics["personal_leave_count"] = personalLeaveCount;
-    statistics["sick_leave_count"] = sickLeaveCount;
-    result["statistics"] = statistics;
+void ReportService::writeDailyReport(
+    utils::JsonWriter &json,
+    const std::string &date,
+    const std::string &className) const
+{
+    auto body = cache_.get(
+        cacheKey({"daily", date, className}),
+        cacheScope(className, date, date, false),
+        [&](utils::JsonWriter &out) { buildDailyReport(out, date, className); });
+    json.raw(*body);
+}
 
-    return result;
+void ReportService::writeSummaryReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className) const
+{
+    auto body = cache_.get(
+        cacheKey({"summary", startDate, endDate, className}),
+        cacheScope(className, startDate, endDate, true),
+        [&](utils::JsonWriter &out) {
+            buildSummaryReport(out, startDate, endDate, className);
+        });
+    json.raw(*body);
+}
+
+void ReportService::writeAbnormalReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &type) const
+{
+    auto body = cache_.get(
+        cacheKey({"abnormal", startDate, endDate, className, type}),
+        cacheScope(className, startDate, endDate, false),
+        [&](utils::JsonWriter &out) {
+            buildAbnormalReport(out, startDate, endDate, className, type);
+        });
+    json.raw(*body);
+}
+
+void ReportService::writeLeaveReport(
+    utils::JsonWriter &json,
+    const std::string &startDate,
+    const std::string &endDate,
+    const std::string &className,
+    const std::string &type) const
+{
+    auto body = cache_.get(
+        cacheKey({"leave", startDate, endDate, className, type}),
+        cacheScope(className, startDate, endDate, false),
+        [&](utils::JsonWriter &out) {
+            buildLeaveReport(out, startDate, endDate, className, type);
+        });
+    json.raw(*body);
 }
 
 }  // namespace services
 }  // namespace student_attendance
-
@@ -0,0 +1,250 @@
+#include "student_attendance/utils/PlatformFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace student_attendance
+{
+namespace utils
+{
+
+PlatformFile::PlatformFile(PlatformFile &&other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      path_(std::move(other.path_)),
+      error_(std::move(other.error_))
+{
+}
+
+PlatformFile &PlatformFile::operator=(PlatformFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+        path_ = std::move(other.path_);
+        error_ = std::move(other.error_);
+    }
+    return *this;
+}
+
+bool PlatformFile::open(const std::filesystem::path &path, Mode mode)
+{
+    close();
+    path_ = path.string();
+#ifdef _WIN32
+    int flags = _O_WRONLY | _O_CREAT | _O_BINARY | _O_NOINHERIT;
+    flags |= mode == Mode::Append ? _O_APPEND : _O_TRUNC;
+    if (_wsopen_s(&fd_, path.c_str(), flags, _SH_DENYNO, _S_IREAD | _S_IWRITE) != 0)
+    {
+        fd_ = -1;
+    }
+#else
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    flags |= mode == Mode::Append ? O_APPEND : O_TRUNC;
+    fd_ = ::open(path.c_str(), flags, 0644);
+#endif
+    return fd_ >= 0 || failed("open");
+}
+
+void PlatformFile::close()
+{
+    if (fd_ >= 0)
+    {
+#ifdef _WIN32
+        _close(fd_);
+#else
+        ::close(fd_);
+#endif
+        fd_ = -1;
+    }
+}
+
+bool PlatformFile::writeAll(std::string_view data, size_t *written)
+{
+    size_t done = 0;
+    while (done < data.size())
+    {
+#ifdef _WIN32
+        // _write takes an unsigned int count
+        auto chunk = static_cast<unsigned int>(std::min<size_t>(data.size() - done, 1u << 30));
+        auto n = _write(fd_, data.data() + done, chunk);
+#else
+        auto n = ::write(fd_, data.data() + done, data.size() - done);
+#endif
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (written)
+                *written = done;
+            return failed("write");
+        }
+        done += static_cast<size_t>(n);
+    }
+    if (written)
+        *written = done;
+    return true;
+}
+
+bool PlatformFile::sync()
+{
+#if defined(_WIN32)
+    return _commit(fd_) == 0 || failed("_commit");
+#elif defined(__APPLE__)
+    // fsync leaves the data in the drive's cache on macOS
+    if (::fcntl(fd_, F_FULLFSYNC) == 0)
+        return true;
+    return ::fsync(fd_) == 0 || failed("fsync");
+#elif defined(__linux__)
+    return ::fdatasync(fd_) == 0 || failed("fdatasync");
+#else
+    return ::fsync(fd_) == 0 || failed("fsync");
+#endif
+}
+
+bool PlatformFile::truncate(uint64_t size)
+{
+#ifdef _WIN32
+    return _chsize_s(fd_, static_cast<__int64>(size)) == 0 || failed("_chsize_s");
+#else
+    int result = 0;
+    do
+    {
+        result = ::ftruncate(fd_, static_cast<off_t>(size));
+    } while (result != 0 && errno == EINTR);
+    return result == 0 || failed("ftruncate");
+#endif
+}
+
+bool PlatformFile::failed(const char *what)
+{
+    error_ = std::string(what) + " " + path_ + ": " + std::strerror(errno);
+    return false;
+}
+
+bool MappedFile::map(const std::filesystem::path &path)
+{
+    unmap();
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return failed("CreateFile", path);
+    LARGE_INTEGER length{};
+    if (!::GetFileSizeEx(file, &length))
+    {
+        ::CloseHandle(file);
+        return failed("GetFileSizeEx", path);
+    }
+    // An empty file cannot be mapped, and needs no mapping
+    if (length.QuadPart > 0)
+    {
+        HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            ::CloseHandle(file);
+            return failed("CreateFileMapping", path);
+        }
+        // The view keeps the mapping, and the file, alive
+        void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        ::CloseHandle(mapping);
+        if (!data)
+        {
+            ::CloseHandle(file);
+            return failed("MapViewOfFile", path);
+        }
+        data_ = static_cast<const char *>(data);
+        size_ = static_cast<size_t>(length.QuadPart);
+    }
+    ::CloseHandle(file);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return failed("open", path);
+    struct stat info{};
+    if (::fstat(fd, &info) != 0)
+    {
+        failed("fstat", path);
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size > 0)
+    {
+        auto length = static_cast<size_t>(info.st_size);
+        void *data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            failed("mmap", path);
+            ::close(fd);
+            return false;
+        }
+        data_ = static_cast<const char *>(data);
+        size_ = length;
+    }
+    ::close(fd);
+#endif
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (data_)
+    {
+#ifdef _WIN32
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<char *>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::failed(const char *what, const std::filesystem::path &path)
+{
+#ifdef _WIN32
+    error_ = std::string(what) + " " + path.string() + ": error " +
+             std::to_string(::GetLastError());
+#else
+    error_ = std::string(what) + " " + path.string() + ": " + std::strerror(errno);
+#endif
+    return false;
+}
+
+void syncDirectory(const std::filesystem::path &dir)
+{
+#ifndef _WIN32
+    int flags = O_RDONLY | O_CLOEXEC;
+#ifdef O_DIRECTORY
+    flags |= O_DIRECTORY;
+#endif
+    int fd = ::open(dir.c_str(), flags);
+    if (fd >= 0)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)dir;
+#endif
+}
+
+}  // namespace utils
+}  // namespace student_attendance
@@ -6,6 +6,9 @@
 using namespace student_attendance::services;
 using namespace student_attendance::db;
 using namespace student_attendance::models;
+using student_attendance::utils::AttendanceStatus;
+using student_attendance::utils::Date;
+using student_attendance::utils::StatusCode;
 
 class AttendanceApiTest : public ::testing::Test
 {
@@ -44,10 +47,10 @@ TEST_F(AttendanceApiTest, GetAttendances_WithStudentIdFilter)
 TEST_F(AttendanceApiTest, GetAttendances_WithDateFilter)
 {
     auto result = AttendanceService::getInstance().getAttendances(
-        1, 20, "", "", "", "12-15", "", "", "", "", "asc");
+        1, 20, "", "", "", "2025-12-15", "", "", "", "", "asc");
     for (const auto &att : result.attendances)
     {
-        EXPECT_EQ(att.date, "12-15");
+        EXPECT_EQ(att.date, Date::parse("2025-12-15"));
     }
 }
 
@@ -57,58 +60,126 @@ TEST_F(AttendanceApiTest, GetAttendances_WithStatusFilter)
         1, 20, "", "", "", "", "", "", "present", "", "asc");
     for (const auto &att : result.attendances)
     {
-        EXPECT_EQ(att.status, "present");
+        EXPECT_EQ(att.status, StatusCode::Present);
     }
 }
 
+TEST_F(AttendanceApiTest, GetAttendances_CursorWalksWholeListing)
+{
+    auto &service = AttendanceService::getInstance();
+    auto full = service.getAttendances(1, 100, "", "", "", "", "", "", "", "date", "desc");
+    ASSERT_GT(full.attendances.size(), 3u);
+
+    // Sample records share one date, so the walk relies on the id tiebreak
+    std::vector<int> walked;
+    std::optional<student_attendance::utils::PageCursor> cursor;
+    do
+    {
+        auto page = service.getAttendances(1, 3, "", "", "", "", "", "", "", "date", "desc",
+                                           cursor, false);
+        EXPECT_EQ(page.total, -1);
+        EXPECT_LE(page.attendances.size(), 3u);
+        for (const auto &att : page.attendances)
+        {
+            walked.push_back(att.id);
+        }
+        cursor = student_attendance::utils::PageCursor::decode(page.nextCursor);
+    } while (cursor);
+
+    ASSERT_EQ(walked.size(), full.attendances.size());
+    for (size_t i = 0; i < walked.size(); ++i)
+    {
+        EXPECT_EQ(walked[i], full.attendances[i].id);
+    }
+}
+
+TEST_F(AttendanceApiTest, GetAttendances_ForeignCursorReturnsNothing)
+{
+    student_attendance::utils::PageCursor cursor;
+    cursor.sortColumn = 3;
+    cursor.key = "not-a-day";
+    cursor.id = "1";
+    auto result = AttendanceService::getInstance().getAttendances(
+        1, 20, "", "", "", "", "", "", "", "", "", cursor);
+    EXPECT_TRUE(result.attendances.empty());
+    EXPECT_TRUE(result.nextCursor.empty());
+}
+
 // POST /api/v1/attendances - 新增考勤记录
 TEST_F(AttendanceApiTest, CreateAttendance_Success)
 {
     auto [success, att] = AttendanceService::getInstance().createAttendance(
-        "2024001", "12-20", "present", "测试备注");
+        "2024001", "2025-12-20", "present", "测试备注");
     EXPECT_TRUE(success);
     EXPECT_EQ(att.studentId, "2024001");
-    EXPECT_EQ(att.date, "12-20");
-    EXPECT_EQ(att.status, "present");
+    EXPECT_EQ(att.date, Date::parse("2025-12-20"));
+    EXPECT_EQ(att.status, StatusCode::Present);
 }
 
 TEST_F(AttendanceApiTest, CreateAttendance_InvalidStudent)
 {
     auto [success, att] = AttendanceService::getInstance().createAttendance(
-        "9999999", "12-20", "present", "");
+        "9999999", "2025-12-20", "present", "");
     EXPECT_FALSE(success);
 }
 
 TEST_F(AttendanceApiTest, CreateAttendance_InvalidStatus)
 {
     auto [success, att] = AttendanceService::getInstance().createAttendance(
-        "2024001", "12-20", "invalid_status", "");
+        "2024001", "2025-12-20", "invalid_status", "");
     EXPECT_FALSE(success);
 }
 
 // POST /api/v1/attendances/batch - 批量新增考勤记录
 TEST_F(AttendanceApiTest, BatchCreateAttendances_Success)
 {
-    std::vector<std::pair<std::string, std::string>> records = {
+    std::vector<AttendanceService::BatchRecord> records = {
         {"2024001", "present"},
         {"2024002", "late"},
         {"2024003", "absent"}
     };
 
-    int count = AttendanceService::getInstance().batchCreateAttendances("12-25", records);
-    EXPECT_EQ(count, 3);
+    auto result = AttendanceService::getInstance().batchCreateAttendances("2025-12-25", records);
+    EXPECT_EQ(result.createdCount, 3);
 }
 
 TEST_F(AttendanceApiTest, BatchCreateAttendances_PartialSuccess)
 {
-    std::vector<std::pair<std::string, std::string>> records = {
+    std::vector<AttendanceService::BatchRecord> records = {
         {"2024001", "present"},
         {"9999999", "present"},  // Invalid student
         {"2024002", "late"}
     };
 
-    int count = AttendanceService::getInstance().batchCreateAttendances("12-26", records);
-    EXPECT_EQ(count, 2);  // Only 2 should succeed
+    auto result = AttendanceService::getInstance().batchCreateAttendances("2025-12-26", records);
+    EXPECT_EQ(result.createdCount, 2);  // Only 2 should succeed
+    ASSERT_EQ(result.rows.size(), 3u);
+    EXPECT_TRUE(result.rows[0].created);
+    EXPECT_FALSE(result.rows[1].created);
+    EXPECT_EQ(result.rows[1].error, "学生不存在");
+    EXPECT_TRUE(result.rows[2].created);
+    EXPECT_GT(result.rows[2].id, result.rows[0].id);
+}
+
+TEST_F(AttendanceApiTest, BatchCreateAttendances_ReportsRowErrors)
+{
+    std::vector<AttendanceService::BatchRecord> records = {
+        {"2024001", "present", "准时"},
+        {"", "present"},
+        {"2024002", "unknown"}
+    };
+
+    auto result = AttendanceService::getInstance().batchCreateAttendances("2024-12-29", records);
+    EXPECT_EQ(result.createdCount, 1);
+    ASSERT_EQ(result.rows.size(), 3u);
+    EXPECT_EQ(result.rows[1].error, "学号不能为空");
+    EXPECT_EQ(result.rows[2].error, "无效的考勤状态");
+
+    auto att = DataStore::getInstance().getAttendanceById(result.rows[0].id);
+    ASSERT_TRUE(att.has_value());
+    EXPECT_EQ(att->studentId, "2024001");
+    EXPECT_FALSE(att->name.empty());
+    EXPECT_EQ(att->remark, "准时");
 }
 
 // GET /api/v1/attendances/{id} - 获取单条考勤记录
@@ -133,7 +204,7 @@ TEST_F(AttendanceApiTest, UpdateAttendance_Success)
 
     auto att = AttendanceService::getInstance().getAttendance(1);
     EXPECT_TRUE(att.has_value());
-    EXPECT_EQ(att->status, "late");
+    EXPECT_EQ(att->status, StatusCode::Late);
     EXPECT_EQ(att->remark, "迟到5分钟");
 }
 
@@ -149,7 +220,7 @@ TEST_F(AttendanceApiTest, DeleteAttendance_Success)
 {
     // First create an attendance to delete
     auto [created, att] = AttendanceService::getInstance().createAttendance(
-        "2024001", "12-30", "present", "");
+        "2024001", "2025-12-30", "present", "");
     EXPECT_TRUE(created);
 
     bool deleted = AttendanceService::getInstance().deleteAttendance(att.id);
@@ -223,11 +294,11 @@ TEST_F(AttendanceApiTest, GetAttendances_WithClassFilter)
 TEST_F(AttendanceApiTest, GetAttendances_WithDateRange)
 {
     auto result = AttendanceService::getInstance().getAttendances(
-        1, 20, "", "", "", "", "12-01", "12-31", "", "", "asc");
+        1, 20, "", "", "", "", "2025-12-01", "2025-12-31", "", "", "asc");
     for (const auto &att : result.attendances)
     {
-        EXPECT_GE(att.date, "12-01");
-        EXPECT_LE(att.date, "12-31");
+        EXPECT_GE(att.date, *Date::parse("2025-12-01"));
+        EXPECT_LE(att.date, *Date::parse("2025-12-31"));
     }
 }
 
@@ -238,7 +309,7 @@ TEST_F(AttendanceApiTest, GetAttendances_MultipleFilters)
     for (const auto &att : result.attendances)
     {
         EXPECT_EQ(att.className, "人文2401班");
-        EXPECT_EQ(att.status, "present");
+        EXPECT_EQ(att.status, StatusCode::Present);
     }
 }
 
@@ -252,7 +323,7 @@ TEST_F(AttendanceApiTest, CreateAttendance_EmptyDate)
 TEST_F(AttendanceApiTest, CreateAttendance_EmptyStudentId)
 {
     auto [success, att] = AttendanceService::getInstance().createAttendance(
-        "", "12-20", "present", "");
+        "", "2025-12-20", "present", "");
     EXPECT_FALSE(success);
 }
 
@@ -265,9 +336,9 @@ TEST_F(AttendanceApiTest, CreateAttendance_AllStatusTypes)
     for (const auto &status : statuses)
     {
         auto [success, att] = AttendanceService::getInstance().createAttendance(
-            "2024001", "12-20", status, "测试" + status);
+            "2024001", "2025-12-20", status, "测试" + status);
         EXPECT_TRUE(success) << "Failed to create attendance with status: " << status;
-        EXPECT_EQ(att.status, status);
+        EXPECT_EQ(AttendanceStatus::toString(att.status), status);
     }
 }
 
@@ -294,21 +365,21 @@ TEST_F(AttendanceApiTest, UpdateAttendance_AllStatusTypes)
 
 TEST_F(AttendanceApiTest, BatchCreateAttendances_EmptyRecords)
 {
-    std::vector<std::pair<std::string, std::string>> records;
-    int count = AttendanceService::getInstance().batchCreateAttendances("12-27", records);
-    EXPECT_EQ(count, 0);
+    std::vector<AttendanceService::BatchRecord> records;
+    auto result = AttendanceService::getInstance().batchCreateAttendances("2025-12-27", records);
+    EXPECT_EQ(result.createdCount, 0);
 }
 
 TEST_F(AttendanceApiTest, BatchCreateAttendances_AllInvalidStudents)
 {
-    std::vector<std::pair<std::string, std::string>> records = {
+    std::vector<AttendanceService::BatchRecord> records = {
         {"9999991", "present"},
         {"9999992", "present"},
         {"9999993", "present"}
     };
 
-    int count = AttendanceService::getInstance().batchCreateAttendances("12-28", records);
-    EXPECT_EQ(count, 0);
+    auto result = AttendanceService::getInstance().batchCreateAttendances("2025-12-28", records);
+    EXPECT_EQ(result.createdCount, 0);
 }
 
 TEST_F(AttendanceApiTest, GetAttendance_NegativeId)
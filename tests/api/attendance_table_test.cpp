@@ -0,0 +1,414 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <tuple>
+#include "student_attendance/models/AttendanceTable.h"
+
+using namespace student_attendance::models;
+using student_attendance::utils::Date;
+using student_attendance::utils::StatusCode;
+
+namespace
+{
+
+Date dec(unsigned day)
+{
+    return Date::fromYmd(2024, 12, day);
+}
+
+}  // namespace
+
+class AttendanceTableTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        table.insert(Attendance(0, "2024001", "张三", "人文2401班", dec(14), StatusCode::Present, ""));
+        table.insert(Attendance(0, "2024002", "李四", "人文2401班", dec(15), StatusCode::Late, "迟到5分钟"));
+        table.insert(Attendance(0, "2024004", "赵六", "人文2402班", dec(15), StatusCode::Absent, ""));
+        table.insert(Attendance(0, "2024001", "张三", "人文2401班", dec(16), StatusCode::SickLeave, "感冒"));
+    }
+
+    AttendanceTable table;
+};
+
+TEST_F(AttendanceTableTest, Insert_AssignsSequentialIds)
+{
+    int id = table.insert(Attendance(0, "2024005", "钱七", "人文2402班", dec(17), StatusCode::Present, ""));
+    EXPECT_EQ(id, 5);
+    EXPECT_EQ(table.size(), 5u);
+}
+
+TEST_F(AttendanceTableTest, Find_RoundTripsAllFields)
+{
+    auto att = table.find(2);
+    ASSERT_TRUE(att.has_value());
+    EXPECT_EQ(att->id, 2);
+    EXPECT_EQ(att->studentId, "2024002");
+    EXPECT_EQ(att->name, "李四");
+    EXPECT_EQ(att->className, "人文2401班");
+    EXPECT_EQ(att->date, dec(15));
+    EXPECT_EQ(att->status, StatusCode::Late);
+    EXPECT_EQ(att->remark, "迟到5分钟");
+}
+
+TEST_F(AttendanceTableTest, Update_ReplacesStatusAndRemark)
+{
+    EXPECT_TRUE(table.update(2, StatusCode::Present, "已补签"));
+
+    auto att = table.find(2);
+    ASSERT_TRUE(att.has_value());
+    EXPECT_EQ(att->status, StatusCode::Present);
+    EXPECT_EQ(att->remark, "已补签");
+}
+
+TEST_F(AttendanceTableTest, Update_NoStatusKeepsExisting)
+{
+    EXPECT_TRUE(table.update(3, std::nullopt, "备注"));
+    EXPECT_EQ(table.find(3)->status, StatusCode::Absent);
+}
+
+TEST_F(AttendanceTableTest, Erase_HidesRow)
+{
+    EXPECT_TRUE(table.erase(1));
+    EXPECT_FALSE(table.find(1).has_value());
+    EXPECT_FALSE(table.erase(1));
+    EXPECT_EQ(table.size(), 3u);
+
+    AttendanceFilter filter;
+    filter.studentId = "2024001";
+    EXPECT_EQ(table.select(filter).size(), 1u);
+}
+
+TEST_F(AttendanceTableTest, Select_CombinesFilters)
+{
+    AttendanceFilter filter;
+    filter.className = "人文2401班";
+    filter.startDate = dec(15);
+    filter.endDate = dec(16);
+    auto rows = table.select(filter);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].id, 2);
+    EXPECT_EQ(rows[1].id, 4);
+}
+
+TEST_F(AttendanceTableTest, Select_DateRangeSpansYears)
+{
+    table.insert(Attendance(0, "2024001", "张三", "人文2401班", Date::fromYmd(2025, 1, 3),
+                            StatusCode::Present, ""));
+    table.insert(Attendance(0, "2024001", "张三", "人文2401班", Date::fromYmd(2025, 12, 15),
+                            StatusCode::Present, ""));
+
+    AttendanceFilter filter;
+    filter.startDate = dec(16);
+    filter.endDate = Date::fromYmd(2025, 1, 31);
+    auto rows = table.select(filter);
+    ASSERT_EQ(rows.size(), 2u);
+    EXPECT_EQ(rows[0].id, 4);
+    EXPECT_EQ(rows[1].id, 5);
+
+    // Same month and day in another year is a different day
+    filter = AttendanceFilter();
+    filter.date = dec(15);
+    EXPECT_EQ(table.select(filter).size(), 2u);
+
+    filter.startDate = dec(16);
+    EXPECT_TRUE(table.select(filter).empty());
+}
+
+TEST_F(AttendanceTableTest, Select_NameIsSubstringMatch)
+{
+    AttendanceFilter filter;
+    filter.name = "三";
+    EXPECT_EQ(table.select(filter).size(), 2u);
+}
+
+TEST_F(AttendanceTableTest, Select_UnknownValueMatchesNothing)
+{
+    AttendanceFilter filter;
+    filter.studentId = "9999999";
+    EXPECT_TRUE(table.select(filter).empty());
+
+    filter = AttendanceFilter();
+    filter.status = StatusCode::EarlyLeave;
+    EXPECT_TRUE(table.select(filter).empty());
+}
+
+TEST_F(AttendanceTableTest, Erase_CompactionKeepsIdsAddressable)
+{
+    std::vector<int> ids;
+    for (int i = 0; i < 5000; ++i)
+    {
+        ids.push_back(table.insert(
+            Attendance(0, "2024003", "王五", "人文2401班", dec(20), StatusCode::Present, "r" + std::to_string(i))));
+    }
+    for (size_t i = 0; i < ids.size(); i += 2)
+    {
+        ASSERT_TRUE(table.erase(ids[i]));
+    }
+    for (size_t i = 1; i < ids.size(); i += 2)
+    {
+        auto att = table.find(ids[i]);
+        ASSERT_TRUE(att.has_value());
+        EXPECT_EQ(att->remark, "r" + std::to_string(i));
+    }
+    EXPECT_EQ(table.size(), 4u + 2500u);
+}
+
+TEST_F(AttendanceTableTest, Copy_KeepsItsRowsAsTheOriginalChanges)
+{
+    AttendanceTable copy = table;
+    table.update(2, StatusCode::Present, "已更正");
+    table.erase(3);
+    for (int i = 0; i < 3000; ++i)
+    {
+        table.insert(Attendance(0, "2024003", "王五", "人文2401班", dec(20), StatusCode::Present,
+                                "r" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(copy.size(), 4u);
+    auto updated = copy.find(2);
+    ASSERT_TRUE(updated.has_value());
+    EXPECT_EQ(updated->status, StatusCode::Late);
+    EXPECT_EQ(updated->remark, "迟到5分钟");
+    EXPECT_TRUE(copy.find(3).has_value());
+    EXPECT_FALSE(copy.find(5).has_value());
+    AttendanceFilter filter;
+    filter.date = dec(15);
+    EXPECT_EQ(copy.select(filter).size(), 2u);
+
+    // Writes to the copy leave the original alone too
+    copy.erase(1);
+    EXPECT_TRUE(table.find(1).has_value());
+    EXPECT_EQ(table.find(3002)->remark, "r2997");
+    EXPECT_EQ(table.size(), 3u + 3000u);
+}
+
+TEST_F(AttendanceTableTest, Clear_ResetsIds)
+{
+    table.clear();
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.insert(Attendance(0, "2024001", "张三", "人文2401班", dec(15), StatusCode::Present, "")), 1);
+}
+
+// ==================== Index Planner Tests ====================
+
+class AttendanceTableIndexTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const StatusCode statuses[] = {StatusCode::Present, StatusCode::Absent,
+                                       StatusCode::Late, StatusCode::SickLeave};
+        for (unsigned day = 1; day <= 20; ++day)
+        {
+            Date date = dec(day);
+            for (int s = 0; s < 100; ++s)
+            {
+                std::string studentId = "S" + std::to_string(s);
+                std::string className = "班级" + std::to_string(s % 5);
+                table.insert(Attendance(0, studentId, "学生" + std::to_string(s), className,
+                                        date, statuses[(day + s) % 4], ""));
+            }
+        }
+    }
+
+    size_t bruteForceCount(const AttendanceFilter &filter) const
+    {
+        AttendanceFilter everything;
+        size_t count = 0;
+        for (const auto &att : table.select(everything))
+        {
+            if (!filter.studentId.empty() && att.studentId != filter.studentId)
+                continue;
+            if (!filter.className.empty() && att.className != filter.className)
+                continue;
+            if (filter.date && att.date != *filter.date)
+                continue;
+            if (filter.startDate && att.date < *filter.startDate)
+                continue;
+            if (filter.endDate && att.date > *filter.endDate)
+                continue;
+            if (filter.status && att.status != *filter.status)
+                continue;
+            count++;
+        }
+        return count;
+    }
+
+    // Ids of the matching rows as walk() should list them, by sorting
+    std::vector<int> sortedIds(const AttendanceFilter &filter, AttendanceTable::Order order,
+                               bool descending) const
+    {
+        auto rows = table.select(filter);
+        auto key = [order](const Attendance &a) {
+            switch (order)
+            {
+            case AttendanceTable::Order::ByStudent:
+                return std::make_tuple(a.studentId, 0, a.id);
+            case AttendanceTable::Order::ByName:
+                return std::make_tuple(a.name, 0, a.id);
+            case AttendanceTable::Order::ByDate:
+                return std::make_tuple(std::string(), a.date.ordinal(), a.id);
+            default:
+                return std::make_tuple(std::string(), 0, a.id);
+            }
+        };
+        std::sort(rows.begin(), rows.end(), [&](const Attendance &a, const Attendance &b) {
+            return descending ? key(b) < key(a) : key(a) < key(b);
+        });
+        std::vector<int> ids;
+        for (const auto &row : rows)
+            ids.push_back(row.id);
+        return ids;
+    }
+
+    std::vector<int> walkedIds(const AttendanceFilter &filter, AttendanceTable::Order order,
+                               bool descending, const Attendance *after = nullptr) const
+    {
+        std::vector<int> ids;
+        table.walk(filter, order, descending, after, [&ids](const AttendanceTable::Row &row) {
+            ids.push_back(row.id());
+            return true;
+        });
+        return ids;
+    }
+
+    AttendanceTable table;
+};
+
+TEST_F(AttendanceTableIndexTest, SingleStudentQuery_IsSublinear)
+{
+    AttendanceFilter filter;
+    filter.studentId = "S42";
+    EXPECT_EQ(table.estimateRows(filter), 20u);
+    EXPECT_EQ(table.select(filter).size(), 20u);
+}
+
+TEST_F(AttendanceTableIndexTest, SingleDayQuery_IsSublinear)
+{
+    AttendanceFilter filter;
+    filter.date = dec(7);
+    EXPECT_EQ(table.estimateRows(filter), 100u);
+    EXPECT_EQ(table.select(filter).size(), 100u);
+}
+
+TEST_F(AttendanceTableIndexTest, IntersectsClassAndDay)
+{
+    AttendanceFilter filter;
+    filter.className = "班级3";
+    filter.date = dec(7);
+    EXPECT_LE(table.estimateRows(filter), 100u);
+    EXPECT_EQ(table.select(filter).size(), 20u);
+}
+
+TEST_F(AttendanceTableIndexTest, UnselectiveFilter_FallsBackToScan)
+{
+    AttendanceFilter filter;
+    filter.startDate = dec(1);
+    filter.endDate = dec(20);
+    EXPECT_EQ(table.estimateRows(filter), 2000u);
+    EXPECT_EQ(table.select(filter).size(), 2000u);
+}
+
+TEST_F(AttendanceTableIndexTest, IndexedResultsMatchBruteForce)
+{
+    std::vector<AttendanceFilter> filters(6);
+    filters[0].studentId = "S7";
+    filters[0].status = StatusCode::Late;
+    filters[1].className = "班级1";
+    filters[1].startDate = dec(3);
+    filters[1].endDate = dec(5);
+    filters[2].startDate = dec(10);
+    filters[2].endDate = dec(11);
+    filters[3].status = StatusCode::SickLeave;
+    filters[3].date = dec(9);
+    filters[4].className = "班级2";
+    filters[4].status = StatusCode::Absent;
+    filters[5].studentId = "S9";
+    filters[5].className = "班级0";
+
+    for (const auto &filter : filters)
+    {
+        EXPECT_EQ(table.select(filter).size(), bruteForceCount(filter));
+    }
+}
+
+TEST_F(AttendanceTableIndexTest, IndexesFollowUpdatesAndDeletes)
+{
+    AttendanceFilter filter;
+    filter.studentId = "S1";
+    filter.status = StatusCode::Present;
+    auto before = table.select(filter);
+    ASSERT_FALSE(before.empty());
+
+    ASSERT_TRUE(table.update(before.front().id, StatusCode::Absent, ""));
+    ASSERT_TRUE(table.erase(before.back().id));
+    EXPECT_EQ(table.select(filter).size(), before.size() - 2);
+
+    filter.status = StatusCode::Absent;
+    EXPECT_EQ(table.select(filter).size(), bruteForceCount(filter));
+}
+
+TEST_F(AttendanceTableIndexTest, Walk_ListsEveryOrderFromAnyRow)
+{
+    // Erased rows stay in the postings until compaction and must be stepped over
+    for (int id = 5; id <= 2000; id += 7)
+        ASSERT_TRUE(table.erase(id));
+
+    std::vector<AttendanceFilter> filters(3);
+    filters[1].className = "班级2";
+    filters[2].status = StatusCode::Late;
+    filters[2].startDate = dec(4);
+    for (auto order : {AttendanceTable::Order::ById, AttendanceTable::Order::ByStudent,
+                       AttendanceTable::Order::ByName, AttendanceTable::Order::ByDate})
+    {
+        for (bool descending : {false, true})
+        {
+            for (const auto &filter : filters)
+            {
+                auto expected = sortedIds(filter, order, descending);
+                ASSERT_EQ(walkedIds(filter, order, descending), expected);
+
+                // Seeking past a row lists the rest
+                for (size_t at : {size_t{0}, expected.size() / 3, expected.size() - 1})
+                {
+                    auto after = table.find(expected[at]);
+                    std::vector<int> rest(expected.begin() + static_cast<std::ptrdiff_t>(at) + 1,
+                                          expected.end());
+                    EXPECT_EQ(walkedIds(filter, order, descending, &*after), rest);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(AttendanceTableIndexTest, Walk_StopsWhenToldAndSurvivesCompaction)
+{
+    size_t visited = 0;
+    table.walk({}, AttendanceTable::Order::ByName, false, nullptr,
+               [&visited](const AttendanceTable::Row &) { return ++visited < 5; });
+    EXPECT_EQ(visited, 5u);
+
+    // Erasing most rows compacts the table, renumbering them
+    for (int id = 1; id <= 1900; ++id)
+        ASSERT_TRUE(table.erase(id));
+    table.insert(Attendance(0, "S0", "新生", "班级0", dec(21), StatusCode::Present, ""));
+    for (auto order : {AttendanceTable::Order::ByStudent, AttendanceTable::Order::ByName,
+                       AttendanceTable::Order::ByDate})
+    {
+        EXPECT_EQ(walkedIds({}, order, true), sortedIds({}, order, true));
+    }
+}
+
+TEST_F(AttendanceTableIndexTest, Count_MatchesBruteForce)
+{
+    ASSERT_TRUE(table.erase(3));
+    std::vector<AttendanceFilter> filters(4);
+    filters[1].status = StatusCode::Absent;
+    filters[2].className = "班级4";
+    filters[3].name = "学生1";
+    for (const auto &filter : filters)
+    {
+        EXPECT_EQ(table.count(filter), table.select(filter).size());
+    }
+}
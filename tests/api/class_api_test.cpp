@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <set>
 #include "student_attendance/db/DatabaseManager.h"
 #include "student_attendance/models/DataStore.h"
@@ -204,3 +205,56 @@ TEST_F(ClassApiTest, GetClassStudentCount_AfterAddingStudent)
     EXPECT_EQ(finalCount, initialCount + 1);
 }
 
+
+// ==================== 班级名册测试 ====================
+
+TEST_F(ClassApiTest, GetClassSizes_MatchCounts)
+{
+    auto &store = DataStore::getInstance();
+    auto sizes = store.getClassSizes();
+    auto names = store.getAllClasses();
+    ASSERT_EQ(sizes.size(), names.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        EXPECT_EQ(sizes[i].name, names[i]);
+        EXPECT_EQ(sizes[i].studentCount, store.getClassStudentCount(names[i]));
+    }
+    EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+}
+
+TEST_F(ClassApiTest, FindClassStudents_UnknownClass)
+{
+    EXPECT_FALSE(DataStore::getInstance().findClassStudents("不存在的班级").has_value());
+}
+
+TEST_F(ClassApiTest, FindClassStudents_OrderedById)
+{
+    auto &store = DataStore::getInstance();
+    store.addStudent(Student("2024000", "新生", "人文2401班"));
+
+    auto students = store.findClassStudents("人文2401班");
+    ASSERT_TRUE(students.has_value());
+    ASSERT_EQ(students->size(), 4u);
+    EXPECT_EQ(students->front().studentId, "2024000");
+    for (size_t i = 1; i < students->size(); ++i)
+    {
+        EXPECT_LT((*students)[i - 1].studentId, (*students)[i].studentId);
+    }
+}
+
+TEST_F(ClassApiTest, Roster_FollowsUpdateDeleteAndImport)
+{
+    auto &store = DataStore::getInstance();
+
+    // Moving the last students out removes the class
+    store.updateStudent("2024007", Student("", "", "人文2401班"));
+    store.deleteStudent("2024008");
+    EXPECT_FALSE(store.findClassStudents("人文2403班").has_value());
+    EXPECT_EQ(store.getClassStudentCount("人文2401班"), 4);
+
+    store.importStudents({Student("2024100", "导入", "人文2403班"),
+                          Student("2024001", "张三", "人文2402班")});
+    EXPECT_EQ(store.getClassStudentCount("人文2403班"), 1);
+    EXPECT_EQ(store.getClassStudentCount("人文2401班"), 3);
+    EXPECT_EQ(store.getClassStudentCount("人文2402班"), 4);
+}
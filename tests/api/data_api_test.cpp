@@ -1,11 +1,20 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/Storage.h"
 #include "student_attendance/models/Student.h"
 #include "student_attendance/models/Attendance.h"
 #include "student_attendance/models/DataStore.h"
+#include "student_attendance/services/ExportService.h"
+#include "student_attendance/services/ImportService.h"
+#include <future>
+#include <sstream>
+#include <trantor/net/EventLoopThread.h>
 
 using namespace student_attendance::db;
 using namespace student_attendance::models;
+using student_attendance::services::ExportService;
+using student_attendance::services::ImportService;
 
 class DataApiTest : public ::testing::Test
 {
@@ -21,6 +30,18 @@ protected:
         DatabaseManager::getInstance().reset();
         DataStore::getInstance().reset();
     }
+
+    static std::string exportText(const std::string &type, ExportService::Format format)
+    {
+        std::ostringstream out;
+        EXPECT_TRUE(ExportService::getInstance().exportTo(type, format, out));
+        return out.str();
+    }
+
+    static size_t lineCount(const std::string &text)
+    {
+        return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
 };
 
 // GET /api/v1/data/export - 导出数据
@@ -211,3 +232,308 @@ TEST_F(DataApiTest, Attendance_ToJsonFromJson_Consistency)
     }
 }
 
+
+// Keyset pages by id, as exports read the query-paged backends
+Page<Student> studentsAfter(const std::string &afterId, int limit)
+{
+    StudentQuery query;
+    if (!afterId.empty())
+    {
+        query.after = Student(afterId, "", "");
+    }
+    query.limit = limit;
+    query.withTotal = false;
+    return drogon::sync_wait(Storage::of(Storage::Backend::Memory).listStudents(query));
+}
+
+TEST_F(DataApiTest, StudentsAfter_PagesInIdOrder)
+{
+    auto first = studentsAfter("", 3).rows;
+    ASSERT_EQ(first.size(), 3u);
+    EXPECT_EQ(first[0].studentId, "2024001");
+    EXPECT_EQ(first[2].studentId, "2024003");
+
+    auto rest = studentsAfter(first.back().studentId, 100);
+    ASSERT_EQ(rest.rows.size(), 5u);
+    EXPECT_EQ(rest.rows.front().studentId, "2024004");
+    EXPECT_FALSE(rest.more);
+    EXPECT_TRUE(studentsAfter(rest.rows.back().studentId, 100).rows.empty());
+}
+
+TEST_F(DataApiTest, StudentsAfter_SeesWritesBetweenBatches)
+{
+    auto &store = DataStore::getInstance();
+    auto first = studentsAfter("", 2).rows;
+    ASSERT_EQ(first.size(), 2u);
+
+    store.addStudent(Student("2024002a", "新生", "人文2401班"));
+    store.deleteStudent("2024003");
+    auto next = studentsAfter(first.back().studentId, 2).rows;
+    ASSERT_EQ(next.size(), 2u);
+    EXPECT_EQ(next[0].studentId, "2024002a");
+    EXPECT_EQ(next[1].studentId, "2024004");
+}
+
+TEST_F(DataApiTest, ExportStream_CsvHasHeaderAndEveryRow)
+{
+    auto students = exportText("students", ExportService::Format::Csv);
+    EXPECT_EQ(students.rfind("student_id,name,class\n", 0), 0u);
+    EXPECT_EQ(lineCount(students), DataStore::getInstance().getAllStudents().size() + 1);
+
+    auto attendances = exportText("attendances", ExportService::Format::Csv);
+    EXPECT_EQ(attendances.rfind("id,student_id,name,class,date,status,remark\n", 0), 0u);
+    EXPECT_EQ(lineCount(attendances), DataStore::getInstance().getAllAttendances().size() + 1);
+}
+
+TEST_F(DataApiTest, ExportStream_CsvQuotesSpecialFields)
+{
+    DataStore::getInstance().importStudents({Student("Q001", "张, \"三\"", "人文2401班")});
+    auto csv = exportText("students", ExportService::Format::Csv);
+    EXPECT_NE(csv.find("Q001,\"张, \"\"三\"\"\",人文2401班\n"), std::string::npos);
+}
+
+TEST_F(DataApiTest, ExportStream_JsonParsesToStoreContents)
+{
+    auto text = exportText("all", ExportService::Format::Json);
+    Json::Value parsed;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    std::istringstream in(text);
+    ASSERT_TRUE(Json::parseFromStream(builder, in, &parsed, &errors)) << errors;
+    EXPECT_EQ(parsed["students"].size(), DataStore::getInstance().getAllStudents().size());
+    EXPECT_EQ(parsed["attendances"].size(), DataStore::getInstance().getAllAttendances().size());
+    EXPECT_EQ(parsed["attendances"][0]["id"].asInt(), 1);
+}
+
+TEST_F(DataApiTest, ExportStream_SpansManyBatches)
+{
+    std::vector<Student> students;
+    for (int i = 0; i < 1500; ++i)
+    {
+        students.emplace_back("B" + std::to_string(100000 + i), "学生", "人文2405班");
+    }
+    DataStore::getInstance().importStudents(students);
+
+    auto csv = exportText("students", ExportService::Format::Csv);
+    EXPECT_EQ(lineCount(csv), 1509u);
+
+    auto json = exportText("students", ExportService::Format::Json);
+    Json::Value parsed;
+    std::istringstream in(json);
+    std::string errors;
+    ASSERT_TRUE(Json::parseFromStream(Json::CharReaderBuilder(), in, &parsed, &errors));
+    EXPECT_EQ(parsed["students"].size(), 1508u);
+}
+
+TEST_F(DataApiTest, ExportStream_SmallReadsMatchWholeExport)
+{
+    auto whole = exportText("attendances", ExportService::Format::Json);
+    auto stream = ExportService::getInstance().open("attendances", ExportService::Format::Json);
+    ASSERT_NE(stream, nullptr);
+
+    std::string pieces;
+    char buffer[7];
+    while (auto count = stream->read(buffer, sizeof(buffer)))
+    {
+        pieces.append(buffer, count);
+    }
+    EXPECT_EQ(pieces, whole);
+    EXPECT_EQ(stream->read(buffer, sizeof(buffer)), 0u);
+}
+
+TEST_F(DataApiTest, ExportStream_RejectsUnsupportedTypes)
+{
+    EXPECT_EQ(ExportService::getInstance().open("all", ExportService::Format::Csv), nullptr);
+    EXPECT_EQ(ExportService::getInstance().open("users", ExportService::Format::Json), nullptr);
+}
+
+TEST_F(DataApiTest, ExportStream_EmptyStore)
+{
+    DataStore::getInstance().clear();
+    EXPECT_EQ(exportText("all", ExportService::Format::Json),
+              "{\"attendances\":[],\"students\":[]}");
+    EXPECT_EQ(exportText("students", ExportService::Format::Csv), "student_id,name,class\n");
+}
+
+// ==================== ImportService Tests ====================
+
+TEST_F(DataApiTest, ImportCsv_Students)
+{
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Csv,
+        "name,student_id,class\n新生甲,2024201,新班\n\"新生,乙\",2024202,新班\n");
+    EXPECT_TRUE(result.fatal.empty());
+    EXPECT_EQ(result.importedCount, 2);
+    EXPECT_EQ(result.skippedCount, 0);
+    auto student = DataStore::getInstance().getStudentById("2024202");
+    ASSERT_TRUE(student.has_value());
+    EXPECT_EQ(student->name, "新生,乙");
+    EXPECT_EQ(DataStore::getInstance().getClassStudentCount("新班"), 2);
+}
+
+TEST_F(DataApiTest, ImportCsv_ReportsErrorsByLine)
+{
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Csv,
+        "student_id,name,class\n"
+        "2024001,重复,一班\n"   // line 2: already exists
+        "2024301,,一班\n"       // line 3: no name
+        "2024302,正常,一班\n"
+        "2024302,再次,一班\n"); // line 5: duplicate within the file
+    EXPECT_EQ(result.importedCount, 1);
+    EXPECT_EQ(result.skippedCount, 3);
+    ASSERT_EQ(result.errors.size(), 3u);
+    EXPECT_EQ(result.errors[0].line, 2);
+    EXPECT_EQ(result.errors[0].message, "学号已存在");
+    EXPECT_EQ(result.errors[1].line, 3);
+    EXPECT_EQ(result.errors[1].message, "姓名不能为空");
+    EXPECT_EQ(result.errors[2].line, 5);
+    EXPECT_EQ(result.errors[2].message, "学号已存在");
+}
+
+TEST_F(DataApiTest, ImportCsv_MissingColumnIsFatal)
+{
+    size_t before = DataStore::getInstance().getAllStudents().size();
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Csv,
+        "student_id,name\n2024401,某人\n");
+    EXPECT_EQ(result.fatal, "CSV缺少列: class");
+    EXPECT_EQ(result.importedCount, 0);
+    EXPECT_EQ(DataStore::getInstance().getAllStudents().size(), before);
+}
+
+TEST_F(DataApiTest, ImportCsv_AttendanceExportRoundTrips)
+{
+    auto csv = exportText("attendances", ExportService::Format::Csv);
+    size_t before = DataStore::getInstance().getAllAttendances().size();
+    ASSERT_GT(before, 0u);
+
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Attendances, ImportService::Format::Csv, csv);
+    EXPECT_TRUE(result.fatal.empty());
+    EXPECT_EQ(result.importedCount, static_cast<int>(before));
+    EXPECT_EQ(DataStore::getInstance().getAllAttendances().size(), before * 2);
+}
+
+TEST_F(DataApiTest, ImportCsv_AttendanceValidation)
+{
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Attendances, ImportService::Format::Csv,
+        "student_id,date,status\n"
+        "2024001,2024-12-16,present\n"
+        "2024001,2024-13-01,present\n"
+        "2024001,2024-12-16,unknown\n"
+        "9999999,2024-12-16,late\n");
+    EXPECT_EQ(result.importedCount, 1);
+    ASSERT_EQ(result.errors.size(), 3u);
+    EXPECT_EQ(result.errors[0].message, "无效的考勤日期");
+    EXPECT_EQ(result.errors[1].message, "无效的考勤状态");
+    EXPECT_EQ(result.errors[2].message, "学生不存在");
+    EXPECT_EQ(result.errors[2].line, 5);
+}
+
+TEST_F(DataApiTest, ImportCsv_SpansManyBatches)
+{
+    DataStore::getInstance().clear();
+    std::string csv = "student_id,name,class\n";
+    const int total = static_cast<int>(ImportService::kBatchSize) * 3 + 17;
+    for (int i = 0; i < total; ++i)
+    {
+        csv += "S" + std::to_string(100000 + i) + ",学生" + std::to_string(i) + ",批量班\n";
+        if (i % 500 == 0)
+            csv += "S" + std::to_string(100000 + i) + ",重复,批量班\n";
+    }
+
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Csv, csv);
+    EXPECT_EQ(result.importedCount, total);
+    EXPECT_EQ(result.skippedCount, (total + 499) / 500);
+    EXPECT_EQ(DataStore::getInstance().getAllStudents().size(), static_cast<size_t>(total));
+    for (size_t i = 1; i < result.errors.size(); ++i)
+    {
+        EXPECT_LT(result.errors[i - 1].line, result.errors[i].line);
+    }
+}
+
+TEST_F(DataApiTest, ImportCoro_ParsesOffTheLoop)
+{
+    DataStore::getInstance().clear();
+    std::string csv = "student_id,name,class\n";
+    const int total = static_cast<int>(ImportService::kBatchSize) * 2 + 5;
+    for (int i = 0; i < total; ++i)
+    {
+        csv += "L" + std::to_string(100000 + i) + ",学生,循环班\n";
+    }
+
+    trantor::EventLoopThread thread;
+    thread.run();
+    auto *loop = thread.getLoop();
+    std::promise<std::pair<int, bool>> done;
+    loop->queueInLoop([&] {
+        drogon::async_run([&]() -> drogon::Task<> {
+            auto result = co_await ImportService::getInstance().importCoro(
+                ImportService::Type::Students, ImportService::Format::Csv, csv);
+            done.set_value({result.importedCount, loop->isInLoopThread()});
+        });
+    });
+    auto [imported, onLoop] = done.get_future().get();
+    EXPECT_EQ(imported, total);
+    EXPECT_TRUE(onLoop);
+    EXPECT_EQ(DataStore::getInstance().getAllStudents().size(), static_cast<size_t>(total));
+}
+
+TEST_F(DataApiTest, ImportCsv_CapsErrorList)
+{
+    std::string csv = "student_id,name,class\n";
+    const int bad = static_cast<int>(ImportService::kMaxErrors) + 5;
+    for (int i = 0; i < bad; ++i)
+    {
+        csv += ",无学号,某班\n";
+    }
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Csv, csv);
+    EXPECT_EQ(result.skippedCount, bad);
+    EXPECT_EQ(result.errors.size(), ImportService::kMaxErrors);
+    EXPECT_TRUE(result.errorsTruncated);
+}
+
+TEST_F(DataApiTest, ImportJson_FileOfStudents)
+{
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Json,
+        "[{\"student_id\":\"2024501\",\"name\":\"甲\",\"class\":\"J班\"},"
+        " {\"student_id\":\"2024502\",\"name\":\"乙\"}, 42, {broken}]");
+    EXPECT_EQ(result.importedCount, 1);
+    ASSERT_EQ(result.errors.size(), 3u);
+    EXPECT_EQ(result.errors[0].line, 2);
+    EXPECT_EQ(result.errors[0].message, "班级不能为空");
+    EXPECT_EQ(result.errors[1].message, "数据格式错误");
+    EXPECT_EQ(result.errors[2].message, "数据格式错误");
+}
+
+TEST_F(DataApiTest, ImportJson_RejectsNonArray)
+{
+    auto result = ImportService::getInstance().import(
+        ImportService::Type::Students, ImportService::Format::Json, "{\"data\":[]}");
+    EXPECT_EQ(result.fatal, "JSON数据须为数组");
+}
+
+TEST_F(DataApiTest, ImportJson_RequestRecords)
+{
+    Json::Value records(Json::arrayValue);
+    Json::Value att;
+    att["student_id"] = "2024001";
+    att["date"] = "2024-12-16";
+    att["status"] = "late";
+    records.append(att);
+    att["student_id"] = "missing";
+    records.append(att);
+
+    size_t before = DataStore::getInstance().getAllAttendances().size();
+    auto result = ImportService::getInstance().import(ImportService::Type::Attendances, records);
+    EXPECT_EQ(result.importedCount, 1);
+    ASSERT_EQ(result.errors.size(), 1u);
+    EXPECT_EQ(result.errors[0].line, 2);
+    EXPECT_EQ(result.errors[0].message, "学生不存在");
+    EXPECT_EQ(DataStore::getInstance().getAllAttendances().size(), before + 1);
+}
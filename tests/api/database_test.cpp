@@ -1,9 +1,29 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <trantor/net/EventLoopThread.h>
 #include "student_attendance/db/DatabaseManager.h"
+#include "student_attendance/db/SqliteTuning.h"
+#include "student_attendance/db/SqlText.h"
+#include "student_attendance/db/Storage.h"
+#include "student_attendance/db/StudentCache.h"
+#include "student_attendance/db/WriteAheadLog.h"
+#include "student_attendance/db/WriteThrough.h"
 #include "student_attendance/models/DataStore.h"
+#include "student_attendance/services/ExportService.h"
 
 using namespace student_attendance::db;
 using namespace student_attendance::models;
+using student_attendance::services::ExportService;
+using student_attendance::utils::Date;
+using student_attendance::utils::StatusCode;
 
 class DatabaseManagerTest : public ::testing::Test
 {
@@ -37,6 +57,277 @@ TEST_F(DatabaseManagerTest, Reset_CanBeCalledMultipleTimes)
     EXPECT_NO_THROW(DatabaseManager::getInstance().reset());
 }
 
+// ==================== SQL Text Tests ====================
+
+TEST(SqlTextTest, ShapeKeys_AreDistinct)
+{
+    using Q = QueryId;
+    EXPECT_NE(SqlText::shape(Q::StudentPage, 1), SqlText::shape(Q::StudentPage, 2));
+    EXPECT_NE(SqlText::shape(Q::StudentPage, 1, 1), SqlText::shape(Q::StudentPage, 1, 2));
+    EXPECT_NE(SqlText::shape(Q::StudentPage, 1, 1, false),
+              SqlText::shape(Q::StudentPage, 1, 1, true));
+    EXPECT_NE(SqlText::shape(Q::StudentCount), SqlText::shape(Q::StudentPage));
+}
+
+TEST(SqlTextTest, Get_BuildsOncePerShape)
+{
+    auto &texts = SqlText::getInstance();
+    int builds = 0;
+    auto key = SqlText::shape(QueryId::StudentPage, 0xFFFF, 7, true);
+    auto build = [&builds] {
+        ++builds;
+        return std::string("SELECT 1");
+    };
+    const auto &first = texts.get(key, build);
+    const auto &second = texts.get(key, build);
+
+    EXPECT_EQ(&first, &second);
+    EXPECT_EQ(first, "SELECT 1");
+    EXPECT_LE(builds, 1);
+}
+
+// ==================== SQLite Tuning Tests ====================
+
+TEST(SqliteTuningTest, FromConfig_DefaultsToWalProfile)
+{
+    std::string error;
+    auto tuning = SqliteTuning::fromConfig(Json::Value(Json::objectValue), error);
+    ASSERT_TRUE(tuning.has_value());
+    EXPECT_EQ(tuning->profile, "wal");
+    EXPECT_EQ(tuning->journalMode, "WAL");
+    EXPECT_EQ(tuning->synchronous, "NORMAL");
+    EXPECT_GT(tuning->mmapSize, 0);
+
+    for (const auto &name : SqliteTuning::profileNames())
+    {
+        EXPECT_TRUE(SqliteTuning::fromProfile(name).has_value()) << name;
+    }
+    EXPECT_EQ(SqliteTuning::fromProfile("default")->journalMode, "DELETE");
+    EXPECT_EQ(SqliteTuning::fromProfile("durable")->synchronous, "FULL");
+}
+
+TEST(SqliteTuningTest, FromConfig_OverridesProfile)
+{
+    Json::Value config;
+    config["profile"] = "durable";
+    config["synchronous"] = "extra";
+    config["cache_size"] = -1024;
+    config["busy_timeout"] = 250;
+    std::string error;
+    auto tuning = SqliteTuning::fromConfig(config, error);
+    ASSERT_TRUE(tuning.has_value()) << error;
+    EXPECT_EQ(tuning->profile, "durable");
+    EXPECT_EQ(tuning->journalMode, "WAL");
+    EXPECT_EQ(tuning->synchronous, "EXTRA");
+    EXPECT_EQ(tuning->cacheSize, -1024);
+    EXPECT_EQ(tuning->busyTimeoutMs, 250);
+
+    auto pragmas = tuning->pragmas();
+    ASSERT_EQ(pragmas.size(), 6u);
+    EXPECT_EQ(pragmas[0], "PRAGMA journal_mode = WAL");
+    EXPECT_EQ(pragmas[1], "PRAGMA synchronous = EXTRA");
+}
+
+TEST(SqliteTuningTest, FromConfig_RejectsUnknownValues)
+{
+    std::string error;
+    Json::Value config;
+    config["profile"] = "turbo";
+    EXPECT_FALSE(SqliteTuning::fromConfig(config, error).has_value());
+    EXPECT_NE(error.find("turbo"), std::string::npos);
+
+    config["profile"] = "wal";
+    config["journal_mode"] = "WAL; DROP TABLE students";
+    EXPECT_FALSE(SqliteTuning::fromConfig(config, error).has_value());
+
+    config.removeMember("journal_mode");
+    config["mmap_size"] = "large";
+    EXPECT_FALSE(SqliteTuning::fromConfig(config, error).has_value());
+}
+
+// ==================== Student Cache Tests ====================
+
+TEST_F(DatabaseManagerTest, StudentCache_InvalidatedByReset)
+{
+    auto &cache = StudentCache::getInstance();
+    std::optional<Student> student;
+    EXPECT_FALSE(cache.lookup("2024001", student));
+    EXPECT_FALSE(drogon::sync_wait(cache.load(nullptr)));
+}
+
+TEST_F(DatabaseManagerTest, StudentCache_FollowsSqliteWrites)
+{
+    auto client = DatabaseManager::getInstance().getClient();
+    if (!client)
+    {
+        GTEST_SKIP() << "no SQLite client";
+    }
+    auto &storage = Storage::of(Storage::Backend::Sqlite);
+    auto &cache = StudentCache::getInstance();
+
+    auto found = drogon::sync_wait(storage.getStudent("2024001"));
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found->name, "张三");
+    auto loads = cache.stats().loads;
+
+    std::optional<Student> student;
+    ASSERT_TRUE(drogon::sync_wait(storage.addStudent(Student("2024900", "新生", "新班级"))));
+    ASSERT_TRUE(cache.lookup("2024900", student));
+    ASSERT_TRUE(student.has_value());
+    EXPECT_EQ(student->className, "新班级");
+
+    ASSERT_TRUE(drogon::sync_wait(storage.updateStudent("2024900", "", "转入班级")));
+    ASSERT_TRUE(cache.lookup("2024900", student));
+    EXPECT_EQ(student->name, "新生");
+    EXPECT_EQ(student->className, "转入班级");
+
+    // Resolved from the cache without reading the roster again
+    std::vector<Attendance> rows(1);
+    rows[0].studentId = "2024900";
+    rows[0].date = Date::fromYmd(2024, 12, 20);
+    EXPECT_EQ(drogon::sync_wait(storage.addAttendances(rows)), 1);
+    EXPECT_EQ(rows[0].className, "转入班级");
+    EXPECT_EQ(cache.stats().loads, loads);
+
+    ASSERT_TRUE(drogon::sync_wait(storage.deleteAttendance(rows[0].id)));
+    ASSERT_TRUE(drogon::sync_wait(storage.deleteStudent("2024900")));
+    ASSERT_TRUE(cache.lookup("2024900", student));
+    EXPECT_FALSE(student.has_value());
+}
+
+TEST_F(DatabaseManagerTest, SqliteStorage_GenerationsFollowClassAndDay)
+{
+    if (!DatabaseManager::getInstance().getClient())
+    {
+        GTEST_SKIP() << "no SQLite client";
+    }
+    auto &storage = Storage::of(Storage::Backend::Sqlite);
+    auto before = storage.generation();
+
+    ASSERT_TRUE(drogon::sync_wait(storage.addStudent(Student("2024901", "新生", "新班级"))));
+    EXPECT_GT(storage.rosterGeneration("新班级"), before);
+    EXPECT_LE(storage.rosterGeneration("其他班级"), before);
+
+    auto day = Date::fromYmd(2024, 12, 20);
+    std::vector<Attendance> rows(1);
+    rows[0].studentId = "2024901";
+    rows[0].date = day;
+    ASSERT_EQ(drogon::sync_wait(storage.addAttendances(rows)), 1);
+    auto stamped = storage.attendanceGeneration("新班级", day, day);
+    EXPECT_GT(stamped, before);
+    auto nextDay = Date::fromYmd(2024, 12, 21);
+    EXPECT_LE(storage.attendanceGeneration("新班级", nextDay, nextDay), before);
+    EXPECT_LE(storage.attendanceGeneration("其他班级", std::nullopt, std::nullopt), before);
+
+    // The records follow the student, so both classes change on every day
+    ASSERT_TRUE(drogon::sync_wait(storage.updateStudent("2024901", "", "转入班级")));
+    EXPECT_GT(storage.attendanceGeneration("新班级", nextDay, nextDay), stamped);
+    EXPECT_GT(storage.attendanceGeneration("转入班级", std::nullopt, std::nullopt), stamped);
+
+    ASSERT_TRUE(drogon::sync_wait(storage.deleteStudent("2024901")));
+}
+
+TEST_F(DatabaseManagerTest, Mirror_LoadsStoreAndReseedsIds)
+{
+    auto &store = DataStore::getInstance();
+    if (!DatabaseManager::getInstance().getClient())
+    {
+        EXPECT_FALSE(loadFromMirror(store));
+        GTEST_SKIP() << "no SQLite client";
+    }
+    auto &sqlite = Storage::of(Storage::Backend::Sqlite);
+    std::vector<Attendance> rows(1);
+    rows[0].studentId = "2024001";
+    rows[0].date = Date::fromYmd(2024, 12, 20);
+    ASSERT_EQ(drogon::sync_wait(sqlite.addAttendances(rows)), 1);
+
+    store.clear();
+    ASSERT_TRUE(loadFromMirror(store));
+    EXPECT_EQ(static_cast<int>(store.getAllStudents().size()),
+              drogon::sync_wait(sqlite.listStudents(StudentQuery{})).total);
+    ASSERT_TRUE(store.getAttendanceById(rows[0].id).has_value());
+
+    // Ids the mirror holds are not handed out again
+    store.reset();
+    reseedFromMirror(store);
+    int next = store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班",
+                                              Date::fromYmd(2024, 12, 21), StatusCode::Present, ""));
+    EXPECT_GT(next, rows[0].id);
+}
+
+TEST_F(DatabaseManagerTest, SqliteStorage_ReportReadsMatchMemory)
+{
+    if (!DatabaseManager::getInstance().getClient())
+    {
+        GTEST_SKIP() << "no SQLite client";
+    }
+    auto &sqlite = Storage::of(Storage::Backend::Sqlite);
+    auto &memory = Storage::of(Storage::Backend::Memory);
+    EXPECT_EQ(sqlite.snapshot(), nullptr);
+
+    auto summaries = sqlite.studentSummaries("", std::nullopt, std::nullopt);
+    auto expected = memory.studentSummaries("", std::nullopt, std::nullopt);
+    ASSERT_EQ(summaries.size(), expected.size());
+    for (size_t i = 0; i < summaries.size(); ++i)
+    {
+        EXPECT_EQ(summaries[i].student.studentId, expected[i].student.studentId);
+        EXPECT_EQ(summaries[i].histogram, expected[i].histogram);
+    }
+
+    ReportScope scope;
+    scope.filter.className = expected.front().student.className;
+    auto view = sqlite.snapshot(scope);
+    ASSERT_NE(view, nullptr);
+    for (const auto &student : view->getAllStudents())
+    {
+        EXPECT_EQ(student.className, scope.filter.className);
+    }
+    size_t rows = 0, expectedRows = 0;
+    view->scanAttendances(AttendanceFilter{}, [&](const auto &) { ++rows; });
+    memory.snapshot()->scanAttendances(scope.filter, [&](const auto &) { ++expectedRows; });
+    EXPECT_EQ(rows, expectedRows);
+}
+
+TEST_F(DatabaseManagerTest, SqliteStorage_ExportPagesBatchesInOrder)
+{
+    if (!DatabaseManager::getInstance().getClient())
+    {
+        GTEST_SKIP() << "no SQLite client";
+    }
+    auto &sqlite = Storage::of(Storage::Backend::Sqlite);
+    // Several batches' worth, so later ones are requested while earlier
+    // ones are written out
+    std::vector<Student> students;
+    for (int i = 0; i < 1500; ++i)
+    {
+        students.emplace_back("2031" + std::to_string(10000 + i), "导出", "导出班");
+    }
+    std::vector<bool> added;
+    ASSERT_EQ(drogon::sync_wait(sqlite.addStudents(students, added)), 1500);
+    auto total = drogon::sync_wait(sqlite.listStudents(StudentQuery{})).total;
+
+    auto previous = Storage::current().backend();
+    Storage::select(Storage::Backend::Sqlite);
+    std::ostringstream out;
+    bool exported =
+        ExportService::getInstance().exportTo("students", ExportService::Format::Csv, out);
+    Storage::select(previous);
+    ASSERT_TRUE(exported);
+
+    std::istringstream lines(out.str());
+    std::string line;
+    std::getline(lines, line);
+    EXPECT_EQ(line, "student_id,name,class");
+    std::vector<std::string> ids;
+    while (std::getline(lines, line))
+    {
+        ids.push_back(line.substr(0, line.find(',')));
+    }
+    EXPECT_EQ(static_cast<int>(ids.size()), total);
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+    EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+}
+
 // ==================== DataStore Integration Tests ====================
 
 class DataStoreTest : public ::testing::Test
@@ -189,7 +480,7 @@ TEST_F(DataStoreTest, SearchStudents_NoMatch)
 
 TEST_F(DataStoreTest, AddAttendance_ReturnsId)
 {
-    Attendance att(0, "2024001", "张三", "人文2401班", "12-20", "present", "");
+    Attendance att(0, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 20), StatusCode::Present, "");
     int id = DataStore::getInstance().addAttendance(att);
     EXPECT_GT(id, 0);
 }
@@ -214,7 +505,7 @@ TEST_F(DataStoreTest, UpdateAttendance_Success)
     ASSERT_TRUE(original.has_value());
 
     Attendance updated = *original;
-    updated.status = "late";
+    updated.status = StatusCode::Late;
     updated.remark = "更新后的备注";
 
     bool result = DataStore::getInstance().updateAttendance(1, updated);
@@ -222,13 +513,13 @@ TEST_F(DataStoreTest, UpdateAttendance_Success)
 
     auto modified = DataStore::getInstance().getAttendanceById(1);
     EXPECT_TRUE(modified.has_value());
-    EXPECT_EQ(modified->status, "late");
+    EXPECT_EQ(modified->status, StatusCode::Late);
     EXPECT_EQ(modified->remark, "更新后的备注");
 }
 
 TEST_F(DataStoreTest, UpdateAttendance_NotExists)
 {
-    Attendance att(99999, "2024001", "张三", "人文2401班", "12-20", "present", "");
+    Attendance att(99999, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 20), StatusCode::Present, "");
     bool result = DataStore::getInstance().updateAttendance(99999, att);
     EXPECT_FALSE(result);
 }
@@ -236,7 +527,7 @@ TEST_F(DataStoreTest, UpdateAttendance_NotExists)
 TEST_F(DataStoreTest, DeleteAttendance_Success)
 {
     // First add an attendance to delete
-    Attendance att(0, "2024001", "张三", "人文2401班", "12-30", "present", "");
+    Attendance att(0, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 30), StatusCode::Present, "");
     int id = DataStore::getInstance().addAttendance(att);
     EXPECT_GT(id, 0);
 
@@ -261,8 +552,9 @@ TEST_F(DataStoreTest, GetAllAttendances_ReturnsData)
 
 TEST_F(DataStoreTest, SearchAttendances_ByStudentId)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "2024001", "", "", "", "", "", "");
+    AttendanceFilter filter;
+    filter.studentId = "2024001";
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
     for (const auto &att : attendances)
     {
         EXPECT_EQ(att.studentId, "2024001");
@@ -271,28 +563,32 @@ TEST_F(DataStoreTest, SearchAttendances_ByStudentId)
 
 TEST_F(DataStoreTest, SearchAttendances_ByDate)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "", "", "", "12-15", "", "", "");
+    AttendanceFilter filter;
+    filter.date = Date::parse("2025-12-15");
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
+    EXPECT_FALSE(attendances.empty());
     for (const auto &att : attendances)
     {
-        EXPECT_EQ(att.date, "12-15");
+        EXPECT_EQ(att.date, *filter.date);
     }
 }
 
 TEST_F(DataStoreTest, SearchAttendances_ByStatus)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "", "", "", "", "", "", "present");
+    AttendanceFilter filter;
+    filter.status = StatusCode::Present;
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
     for (const auto &att : attendances)
     {
-        EXPECT_EQ(att.status, "present");
+        EXPECT_EQ(att.status, StatusCode::Present);
     }
 }
 
 TEST_F(DataStoreTest, SearchAttendances_ByClassName)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "", "", "人文2401班", "", "", "", "");
+    AttendanceFilter filter;
+    filter.className = "人文2401班";
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
     for (const auto &att : attendances)
     {
         EXPECT_EQ(att.className, "人文2401班");
@@ -301,22 +597,88 @@ TEST_F(DataStoreTest, SearchAttendances_ByClassName)
 
 TEST_F(DataStoreTest, SearchAttendances_ByDateRange)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "", "", "", "", "12-01", "12-31", "");
+    AttendanceFilter filter;
+    filter.startDate = Date::parse("2025-12-01");
+    filter.endDate = Date::parse("2025-12-31");
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
+    EXPECT_FALSE(attendances.empty());
     for (const auto &att : attendances)
     {
-        EXPECT_GE(att.date, "12-01");
-        EXPECT_LE(att.date, "12-31");
+        EXPECT_GE(att.date, *filter.startDate);
+        EXPECT_LE(att.date, *filter.endDate);
     }
 }
 
 TEST_F(DataStoreTest, SearchAttendances_NoMatch)
 {
-    auto attendances = DataStore::getInstance().searchAttendances(
-        "9999999", "", "", "", "", "", "");
+    AttendanceFilter filter;
+    filter.studentId = "9999999";
+    auto attendances = DataStore::getInstance().searchAttendances(filter);
     EXPECT_EQ(attendances.size(), 0u);
 }
 
+// ==================== Aggregate Counters ====================
+
+namespace
+{
+
+StatusHistogram tallyByScan(const AttendanceFilter &filter)
+{
+    StatusHistogram counts{};
+    DataStore::getInstance().scanAttendances(filter, [&counts](const AttendanceTable::Row &row) {
+        counts[static_cast<size_t>(row.status())]++;
+    });
+    return counts;
+}
+
+}  // namespace
+
+TEST_F(DataStoreTest, Aggregates_MatchSampleData)
+{
+    auto &store = DataStore::getInstance();
+    auto day = *Date::parse("2025-12-15");
+
+    AttendanceFilter filter;
+    filter.date = day;
+    EXPECT_EQ(store.dailyHistogram(day, ""), tallyByScan(filter));
+
+    filter.className = "人文2401班";
+    EXPECT_EQ(store.dailyHistogram(day, "人文2401班"), tallyByScan(filter));
+
+    auto histograms = store.studentHistograms({"2024003", "2024006"}, "", std::nullopt, std::nullopt);
+    ASSERT_EQ(histograms.size(), 2u);
+    EXPECT_EQ(histograms[0][static_cast<size_t>(StatusCode::Late)], 1);
+    EXPECT_EQ(histograms[1][static_cast<size_t>(StatusCode::SickLeave)], 1);
+}
+
+TEST_F(DataStoreTest, Aggregates_FollowWrites)
+{
+    auto &store = DataStore::getInstance();
+    auto day = Date::fromYmd(2024, 12, 20);
+    int first = store.addAttendance(
+        Attendance(0, "2024001", "张三", "人文2401班", day, StatusCode::Present, ""));
+    int second = store.addAttendance(
+        Attendance(0, "2024001", "张三", "人文2401班", Date::fromYmd(2025, 1, 6), StatusCode::Late, ""));
+
+    store.updateAttendance(first, StatusCode::Absent, "");
+    store.deleteAttendance(second);
+
+    AttendanceFilter filter;
+    filter.date = day;
+    EXPECT_EQ(store.dailyHistogram(day, "人文2401班"), tallyByScan(filter));
+
+    filter = AttendanceFilter();
+    filter.studentId = "2024001";
+    filter.startDate = day;
+    auto histograms = store.studentHistograms({"2024001"}, "", day, std::nullopt);
+    EXPECT_EQ(histograms[0], tallyByScan(filter));
+    EXPECT_EQ(histograms[0][static_cast<size_t>(StatusCode::Absent)], 1);
+    EXPECT_EQ(histograms[0][static_cast<size_t>(StatusCode::Late)], 0);
+
+    store.clear();
+    EXPECT_EQ(store.dailyHistogram(day, ""), StatusHistogram{});
+}
+
 // ==================== Class Operations ====================
 
 TEST_F(DataStoreTest, GetAllClasses_ReturnsData)
@@ -354,6 +716,21 @@ TEST_F(DataStoreTest, GetClassStudentCount_ZeroForNonExistent)
     EXPECT_EQ(count, 0);
 }
 
+TEST_F(DataStoreTest, ClassIndex_FollowsStudentChanges)
+{
+    auto &store = DataStore::getInstance();
+    int before = store.getClassStudentCount("人文2401班");
+
+    store.updateStudent("2024001", Student("2024001", "", "人文2402班"));
+    EXPECT_EQ(store.getClassStudentCount("人文2401班"), before - 1);
+    EXPECT_EQ(store.getStudentsByClass("人文2402班").size(), 4u);
+
+    store.deleteStudent("2024007");
+    store.deleteStudent("2024008");
+    auto classes = store.getAllClasses();
+    EXPECT_EQ(std::find(classes.begin(), classes.end(), "人文2403班"), classes.end());
+}
+
 // ==================== Import/Export Operations ====================
 
 TEST_F(DataStoreTest, Clear_RemovesAllData)
@@ -397,8 +774,8 @@ TEST_F(DataStoreTest, ImportAttendances_AddsNewAttendances)
     size_t initialCount = DataStore::getInstance().getAllAttendances().size();
 
     std::vector<Attendance> newAttendances = {
-        Attendance(0, "2024001", "张三", "人文2401班", "12-25", "present", ""),
-        Attendance(0, "2024002", "李四", "人文2401班", "12-25", "late", "")
+        Attendance(0, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 25), StatusCode::Present, ""),
+        Attendance(0, "2024002", "李四", "人文2401班", Date::fromYmd(2024, 12, 25), StatusCode::Late, "")
     };
 
     DataStore::getInstance().importAttendances(newAttendances);
@@ -416,3 +793,768 @@ TEST_F(DataStoreTest, Reset_RestoresSampleData)
     EXPECT_GT(DataStore::getInstance().getAllStudents().size(), 0u);
 }
 
+
+// ==================== Sharding ====================
+
+TEST_F(DataStoreTest, Shards_KeepIdOrderAcrossStudents)
+{
+    auto &store = DataStore::getInstance();
+    std::vector<Attendance> batch;
+    for (const auto &student : store.getAllStudents())
+    {
+        batch.emplace_back(0, student.studentId, "", "", Date::fromYmd(2024, 12, 16),
+                           StatusCode::Present, "");
+    }
+    ASSERT_EQ(store.addAttendances(batch), static_cast<int>(batch.size()));
+
+    // A batch spans shards but still gets ids in input order
+    for (size_t i = 1; i < batch.size(); ++i)
+    {
+        EXPECT_EQ(batch[i].id, batch[i - 1].id + 1);
+    }
+
+    auto all = store.getAllAttendances();
+    EXPECT_TRUE(std::is_sorted(all.begin(), all.end(),
+                               [](const Attendance &a, const Attendance &b) { return a.id < b.id; }));
+
+    // Paged by id through the storage, as exports and keyset listings are
+    auto &memory = Storage::of(Storage::Backend::Memory);
+    std::vector<int> exported;
+    AttendanceQuery query;
+    query.limit = 3;
+    query.withTotal = false;
+    while (true)
+    {
+        auto page = drogon::sync_wait(memory.listAttendances(query));
+        for (const auto &row : page.rows)
+        {
+            exported.push_back(row.id);
+        }
+        if (!page.more)
+            break;
+        query.after = page.rows.back();
+    }
+    ASSERT_EQ(exported.size(), all.size());
+    for (size_t i = 0; i < all.size(); ++i)
+    {
+        EXPECT_EQ(exported[i], all[i].id);
+    }
+
+    ASSERT_TRUE(store.updateAttendance(batch.back().id, StatusCode::Late, "迟到"));
+    EXPECT_EQ(store.getAttendanceById(batch.back().id)->status, StatusCode::Late);
+    EXPECT_TRUE(store.deleteAttendance(batch.front().id));
+    EXPECT_FALSE(store.getAttendanceById(batch.front().id).has_value());
+}
+
+TEST_F(DataStoreTest, Shards_WritesProceedDuringScans)
+{
+    auto &store = DataStore::getInstance();
+    constexpr int kWriters = 4;
+    constexpr int kPerWriter = 500;
+    size_t initial = store.getAllAttendances().size();
+
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done)
+        {
+            AttendanceFilter filter;
+            filter.className = "人文2401班";
+            size_t rows = 0;
+            store.scanAttendances(filter, [&rows](const AttendanceTable::Row &) { rows++; });
+            store.dailyHistogram(Date::fromYmd(2024, 12, 16), "");
+            store.getClassSizes();
+        }
+    });
+
+    std::vector<std::thread> writers;
+    const std::vector<std::string> ids = {"2024001", "2024004", "2024007", "2024008"};
+    for (int w = 0; w < kWriters; ++w)
+    {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kPerWriter; ++i)
+            {
+                Attendance att(0, ids[w], "", "人文2401班", Date::fromYmd(2024, 12, 16),
+                               StatusCode::Present, "");
+                store.addAttendance(att);
+            }
+        });
+    }
+    for (auto &writer : writers)
+    {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+
+    auto all = store.getAllAttendances();
+    ASSERT_EQ(all.size(), initial + kWriters * kPerWriter);
+    std::set<int> unique;
+    for (const auto &att : all)
+    {
+        unique.insert(att.id);
+    }
+    EXPECT_EQ(unique.size(), all.size());
+    auto day = store.dailyHistogram(Date::fromYmd(2024, 12, 16), "人文2401班");
+    EXPECT_EQ(day[static_cast<size_t>(StatusCode::Present)], kWriters * kPerWriter);
+}
+
+// ==================== Snapshots ====================
+
+TEST_F(DataStoreTest, Snapshot_IsPointInTime)
+{
+    auto &store = DataStore::getInstance();
+    auto before = store.snapshot();
+    EXPECT_EQ(store.snapshot(), before);  // Nothing written, same view
+
+    store.addStudent(Student("2024999", "新生", "人文2401班"));
+    store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 16),
+                                   StatusCode::Absent, ""));
+    auto after = store.snapshot();
+    EXPECT_NE(after, before);
+    EXPECT_GT(after->generation(), before->generation());
+
+    EXPECT_FALSE(before->getStudentById("2024999").has_value());
+    EXPECT_TRUE(after->getStudentById("2024999").has_value());
+    EXPECT_EQ(before->getStudentsByClass("人文2401班").size() + 1,
+              after->getStudentsByClass("人文2401班").size());
+    EXPECT_EQ(before->attendanceCount() + 1, after->attendanceCount());
+
+    // Views stay readable after the store itself is emptied
+    store.clear();
+    AttendanceFilter filter;
+    filter.studentId = "2024003";
+    std::vector<std::string> names;
+    after->scanAttendances(filter, [&names](const AttendanceTable::Row &row) {
+        names.push_back(row.name());
+    });
+    ASSERT_EQ(names.size(), 1u);
+    EXPECT_EQ(names[0], "王五");
+    auto day = after->dailyHistogram(*Date::parse("2025-12-15"), "");
+    EXPECT_EQ(day[static_cast<size_t>(StatusCode::Late)], 1);
+    EXPECT_EQ(store.snapshot()->attendanceCount(), 0u);
+}
+
+TEST_F(DataStoreTest, Snapshot_KeepsValuesWrittenOverAfterIt)
+{
+    auto &store = DataStore::getInstance();
+    auto records = store.searchAttendances(AttendanceFilter{});
+    ASSERT_FALSE(records.empty());
+    const auto &first = records.front();
+    auto before = store.snapshot();
+
+    store.updateAttendance(first.id, StatusCode::EarlyLeave, "改过");
+    store.updateStudent("2024001", Student("2024001", "张三丰", "人文2402班"));
+    store.deleteStudent("2024002");
+    auto after = store.snapshot();
+
+    AttendanceFilter filter;
+    filter.studentId = first.studentId;
+    std::vector<Attendance> seen;
+    before->scanAttendances(filter, [&seen](const AttendanceTable::Row &row) {
+        seen.push_back(row.toAttendance());
+    });
+    ASSERT_FALSE(seen.empty());
+    EXPECT_EQ(seen.front().status, first.status);
+    EXPECT_EQ(seen.front().remark, first.remark);
+    auto day = before->dailyHistogram(first.date, "");
+    EXPECT_EQ(day[static_cast<size_t>(StatusCode::EarlyLeave)], 0);
+    EXPECT_EQ(before->getStudentById("2024001")->name, "张三");
+    EXPECT_TRUE(before->getStudentById("2024002").has_value());
+
+    EXPECT_EQ(after->dailyHistogram(first.date, "")[static_cast<size_t>(StatusCode::EarlyLeave)], 1);
+    EXPECT_EQ(after->getStudentById("2024001")->className, "人文2402班");
+    for (const auto &student : after->getStudentsByClass("人文2401班"))
+    {
+        EXPECT_NE(student.studentId, "2024001");
+        EXPECT_NE(student.studentId, "2024002");
+    }
+}
+
+TEST_F(DataStoreTest, Snapshot_ShardsStayConsistentUnderWrites)
+{
+    auto &store = DataStore::getInstance();
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < 2000; ++i)
+        {
+            store.addAttendance(Attendance(0, i % 2 ? "2024001" : "2024004", "", "人文2401班",
+                                           Date::fromYmd(2024, 12, 16), StatusCode::Present, "w"));
+        }
+        done = true;
+    });
+
+    // Each shard's rows and aggregates come from one copy, so they agree
+    size_t snapshots = 0;
+    while (!done || snapshots == 0)
+    {
+        auto view = store.snapshot();
+        ++snapshots;
+        int scanned = 0;
+        AttendanceFilter filter;
+        filter.date = Date::fromYmd(2024, 12, 16);
+        view->scanAttendances(filter, [&scanned](const AttendanceTable::Row &) { ++scanned; });
+        auto day = view->dailyHistogram(Date::fromYmd(2024, 12, 16), "");
+        ASSERT_EQ(day[static_cast<size_t>(StatusCode::Present)], scanned);
+        EXPECT_GE(view->attendanceCount(), static_cast<size_t>(scanned));
+    }
+    writer.join();
+    EXPECT_EQ(store.snapshot()->attendanceCount(), store.getAllAttendances().size());
+}
+
+TEST_F(DataStoreTest, RestoreAttendances_SkipsRecordsAlreadyHeld)
+{
+    auto &store = DataStore::getInstance();
+    auto held = store.getAllAttendances();
+    ASSERT_FALSE(held.empty());
+    Attendance extra = held.back();
+    extra.id = held.back().id + 1;
+    extra.remark = "补录";
+
+    auto records = held;
+    records.push_back(extra);
+    store.restoreAttendances(records);
+    auto all = store.getAllAttendances();
+    ASSERT_EQ(all.size(), held.size() + 1);
+    EXPECT_EQ(store.getAttendanceById(extra.id)->remark, "补录");
+}
+
+// ==================== Write-Ahead Log ====================
+
+class WriteAheadLogTest : public DataStoreTest
+{
+protected:
+    void SetUp() override
+    {
+        DataStoreTest::SetUp();
+        options_.directory =
+            (std::filesystem::temp_directory_path() / "student_attendance_wal_test").string();
+        std::filesystem::remove_all(options_.directory);
+    }
+
+    void TearDown() override
+    {
+        WriteAheadLog::getInstance().close();
+        std::filesystem::remove_all(options_.directory);
+        DataStoreTest::TearDown();
+    }
+
+    // Closes the log, empties the store and recovers it from disk
+    WriteAheadLog::RecoveryStats restart()
+    {
+        auto &wal = WriteAheadLog::getInstance();
+        wal.close();
+        DataStore::getInstance().clear();
+        return wal.open(options_, DataStore::getInstance());
+    }
+
+    std::vector<std::filesystem::path> segments() const
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto &entry : std::filesystem::directory_iterator(options_.directory))
+        {
+            if (entry.path().extension() == ".log")
+                paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    WriteAheadLog::Options options_;
+};
+
+TEST_F(WriteAheadLogTest, Recover_ReplaysLoggedWrites)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    auto first = wal.open(options_, store);
+    EXPECT_FALSE(first.fromSnapshot);
+    ASSERT_TRUE(wal.isOpen());
+
+    store.addStudent(Student("2024999", "新生", "人文2401班"));
+    store.updateStudent("2024002", Student("2024002", "", "理工2401班"));
+    int added = store.addAttendance(Attendance(0, "2024999", "新生", "人文2401班",
+                                               Date::fromYmd(2024, 12, 16), StatusCode::SickLeave,
+                                               "病假"));
+    int last = store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班",
+                                              Date::fromYmd(2024, 12, 16), StatusCode::Absent, ""));
+    store.updateAttendance(added, StatusCode::Present, "补签");
+    store.deleteAttendance(last);
+    EXPECT_TRUE(wal.waitDurable());
+    auto before = store.getAllAttendances();
+    auto students = store.getAllStudents();
+
+    auto stats = restart();
+    EXPECT_TRUE(stats.fromSnapshot);
+    EXPECT_FALSE(stats.tornTail);
+    EXPECT_EQ(stats.replayed, 6u);
+
+    auto after = store.getAllAttendances();
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < after.size(); ++i)
+    {
+        EXPECT_EQ(after[i].id, before[i].id);
+        EXPECT_EQ(after[i].studentId, before[i].studentId);
+        EXPECT_EQ(after[i].status, before[i].status);
+        EXPECT_EQ(after[i].remark, before[i].remark);
+    }
+    EXPECT_EQ(store.getAllStudents().size(), students.size());
+    EXPECT_EQ(store.getStudentById("2024002")->className, "理工2401班");
+    EXPECT_EQ(store.getAttendanceById(added)->remark, "补签");
+
+    // The deleted record's id is not handed out again
+    int next = store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班",
+                                              Date::fromYmd(2024, 12, 17), StatusCode::Present, ""));
+    EXPECT_GT(next, last);
+}
+
+TEST_F(WriteAheadLogTest, HasState_OnlyOnceOpened)
+{
+    EXPECT_FALSE(WriteAheadLog::hasState(options_.directory));
+    std::filesystem::create_directories(options_.directory);
+    EXPECT_FALSE(WriteAheadLog::hasState(options_.directory));
+
+    WriteAheadLog::getInstance().open(options_, DataStore::getInstance());
+    EXPECT_TRUE(WriteAheadLog::hasState(options_.directory));
+}
+
+TEST_F(WriteAheadLogTest, Recover_StopsAtTornTail)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    wal.open(options_, store);
+
+    store.addStudent(Student("2024998", "甲", "人文2401班"));
+    store.addStudent(Student("2024999", "乙", "人文2401班"));
+    EXPECT_TRUE(wal.waitDurable());
+    wal.close();
+
+    // A crash in the middle of the last record
+    auto logs = segments();
+    ASSERT_FALSE(logs.empty());
+    auto path = logs.back();
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+    store.clear();
+    auto stats = wal.open(options_, store);
+    EXPECT_TRUE(stats.tornTail);
+    EXPECT_EQ(stats.replayed, 1u);
+    EXPECT_TRUE(store.studentExists("2024998"));
+    EXPECT_FALSE(store.studentExists("2024999"));
+
+    // Recovery checkpointed, so the damaged log is gone
+    EXPECT_FALSE(restart().tornTail);
+    EXPECT_TRUE(store.studentExists("2024998"));
+}
+
+TEST_F(WriteAheadLogTest, WaitDurableCoro_ResumesOnCallerLoop)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    wal.open(options_, store);
+
+    trantor::EventLoopThread thread;
+    thread.run();
+    auto *loop = thread.getLoop();
+    std::promise<std::pair<bool, bool>> done;
+    loop->queueInLoop([&] {
+        drogon::async_run([&]() -> drogon::Task<> {
+            store.addStudent(Student("2024997", "丙", "人文2401班"));
+            bool durable = co_await wal.waitDurableCoro();
+            done.set_value({durable, loop->isInLoopThread()});
+        });
+    });
+    auto [durable, onLoop] = done.get_future().get();
+    EXPECT_TRUE(durable);
+    EXPECT_TRUE(onLoop);
+    EXPECT_EQ(restart().replayed, 1u);
+    EXPECT_TRUE(store.studentExists("2024997"));
+}
+
+TEST_F(WriteAheadLogTest, Checkpoint_DropsCoveredLog)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    options_.checkpointBytes = 1 << 10;
+    wal.open(options_, store);
+    auto checkpoints = wal.stats().checkpoints;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班",
+                                       Date::fromOrdinal(Date::fromYmd(2024, 9, 1).ordinal() + i), StatusCode::Present,
+                                       ""));
+    }
+    EXPECT_TRUE(wal.waitDurable());
+    wal.checkpoint();
+    EXPECT_GT(wal.stats().checkpoints, checkpoints);
+    EXPECT_GE(wal.stats().syncs, 1u);
+
+    // Only the segment opened by the last checkpoint is left, and it is empty
+    auto logs = segments();
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(std::filesystem::file_size(logs[0]), 0u);
+
+    auto count = store.snapshot()->attendanceCount();
+    auto stats = restart();
+    EXPECT_EQ(stats.replayed, 0u);
+    EXPECT_EQ(stats.attendances, count);
+}
+
+TEST_F(WriteAheadLogTest, Snapshot_LoadsImageWithIndexes)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    wal.open(options_, store);
+    store.addAttendance(Attendance(0, "2024004", "赵六", "人文2402班", Date::fromYmd(2024, 12, 16),
+                                   StatusCode::Late, "迟到五分钟"));
+    int erased = store.addAttendance(Attendance(0, "2024005", "钱七", "人文2402班",
+                                                Date::fromYmd(2024, 12, 16), StatusCode::Absent, ""));
+    store.deleteAttendance(erased);
+    wal.checkpoint();
+
+    AttendanceFilter byClass;
+    byClass.className = "人文2402班";
+    AttendanceFilter late;
+    late.status = StatusCode::Late;
+    auto classRows = store.searchAttendances(byClass);
+    auto lateRows = store.searchAttendances(late);
+    auto day = store.dailyHistogram(Date::fromYmd(2024, 12, 16), "");
+    // Name postings and key orders are rebuilt on load rather than saved
+    AttendanceQuery byName;
+    byName.sortColumn = AttendanceQuery::ByName;
+    byName.limit = 1000;
+    auto &memory = Storage::of(Storage::Backend::Memory);
+    auto named = drogon::sync_wait(memory.listAttendances(byName)).rows;
+
+    auto stats = restart();
+    EXPECT_TRUE(stats.fromSnapshot);
+    EXPECT_EQ(stats.replayed, 0u);
+    EXPECT_EQ(stats.students, store.getAllStudents().size());
+
+    auto reloaded = store.searchAttendances(byClass);
+    ASSERT_EQ(reloaded.size(), classRows.size());
+    for (size_t i = 0; i < reloaded.size(); ++i)
+    {
+        EXPECT_EQ(reloaded[i].id, classRows[i].id);
+        EXPECT_EQ(reloaded[i].remark, classRows[i].remark);
+    }
+    EXPECT_EQ(store.searchAttendances(late).size(), lateRows.size());
+    EXPECT_EQ(store.dailyHistogram(Date::fromYmd(2024, 12, 16), ""), day);
+    auto renamed = drogon::sync_wait(memory.listAttendances(byName)).rows;
+    ASSERT_EQ(renamed.size(), named.size());
+    for (size_t i = 0; i < renamed.size(); ++i)
+    {
+        EXPECT_EQ(renamed[i].id, named[i].id);
+    }
+    EXPECT_FALSE(store.getAttendanceById(erased).has_value());
+    EXPECT_EQ(store.getClassStudentCount("人文2402班"), 3);
+    EXPECT_GT(store.addAttendance(Attendance(0, "2024001", "张三", "人文2401班",
+                                             Date::fromYmd(2024, 12, 17), StatusCode::Present, "")),
+              erased);
+}
+
+TEST_F(WriteAheadLogTest, Snapshot_RejectsUnknownFormat)
+{
+    auto &store = DataStore::getInstance();
+    auto &wal = WriteAheadLog::getInstance();
+    wal.open(options_, store);
+    wal.close();
+
+    // The header of the old record-by-record format
+    auto path = std::filesystem::path(options_.directory) / "snapshot.bin";
+    ASSERT_TRUE(std::filesystem::exists(path));
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.write("SASNAP01", 8);
+    }
+    store.clear();
+    EXPECT_THROW(wal.open(options_, store), std::runtime_error);
+    EXPECT_FALSE(wal.isOpen());
+}
+
+TEST_F(DataStoreTest, LoadImage_RejectsDamagedImage)
+{
+    auto &store = DataStore::getInstance();
+    std::string image;
+    store.snapshot()->saveImage(image);
+    auto count = store.snapshot()->attendanceCount();
+
+    auto damaged = image;
+    damaged[damaged.size() / 2] ^= 0x5A;
+    EXPECT_FALSE(store.loadImage(damaged).has_value());
+    EXPECT_FALSE(store.loadImage(std::string_view(image).substr(0, image.size() - 8)).has_value());
+    EXPECT_EQ(store.snapshot()->attendanceCount(), count);
+
+    store.clear();
+    auto info = store.loadImage(image);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->attendances, count);
+    EXPECT_EQ(store.snapshot()->attendanceCount(), count);
+    EXPECT_TRUE(store.studentExists("2024008"));
+}
+
+// ==================== Storage ====================
+
+TEST(StorageTest, ParseBackend_KnowsEveryName)
+{
+    for (auto backend : {Storage::Backend::Memory, Storage::Backend::Sqlite,
+                         Storage::Backend::Hybrid})
+    {
+        EXPECT_EQ(Storage::parseBackend(Storage::backendName(backend)), backend);
+        EXPECT_EQ(Storage::of(backend).backend(), backend);
+    }
+    EXPECT_FALSE(Storage::parseBackend("postgres").has_value());
+}
+
+TEST_F(DataStoreTest, Storage_ListsStudentsByPage)
+{
+    auto &storage = Storage::of(Storage::Backend::Memory);
+    StudentQuery query;
+    query.sortColumn = StudentQuery::ByName;
+    query.descending = true;
+    query.limit = 3;
+
+    auto first = drogon::sync_wait(storage.listStudents(query));
+    ASSERT_EQ(first.rows.size(), 3u);
+    EXPECT_EQ(first.total, static_cast<int>(DataStore::getInstance().getAllStudents().size()));
+    EXPECT_TRUE(first.more);
+    EXPECT_GE(first.rows[0].name, first.rows[1].name);
+
+    // Keyset and offset paging agree
+    query.after = first.rows.back();
+    auto byKey = drogon::sync_wait(storage.listStudents(query));
+    query.after.reset();
+    query.offset = 3;
+    auto byOffset = drogon::sync_wait(storage.listStudents(query));
+    ASSERT_EQ(byKey.rows.size(), byOffset.rows.size());
+    for (size_t i = 0; i < byKey.rows.size(); ++i)
+    {
+        EXPECT_EQ(byKey.rows[i].studentId, byOffset.rows[i].studentId);
+    }
+}
+
+namespace
+{
+
+// Every row of a listing, read a page at a time by keyset
+template <typename Row, typename Query, typename List>
+std::vector<Row> listByKeyset(Query query, List &&list)
+{
+    std::vector<Row> rows;
+    while (true)
+    {
+        auto page = drogon::sync_wait(list(query));
+        rows.insert(rows.end(), page.rows.begin(), page.rows.end());
+        if (!page.more)
+            return rows;
+        query.after = page.rows.back();
+    }
+}
+
+}  // namespace
+
+TEST_F(DataStoreTest, Storage_ListsStudentsInEveryOrder)
+{
+    auto &store = DataStore::getInstance();
+    for (int i = 0; i < 300; ++i)
+    {
+        // Repeated names and classes, so the id breaks ties
+        ASSERT_TRUE(store.addStudent(Student("S" + std::to_string(1000 + i),
+                                             "学生" + std::to_string(i % 37),
+                                             "班级" + std::to_string(i % 7))));
+    }
+    ASSERT_TRUE(store.deleteStudent("S1010"));
+
+    auto &storage = Storage::of(Storage::Backend::Memory);
+    for (uint8_t column : {StudentQuery::ById, StudentQuery::ByName, StudentQuery::ByClass})
+    {
+        for (bool descending : {false, true})
+        {
+            for (auto [className, keyword] : {std::pair<std::string, std::string>("", ""),
+                                              {"班级3", ""}, {"", "学生1"}, {"班级5", "S11"}})
+            {
+                StudentQuery query;
+                query.sortColumn = column;
+                query.descending = descending;
+                query.className = className;
+                query.keyword = keyword;
+                query.limit = 9;
+                query.withTotal = false;
+                auto listed = listByKeyset<Student>(query, [&storage](const StudentQuery &q) {
+                    return storage.listStudents(q);
+                });
+
+                auto expected = store.searchStudents(keyword, className);
+                auto key = [column](const Student &s) {
+                    return std::make_pair(column == StudentQuery::ByName    ? s.name
+                                          : column == StudentQuery::ByClass ? s.className
+                                                                            : std::string(),
+                                          s.studentId);
+                };
+                std::sort(expected.begin(), expected.end(), [&](const Student &a, const Student &b) {
+                    return descending ? key(b) < key(a) : key(a) < key(b);
+                });
+                ASSERT_EQ(listed.size(), expected.size());
+                for (size_t i = 0; i < listed.size(); ++i)
+                {
+                    EXPECT_EQ(listed[i].studentId, expected[i].studentId);
+                }
+
+                query.offset = 9;
+                query.withTotal = true;
+                auto second = drogon::sync_wait(storage.listStudents(query));
+                EXPECT_EQ(second.total, static_cast<int>(expected.size()));
+                for (size_t i = 0; i < second.rows.size(); ++i)
+                {
+                    EXPECT_EQ(second.rows[i].studentId, expected[9 + i].studentId);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DataStoreTest, Storage_ListsAttendancesInEveryOrder)
+{
+    // Enough records that unfiltered listings walk the shards rather than sort
+    auto &store = DataStore::getInstance();
+    auto students = store.getAllStudents();
+    std::vector<Attendance> batch;
+    for (unsigned day = 1; day <= 25; ++day)
+    {
+        for (size_t s = 0; s < students.size(); ++s)
+        {
+            for (int copy = 0; copy < 12; ++copy)
+            {
+                batch.emplace_back(0, students[s].studentId, "", "", Date::fromYmd(2024, 11, day),
+                                   static_cast<StatusCode>((day + s) % 4), "");
+            }
+        }
+    }
+    ASSERT_EQ(store.addAttendances(batch), static_cast<int>(batch.size()));
+    for (size_t i = 0; i < batch.size(); i += 5)
+    {
+        ASSERT_TRUE(store.deleteAttendance(batch[i].id));
+    }
+
+    std::vector<AttendanceFilter> filters(3);
+    filters[1].studentId = students[2].studentId;
+    filters[2].status = StatusCode::Late;
+    auto &storage = Storage::of(Storage::Backend::Memory);
+    for (uint8_t column : {AttendanceQuery::ById, AttendanceQuery::ByStudent,
+                           AttendanceQuery::ByName, AttendanceQuery::ByDate})
+    {
+        for (bool descending : {false, true})
+        {
+            for (const auto &filter : filters)
+            {
+                AttendanceQuery query;
+                query.filter = filter;
+                query.sortColumn = column;
+                query.descending = descending;
+                query.limit = 250;
+                query.withTotal = false;
+                auto listed = listByKeyset<Attendance>(query, [&storage](const AttendanceQuery &q) {
+                    return storage.listAttendances(q);
+                });
+
+                auto expected = store.searchAttendances(filter);
+                auto key = [column](const Attendance &a) {
+                    return std::make_tuple(column == AttendanceQuery::ByStudent ? a.studentId
+                                           : column == AttendanceQuery::ByName  ? a.name
+                                                                                : std::string(),
+                                           column == AttendanceQuery::ByDate ? a.date.ordinal() : 0,
+                                           a.id);
+                };
+                std::sort(expected.begin(), expected.end(),
+                          [&](const Attendance &a, const Attendance &b) {
+                              return descending ? key(b) < key(a) : key(a) < key(b);
+                          });
+                ASSERT_EQ(listed.size(), expected.size());
+                for (size_t i = 0; i < listed.size(); ++i)
+                {
+                    ASSERT_EQ(listed[i].id, expected[i].id);
+                }
+
+                query.offset = 500;
+                query.withTotal = true;
+                auto third = drogon::sync_wait(storage.listAttendances(query));
+                EXPECT_EQ(third.total, static_cast<int>(expected.size()));
+                for (size_t i = 0; i < third.rows.size(); ++i)
+                {
+                    EXPECT_EQ(third.rows[i].id, expected[500 + i].id);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(DataStoreTest, Storage_WritesShowInReads)
+{
+    auto &storage = Storage::of(Storage::Backend::Hybrid);
+    ASSERT_TRUE(drogon::sync_wait(storage.addStudent(Student("2024900", "新生", "新班级"))));
+    EXPECT_FALSE(drogon::sync_wait(storage.addStudent(Student("2024900", "重复", "新班级"))));
+
+    std::vector<Attendance> rows(2);
+    rows[0].studentId = "2024900";
+    rows[0].date = Date::fromYmd(2024, 12, 20);
+    rows[0].status = StatusCode::Late;
+    rows[1].studentId = "unknown";
+    rows[1].date = rows[0].date;
+    EXPECT_EQ(drogon::sync_wait(storage.addAttendances(rows)), 1);
+    ASSERT_NE(rows[0].id, 0);
+    EXPECT_EQ(rows[0].className, "新班级");
+    EXPECT_EQ(rows[1].id, 0);
+
+    auto generation = storage.attendanceGeneration("新班级", std::nullopt, std::nullopt);
+    ASSERT_TRUE(drogon::sync_wait(storage.updateAttendance(rows[0].id, std::nullopt, "补签")));
+    EXPECT_GT(storage.attendanceGeneration("新班级", std::nullopt, std::nullopt), generation);
+    auto updated = drogon::sync_wait(storage.getAttendance(rows[0].id));
+    ASSERT_TRUE(updated.has_value());
+    EXPECT_EQ(updated->status, StatusCode::Late);
+    EXPECT_EQ(updated->remark, "补签");
+
+    AttendanceQuery query;
+    query.filter.className = "新班级";
+    auto page = drogon::sync_wait(storage.listAttendances(query));
+    ASSERT_EQ(page.rows.size(), 1u);
+    EXPECT_EQ(page.rows[0].id, rows[0].id);
+    auto classStudents = drogon::sync_wait(storage.classStudents("新班级"));
+    ASSERT_TRUE(classStudents.has_value());
+    EXPECT_EQ(classStudents->size(), 1u);
+
+    EXPECT_TRUE(drogon::sync_wait(storage.deleteAttendance(rows[0].id)));
+    EXPECT_FALSE(drogon::sync_wait(storage.getAttendance(rows[0].id)).has_value());
+    EXPECT_TRUE(drogon::sync_wait(storage.deleteStudent("2024900")));
+    EXPECT_FALSE(drogon::sync_wait(storage.classStudents("新班级")).has_value());
+}
+
+TEST_F(DataStoreTest, Snapshot_FromRecordsMatchesStore)
+{
+    auto &store = DataStore::getInstance();
+    auto attendances = store.getAllAttendances();
+    std::sort(attendances.begin(), attendances.end(),
+              [](const Attendance &a, const Attendance &b) { return a.id < b.id; });
+    auto view = DataSnapshot::fromRecords(store.getAllStudents(), attendances, 7);
+    auto live = store.snapshot();
+
+    EXPECT_EQ(view->generation(), 7u);
+    EXPECT_EQ(view->attendanceCount(), live->attendanceCount());
+    EXPECT_EQ(view->getStudentsByClass("人文2402班").size(),
+              live->getStudentsByClass("人文2402班").size());
+    auto day = *Date::parse("2025-12-15");
+    EXPECT_EQ(view->dailyHistogram(day, ""), live->dailyHistogram(day, ""));
+
+    std::vector<int> ids;
+    int last = 0;
+    while (true)
+    {
+        auto next = view->scanAttendancesAfter(last, 2, [&ids](const AttendanceTable::Row &row) {
+            ids.push_back(row.id());
+        });
+        if (next == last)
+            break;
+        last = next;
+    }
+    ASSERT_EQ(ids.size(), attendances.size());
+    EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end()));
+}
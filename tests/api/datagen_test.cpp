@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <set>
+#include "student_attendance/datagen/BulkLoader.h"
+#include "student_attendance/datagen/SchoolGenerator.h"
+#include "student_attendance/models/DataStore.h"
+
+using namespace student_attendance::datagen;
+using namespace student_attendance::models;
+using student_attendance::utils::Date;
+using student_attendance::utils::StatusCode;
+
+class SchoolGeneratorTest : public ::testing::Test
+{
+protected:
+    static SchoolSpec smallSpec()
+    {
+        SchoolSpec spec;
+        spec.classes = 3;
+        spec.studentsPerClass = 10;
+        spec.termDays = 12;
+        return spec;
+    }
+
+    static std::vector<Attendance> collect(const SchoolGenerator &generator, size_t batchSize)
+    {
+        std::vector<Attendance> all;
+        generator.generateAttendances(batchSize, [&](const std::vector<Attendance> &batch) {
+            EXPECT_LE(batch.size(), batchSize);
+            all.insert(all.end(), batch.begin(), batch.end());
+        });
+        return all;
+    }
+};
+
+TEST_F(SchoolGeneratorTest, StudentsMatchSpec)
+{
+    SchoolGenerator generator(smallSpec());
+    auto students = generator.students();
+    ASSERT_EQ(students.size(), 30u);
+
+    std::set<std::string> ids;
+    std::set<std::string> classes;
+    for (const auto &student : students)
+    {
+        ids.insert(student.studentId);
+        classes.insert(student.className);
+        EXPECT_FALSE(student.name.empty());
+    }
+    EXPECT_EQ(ids.size(), 30u);
+    EXPECT_EQ(classes.size(), 3u);
+    EXPECT_EQ(students.front().className, "人文2401班");
+    EXPECT_EQ(students.front().studentId, "20240000001");
+}
+
+TEST_F(SchoolGeneratorTest, TermSkipsWeekends)
+{
+    SchoolGenerator generator(smallSpec());
+    auto days = generator.termDays();
+    ASSERT_EQ(days.size(), 12u);
+    EXPECT_EQ(days.front(), Date::fromYmd(2024, 9, 2));
+    for (auto day : days)
+    {
+        std::chrono::weekday weekday{std::chrono::sys_days{std::chrono::days{day.ordinal()}}};
+        EXPECT_NE(weekday, std::chrono::Saturday);
+        EXPECT_NE(weekday, std::chrono::Sunday);
+    }
+    EXPECT_EQ(days.back(), Date::fromYmd(2024, 9, 17));
+}
+
+TEST_F(SchoolGeneratorTest, AttendancesCoverEveryStudentEveryDay)
+{
+    SchoolGenerator generator(smallSpec());
+    auto records = collect(generator, 7);
+    ASSERT_EQ(records.size(), 360u);
+    EXPECT_EQ(records.front().date, Date::fromYmd(2024, 9, 2));
+    EXPECT_EQ(records.back().date, Date::fromYmd(2024, 9, 17));
+    EXPECT_FALSE(records.front().className.empty());
+}
+
+TEST_F(SchoolGeneratorTest, SameSpecSameData)
+{
+    auto first = collect(SchoolGenerator(smallSpec()), 50);
+    auto second = collect(SchoolGenerator(smallSpec()), 64);
+    ASSERT_EQ(first.size(), second.size());
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        EXPECT_EQ(first[i].studentId, second[i].studentId);
+        EXPECT_EQ(first[i].status, second[i].status);
+    }
+}
+
+TEST_F(SchoolGeneratorTest, StatusWeightsAreHonored)
+{
+    auto spec = smallSpec();
+    spec.statusWeights = {0, 0, 0, 0, 1, 0};
+    auto records = collect(SchoolGenerator(spec), 100);
+    for (const auto &att : records)
+    {
+        EXPECT_EQ(att.status, StatusCode::Late);
+    }
+
+    spec.statusWeights = {1, 0, 0, 0, 0, 0};
+    records = collect(SchoolGenerator(spec), 100);
+    for (const auto &att : records)
+    {
+        EXPECT_EQ(att.status, StatusCode::Present);
+    }
+}
+
+TEST_F(SchoolGeneratorTest, BulkLoadIntoDataStore)
+{
+    auto &store = DataStore::getInstance();
+    auto stats = BulkLoader::loadDataStore(SchoolGenerator(smallSpec()), store);
+    EXPECT_EQ(stats.students, 30);
+    EXPECT_EQ(stats.attendances, 360);
+    EXPECT_EQ(store.getAllStudents().size(), 30u);
+    EXPECT_EQ(store.getAllAttendances().size(), 360u);
+    EXPECT_EQ(store.getClassStudentCount("人文2401班"), 10);
+
+    auto histogram = store.dailyHistogram(Date::fromYmd(2024, 9, 2), "");
+    int total = 0;
+    for (int count : histogram)
+    {
+        total += count;
+    }
+    EXPECT_EQ(total, 30);
+
+    store.reset();
+}
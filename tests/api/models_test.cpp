@@ -4,6 +4,27 @@
 #include "student_attendance/models/User.h"
 
 using namespace student_attendance::models;
+using student_attendance::utils::JsonWriter;
+using student_attendance::utils::AttendanceStatus;
+using student_attendance::utils::Date;
+using student_attendance::utils::StatusCode;
+
+namespace
+{
+
+template <typename Model>
+Json::Value writtenJson(const Model &model)
+{
+    std::string text;
+    JsonWriter json(text);
+    model.writeJson(json);
+    Json::Value value;
+    Json::Reader reader;
+    EXPECT_TRUE(reader.parse(text, value)) << text;
+    return value;
+}
+
+}  // namespace
 
 // ==================== Student Model Tests ====================
 
@@ -114,6 +135,12 @@ TEST_F(StudentModelTest, SpecialCharactersInFields)
     EXPECT_EQ(json["class"].asString(), "人文2401班（A）");
 }
 
+TEST_F(StudentModelTest, WriteJson_MatchesToJson)
+{
+    Student student("2024-001", "张\"三\"\n", "人文2401班");
+    EXPECT_EQ(writtenJson(student), student.toJson());
+}
+
 // ==================== Attendance Model Tests ====================
 
 class AttendanceModelTest : public ::testing::Test
@@ -130,33 +157,33 @@ TEST_F(AttendanceModelTest, DefaultConstructor)
     EXPECT_TRUE(att.studentId.empty());
     EXPECT_TRUE(att.name.empty());
     EXPECT_TRUE(att.className.empty());
-    EXPECT_TRUE(att.date.empty());
-    EXPECT_TRUE(att.status.empty());
+    EXPECT_FALSE(att.date.valid());
+    EXPECT_EQ(att.status, StatusCode::Present);
     EXPECT_TRUE(att.remark.empty());
 }
 
 TEST_F(AttendanceModelTest, ParameterizedConstructor)
 {
-    Attendance att(1, "2024001", "张三", "人文2401班", "12-15", "present", "正常出勤");
+    Attendance att(1, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15), StatusCode::Present, "正常出勤");
 
     EXPECT_EQ(att.id, 1);
     EXPECT_EQ(att.studentId, "2024001");
     EXPECT_EQ(att.name, "张三");
     EXPECT_EQ(att.className, "人文2401班");
-    EXPECT_EQ(att.date, "12-15");
-    EXPECT_EQ(att.status, "present");
+    EXPECT_EQ(att.date, Date::fromYmd(2024, 12, 15));
+    EXPECT_EQ(att.status, StatusCode::Present);
     EXPECT_EQ(att.remark, "正常出勤");
 }
 
 TEST_F(AttendanceModelTest, ParameterizedConstructor_DefaultRemark)
 {
-    Attendance att(1, "2024001", "张三", "人文2401班", "12-15", "present");
+    Attendance att(1, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15), StatusCode::Present);
     EXPECT_TRUE(att.remark.empty());
 }
 
 TEST_F(AttendanceModelTest, ToJson_ContainsAllFields)
 {
-    Attendance att(1, "2024001", "张三", "人文2401班", "12-15", "present", "备注");
+    Attendance att(1, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15), StatusCode::Present, "备注");
     auto json = att.toJson();
 
     EXPECT_TRUE(json.isMember("id"));
@@ -172,7 +199,7 @@ TEST_F(AttendanceModelTest, ToJson_ContainsAllFields)
     EXPECT_EQ(json["student_id"].asString(), "2024001");
     EXPECT_EQ(json["name"].asString(), "张三");
     EXPECT_EQ(json["class"].asString(), "人文2401班");
-    EXPECT_EQ(json["date"].asString(), "12-15");
+    EXPECT_EQ(json["date"].asString(), "2024-12-15");
     EXPECT_EQ(json["status"].asString(), "present");
     EXPECT_EQ(json["status_symbol"].asString(), "√");
     EXPECT_EQ(json["remark"].asString(), "备注");
@@ -180,21 +207,21 @@ TEST_F(AttendanceModelTest, ToJson_ContainsAllFields)
 
 TEST_F(AttendanceModelTest, ToJson_StatusSymbols)
 {
-    std::vector<std::pair<std::string, std::string>> statusSymbols = {
-        {"present", "√"},
-        {"absent", "X"},
-        {"personal_leave", "△"},
-        {"sick_leave", "○"},
-        {"late", "+"},
-        {"early_leave", "–"}
+    std::vector<std::pair<StatusCode, std::string>> statusSymbols = {
+        {StatusCode::Present, "√"},
+        {StatusCode::Absent, "X"},
+        {StatusCode::PersonalLeave, "△"},
+        {StatusCode::SickLeave, "○"},
+        {StatusCode::Late, "+"},
+        {StatusCode::EarlyLeave, "–"}
     };
 
     for (const auto &[status, symbol] : statusSymbols)
     {
-        Attendance att(1, "2024001", "张三", "人文2401班", "12-15", status);
+        Attendance att(1, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15), status);
         auto json = att.toJson();
         EXPECT_EQ(json["status_symbol"].asString(), symbol)
-            << "Status: " << status << " should have symbol: " << symbol;
+            << "Status: " << AttendanceStatus::toString(status) << " should have symbol: " << symbol;
     }
 }
 
@@ -205,7 +232,7 @@ TEST_F(AttendanceModelTest, FromJson_AllFields)
     json["student_id"] = "2024002";
     json["name"] = "李四";
     json["class"] = "人文2402班";
-    json["date"] = "12-16";
+    json["date"] = "2024-12-16";
     json["status"] = "late";
     json["remark"] = "迟到5分钟";
 
@@ -215,8 +242,8 @@ TEST_F(AttendanceModelTest, FromJson_AllFields)
     EXPECT_EQ(att.studentId, "2024002");
     EXPECT_EQ(att.name, "李四");
     EXPECT_EQ(att.className, "人文2402班");
-    EXPECT_EQ(att.date, "12-16");
-    EXPECT_EQ(att.status, "late");
+    EXPECT_EQ(att.date, Date::fromYmd(2024, 12, 16));
+    EXPECT_EQ(att.status, StatusCode::Late);
     EXPECT_EQ(att.remark, "迟到5分钟");
 }
 
@@ -245,7 +272,7 @@ TEST_F(AttendanceModelTest, FromJson_EmptyJson)
 
 TEST_F(AttendanceModelTest, ToJsonFromJson_RoundTrip)
 {
-    Attendance original(1, "2024001", "张三", "人文2401班", "12-15", "present", "备注");
+    Attendance original(1, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15), StatusCode::Present, "备注");
     auto json = original.toJson();
     Attendance restored = Attendance::fromJson(json);
 
@@ -258,6 +285,13 @@ TEST_F(AttendanceModelTest, ToJsonFromJson_RoundTrip)
     EXPECT_EQ(original.remark, restored.remark);
 }
 
+TEST_F(AttendanceModelTest, WriteJson_MatchesToJson)
+{
+    Attendance att(7, "2024001", "张三", "人文2401班", Date::fromYmd(2024, 12, 15),
+                   StatusCode::SickLeave, "发烧\t38°C");
+    EXPECT_EQ(writtenJson(att), att.toJson());
+}
+
 // ==================== User Model Tests ====================
 
 class UserModelTest : public ::testing::Test
@@ -2,6 +2,10 @@
 #include "student_attendance/db/DatabaseManager.h"
 #include "student_attendance/services/ReportService.h"
 #include "student_attendance/models/DataStore.h"
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <trantor/net/EventLoopThread.h>
 
 using namespace student_attendance::services;
 using namespace student_attendance::db;
@@ -27,7 +31,7 @@ protected:
 TEST_F(ReportApiTest, GetDetailsReport_Success)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "", "");
+        "2025-12-01", "2025-12-31", "", "");
     EXPECT_TRUE(data.isMember("period"));
     EXPECT_TRUE(data.isMember("records"));
 }
@@ -35,21 +39,21 @@ TEST_F(ReportApiTest, GetDetailsReport_Success)
 TEST_F(ReportApiTest, GetDetailsReport_WithClassFilter)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "人文2401班", "");
+        "2025-12-01", "2025-12-31", "人文2401班", "");
     EXPECT_TRUE(data.isMember("records"));
 }
 
 TEST_F(ReportApiTest, GetDetailsReport_WithStudentFilter)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "", "2024001");
+        "2025-12-01", "2025-12-31", "", "2024001");
     EXPECT_TRUE(data.isMember("records"));
 }
 
 // GET /api/v1/reports/daily - 考勤日报表
 TEST_F(ReportApiTest, GetDailyReport_Success)
 {
-    auto data = ReportService::getInstance().getDailyReport("12-15", "");
+    auto data = ReportService::getInstance().getDailyReport("2025-12-15", "");
     EXPECT_TRUE(data.isMember("date"));
     EXPECT_TRUE(data.isMember("summary"));
     EXPECT_TRUE(data.isMember("details"));
@@ -57,7 +61,7 @@ TEST_F(ReportApiTest, GetDailyReport_Success)
 
 TEST_F(ReportApiTest, GetDailyReport_WithClassFilter)
 {
-    auto data = ReportService::getInstance().getDailyReport("12-15", "人文2401班");
+    auto data = ReportService::getInstance().getDailyReport("2025-12-15", "人文2401班");
     EXPECT_TRUE(data.isMember("details"));
 }
 
@@ -65,7 +69,7 @@ TEST_F(ReportApiTest, GetDailyReport_WithClassFilter)
 TEST_F(ReportApiTest, GetSummaryReport_Success)
 {
     auto data = ReportService::getInstance().getSummaryReport(
-        "12-01", "12-31", "");
+        "2025-12-01", "2025-12-31", "");
     EXPECT_TRUE(data.isMember("period"));
     EXPECT_TRUE(data.isMember("summary"));
 }
@@ -73,7 +77,7 @@ TEST_F(ReportApiTest, GetSummaryReport_Success)
 TEST_F(ReportApiTest, GetSummaryReport_WithClassFilter)
 {
     auto data = ReportService::getInstance().getSummaryReport(
-        "12-01", "12-31", "人文2401班");
+        "2025-12-01", "2025-12-31", "人文2401班");
     EXPECT_TRUE(data.isMember("summary"));
 }
 
@@ -81,7 +85,7 @@ TEST_F(ReportApiTest, GetSummaryReport_WithClassFilter)
 TEST_F(ReportApiTest, GetAbnormalReport_Success)
 {
     auto data = ReportService::getInstance().getAbnormalReport(
-        "12-01", "12-31", "", "");
+        "2025-12-01", "2025-12-31", "", "");
     EXPECT_TRUE(data.isMember("period"));
     EXPECT_TRUE(data.isMember("abnormal_records"));
     EXPECT_TRUE(data.isMember("statistics"));
@@ -90,7 +94,7 @@ TEST_F(ReportApiTest, GetAbnormalReport_Success)
 TEST_F(ReportApiTest, GetAbnormalReport_WithTypeFilter)
 {
     auto data = ReportService::getInstance().getAbnormalReport(
-        "12-01", "12-31", "", "absent");
+        "2025-12-01", "2025-12-31", "", "absent");
     EXPECT_TRUE(data.isMember("abnormal_records"));
 }
 
@@ -98,7 +102,7 @@ TEST_F(ReportApiTest, GetAbnormalReport_WithTypeFilter)
 TEST_F(ReportApiTest, GetLeaveReport_Success)
 {
     auto data = ReportService::getInstance().getLeaveReport(
-        "12-01", "12-31", "", "");
+        "2025-12-01", "2025-12-31", "", "");
     EXPECT_TRUE(data.isMember("period"));
     EXPECT_TRUE(data.isMember("leave_records"));
     EXPECT_TRUE(data.isMember("statistics"));
@@ -107,7 +111,7 @@ TEST_F(ReportApiTest, GetLeaveReport_Success)
 TEST_F(ReportApiTest, GetLeaveReport_WithTypeFilter)
 {
     auto data = ReportService::getInstance().getLeaveReport(
-        "12-01", "12-31", "", "sick_leave");
+        "2025-12-01", "2025-12-31", "", "sick_leave");
     EXPECT_TRUE(data.isMember("leave_records"));
 }
 
@@ -122,7 +126,7 @@ TEST_F(ReportApiTest, GetDetailsReport_EmptyDateRange)
 TEST_F(ReportApiTest, GetDetailsReport_InvalidDateRange)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-31", "12-01", "", "");  // End before start
+        "2025-12-31", "2025-12-01", "", "");  // End before start
     // Should handle gracefully
     EXPECT_TRUE(data.isMember("records"));
 }
@@ -130,21 +134,21 @@ TEST_F(ReportApiTest, GetDetailsReport_InvalidDateRange)
 TEST_F(ReportApiTest, GetDetailsReport_SameDayRange)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-15", "12-15", "", "");
+        "2025-12-15", "2025-12-15", "", "");
     EXPECT_TRUE(data.isMember("records"));
 }
 
 TEST_F(ReportApiTest, GetDetailsReport_NonExistentClass)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "不存在的班级", "");
+        "2025-12-01", "2025-12-31", "不存在的班级", "");
     EXPECT_TRUE(data.isMember("records"));
 }
 
 TEST_F(ReportApiTest, GetDetailsReport_NonExistentStudent)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "", "9999999");
+        "2025-12-01", "2025-12-31", "", "9999999");
     EXPECT_TRUE(data.isMember("records"));
 }
 
@@ -156,7 +160,7 @@ TEST_F(ReportApiTest, GetDailyReport_EmptyDate)
 
 TEST_F(ReportApiTest, GetDailyReport_NonExistentClass)
 {
-    auto data = ReportService::getInstance().getDailyReport("12-15", "不存在的班级");
+    auto data = ReportService::getInstance().getDailyReport("2025-12-15", "不存在的班级");
     EXPECT_TRUE(data.isMember("details"));
 }
 
@@ -169,7 +173,7 @@ TEST_F(ReportApiTest, GetSummaryReport_EmptyDateRange)
 TEST_F(ReportApiTest, GetSummaryReport_NonExistentClass)
 {
     auto data = ReportService::getInstance().getSummaryReport(
-        "12-01", "12-31", "不存在的班级");
+        "2025-12-01", "2025-12-31", "不存在的班级");
     EXPECT_TRUE(data.isMember("summary"));
 }
 
@@ -185,7 +189,7 @@ TEST_F(ReportApiTest, GetAbnormalReport_AllAbnormalTypes)
     for (const auto &type : types)
     {
         auto data = ReportService::getInstance().getAbnormalReport(
-            "12-01", "12-31", "", type);
+            "2025-12-01", "2025-12-31", "", type);
         EXPECT_TRUE(data.isMember("abnormal_records"))
             << "Failed for type: " << type;
     }
@@ -203,7 +207,7 @@ TEST_F(ReportApiTest, GetLeaveReport_AllLeaveTypes)
     for (const auto &type : types)
     {
         auto data = ReportService::getInstance().getLeaveReport(
-            "12-01", "12-31", "", type);
+            "2025-12-01", "2025-12-31", "", type);
         EXPECT_TRUE(data.isMember("leave_records"))
             << "Failed for type: " << type;
     }
@@ -212,21 +216,315 @@ TEST_F(ReportApiTest, GetLeaveReport_AllLeaveTypes)
 TEST_F(ReportApiTest, GetDetailsReport_WithBothFilters)
 {
     auto data = ReportService::getInstance().getDetailsReport(
-        "12-01", "12-31", "人文2401班", "2024001");
+        "2025-12-01", "2025-12-31", "人文2401班", "2024001");
     EXPECT_TRUE(data.isMember("records"));
 }
 
 TEST_F(ReportApiTest, GetAbnormalReport_WithBothFilters)
 {
     auto data = ReportService::getInstance().getAbnormalReport(
-        "12-01", "12-31", "人文2401班", "absent");
+        "2025-12-01", "2025-12-31", "人文2401班", "absent");
     EXPECT_TRUE(data.isMember("abnormal_records"));
 }
 
 TEST_F(ReportApiTest, GetLeaveReport_WithBothFilters)
 {
     auto data = ReportService::getInstance().getLeaveReport(
-        "12-01", "12-31", "人文2401班", "sick_leave");
+        "2025-12-01", "2025-12-31", "人文2401班", "sick_leave");
     EXPECT_TRUE(data.isMember("leave_records"));
 }
 
+
+// ==================== 报表缓存测试 ====================
+
+namespace
+{
+
+using student_attendance::utils::StatusCode;
+
+Attendance attendanceOf(const std::string &studentId, const std::string &date, StatusCode status)
+{
+    Attendance att;
+    att.studentId = studentId;
+    att.date = *student_attendance::utils::Date::parse(date);
+    att.status = status;
+    return att;
+}
+
+}  // namespace
+
+TEST_F(ReportApiTest, ReportCache_RepeatedRequestIsHit)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+
+    auto first = ReportService::getInstance().getSummaryReport("2025-12-01", "2025-12-31", "");
+    auto second = ReportService::getInstance().getSummaryReport("2025-12-01", "2025-12-31", "");
+    EXPECT_EQ(first, second);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST_F(ReportApiTest, ReportCache_WriteInScopeInvalidates)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+
+    auto before = ReportService::getInstance().getDailyReport("2025-12-16", "人文2401班");
+    EXPECT_EQ(before["summary"]["total_students"].asInt(), 0);
+
+    std::vector<Attendance> batch = {
+        attendanceOf("2024001", "2025-12-16", StatusCode::Late)};
+    DataStore::getInstance().addAttendances(batch);
+
+    auto after = ReportService::getInstance().getDailyReport("2025-12-16", "人文2401班");
+    EXPECT_EQ(after["summary"]["total_students"].asInt(), 1);
+    EXPECT_EQ(cache.stats().invalidations, 1u);
+}
+
+TEST_F(ReportApiTest, ReportCache_WriteOutsideScopeKeepsEntry)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+
+    ReportService::getInstance().getAbnormalReport("2025-12-01", "2025-12-31", "人文2401班", "");
+
+    // Another class in range, and the same class outside the range
+    std::vector<Attendance> batch = {
+        attendanceOf("2024004", "2025-12-16", StatusCode::Absent),
+        attendanceOf("2024001", "2025-11-20", StatusCode::Absent)};
+    DataStore::getInstance().addAttendances(batch);
+
+    ReportService::getInstance().getAbnormalReport("2025-12-01", "2025-12-31", "人文2401班", "");
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.invalidations, 0u);
+}
+
+TEST_F(ReportApiTest, ReportCache_RemarkUpdateInvalidates)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+
+    auto &store = DataStore::getInstance();
+    AttendanceFilter filter;
+    filter.studentId = "2024003";
+    auto late = store.searchAttendances(filter).at(0);
+
+    ReportService::getInstance().getAbnormalReport("2025-12-15", "2025-12-15", "", "late");
+    store.updateAttendance(late.id, std::nullopt, "迟到十分钟");
+
+    auto data =
+        ReportService::getInstance().getAbnormalReport("2025-12-15", "2025-12-15", "", "late");
+    ASSERT_EQ(data["abnormal_records"].size(), 1u);
+    EXPECT_EQ(data["abnormal_records"][0]["remark"].asString(), "迟到十分钟");
+}
+
+TEST_F(ReportApiTest, ReportCache_RosterChangeInvalidatesSummary)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+
+    ReportService::getInstance().getSummaryReport("2025-12-01", "2025-12-31", "人文2403班");
+    DataStore::getInstance().updateStudent("2024007", Student("2024007", "周久", ""));
+
+    auto data = ReportService::getInstance().getSummaryReport("2025-12-01", "2025-12-31", "人文2403班");
+    bool renamed = false;
+    for (const auto &row : data["summary"])
+    {
+        renamed = renamed || row["name"].asString() == "周久";
+    }
+    EXPECT_TRUE(renamed);
+}
+
+TEST_F(ReportApiTest, ReportCache_ResetInvalidates)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+
+    auto &store = DataStore::getInstance();
+    ReportService::getInstance().getDetailsReport("2025-12-01", "2025-12-31", "", "");
+    store.clear();
+
+    auto data = ReportService::getInstance().getDetailsReport("2025-12-01", "2025-12-31", "", "");
+    EXPECT_EQ(data["records"].size(), 0u);
+}
+
+TEST_F(ReportApiTest, ReportCache_DisabledComputesEveryTime)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+    cache.setCapacity(0, 0);
+
+    ReportService::getInstance().getLeaveReport("2025-12-01", "2025-12-31", "", "");
+    ReportService::getInstance().getLeaveReport("2025-12-01", "2025-12-31", "", "");
+    auto stats = cache.stats();
+    cache.setCapacity(ReportCache::kMaxEntries, ReportCache::kMaxBytes);
+
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST_F(ReportApiTest, ReportCache_EvictsLeastRecentlyUsed)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+    cache.setCapacity(2, ReportCache::kMaxBytes);
+
+    auto &service = ReportService::getInstance();
+    service.getDailyReport("2025-12-13", "");
+    service.getDailyReport("2025-12-14", "");
+    service.getDailyReport("2025-12-13", "");  // 12-14 is now the oldest
+    service.getDailyReport("2025-12-15", "");
+    service.getDailyReport("2025-12-13", "");
+    auto stats = cache.stats();
+    cache.setCapacity(ReportCache::kMaxEntries, ReportCache::kMaxBytes);
+
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.hits, 2u);
+}
+
+using student_attendance::utils::JsonWriter;
+
+// Computes `key` on another thread and holds it in flight until the
+// returned promise is set
+class InFlightReport
+{
+public:
+    InFlightReport(const std::string &key, const ReportCache::Scope &scope)
+    {
+        auto started = std::make_shared<std::promise<void>>();
+        auto release = release_.get_future().share();
+        thread_ = std::thread([=] {
+            ReportCache::getInstance().get(key, scope, [&](JsonWriter &json) {
+                started->set_value();
+                release.wait();
+                json.value("old");
+            });
+        });
+        started->get_future().wait();
+    }
+    ~InFlightReport()
+    {
+        release_.set_value();
+        thread_.join();
+    }
+
+private:
+    std::promise<void> release_;
+    std::thread thread_;
+};
+
+TEST_F(ReportApiTest, ReportCache_InFlightStaleIsRecomputed)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    cache.resetStats();
+    ReportCache::Scope scope;
+    scope.className = "人文2401班";
+
+    InFlightReport inFlight("stale", scope);
+    std::vector<Attendance> batch = {
+        attendanceOf("2024001", "2025-12-16", StatusCode::Late)};
+    DataStore::getInstance().addAttendances(batch);
+
+    // Joining would wait on the release below and miss the write
+    auto body = cache.get("stale", scope, [](JsonWriter &json) {
+        json.value("new");
+    });
+    EXPECT_EQ(*body, "\"new\"");
+    EXPECT_EQ(cache.stats().invalidations, 1u);
+}
+
+TEST_F(ReportApiTest, ReportCache_LoopThreadDoesNotWaitInFlight)
+{
+    auto &cache = ReportCache::getInstance();
+    cache.clear();
+    ReportCache::Scope scope;
+
+    InFlightReport inFlight("busy", scope);
+    trantor::EventLoopThread thread;
+    thread.run();
+    std::promise<std::string> done;
+    thread.getLoop()->queueInLoop([&] {
+        auto body = cache.get("busy", scope, [](JsonWriter &json) {
+            json.value("own");
+        });
+        done.set_value(*body);
+    });
+    EXPECT_EQ(done.get_future().get(), "\"own\"");
+}
+
+// ==================== 并行报表测试 ====================
+
+// Enough students and rows that reports are split across the compute pool
+TEST_F(ReportApiTest, ParallelReports_MatchSerialOrder)
+{
+    auto &store = DataStore::getInstance();
+    store.clear();
+    std::vector<Student> roster;
+    for (int n = 0; n < 2400; ++n)
+    {
+        char id[16];
+        std::snprintf(id, sizeof(id), "S%05d", n);
+        roster.push_back(Student(id, "学生" + std::to_string(n), "班级" + std::to_string(n % 12)));
+    }
+    store.importStudents(roster);
+
+    std::vector<Attendance> rows;
+    for (int day = 1; day <= 20; ++day)
+    {
+        char date[16];
+        std::snprintf(date, sizeof(date), "2025-11-%02d", day);
+        for (const auto &student : roster)
+        {
+            rows.push_back(attendanceOf(student.studentId, date,
+                                        day % 5 == 0 ? StatusCode::Late : StatusCode::Present));
+        }
+    }
+    store.addAttendances(rows);
+    ReportCache::getInstance().clear();
+
+    auto details =
+        ReportService::getInstance().getDetailsReport("2025-11-01", "2025-11-30", "", "");
+    ASSERT_EQ(details["records"].size(), roster.size());
+    std::string previous;
+    for (const auto &record : details["records"])
+    {
+        auto key = record["class"].asString() + "/" + record["student_id"].asString();
+        EXPECT_LT(previous, key);
+        previous = key;
+
+        const auto &days = record["attendance_details"];
+        ASSERT_EQ(days.size(), 20u);
+        for (Json::ArrayIndex i = 1; i < days.size(); ++i)
+        {
+            EXPECT_LT(days[i - 1]["date"].asString(), days[i]["date"].asString());
+        }
+    }
+
+    auto summary = ReportService::getInstance().getSummaryReport("2025-11-01", "2025-11-30", "");
+    ASSERT_EQ(summary["summary"].size(), roster.size());
+    for (Json::ArrayIndex i = 0; i < summary["summary"].size(); ++i)
+    {
+        const auto &row = summary["summary"][i];
+        EXPECT_EQ(row["student_id"], details["records"][i]["student_id"]);
+        EXPECT_EQ(row["total_days"].asInt(), 20);
+        EXPECT_EQ(row["late_count"].asInt(), 4);
+    }
+
+    // Recomputed from scratch, the text is identical
+    ReportCache::getInstance().clear();
+    EXPECT_EQ(ReportService::getInstance().getDetailsReport("2025-11-01", "2025-11-30", "", ""),
+              details);
+}
@@ -67,6 +67,40 @@ TEST_F(StudentApiTest, GetStudents_WithSorting)
     }
 }
 
+TEST_F(StudentApiTest, GetStudents_CursorWalksWholeListing)
+{
+    auto &service = StudentService::getInstance();
+    auto full = service.getStudents(1, 100, "class", "desc", "", "");
+    ASSERT_GT(full.students.size(), 3u);
+    EXPECT_TRUE(full.nextCursor.empty());
+
+    // Many students share a class, so the walk relies on the student_id tiebreak
+    std::vector<std::string> walked;
+    auto page = service.getStudents(1, 3, "class", "desc", "", "", std::nullopt, false);
+    EXPECT_EQ(page.total, -1);
+    while (true)
+    {
+        for (const auto &student : page.students)
+        {
+            walked.push_back(student.studentId);
+        }
+        if (page.nextCursor.empty())
+        {
+            break;
+        }
+        auto cursor = student_attendance::utils::PageCursor::decode(page.nextCursor);
+        ASSERT_TRUE(cursor.has_value());
+        // The cursor keeps its ordering even when the request asks for another
+        page = service.getStudents(1, 3, "", "asc", "", "", cursor, false);
+    }
+
+    ASSERT_EQ(walked.size(), full.students.size());
+    for (size_t i = 0; i < walked.size(); ++i)
+    {
+        EXPECT_EQ(walked[i], full.students[i].studentId);
+    }
+}
+
 // POST /api/v1/students - 新增学生
 TEST_F(StudentApiTest, CreateStudent_Success)
 {
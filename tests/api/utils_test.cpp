@@ -1,8 +1,47 @@
 #include <gtest/gtest.h>
 #include "student_attendance/utils/AttendanceStatus.h"
+#include "student_attendance/utils/ComputePool.h"
+#include "student_attendance/utils/CsvReader.h"
+#include "student_attendance/utils/CsvScanner.h"
+#include "student_attendance/utils/Date.h"
+#include "student_attendance/utils/JsonArrayReader.h"
+#include "student_attendance/utils/JsonWriter.h"
+#include <json/json.h>
+#include "student_attendance/utils/PageCursor.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
 
 using namespace student_attendance::utils;
 
+namespace
+{
+
+struct CsvRecord
+{
+    int64_t line;
+    std::vector<std::string> fields;
+};
+
+// Feeds `text` in pieces of at most `step` bytes.
+std::vector<CsvRecord> readCsv(std::string_view text, size_t step = 1 << 20,
+                               CsvScanner::Level level = CsvScanner::bestLevel())
+{
+    std::vector<CsvRecord> records;
+    auto onRecord = [&](int64_t line, const std::vector<std::string_view> &fields) {
+        records.push_back({line, std::vector<std::string>(fields.begin(), fields.end())});
+    };
+    CsvReader reader(level);
+    for (size_t i = 0; i < text.size(); i += step)
+    {
+        reader.feed(text.substr(i, step), onRecord);
+    }
+    reader.finish(onRecord);
+    return records;
+}
+
+}  // namespace
+
 class AttendanceStatusTest : public ::testing::Test
 {
 protected:
@@ -231,3 +270,397 @@ TEST_F(AttendanceStatusTest, SymbolStatusRoundTrip)
     }
 }
 
+
+// ==================== StatusCode Tests ====================
+
+TEST_F(AttendanceStatusTest, StatusCode_IsOneByte)
+{
+    static_assert(sizeof(StatusCode) == 1);
+    static_assert(AttendanceStatus::fromString("late") == StatusCode::Late);
+    static_assert(AttendanceStatus::isLeaveStatus(StatusCode::SickLeave));
+}
+
+TEST_F(AttendanceStatusTest, StatusCode_StringRoundTrip)
+{
+    for (size_t i = 0; i < kStatusCount; ++i)
+    {
+        auto code = static_cast<StatusCode>(i);
+        EXPECT_EQ(AttendanceStatus::fromString(AttendanceStatus::toString(code)), code);
+        EXPECT_EQ(AttendanceStatus::fromSymbol(AttendanceStatus::getSymbol(code)), code);
+        EXPECT_EQ(AttendanceStatus::fromInt(static_cast<int>(i)), code);
+    }
+}
+
+TEST_F(AttendanceStatusTest, StatusCode_RejectsUnknownValues)
+{
+    EXPECT_FALSE(AttendanceStatus::fromString("unknown").has_value());
+    EXPECT_FALSE(AttendanceStatus::fromString("").has_value());
+    EXPECT_FALSE(AttendanceStatus::fromInt(-1).has_value());
+    EXPECT_FALSE(AttendanceStatus::fromInt(static_cast<int>(kStatusCount)).has_value());
+}
+
+// ==================== Date Tests ====================
+
+class DateTest : public ::testing::Test
+{
+};
+
+TEST_F(DateTest, Parse_FullDate)
+{
+    auto date = Date::parse("2024-12-15");
+    ASSERT_TRUE(date.has_value());
+    EXPECT_EQ(*date, Date::fromYmd(2024, 12, 15));
+    EXPECT_EQ(date->toString(), "2024-12-15");
+}
+
+TEST_F(DateTest, Parse_MonthDayUsesDefaultYear)
+{
+    auto date = Date::parse("12-15");
+    ASSERT_TRUE(date.has_value());
+    EXPECT_EQ(*date, Date::fromYmd(Date::defaultYear(), 12, 15));
+}
+
+TEST_F(DateTest, Parse_RejectsMalformedInput)
+{
+    EXPECT_FALSE(Date::parse("").has_value());
+    EXPECT_FALSE(Date::parse("12/15").has_value());
+    EXPECT_FALSE(Date::parse("2024-13-01").has_value());
+    EXPECT_FALSE(Date::parse("2023-02-29").has_value());
+    EXPECT_FALSE(Date::parse("2024-1-15").has_value());
+    EXPECT_TRUE(Date::parse("2024-02-29").has_value());
+}
+
+TEST_F(DateTest, Ordinal_CountsDaysFromEpoch)
+{
+    EXPECT_EQ(Date::fromYmd(1970, 1, 1).ordinal(), 0);
+    EXPECT_EQ(Date::fromYmd(2025, 1, 1).ordinal() - Date::fromYmd(2024, 12, 31).ordinal(), 1);
+    EXPECT_LT(Date::fromYmd(2024, 12, 31), Date::fromYmd(2025, 1, 1));
+    EXPECT_EQ(Date::fromOrdinal(Date::fromYmd(2024, 3, 1).ordinal()).toString(), "2024-03-01");
+}
+
+TEST_F(DateTest, Default_IsInvalid)
+{
+    Date date;
+    EXPECT_FALSE(date.valid());
+    EXPECT_TRUE(date.toString().empty());
+    EXPECT_FALSE(Date::fromYmd(2024, 2, 30).valid());
+}
+
+// ==================== PageCursor Tests ====================
+
+TEST(PageCursorTest, Encode_RoundTrips)
+{
+    PageCursor cursor;
+    cursor.sortColumn = 2;
+    cursor.descending = true;
+    cursor.key = "张三:12";
+    cursor.id = "2024001";
+
+    auto token = cursor.encode();
+    EXPECT_EQ(token.find_first_not_of(
+                  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"),
+              std::string::npos);
+
+    auto decoded = PageCursor::decode(token);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->sortColumn, 2);
+    EXPECT_TRUE(decoded->descending);
+    EXPECT_EQ(decoded->key, "张三:12");
+    EXPECT_EQ(decoded->id, "2024001");
+}
+
+TEST(PageCursorTest, Encode_AllowsEmptyKey)
+{
+    PageCursor cursor;
+    cursor.id = "42";
+    auto decoded = PageCursor::decode(cursor.encode());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->sortColumn, 0);
+    EXPECT_FALSE(decoded->descending);
+    EXPECT_TRUE(decoded->key.empty());
+    EXPECT_EQ(decoded->id, "42");
+}
+
+TEST(PageCursorTest, Decode_RejectsGarbage)
+{
+    EXPECT_FALSE(PageCursor::decode("").has_value());
+    EXPECT_FALSE(PageCursor::decode("not a cursor").has_value());
+    EXPECT_FALSE(PageCursor::decode("a").has_value());
+    // Valid base64url, wrong payload
+    EXPECT_FALSE(PageCursor::decode("aGVsbG8").has_value());
+}
+
+// ==================== CsvReader Tests ====================
+
+TEST(CsvReaderTest, SplitsRecordsAndFields)
+{
+    auto records = readCsv("student_id,name,class\n2024001,张三,计算机2401\n");
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].fields, (std::vector<std::string>{"student_id", "name", "class"}));
+    EXPECT_EQ(records[1].fields, (std::vector<std::string>{"2024001", "张三", "计算机2401"}));
+    EXPECT_EQ(records[1].line, 2);
+}
+
+TEST(CsvReaderTest, QuotedFields)
+{
+    auto records = readCsv("a,\"b,c\",\"say \"\"hi\"\"\",\"\"\n");
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].fields, (std::vector<std::string>{"a", "b,c", "say \"hi\"", ""}));
+}
+
+TEST(CsvReaderTest, QuotedLineBreaksKeepLineNumbers)
+{
+    auto records = readCsv("h\n\"one\ntwo\",x\nnext,y\n");
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[1].fields[0], "one\ntwo");
+    EXPECT_EQ(records[1].line, 2);
+    EXPECT_EQ(records[2].line, 4);
+}
+
+TEST(CsvReaderTest, CrLfBlankLinesAndMissingFinalNewline)
+{
+    auto records = readCsv("a,b\r\n\r\nc,d\r\n\ne,f");
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[1].fields, (std::vector<std::string>{"c", "d"}));
+    EXPECT_EQ(records[1].line, 3);
+    EXPECT_EQ(records[2].fields, (std::vector<std::string>{"e", "f"}));
+    EXPECT_EQ(records[2].line, 5);
+}
+
+TEST(CsvReaderTest, SkipsByteOrderMark)
+{
+    auto records = readCsv("\xEF\xBB\xBFstudent_id,name\n");
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].fields[0], "student_id");
+}
+
+TEST(CsvReaderTest, ChunkBoundariesDoNotMatter)
+{
+    const std::string text =
+        "\xEF\xBB\xBFid,text\r\n1,\"a,\"\"b\"\"\r\nc\"\r\n2,plain\n\n3,\"\"\n";
+    auto whole = readCsv(text);
+    ASSERT_EQ(whole.size(), 4u);
+    for (size_t step = 1; step < text.size(); ++step)
+    {
+        auto pieces = readCsv(text, step);
+        ASSERT_EQ(pieces.size(), whole.size()) << "step " << step;
+        for (size_t i = 0; i < whole.size(); ++i)
+        {
+            EXPECT_EQ(pieces[i].line, whole[i].line) << "step " << step;
+            EXPECT_EQ(pieces[i].fields, whole[i].fields) << "step " << step;
+        }
+    }
+}
+
+TEST(CsvReaderTest, ReportsUnterminatedQuote)
+{
+    CsvReader reader;
+    reader.feed("a,\"open\n", [](int64_t, const std::vector<std::string_view> &) {});
+    EXPECT_TRUE(reader.inQuotedField());
+}
+
+TEST(CsvReaderTest, SameRecordsAtEveryScannerLevel)
+{
+    // Long enough for whole 64-byte blocks plus a partial tail
+    std::string text = "id,text\n";
+    for (int i = 0; i < 200; ++i)
+    {
+        text += std::to_string(i) + (i % 7 == 0 ? ",\"x,\"\"y\"\"\nz\"\r\n" : ",plain text\n");
+    }
+    auto reference = readCsv(text, 1 << 20, CsvScanner::Level::Scalar);
+    ASSERT_EQ(reference.size(), 201u);
+    for (auto level : {CsvScanner::Level::Sse2, CsvScanner::Level::Avx2})
+    {
+        for (size_t step : {size_t(13), size_t(64), size_t(1) << 20})
+        {
+            auto records = readCsv(text, step, level);
+            ASSERT_EQ(records.size(), reference.size()) << CsvScanner::levelName(level);
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                EXPECT_EQ(records[i].line, reference[i].line);
+                EXPECT_EQ(records[i].fields, reference[i].fields);
+            }
+        }
+    }
+}
+
+// ==================== CsvScanner Tests ====================
+
+TEST(CsvScannerTest, FindsEverySpecialByteAtEveryLevel)
+{
+    // Deterministic bytes with specials scattered across block boundaries
+    std::string text(1000, 'a');
+    uint32_t seed = 12345;
+    for (auto &c : text)
+    {
+        seed = seed * 1103515245 + 12345;
+        c = static_cast<char>((seed >> 16) & 0xFF);
+    }
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (CsvScanner::isSpecial(text[i]))
+            expected.push_back(i);
+    }
+    ASSERT_FALSE(expected.empty());
+
+    for (auto level : {CsvScanner::Level::Scalar, CsvScanner::Level::Sse2,
+                       CsvScanner::Level::Avx2})
+    {
+        CsvScanner scanner(text, level);
+        std::vector<size_t> found;
+        for (size_t pos = scanner.next(0); pos < text.size(); pos = scanner.next(pos + 1))
+        {
+            found.push_back(pos);
+        }
+        EXPECT_EQ(found, expected) << CsvScanner::levelName(level);
+    }
+}
+
+TEST(CsvScannerTest, ReturnsSizeWhenNothingFound)
+{
+    std::string text(130, 'x');
+    CsvScanner scanner(text);
+    EXPECT_EQ(scanner.next(0), text.size());
+    EXPECT_EQ(scanner.next(129), text.size());
+    EXPECT_EQ(CsvScanner(std::string_view()).next(0), 0u);
+}
+
+// ==================== JsonArrayReader Tests ====================
+
+TEST(JsonArrayReaderTest, SplitsTopLevelElements)
+{
+    const std::string text =
+        " [{\"a\":[1,2],\"b\":\"x,]}\"}, {\"c\":\"\\\"\"} ,3]";
+    std::vector<std::string> whole;
+    JsonArrayReader reader;
+    ASSERT_TRUE(reader.feed(text, [&](int64_t index, std::string_view element) {
+        EXPECT_EQ(index, static_cast<int64_t>(whole.size()) + 1);
+        whole.emplace_back(element);
+    }));
+    EXPECT_TRUE(reader.complete());
+    ASSERT_EQ(whole.size(), 3u);
+    EXPECT_EQ(whole[0], "{\"a\":[1,2],\"b\":\"x,]}\"}");
+    EXPECT_EQ(whole[1], "{\"c\":\"\\\"\"} ");
+    EXPECT_EQ(whole[2], "3");
+
+    for (size_t step = 1; step < text.size(); ++step)
+    {
+        std::vector<std::string> pieces;
+        JsonArrayReader split;
+        for (size_t i = 0; i < text.size(); i += step)
+        {
+            split.feed(std::string_view(text).substr(i, step),
+                       [&](int64_t, std::string_view element) { pieces.emplace_back(element); });
+        }
+        EXPECT_EQ(pieces, whole) << "step " << step;
+    }
+}
+
+TEST(JsonArrayReaderTest, RejectsNonArray)
+{
+    JsonArrayReader reader;
+    EXPECT_FALSE(reader.feed("{\"a\":1}", [](int64_t, std::string_view) {}));
+    EXPECT_FALSE(reader.opened());
+}
+
+TEST(JsonArrayReaderTest, EmptyArray)
+{
+    JsonArrayReader reader;
+    int count = 0;
+    EXPECT_TRUE(reader.feed("[ ]", [&](int64_t, std::string_view) { ++count; }));
+    EXPECT_TRUE(reader.complete());
+    EXPECT_EQ(count, 0);
+}
+
+// ==================== JsonWriter Tests ====================
+
+TEST(JsonWriterTest, WritesNestedValuesWithSeparators)
+{
+    std::string out;
+    JsonWriter json(out);
+    json.beginObject()
+        .member("code", 200)
+        .member("ok", true)
+        .key("items")
+        .beginArray()
+        .value(1)
+        .beginObject()
+        .member("a", "b")
+        .endObject()
+        .beginArray()
+        .endArray()
+        .null()
+        .endArray()
+        .member("rate", 0.5)
+        .endObject();
+    EXPECT_EQ(out, "{\"code\":200,\"ok\":true,\"items\":[1,{\"a\":\"b\"},[],null],\"rate\":0.5}");
+}
+
+TEST(JsonWriterTest, EscapesStrings)
+{
+    std::string out;
+    JsonWriter(out).value(std::string_view("q\"b\\n\nt\tc\x01张三", 16));
+    EXPECT_EQ(out, "\"q\\\"b\\\\n\\nt\\tc\\u0001张三\"");
+
+    Json::Value parsed;
+    ASSERT_TRUE(Json::Reader().parse(out, parsed));
+    EXPECT_EQ(parsed.asString(), std::string("q\"b\\n\nt\tc\x01张三", 16));
+}
+
+TEST(JsonWriterTest, NumbersRoundTrip)
+{
+    std::string out;
+    JsonWriter json(out);
+    json.beginArray()
+        .value(-42)
+        .value(int64_t(1) << 40)
+        .value(0.1)
+        .value(95.45)
+        .value(1.0 / 0.0)
+        .endArray();
+    EXPECT_EQ(out, "[-42,1099511627776,0.1,95.45,null]");
+}
+
+// ==================== ComputePool 测试 ====================
+
+TEST(ComputePoolTest, ParallelForRunsEveryIndexOnce)
+{
+    std::vector<std::atomic<int>> calls(1000);
+    ComputePool::getInstance().parallelFor(calls.size(), [&](size_t i) { calls[i]++; });
+    for (const auto &count : calls)
+    {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(ComputePoolTest, NestedParallelForCompletes)
+{
+    auto &pool = ComputePool::getInstance();
+    std::atomic<int> total{0};
+    pool.parallelFor(pool.size() * 2, [&](size_t) {
+        pool.parallelFor(100, [&](size_t) { total++; });
+    });
+    EXPECT_EQ(total.load(), static_cast<int>(pool.size() * 2 * 100));
+}
+
+TEST(ComputePoolTest, ParallelForRethrows)
+{
+    std::atomic<int> calls{0};
+    EXPECT_THROW(ComputePool::getInstance().parallelFor(64,
+                                                        [&](size_t i) {
+                                                            calls++;
+                                                            if (i == 7)
+                                                                throw std::runtime_error("x");
+                                                        }),
+                 std::runtime_error);
+    EXPECT_EQ(calls.load(), 64);
+}
+
+TEST(ComputePoolTest, PartitionsRespectMinimum)
+{
+    auto &pool = ComputePool::getInstance();
+    EXPECT_EQ(pool.partitions(0, 100), 1u);
+    EXPECT_EQ(pool.partitions(250, 100), 2u);
+    EXPECT_LE(pool.partitions(1u << 30, 1), pool.size() * 4);
+}
@@ -45,6 +45,7 @@ target_end()
 if has_config("build_server") then
   add_requires("drogon", {configs = {mysql = false, postgresql = false, sqlite3 = true}})
   add_requires("jsoncpp")
+  add_requires("sqlite3")
 
   target("student_attendance_server_lib")
     set_kind("static")
@@ -53,10 +54,12 @@ if has_config("build_server") then
       "src/db/**.cc",
       "src/models/**.cc",
       "src/services/**.cc",
-      "src/controllers/**.cc"
+      "src/controllers/**.cc",
+      "src/datagen/**.cc",
+      "src/utils/**.cc"
     )
     add_includedirs("include", {public = true})
-    add_packages("drogon", "jsoncpp", {public = true})
+    add_packages("drogon", "jsoncpp", "sqlite3", {public = true})
 
   target_end()
 
@@ -70,6 +73,13 @@ if has_config("build_server") then
     end)
 
   target_end()
+
+  target("student_attendance_datagen")
+    set_kind("binary")
+    add_files("src/datagen_main.cpp")
+    add_deps("student_attendance_server_lib")
+
+  target_end()
 end
 
 if has_config("build_tests") and has_config("build_server") then
@@ -84,6 +94,18 @@ if has_config("build_tests") and has_config("build_server") then
   target_end()
 end
 
+if has_config("build_benchmarks") and has_config("build_server") then
+  add_requires("benchmark")
+
+  target("benchmarks")
+    set_kind("binary")
+    add_files("benchmarks/**.cpp")
+    add_deps("student_attendance_server_lib")
+    add_packages("benchmark")
+
+  target_end()
+end
+
 task("docs")
   set_menu {
     usage = "xmake docs",